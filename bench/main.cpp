@@ -0,0 +1,478 @@
+// gr-render-bench: micro benchmarks of the library hot paths on a headless
+// context. Results are written as JSON; with --baseline they are compared
+// against an earlier run and the exit code is 1 when a case got slower than
+// the threshold. The steady state frame allocation check is a ctest
+// (tests/frame_allocations_test.cpp).
+//
+//   gr-render-bench [--classic | --dsa] [--filter <text>] [--min-time <ms>]
+//                   [--out <file>] [--baseline <file>] [--threshold <percent>]
+
+#include "buffer_layout.hpp"
+#include "context.hpp"
+#include "gFramebuffer.h"
+#include "gRender.h"
+#include "gTexture.h"
+#include "gVertexArray.h"
+#include "gl.h"
+#include "index_buffer.hpp"
+#include "shader.hpp"
+#include "vertex_array.hpp"
+#include "vertex_buffer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace gr;
+
+namespace
+{
+    struct bench_options
+    {
+        const char* filter = nullptr;
+
+        double min_time_ms = 200.0;
+
+        // amostras por caso; o resultado e a mediana
+        uint32_t samples = 5;
+    };
+
+    struct bench_result
+    {
+        std::string name;
+
+        uint64_t iterations;
+
+        double ns_per_op;
+
+        // 0 when the case does not move data
+        double bytes_per_second;
+    };
+
+    class bench_runner
+    {
+    public:
+        explicit bench_runner(const bench_options& options)
+            : m_options(options)
+        {
+        }
+
+        // Runs body in batches until min_time is reached, samples times, and keeps
+        // the median time per call. finish = true waits for the GPU at the end of
+        // each batch, so uploads and readbacks are timed to completion.
+        void run(const std::string& name, uint64_t bytes_per_op, bool finish, const std::function<void()>& body)
+        {
+            if (m_options.filter != nullptr && name.find(m_options.filter) == std::string::npos)
+                return;
+
+            using clock = std::chrono::steady_clock;
+
+            auto batch = [&](uint64_t iterations) {
+                clock::time_point start = clock::now();
+                for (uint64_t i = 0; i < iterations; i++)
+                    body();
+                if (finish)
+                    glFinish();
+                return std::chrono::duration<double, std::nano>(clock::now() - start).count();
+            };
+
+            // aquecimento e calibragem
+            batch(1);
+
+            const double sample_ns = m_options.min_time_ms * 1e6 / m_options.samples;
+            uint64_t iterations = 1;
+            double elapsed = batch(iterations);
+            while (elapsed < sample_ns && iterations < (1ull << 30))
+            {
+                double scale = elapsed > 0.0 ? sample_ns / elapsed * 1.2 : 10.0;
+                iterations = std::max<uint64_t>(iterations + 1, static_cast<uint64_t>(iterations * std::min(scale, 10.0)));
+                elapsed = batch(iterations);
+            }
+
+            std::vector<double> times;
+            for (uint32_t i = 0; i < m_options.samples; i++)
+                times.push_back(batch(iterations) / static_cast<double>(iterations));
+
+            std::sort(times.begin(), times.end());
+            double ns = times[times.size() / 2];
+
+            bench_result result;
+            result.name = name;
+            result.iterations = iterations;
+            result.ns_per_op = ns;
+            result.bytes_per_second = bytes_per_op > 0 ? bytes_per_op / (ns * 1e-9) : 0.0;
+            m_results.push_back(result);
+
+            fprintf(stderr, "%-40s %14.1f ns/op", name.c_str(), ns);
+            if (bytes_per_op > 0)
+                fprintf(stderr, " %10.1f MiB/s", result.bytes_per_second / (1024.0 * 1024.0));
+            fprintf(stderr, "\n");
+        }
+
+        inline const std::vector<bench_result>& get_results() const
+        {
+            return m_results;
+        }
+
+    private:
+        bench_options m_options;
+
+        std::vector<bench_result> m_results;
+    };
+
+    const char* k_vertex_source =
+        "#version 330 core\n"
+        "layout(location = 0) in vec3 a_position;\n"
+        "layout(location = 1) in vec2 a_uv;\n"
+        "uniform vec4 u_offset;\n"
+        "out vec2 v_uv;\n"
+        "void main() { gl_Position = vec4(a_position * 0.01, 1.0) + u_offset; v_uv = a_uv; }\n";
+
+    const char* k_fragment_source =
+        "#version 330 core\n"
+        "in vec2 v_uv;\n"
+        "uniform vec4 u_color;\n"
+        "out vec4 o_color;\n"
+        "void main() { o_color = vec4(v_uv, 0.0, 1.0) * u_color; }\n";
+
+    constexpr uint32_t k_target_size = 256;
+
+    constexpr uint32_t k_draws = 100;
+
+    void bench_draws(bench_runner& runner)
+    {
+        Shader shader;
+        if (shader.build(&k_fragment_source, 1, &k_vertex_source, 1) < 0)
+        {
+            fprintf(stderr, "gr-render-bench: shader build failed, skipping draws\n");
+            return;
+        }
+
+        UniformID offset = shader.registry("u_offset", 1, UniformType::VEC4);
+        shader.registry("u_color", 1, UniformType::VEC4);
+
+        const float vertices[] = {-1, -1, 0, 0, 0, 1, -1, 0, 1, 0, 1, 1, 0, 1, 1, -1, 1, 0, 0, 1};
+        const uint32_t indices[] = {0, 1, 2, 0, 2, 3};
+
+        auto vbo = vertex_buffer::create(vertices, sizeof(vertices), buffer_usage::static_draw);
+        vbo->SetLayout({{shader_data_type::Float3, "a_position"}, {shader_data_type::Float2, "a_uv"}});
+        auto vao = vertex_array::create();
+        vao->AddVertexBuffer(vbo);
+        auto ibo = index_buffer::create(indices, sizeof(indices));
+        vao->SetIndexBuffer(ibo);
+
+        shader.bind();
+        vao->Bind();
+
+        const float color[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+        shader.setUniform("u_color", color);
+
+        runner.run("draw_elements_x100", 0, false, [&]() {
+            for (uint32_t i = 0; i < k_draws; i++)
+                gVertexArray::DrawElements(TRIANGLES, 6, nullptr);
+        });
+
+        runner.run("draw_elements_instanced_x100", 0, false, [&]() {
+            gVertexArray::DrawElementsInstanced(TRIANGLES, 6, nullptr, k_draws);
+        });
+
+        float value[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+        runner.run("shader_set_uniform_by_name", 0, false, [&]() {
+            value[0] += 1e-6f;
+            shader.setUniform("u_offset", value);
+        });
+
+        runner.run("shader_set_uniform_by_id", 0, false, [&]() {
+            value[0] += 1e-6f;
+            shader.SetUniform(offset, value);
+        });
+
+        shader.unbind();
+        glFinish();
+    }
+
+    void bench_vertex_buffer(bench_runner& runner)
+    {
+        const uint32_t sizes[] = {1 << 10, 64 << 10, 1 << 20, 8 << 20};
+
+        std::vector<uint8_t> data(sizes[3], 0x5a);
+        auto vbo = vertex_buffer::create(data.data(), sizes[3], buffer_usage::dynamic_draw);
+
+        for (uint32_t size : sizes)
+        {
+            std::string name = "vertex_buffer_set_data_" + std::to_string(size >> 10) + "k";
+            runner.run(name, size, true, [&]() {
+                vbo->SetData(data.data(), size);
+            });
+        }
+    }
+
+    void bench_texture_upload(bench_runner& runner)
+    {
+        struct format_case
+        {
+            TextureFormat format;
+
+            const char* name;
+        };
+
+        const format_case formats[] = {
+            {TextureFormat_RGBA8888, "rgba8888"},
+            {TextureFormat_RGB888, "rgb888"},
+            {TextureFormat_RGB565, "rgb565"},
+            {TextureFormat_RGBA4444, "rgba4444"},
+            {TextureFormat_RED, "red"},
+            {TextureFormat_RG, "rg"},
+            {TextureFormat_RGBA16F, "rgba16f"},
+            {TextureFormat_RGBA32F, "rgba32f"},
+        };
+
+        const uint32_t size = 512;
+        std::vector<uint8_t> pixels(size * size * 16, 0x3c);
+
+        for (const format_case& item : formats)
+        {
+            gTexture texture;
+            texture.set_format(item.format);
+            texture.updateBuffer(size, size, pixels.data());
+
+            uint64_t bytes = static_cast<uint64_t>(size) * size * texture.get_pixel_size();
+            runner.run(std::string("texture_update_") + item.name, bytes, true, [&]() {
+                texture.updateBuffer(size, size, pixels.data());
+            });
+        }
+    }
+
+    void bench_read_pixels(bench_runner& runner)
+    {
+        const uint32_t size = 1024;
+
+        gTexture target;
+        target.set_format(TextureFormat_RGBA8888);
+        target.updateBuffer(size, size, nullptr);
+
+        u32 framebuffer = gFramebuffer::Create();
+        gFramebuffer::Bind(framebuffer);
+        gFramebuffer::SetTexture(&target, gFramebufferFlags_Color_Attachiment0);
+
+        std::vector<uint8_t> pixels(size * size * 4);
+        runner.run("framebuffer_get_pixels_1024", static_cast<uint64_t>(size) * size * 4, true, [&]() {
+            gFramebuffer::GetPixels(0, 0, 0, size, size, TextureFormat_RGBA8888, pixels.data());
+        });
+
+        gFramebuffer::Unbind();
+        gFramebuffer::Destroy(framebuffer);
+    }
+
+    void bench_buffer_layout(bench_runner& runner)
+    {
+        uint64_t sink = 0;
+
+        runner.run("buffer_layout_construct", 0, false, [&]() {
+            buffer_layout layout = {
+                {shader_data_type::Float3, "a_position"},
+                {shader_data_type::Float3, "a_normal"},
+                {shader_data_type::Float2, "a_uv"},
+                {shader_data_type::Float4, "a_color"},
+                {shader_data_type::Float4, "a_transform", true},
+            };
+            sink += layout.get_hash();
+        });
+
+        if (sink == 1)
+            fprintf(stderr, "\n");
+    }
+
+    std::string json_escape(const std::string& text)
+    {
+        std::string out;
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+                out += '\\';
+            if (static_cast<unsigned char>(c) >= 0x20)
+                out += c;
+        }
+        return out;
+    }
+
+    std::string to_json(const std::vector<bench_result>& results, const char* renderer, const char* path)
+    {
+        std::ostringstream out;
+        out.precision(17);
+        out << "{\n";
+        out << "  \"renderer\": \"" << json_escape(renderer) << "\",\n";
+        out << "  \"render_path\": \"" << path << "\",\n";
+        out << "  \"benchmarks\": [\n";
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const bench_result& result = results[i];
+            out << "    {\"name\": \"" << json_escape(result.name) << "\", \"iterations\": " << result.iterations
+                << ", \"ns_per_op\": " << result.ns_per_op << ", \"bytes_per_second\": " << result.bytes_per_second << "}"
+                << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        out << "  ]\n";
+        out << "}\n";
+        return out.str();
+    }
+
+    // Only understands what to_json writes: "name" followed by "ns_per_op" in
+    // each entry of "benchmarks".
+    bool read_baseline(const char* path, std::unordered_map<std::string, double>& baseline)
+    {
+        std::ifstream file(path);
+        if (!file)
+            return false;
+
+        std::stringstream stream;
+        stream << file.rdbuf();
+        std::string text = stream.str();
+
+        const std::string name_key = "\"name\": \"";
+        const std::string time_key = "\"ns_per_op\": ";
+
+        size_t cursor = 0;
+        while ((cursor = text.find(name_key, cursor)) != std::string::npos)
+        {
+            size_t begin = cursor + name_key.size();
+            size_t end = text.find('"', begin);
+            size_t time = text.find(time_key, end);
+            if (end == std::string::npos || time == std::string::npos)
+                return false;
+
+            baseline[text.substr(begin, end - begin)] = strtod(text.c_str() + time + time_key.size(), nullptr);
+            cursor = time;
+        }
+
+        return true;
+    }
+
+    // number of cases slower than the baseline by more than threshold percent
+    uint32_t compare(const std::vector<bench_result>& results, const std::unordered_map<std::string, double>& baseline, double threshold)
+    {
+        uint32_t regressions = 0;
+
+        fprintf(stderr, "\n%-40s %14s %14s %9s\n", "case", "baseline ns", "current ns", "change");
+        for (const bench_result& result : results)
+        {
+            auto it = baseline.find(result.name);
+            if (it == baseline.end() || it->second <= 0.0)
+            {
+                fprintf(stderr, "%-40s %14s %14.1f %9s\n", result.name.c_str(), "-", result.ns_per_op, "new");
+                continue;
+            }
+
+            double change = (result.ns_per_op / it->second - 1.0) * 100.0;
+            bool regressed = change > threshold;
+            regressions += regressed ? 1 : 0;
+
+            fprintf(stderr, "%-40s %14.1f %14.1f %+8.1f%%%s\n", result.name.c_str(), it->second, result.ns_per_op, change, regressed ? "  REGRESSION" : "");
+        }
+
+        return regressions;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bench_options options;
+    context_config config;
+    const char* out_path = nullptr;
+    const char* baseline_path = nullptr;
+    double threshold = 10.0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool has_value = i + 1 < argc;
+
+        if (strcmp(argv[i], "--classic") == 0)
+            config.path = RenderPath::Classic;
+        else if (strcmp(argv[i], "--dsa") == 0)
+            config.path = RenderPath::DirectStateAccess;
+        else if (strcmp(argv[i], "--filter") == 0 && has_value)
+            options.filter = argv[++i];
+        else if (strcmp(argv[i], "--min-time") == 0 && has_value)
+            options.min_time_ms = std::max(1.0, atof(argv[++i]));
+        else if (strcmp(argv[i], "--out") == 0 && has_value)
+            out_path = argv[++i];
+        else if (strcmp(argv[i], "--baseline") == 0 && has_value)
+            baseline_path = argv[++i];
+        else if (strcmp(argv[i], "--threshold") == 0 && has_value)
+            threshold = atof(argv[++i]);
+        else
+        {
+            fprintf(stderr, "usage: gr-render-bench [--classic | --dsa] [--filter <text>] [--min-time <ms>] [--out <file>] [--baseline <file>] [--threshold <percent>]\n");
+            return 1;
+        }
+    }
+
+    std::unordered_map<std::string, double> baseline;
+    if (baseline_path != nullptr && !read_baseline(baseline_path, baseline))
+    {
+        fprintf(stderr, "gr-render-bench: cannot read baseline %s\n", baseline_path);
+        return 1;
+    }
+
+    std::unique_ptr<context> ctx = context::create_headless(config);
+    if (ctx == nullptr || !ctx->make_current())
+    {
+        fprintf(stderr, "gr-render-bench: no headless context\n");
+        return 1;
+    }
+
+    // o contexto surfaceless nao tem framebuffer padrao
+    gTexture target;
+    target.set_format(TextureFormat_RGBA8888);
+    target.updateBuffer(k_target_size, k_target_size, nullptr);
+
+    u32 framebuffer = gFramebuffer::Create();
+    gFramebuffer::Bind(framebuffer);
+    gFramebuffer::SetTexture(&target, gFramebufferFlags_Color_Attachiment0);
+    gRender::SetViewport(Rect{0, 0, static_cast<float>(k_target_size), static_cast<float>(k_target_size)});
+
+    bench_runner runner(options);
+
+    bench_draws(runner);
+    bench_vertex_buffer(runner);
+    bench_texture_upload(runner);
+    bench_buffer_layout(runner);
+
+    bench_read_pixels(runner);
+
+    gFramebuffer::Unbind();
+    gFramebuffer::Destroy(framebuffer);
+
+    const char* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    const char* path = ctx->get_render_path() == RenderPath::DirectStateAccess ? "dsa" : "classic";
+    std::string json = to_json(runner.get_results(), renderer != nullptr ? renderer : "", path);
+
+    if (out_path != nullptr)
+    {
+        std::ofstream file(out_path);
+        file << json;
+        if (!file)
+        {
+            fprintf(stderr, "gr-render-bench: cannot write %s\n", out_path);
+            return 1;
+        }
+    }
+    else
+    {
+        fputs(json.c_str(), stdout);
+    }
+
+    if (baseline_path != nullptr)
+        return compare(runner.get_results(), baseline, threshold) > 0 ? 1 : 0;
+
+    return 0;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+// Heap allocation counting for checking that a steady state frame does not
+// allocate. Counting is per thread and only active when exactly one translation
+// unit of the application defines GR_DEFINE_ALLOCATION_HOOKS before including
+// this header, which replaces the global operator new/delete:
+//
+//     #define GR_DEFINE_ALLOCATION_HOOKS
+//     #include <gr-render/allocation_hooks.hpp>
+//
+//     render_frame(); // warm up
+//     {
+//         gr::allocation_scope scope;
+//         render_frame();
+//         assert(scope.get_allocations() == 0);
+//     }
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace gr
+{
+    namespace detail
+    {
+        inline thread_local uint64_t t_allocation_count = 0;
+
+        inline thread_local uint64_t t_allocation_bytes = 0;
+    }
+
+    class allocation_scope
+    {
+    public:
+        allocation_scope()
+            :
+                m_count(detail::t_allocation_count),
+                m_bytes(detail::t_allocation_bytes)
+        {}
+
+        inline uint64_t get_allocations() const
+        {
+            return detail::t_allocation_count - m_count;
+        }
+
+        inline uint64_t get_bytes() const
+        {
+            return detail::t_allocation_bytes - m_bytes;
+        }
+
+    private:
+        uint64_t m_count;
+
+        uint64_t m_bytes;
+    };
+}
+
+#ifdef GR_DEFINE_ALLOCATION_HOOKS
+
+namespace gr
+{
+    namespace detail
+    {
+        inline void* counted_alloc(size_t size)
+        {
+            t_allocation_count++;
+            t_allocation_bytes += size;
+
+            void* ptr = malloc(size ? size : 1);
+            if (ptr == nullptr)
+                throw std::bad_alloc();
+            return ptr;
+        }
+
+        inline void* counted_alloc(size_t size, std::align_val_t alignment)
+        {
+            t_allocation_count++;
+            t_allocation_bytes += size;
+
+            size_t align = static_cast<size_t>(alignment);
+#ifdef _WIN32
+            void* ptr = _aligned_malloc(size ? size : 1, align);
+#else
+            // aligned_alloc exige tamanho multiplo do alinhamento
+            void* ptr = aligned_alloc(align, ((size ? size : 1) + align - 1) & ~(align - 1));
+#endif
+            if (ptr == nullptr)
+                throw std::bad_alloc();
+            return ptr;
+        }
+
+        inline void counted_free(void* ptr, std::align_val_t)
+        {
+#ifdef _WIN32
+            _aligned_free(ptr);
+#else
+            free(ptr);
+#endif
+        }
+    }
+}
+
+void* operator new(size_t size) { return gr::detail::counted_alloc(size); }
+void* operator new[](size_t size) { return gr::detail::counted_alloc(size); }
+void* operator new(size_t size, std::align_val_t alignment) { return gr::detail::counted_alloc(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return gr::detail::counted_alloc(size, alignment); }
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete[](void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { free(ptr); }
+void operator delete(void* ptr, std::align_val_t alignment) noexcept { gr::detail::counted_free(ptr, alignment); }
+void operator delete[](void* ptr, std::align_val_t alignment) noexcept { gr::detail::counted_free(ptr, alignment); }
+void operator delete(void* ptr, size_t, std::align_val_t alignment) noexcept { gr::detail::counted_free(ptr, alignment); }
+void operator delete[](void* ptr, size_t, std::align_val_t alignment) noexcept { gr::detail::counted_free(ptr, alignment); }
+
+#endif // GR_DEFINE_ALLOCATION_HOOKS
@@ -36,7 +36,7 @@ namespace gr
         bool instanced;
 
         buffer_element(shader_data_type type, const std::string& name, bool instanced = false, bool normalized = false)
-            : name(name), type(type), size(shader_data_type_size(type)), offset(0), instanced(instanced), normalized(normalized) {}
+            : name(name), type(type), size(shader_data_type_size(type)), offset(0), normalized(normalized), instanced(instanced) {}
 
         inline uint32_t get_component_count() const
         {
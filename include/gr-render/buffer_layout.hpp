@@ -14,8 +14,29 @@ namespace gr
             : m_elements(elements) {
             calculate_offsets_and_stride();
         }
+        explicit buffer_layout(std::vector<buffer_element> elements)
+            : m_elements(std::move(elements)) {
+            calculate_offsets_and_stride();
+        }
 
         uint32_t get_stride() const { return m_stride; }
+
+        // hash of the vertex format (types, offsets, flags and stride); names are left out
+        uint64_t get_hash() const { return m_hash; }
+
+        // same vertex format, ignoring names
+        bool is_compatible(const buffer_layout& other) const {
+            if (m_hash != other.m_hash || m_stride != other.m_stride || m_elements.size() != other.m_elements.size())
+                return false;
+
+            for (size_t i = 0; i < m_elements.size(); i++) {
+                const buffer_element& a = m_elements[i];
+                const buffer_element& b = other.m_elements[i];
+                if (a.type != b.type || a.offset != b.offset || a.normalized != b.normalized || a.instanced != b.instanced)
+                    return false;
+            }
+            return true;
+        }
         const std::vector<buffer_element>& get_elements() const { return m_elements; }
 
         std::vector<buffer_element>::iterator begin() { return m_elements.begin(); }
@@ -32,10 +53,24 @@ namespace gr
                 offset += element.size;
                 m_stride += element.size;
             }
+
+            // FNV-1a
+            m_hash = 14695981039346656037ull;
+            auto mix = [this](uint64_t value) {
+                m_hash ^= value;
+                m_hash *= 1099511628211ull;
+            };
+            for (const auto& element : m_elements) {
+                mix(static_cast<uint64_t>(element.type));
+                mix(element.offset);
+                mix((element.normalized ? 1u : 0u) | (element.instanced ? 2u : 0u));
+            }
+            mix(m_stride);
         }
 
         std::vector<buffer_element> m_elements;
         uint32_t m_stride = 0;
+        uint64_t m_hash = 0;
     };
 }
 
@@ -0,0 +1,204 @@
+#pragma once
+
+#include "frame_allocator.hpp"
+#include "gCommon.h"
+
+#include <memory>
+#include <vector>
+
+namespace gr
+{
+    class vertex_array;
+
+    enum class command_type : uint8_t
+    {
+        bind_shader,
+        set_uniform,
+        bind_texture,
+        bind_vertex_array,
+        bind_legacy_vertex_array,
+        bind_framebuffer,
+        set_enable,
+        set_viewport,
+        set_scissor,
+        draw_elements,
+        draw_arrays
+    };
+
+    // One fixed size packet. Everything a command needs lives in the packet or,
+    // for uniform values, in the data area of the arena that recorded it.
+    struct alignas(64) render_command
+    {
+        uint64_t key;
+
+        command_type type;
+
+        uint8_t primitive;
+
+        uint16_t unit;
+
+        uint32_t count;
+
+        // viewport/scissor; kept out of the union since Rect is not trivial on every gr-math version
+        Rect rect;
+
+        union
+        {
+            Shader* shader;
+
+            gTexture* texture;
+
+            vertex_array* array;
+
+            gVertexArray* legacy_array;
+
+            u32 framebuffer;
+
+            struct
+            {
+                Shader* shader;
+
+                const void* data;
+
+                UniformID id;
+            } uniform;
+
+            struct
+            {
+                GEnum state;
+
+                bool value;
+            } enable;
+
+            struct
+            {
+                uint64_t offset;
+
+                uint32_t instances;
+            } draw;
+        };
+    };
+
+    static_assert(sizeof(render_command) == 64, "render_command must stay one cache line");
+
+    // Linear arena of packets written by a single thread. The packet capacity is
+    // fixed at construction: recording never locks, and a full arena drops the
+    // command and raises the overflow flag instead of growing. Uniform values go
+    // to a frame_allocator rewound by reset(), which only touches the heap until
+    // it has grown to the largest frame seen.
+    //
+    // Every packet carries the current sort key. command_replayer orders packets by
+    // (key, arena index, position), so use distinct keys per object (e.g. its
+    // index in the scene) to get the same stream no matter which thread recorded it.
+    class command_arena
+    {
+    public:
+        command_arena(uint32_t max_commands = 16384, size_t data_size = 1 << 20);
+
+        command_arena(const command_arena&) = delete;
+        command_arena& operator=(const command_arena&) = delete;
+
+        void reset();
+
+        inline void set_key(uint64_t key)
+        {
+            m_key = key;
+        }
+
+        bool bind_shader(Shader* shader);
+
+        // copies the value; the size comes from the shader uniform table. The
+        // replay binds `shader` first when another program is bound.
+        bool set_uniform(Shader* shader, UniformID id, const void* data);
+
+        bool bind_texture(gTexture* texture, uint32_t unit);
+
+        bool bind_vertex_array(vertex_array* array);
+
+        bool bind_vertex_array(gVertexArray* array);
+
+        bool bind_framebuffer(u32 framebuffer);
+
+        bool set_enable(GEnum state, bool value);
+
+        bool set_viewport(const Rect& bounds);
+
+        bool set_scissor(const Rect& bounds);
+
+        // offset in bytes into the bound index buffer; instances = 0 draws non instanced
+        bool draw_elements(PrimitiveType primitive, uint32_t count, uint64_t offset = 0, uint32_t instances = 0);
+
+        bool draw_arrays(PrimitiveType primitive, uint32_t count, uint32_t instances = 0);
+
+        inline const render_command* get_commands() const
+        {
+            return m_commands.get();
+        }
+
+        inline uint32_t size() const
+        {
+            return m_size;
+        }
+
+        inline bool overflowed() const
+        {
+            return m_overflow;
+        }
+
+    private:
+        std::unique_ptr<render_command[]> m_commands;
+
+        frame_allocator m_data;
+
+        uint32_t m_capacity;
+
+        uint32_t m_size;
+
+        uint64_t m_key;
+
+        bool m_overflow;
+
+        render_command* push(command_type type);
+
+        void* allocate(size_t size);
+    };
+
+    struct command_replay_stats
+    {
+        uint32_t commands = 0;
+
+        uint32_t draws = 0;
+
+        // binds skipped because the same object was already bound
+        uint32_t redundant = 0;
+    };
+
+    // Render thread side: merges arenas in a deterministic order and replays them
+    // through the GL wrappers, dropping redundant shader/texture/vertex array binds.
+    class command_replayer
+    {
+    public:
+        static constexpr uint32_t k_max_texture_units = 32;
+
+        void submit(command_arena* const* arenas, uint32_t count);
+
+        inline const command_replay_stats& get_stats() const
+        {
+            return m_stats;
+        }
+
+    private:
+        struct command_ref
+        {
+            uint64_t key;
+
+            uint32_t arena;
+
+            uint32_t index;
+        };
+
+        std::vector<command_ref> m_order;
+
+        command_replay_stats m_stats;
+    };
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+// Headless OpenGL contexts on EGL for batch rendering. Only built when the
+// library links EGL (GR_USE_EGL).
+
+#ifdef GR_USE_EGL
+
+#include "gCommon.h"
+#include "context_state.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gr
+{
+    struct context_config
+    {
+        // desktop GL version; gles = true asks for an OpenGL ES 3 context instead
+        int32_t major = 3;
+
+        int32_t minor = 3;
+
+        bool core_profile = true;
+
+        bool gles = false;
+
+        RenderPath path = RenderPath::Auto;
+
+        // size of the fallback pbuffer when EGL_KHR_surfaceless_context is missing
+        uint32_t width = 1;
+
+        uint32_t height = 1;
+    };
+
+    // One GL context and the library state tied to it. The wrapper caches,
+    // render_stats and the render path are kept per thread, so a context must be
+    // driven by a single thread at a time; make_current() switches that state to
+    // this context. The tables keyed by GL names live in the context_state the
+    // context owns, so contexts that don't share objects never see each other's
+    // names.
+    //
+    // The display is the Mesa surfaceless platform when available, then the first
+    // EGL device, then the default display, so it works on nodes without a GPU
+    // or a window system.
+    class context
+    {
+    public:
+        static std::unique_ptr<context> create_headless(const context_config& config = context_config());
+
+        ~context();
+
+        context(const context&) = delete;
+        context& operator=(const context&) = delete;
+
+        // The first call also runs gRender::Initialize with the configured path.
+        bool make_current();
+
+        void done_current();
+
+        // context made current on this thread, or nullptr
+        static context* get_current();
+
+        inline uint32_t get_index() const
+        {
+            return m_index;
+        }
+
+        inline RenderPath get_render_path() const
+        {
+            return m_path;
+        }
+
+        inline void* get_display() const
+        {
+            return m_display;
+        }
+
+        inline void* get_native_context() const
+        {
+            return m_context;
+        }
+
+    private:
+        context() = default;
+
+        void* m_display = nullptr;
+
+        void* m_context = nullptr;
+
+        void* m_surface = nullptr;
+
+        uint32_t m_api = 0;
+
+        uint32_t m_index = 0;
+
+        RenderPath m_path = RenderPath::Auto;
+
+        bool m_initialized = false;
+
+        context_state m_state;
+    };
+
+    // N headless contexts, each owned by a worker thread. Jobs go to whichever
+    // context is free; they run with their context current and must not keep GL
+    // objects across jobs unless they pin themselves to a context themselves.
+    //
+    // With Mesa llvmpipe every context also rasterizes on its own threads; set
+    // LP_NUM_THREADS to keep contexts * threads close to the core count.
+    class context_pool
+    {
+    public:
+        using job = std::function<void(context&)>;
+
+        // contexts == 0 uses std::thread::hardware_concurrency()
+        explicit context_pool(uint32_t contexts = 0, const context_config& config = context_config());
+        ~context_pool();
+
+        context_pool(const context_pool&) = delete;
+        context_pool& operator=(const context_pool&) = delete;
+
+        // dropped when no context could be made current
+        void submit(job task);
+
+        // Blocks until every submitted job finished.
+        void wait();
+
+        // contexts actually created; may be below the requested count
+        inline uint32_t get_context_count() const
+        {
+            return static_cast<uint32_t>(m_contexts.size());
+        }
+
+    private:
+        std::vector<std::unique_ptr<context>> m_contexts;
+
+        std::vector<std::thread> m_workers;
+
+        std::deque<job> m_jobs;
+
+        std::mutex m_mutex;
+
+        std::condition_variable m_job_cv;
+
+        std::condition_variable m_idle_cv;
+
+        uint32_t m_active;
+
+        // workers whose context became current
+        uint32_t m_live;
+
+        bool m_stop;
+
+        void worker_loop(context& ctx);
+    };
+}
+
+#endif // GR_USE_EGL
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "gCommon.h"
+#include "platform/null/null_device.hpp"
+
+#include <unordered_map>
+
+namespace gr
+{
+    class gVertexArray;
+
+    // Tables that follow GL object names, so they belong to one context and not
+    // to a thread: gVertexArray buffer targets and bindings, and the null_device
+    // objects. gr::context owns one per context and make_current() installs it;
+    // a thread that never made a gr::context current uses a state of its own.
+    struct context_state
+    {
+        // gVertexArray
+        std::unordered_map<BufferID, u32> buffer_targets;
+
+        u32 current_buffer = 0;
+
+        BufferID current_buffer_id = 0;
+
+        gVertexArray* bound_array = nullptr;
+
+        // null_device
+        std::unordered_map<u32, null_object> null_objects;
+
+        u32 null_next_name = 1;
+
+        u32 null_program = 0;
+
+        u32 null_vertex_array = 0;
+
+        static context_state& current();
+
+        // nullptr goes back to the state of the thread
+        static void set_current(context_state* state);
+    };
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace gr
+{
+    // Bump allocator for data that only lives until the end of the frame. Memory
+    // is never freed one allocation at a time: reset() rewinds everything.
+    //
+    // When a frame overflows the current block an extra block is taken from the
+    // heap; the next reset() folds all blocks into one big enough for that frame,
+    // so a steady state frame does not touch the heap at all.
+    class frame_allocator
+    {
+    public:
+        explicit frame_allocator(size_t block_size = 1 << 20);
+
+        frame_allocator(const frame_allocator&) = delete;
+        frame_allocator& operator=(const frame_allocator&) = delete;
+
+        void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+        // No destructor is ever run, so only trivially destructible types.
+        template <typename T>
+        T* allocate_array(size_t count)
+        {
+            static_assert(std::is_trivially_destructible<T>::value, "frame_allocator does not run destructors");
+
+            return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+        }
+
+        template <typename T, typename... Args>
+        T* create(Args&&... args)
+        {
+            static_assert(std::is_trivially_destructible<T>::value, "frame_allocator does not run destructors");
+
+            return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        }
+
+        void reset();
+
+        // bytes handed out since the last reset
+        inline size_t get_used() const
+        {
+            return m_used;
+        }
+
+        inline size_t get_capacity() const
+        {
+            return m_capacity;
+        }
+
+        // largest get_used() seen at a reset
+        inline size_t get_peak() const
+        {
+            return m_peak;
+        }
+
+        // reset() calls so far: memory taken before the count moved is gone
+        inline uint32_t get_resets() const
+        {
+            return m_resets;
+        }
+
+    private:
+        struct block
+        {
+            std::unique_ptr<uint8_t[]> data;
+
+            size_t size;
+        };
+
+        std::vector<block> m_blocks;
+
+        size_t m_block_size;
+
+        size_t m_offset;
+
+        size_t m_used;
+
+        size_t m_capacity;
+
+        size_t m_peak;
+
+        uint32_t m_resets;
+
+        void add_block(size_t size);
+    };
+}
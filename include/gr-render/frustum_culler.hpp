@@ -0,0 +1,76 @@
+#pragma once
+
+#include "gCommon.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace gr
+{
+    class thread_pool;
+
+    typedef struct Plane
+    {
+        float x, y, z, w;
+    } Plane;
+
+    struct frustum
+    {
+        // left, right, bottom, top, near, far; normals point inwards
+        Plane planes[6];
+
+        // Gribb/Hartmann extraction from a column-major (OpenGL) view-projection matrix.
+        static frustum from_matrix(const Matrix4x4& view_projection);
+    };
+
+    // Bounding spheres and boxes in structure-of-arrays form. Boxes are kept as
+    // center/extents so the plane test needs no per-plane vertex selection.
+    class bounds_set
+    {
+    public:
+        static constexpr uint32_t k_block = 16;
+
+        uint32_t add(const Vector3& center, float radius, const Vector3& min, const Vector3& max);
+
+        void set(uint32_t index, const Vector3& center, float radius, const Vector3& min, const Vector3& max);
+
+        void reserve(uint32_t count);
+
+        void clear();
+
+        inline uint32_t size() const
+        {
+            return m_count;
+        }
+
+        const float* sphere_x() const { return m_sphere[0].data(); }
+        const float* sphere_y() const { return m_sphere[1].data(); }
+        const float* sphere_z() const { return m_sphere[2].data(); }
+        const float* sphere_r() const { return m_sphere[3].data(); }
+
+        const float* box_center(int axis) const { return m_box_center[axis].data(); }
+        const float* box_extent(int axis) const { return m_box_extent[axis].data(); }
+
+    private:
+        // padded to a multiple of k_block so the SIMD loop never reads past the end
+        std::vector<float> m_sphere[4];
+
+        std::vector<float> m_box_center[3];
+
+        std::vector<float> m_box_extent[3];
+
+        uint32_t m_count = 0;
+
+        void resize_padded(uint32_t count);
+    };
+
+    class frustum_culler
+    {
+    public:
+        // Writes the indices of visible objects, in ascending order, to `visible` and
+        // returns how many were written. `visible` must hold bounds.size() entries.
+        static uint32_t cull(const frustum& frustum, const bounds_set& bounds, uint32_t* visible, thread_pool* pool = nullptr);
+
+        static void cull(const frustum& frustum, const bounds_set& bounds, std::vector<uint32_t>& visible, thread_pool* pool = nullptr);
+    };
+}
@@ -148,6 +148,7 @@ enum class UniformType
 #define GR_MULTISAMPLE          2
 #define GR_FRAMEBUFFER_SRGB     3
 #define GR_BLEND                4
+#define GR_SCISSOR_TEST         5
 
 typedef uint32_t GEnum;
 
@@ -183,6 +184,20 @@ namespace gr
         GR_ONE_MINUS_SRC_ALPHA = 1 << 27
     };
 
+    // OpenGL entry points used for resource updates, chosen in gRender::Initialize
+    enum class RenderPath {
+        Auto,
+        Classic,            // bind, modify, unbind
+        DirectStateAccess   // OpenGL 4.5 / ARB_direct_state_access
+    };
+
+    // implementation returned by vertex_buffer/index_buffer/vertex_array::create
+    enum class RenderBackend {
+        OpenGL,
+        Software,           // CPU memory, drawn by software_rasterizer
+        Null                // no GL at all, every wrapper only validates (null_device)
+    };
+
     enum BufferBindingTarget {
         GR_ARRAY_BUFFER              = 1 << 1,
         // GR_COPY_READ_BUFFER          = 1 << 3,
@@ -232,6 +247,8 @@ namespace gr
         UniformID id;
         uint32_t stride;
         uint32_t offset;
+        uint32_t count;
+        uint32_t unit; // first texture unit of a sampler, GR_INVALID_ID otherwise
         char *name;
     } ShaderUniform;
 };
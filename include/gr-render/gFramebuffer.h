@@ -24,7 +24,8 @@ namespace gr
         static void Release();
         
     private:
-        static u32 s_current;
+        // framebuffer ligado no contexto desta thread
+        static thread_local u32 s_current;
 
         static std::unordered_map<gFramebufferFlags, u32> m_apiFramebuffer;
     };
@@ -1,8 +1,11 @@
 #pragma once
 
 #include "gCommon.h"
+#include "render_stats.hpp"
 
 namespace gr {
+    class frame_allocator;
+
     class gRender
     {
     public:
@@ -12,11 +15,35 @@ namespace gr {
 
         static void SetEnable(GEnum state, bool value);
 
+        static void SetScissor(const Rect& bounds);
+
         static void SetRenderState(RenderState state, u32 value);
 
         static std::string getRenderStateName(RenderState state);
 
-        static bool Initialize();
+        static void BeginFrame();
+
+        static void EndFrame();
+
+        // counters of the frame in progress, see render_stats for history
+        static const frame_stats& GetFrameStats();
+
+        // Scratch memory of this thread for the frame in progress (sprite_batch
+        // staging, render_stats::get_history); BeginFrame rewinds it.
+        static frame_allocator& GetFrameAllocator();
+
+        // Auto picks DirectStateAccess when the context supports it; asking for
+        // DirectStateAccess on a context without it fails.
+        static bool Initialize(RenderPath path = RenderPath::Auto);
+
+        static RenderPath GetRenderPath();
+
+        // Process wide; affects the buffers and vertex arrays created afterwards.
+        // Null makes every wrapper skip GL (see null_device); set it before
+        // Initialize, which then needs no context.
+        static void SetBackend(RenderBackend backend);
+
+        static RenderBackend GetBackend();
 
         static void Release();
 
@@ -27,11 +54,15 @@ namespace gr {
 
         static gRender& GetInstance();
 
+        static u32 GetGLRenderState(u32 value);
+
         // fields
         Color s_BackgroundColor;
 
         Rect s_ViewportBounds;
 
+        Rect s_ScissorBounds;
+
         u32 s_StateMask;
 
         // methods
@@ -41,6 +72,8 @@ namespace gr {
 
         void setViewport(const Rect& bounds);
 
+        void setScissor(const Rect& bounds);
+
         void setEnable(GEnum state, bool value);
     };
 }
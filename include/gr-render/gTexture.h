@@ -52,7 +52,21 @@ namespace gr
 
         void updateBuffer(u32 width, u32 height, void* pixels);
 
-        void bind(u32 index);
+        // Creates the texture name for a 2D image of `levels` mips without
+        // specifying any storage; levels are then filled one by one.
+        void allocate_levels(u32 width, u32 height, u32 levels);
+
+        void update_level(u32 level, const void* pixels);
+
+        // respecifies the level as 0x0, giving its memory back
+        void release_level(u32 level);
+
+        // GL_TEXTURE_BASE_LEVEL / GL_TEXTURE_MAX_LEVEL
+        void set_level_range(u32 base, u32 max);
+
+        // sampler: sampler_cache name overriding the texture's own wrap and
+        // filter on this unit; 0 samples with the texture's parameters
+        void bind(u32 index, u32 sampler = 0);
 
         void unbind();
 
@@ -78,6 +92,27 @@ namespace gr
 
         void generate_mipmaps();
 
+        void set_debug_name(const char* name);
+
+        // Called by gFramebuffer::SetTexture: from then on the texture memory is
+        // tracked as memory_category::render_target.
+        void set_render_target();
+
+        bool is_render_target() const;
+
+        // bytes of the level 0 image including every face and, with mipmaps, the full chain
+        u64 get_memory_size() const;
+
+        u32 get_pixel_size() const;
+
+        u32 get_level_count() const;
+
+        u32 get_width() const;
+
+        u32 get_height() const;
+
+        const TextureFormatInfo& get_format_info() const;
+
     private:
         static const TextureFormatInfo TextureFormatInfoMapping[20];
 
@@ -85,6 +120,8 @@ namespace gr
         
         u32 m_width;
 
+        u32 m_levels;
+
         TextureID textureID;
 
         TextureFlags_ texture_flags;
@@ -93,10 +130,36 @@ namespace gr
 
         TextureFormat m_format;
 
+        std::string m_debug_name;
+
+        // glTextureStorage2D: tamanho e niveis fixos
+        bool m_immutable;
+
+        // flags de wrap/filtro ja gravadas na textura; 0 = nada gravado
+        u32 m_applied_flags;
+
+        // anexada a um framebuffer: memoria em memory_category::render_target
+        bool m_render_target;
+
         void apply_clamping() const;
 
         void apply_filtering() const;
 
         void apply_mipmaps() const;
+
+        // apply_clamping + apply_filtering, only when those flags changed
+        void apply_sampling();
+
+        void set_parameter(u32 name, int32_t value) const;
+
+        // glTextureStorage2D only for a new texture with pixels, or when the
+        // storage already has this size; everything else takes the mutable path
+        // so the name stays the same
+        bool use_immutable_storage(u32 width, u32 height, const void* pixels) const;
+
+        void update_buffer_dsa(u32 width, u32 height, void* pixels);
+
+        // RenderBackend::Null: fake name, sizes and counters only
+        void update_buffer_null(u32 width, u32 height, const void* pixels);
     };
 } // namespace gr
@@ -18,6 +18,8 @@ namespace gr
 
         static void DeleteBuffer(BufferID index);
 
+        static void SetBufferName(BufferID index, const char* name);
+
         static void Bind(u32 index);
 
         static void SetAttrib(u8 index, u16 size, u16 stride, const void* pointer);
@@ -47,16 +49,11 @@ namespace gr
         const VertexID &getID() const;
 
     private:
-        static gVertexArray *m_instance;
-
-        static u32 s_currentBuffer;
-
+        // buffers e bindings ficam no context_state do contexto atual
         static std::array<std::uint32_t, 5> bufferMappings;
 
         static std::array<u32, 7> primitiveMappings;
 
-        static std::unordered_map<BufferID, u32> m_bufferIndex;
-
         VertexID vertexID;
     };
 } // namespace grr
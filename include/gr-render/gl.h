@@ -1,24 +1,86 @@
 #pragma once
 
+#include "buffer_element.hpp"
 #include "gCommon.h"
 
+#include <atomic>
+#include <string>
+
 #if GR_OPENGLES3
 #include <GLES3/gl3.h>
 #else
 #include <GL/glew.h>
 #endif
 
-#include <sstream>
-
 namespace grr {
     const char* get_enum_name(GLenum err);
 
+    // bytes per pixel of a client side format/type pair (glTexImage2D, glReadPixels)
+    uint32_t get_pixel_size(GLenum format, GLenum type);
+
+    // sized equivalent of an internal format, as required by glTexStorage*
+    GLenum get_sized_internal_format(GLenum internalformat, GLenum type);
+
+    // component type of a vertex attribute (glVertexAttribPointer, glVertexAttribFormat)
+    GLenum get_base_type(gr::shader_data_type type);
+
+    bool supports_direct_state_access();
+
+    // OpenGL 4.3 or ARB_vertex_attrib_binding (glVertexAttribFormat, glBindVertexBuffer)
+    bool supports_vertex_attrib_binding();
+
+    // set by gRender::Initialize; always false on OpenGL ES
+    bool use_direct_state_access();
+
+    void set_direct_state_access(bool enabled);
+
+    // glDeleteBuffers, counted per thread: GL hands deleted names out again,
+    // so caches of buffer names (gr::vertex_format_cache) drop them when the
+    // count moves
+    void delete_buffers(GLsizei count, const GLuint* buffers);
+
+    uint32_t get_buffer_deletions();
+
+    // GL_CALL running on this thread; read by the KHR_debug callback (gr::gl_debug)
+    struct call_site
+    {
+        const char* call;
+
+        const char* file;
+
+        int line;
+    };
+
+    extern thread_local call_site current_call_site;
+
+    // 0 = no glGetError polling; see gr::gl_debug::set_error_sampling
+    extern std::atomic<uint32_t> error_sample_interval;
+
+    extern thread_local uint32_t error_sample_count;
+
+    // drains glGetError into gr::gl_debug, blamed on current_call_site
+    void sample_errors();
+
+    // glGetError right now for one call; reported like a sampled error
     void check_erros_opengl(const std::string &name, const std::string & file);
 
     #define FIX std::string(__FILE__ "(" + std::to_string(__LINE__) + ") :")
 
+    inline void set_call_site(const char* call, const char* file, int line)
+    {
+        // o erro pendente e da chamada anterior, entao amostra antes de trocar
+        uint32_t interval = error_sample_interval.load(std::memory_order_relaxed);
+        if (interval != 0 && ++error_sample_count >= interval)
+        {
+            error_sample_count = 0;
+            sample_errors();
+        }
+
+        current_call_site = {call, file, line};
+    }
+
 #ifdef DEBUG_MODE
-    #define GL_CALL(func) func; check_erros_opengl(#func, FIX)
+    #define GL_CALL(func) (grr::set_call_site(#func, __FILE__, __LINE__), func)
 #else // DEBUG_MODE
     #define GL_CALL(func) func
 #endif
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "gCommon.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace grr
+{
+    struct call_site;
+}
+
+namespace gr
+{
+    enum class gl_debug_severity : uint8_t
+    {
+        notification,
+        low,
+        medium,
+        high
+    };
+
+    struct gl_debug_config
+    {
+        // lower severities are turned off in the driver (glDebugMessageControl)
+        gl_debug_severity min_severity = gl_debug_severity::low;
+
+        // GL_DEBUG_OUTPUT_SYNCHRONOUS: slower, but the callback then runs inside
+        // the call that raised the message, so the call site is always right.
+        // Asynchronous messages carry no call site. gRender::Initialize turns it
+        // on in debug builds.
+        bool synchronous = false;
+
+        // the same message from the same call site (or, without one, with the
+        // same text) is queued once, later ones are only counted
+        bool deduplicate = true;
+    };
+
+    struct gl_debug_message
+    {
+        uint32_t source;
+
+        uint32_t type;
+
+        uint32_t id;
+
+        gl_debug_severity severity;
+
+        // GL_CALL in progress (debug builds), nullptr when unknown
+        const char* call;
+
+        const char* file;
+
+        int line;
+
+        char text[256];
+    };
+
+    struct gl_debug_statistics
+    {
+        uint64_t received = 0;
+
+        // below min_severity but still delivered by the driver
+        uint64_t filtered = 0;
+
+        uint64_t duplicates = 0;
+
+        // ring full
+        uint64_t dropped = 0;
+    };
+
+    // Error reporting without a glGetError after every call. Messages come from
+    // the KHR_debug callback (or sampled glGetError) and go into a fixed, lock
+    // free ring that any thread, the driver's included, can write; flush() hands
+    // them to the sink, once per frame from gRender::EndFrame.
+    //
+    // gRender::Initialize turns it on in debug builds, falling back to sampling
+    // every GL_CALL when the context has no KHR_debug.
+    class gl_debug
+    {
+    public:
+        static constexpr uint32_t k_ring_size = 256;
+
+        static constexpr uint32_t k_dedup_size = 1024;
+
+        // on the current context; false without KHR_debug (GL 4.3)
+        static bool enable(const gl_debug_config& config = gl_debug_config());
+
+        static void disable();
+
+        // drops one message in the driver
+        static void ignore(uint32_t source, uint32_t type, uint32_t id);
+
+        // glGetError every `interval` GL_CALLs; 0 turns it off. Only GL_CALL
+        // polls, so it only does something in debug builds.
+        static void set_error_sampling(uint32_t interval);
+
+        static uint32_t get_error_sampling();
+
+        static void report(uint32_t source, uint32_t type, uint32_t id, gl_debug_severity severity,
+                           const char* text, size_t length, const grr::call_site& site);
+
+        // number of messages handed to the sink
+        static uint32_t flush();
+
+        // default: one line on stderr. Set it before rendering starts.
+        static void set_sink(std::function<void(const gl_debug_message&)> sink);
+
+        static gl_debug_statistics get_statistics();
+
+        // counters and the deduplication table
+        static void reset();
+    };
+}
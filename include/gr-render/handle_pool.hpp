@@ -0,0 +1,154 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace gr
+{
+    // 32 bit handle: low 20 bits are the slot, high 12 bits the generation of
+    // that slot when the handle was made. A value of 0 is never handed out.
+    // Generations do not wrap: a slot released at the last generation is
+    // retired for good, so an old handle can never match a reused slot.
+    template <typename Tag>
+    struct handle
+    {
+        static constexpr uint32_t k_index_bits = 20;
+
+        static constexpr uint32_t k_index_mask = (1u << k_index_bits) - 1;
+
+        static constexpr uint32_t k_generation_mask = (1u << (32 - k_index_bits)) - 1;
+
+        uint32_t value = 0;
+
+        inline uint32_t index() const
+        {
+            return value & k_index_mask;
+        }
+
+        inline uint32_t generation() const
+        {
+            return value >> k_index_bits;
+        }
+
+        inline bool is_null() const
+        {
+            return value == 0;
+        }
+
+        inline bool operator==(handle other) const
+        {
+            return value == other.value;
+        }
+
+        inline bool operator!=(handle other) const
+        {
+            return value != other.value;
+        }
+    };
+
+    // Stale handle in a debug build: reported through gl_debug as a high
+    // severity error, so it reaches the sink and grr::last_engine_error.
+    void report_invalid_handle(uint32_t value);
+
+    // Slot allocator behind the resource pools. Only tracks which slots are alive
+    // and their generation; the pools keep the data in their own parallel arrays
+    // indexed by handle::index().
+    template <typename Tag>
+    class handle_pool
+    {
+    public:
+        using handle_type = handle<Tag>;
+
+        // returns a null handle when every slot is in use
+        handle_type allocate()
+        {
+            uint32_t index;
+
+            if (!m_free.empty())
+            {
+                index = m_free.back();
+                m_free.pop_back();
+            } else
+            {
+                if (m_generations.size() > handle_type::k_index_mask)
+                    return handle_type();
+
+                index = static_cast<uint32_t>(m_generations.size());
+                m_generations.push_back(1);
+            }
+
+            m_alive++;
+
+            handle_type result;
+            result.value = (m_generations[index] << handle_type::k_index_bits) | index;
+            return result;
+        }
+
+        bool release(handle_type id)
+        {
+            if (!is_valid(id))
+                return false;
+
+            uint32_t index = id.index();
+
+            m_alive--;
+
+            // sem geracao livre: o slot sai de uso em vez de voltar para 1
+            if (m_generations[index] == handle_type::k_generation_mask)
+            {
+                m_generations[index] = k_retired;
+                m_retired++;
+                return true;
+            }
+
+            m_generations[index]++;
+            m_free.push_back(index);
+            return true;
+        }
+
+        inline bool is_valid(handle_type id) const
+        {
+            return id.value != 0 && id.index() < m_generations.size() && m_generations[id.index()] == id.generation();
+        }
+
+        // Slot of a live handle. Stale handles are reported here in debug
+        // builds (DEBUG_MODE) only; release builds trust the caller.
+        inline uint32_t get_index(handle_type id) const
+        {
+            #ifdef DEBUG_MODE
+            if (!is_valid(id))
+                report_invalid_handle(id.value);
+            #endif
+            return id.index();
+        }
+
+        // number of slots ever used; size the parallel arrays with this
+        inline uint32_t get_capacity() const
+        {
+            return static_cast<uint32_t>(m_generations.size());
+        }
+
+        inline uint32_t get_alive() const
+        {
+            return m_alive;
+        }
+
+        // slots retired after using up their generations
+        inline uint32_t get_retired() const
+        {
+            return m_retired;
+        }
+
+    private:
+        // maior que qualquer geracao de um handle, entao nunca confere
+        static constexpr uint32_t k_retired = handle_type::k_generation_mask + 1;
+
+        std::vector<uint32_t> m_generations;
+
+        std::vector<uint32_t> m_free;
+
+        uint32_t m_alive = 0;
+
+        uint32_t m_retired = 0;
+    };
+}
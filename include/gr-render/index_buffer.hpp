@@ -10,10 +10,16 @@ namespace gr
     public:
         static std::shared_ptr<index_buffer> create(const void* data, uint32_t size);
 
-        virtual ~index_buffer() {}
+        virtual ~index_buffer();
 
         virtual void Bind() = 0;
 
         virtual void Unbind() = 0;
+
+        // label shown by memory_tracker
+        virtual void SetDebugName(const char* /*name*/) {}
+
+        // GL name of the buffer
+        virtual uint32_t GetID() const = 0;
     };
 }
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "gCommon.h"
+
+#include <string>
+#include <vector>
+
+namespace gr
+{
+    class Shader;
+
+    class gTexture;
+
+    // Parameters and textures of one draw state over a fixed shader.
+    //
+    // When the shader has the uniform block `block_name`, its members are the
+    // parameters: the blob follows the block's reflected offsets and strides
+    // and lives in a range of a shared uniform buffer, rewritten in one upload
+    // when something changed and attached with one glBindBufferRange. Otherwise
+    // the parameters are the shader's plain uniforms and go through
+    // Shader::SetUniform, which is program state: binding another material of
+    // the same shader then has to send every parameter that was ever set.
+    //
+    // set() with an unchanged value does not dirty the material. Use from the
+    // thread owning the context, and destroy it there with that context
+    // current: the uniform buffer pages are per thread and the last material
+    // deletes them.
+    class material
+    {
+    public:
+        explicit material(Shader* shader, const char* block_name = "Material");
+        ~material();
+
+        material(const material&) = delete;
+        material& operator=(const material&) = delete;
+
+        // data is packed the way SetUniform takes it (one element after the
+        // other); size may cover only the first elements of an array.
+        // false for an unknown name or a size that is not whole elements.
+        bool set(const char* name, const void* data, uint32_t size);
+
+        template <typename T>
+        inline bool set(const char* name, const T& value)
+        {
+            return set(name, &value, sizeof(T));
+        }
+
+        // sampler `name` (element `element` of a sampler array), read through
+        // `sampler` (sampler_cache) or the texture's own parameters when 0;
+        // nullptr clears it
+        bool set_texture(const char* name, gTexture* texture, uint32_t element = 0, uint32_t sampler = 0);
+
+        // Uploads what changed and binds shader, parameters and textures.
+        // `previous` is the material bound right before, with no GL state
+        // changed since: the shader bind and the textures both share are skipped,
+        // and rebinding the same material costs nothing when it is clean.
+        void bind(const material* previous = nullptr);
+
+        // Drops this thread's uniform pages without GL calls; gRender::Release
+        // calls it when another context becomes current. Materials made before
+        // keep their range but no longer return it.
+        static void detach_pages();
+
+        inline Shader* get_shader() const
+        {
+            return m_shader;
+        }
+
+        inline bool uses_uniform_block() const
+        {
+            return m_block != GR_INVALID_ID;
+        }
+
+        inline bool is_dirty() const
+        {
+            return m_dirty;
+        }
+
+        inline const void* get_data() const
+        {
+            return m_data.data();
+        }
+
+        inline uint32_t get_size() const
+        {
+            return static_cast<uint32_t>(m_data.size());
+        }
+
+    private:
+        struct parameter
+        {
+            std::string name;
+
+            UniformType type;
+
+            uint32_t count;
+
+            uint32_t offset;
+
+            uint32_t array_stride;
+
+            uint32_t matrix_stride;
+
+            // plain uniforms only
+            UniformID uniform;
+
+            bool assigned;
+
+            bool dirty;
+        };
+
+        struct texture_binding
+        {
+            uint32_t unit;
+
+            gTexture* texture;
+
+            uint32_t sampler;
+        };
+
+        Shader* const m_shader;
+
+        // indice em Shader::get_blocks(), GR_INVALID_ID sem bloco
+        uint32_t m_block;
+
+        uint32_t m_binding;
+
+        std::vector<parameter> m_parameters;
+
+        std::vector<uint8_t> m_data;
+
+        std::vector<texture_binding> m_textures;
+
+        // faixa no buffer compartilhado
+        uint32_t m_buffer;
+
+        uint32_t m_offset;
+
+        uint32_t m_capacity;
+
+        // epoca das paginas da thread quando a faixa foi tirada
+        uint32_t m_pages_epoch;
+
+        bool m_dirty;
+
+        bool write(parameter& entry, const uint8_t* data, uint32_t elements);
+
+        void upload();
+
+        void bind_textures(const material* previous) const;
+    };
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "gCommon.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace gr
+{
+    enum class memory_category : uint8_t
+    {
+        vertex_buffer,
+        index_buffer,
+        uniform_buffer,
+        other_buffer,
+        texture,
+        render_target,
+        count
+    };
+
+    struct memory_category_stats
+    {
+        uint64_t bytes = 0;
+
+        uint64_t peak = 0;
+
+        uint32_t allocations = 0;
+
+        // 0 = sem limite
+        uint64_t budget = 0;
+    };
+
+    struct memory_allocation
+    {
+        memory_category category;
+
+        // see memory_tracker::set_thread_context
+        uint32_t context;
+
+        // gl name of the buffer/texture
+        uint32_t id;
+
+        uint64_t bytes;
+
+        std::string name;
+    };
+
+    using memory_budget_callback = std::function<void(memory_category category, uint64_t bytes, uint64_t budget)>;
+
+    // Bookkeeping of GPU allocations made through the wrappers. Records are keyed
+    // by (context, category, gl name); tracking an existing key replaces its size, so
+    // respecifying a buffer or texture storage does not count twice.
+    class memory_tracker
+    {
+    public:
+        // GL names are only unique within a context: records made on this thread
+        // are filed under `context` (0 by default, up to 2^24 - 1).
+        static void set_thread_context(uint32_t context);
+
+        static void track(memory_category category, uint32_t id, uint64_t bytes, const char* name = nullptr);
+
+        static void untrack(memory_category category, uint32_t id);
+
+        static void set_debug_name(memory_category category, uint32_t id, const char* name);
+
+        static memory_category_stats get_stats(memory_category category);
+
+        static uint64_t get_total();
+
+        static uint64_t get_peak();
+
+        static std::vector<memory_allocation> get_allocations();
+
+        // bytes = 0 removes the budget
+        static void set_budget(memory_category category, uint64_t bytes);
+
+        // called (outside the tracker lock) every time an allocation leaves a category above its budget
+        static void set_budget_callback(memory_budget_callback callback);
+
+        // true if `bytes` more fit in the category budget
+        static bool can_allocate(memory_category category, uint64_t bytes);
+
+        static const char* get_category_name(memory_category category);
+
+        // levels = 0 counts the full mip chain down to 1x1
+        static uint64_t texture_size(uint32_t width, uint32_t height, uint32_t pixel_size, uint32_t levels = 1, uint32_t faces = 1);
+
+        static uint32_t mip_levels(uint32_t width, uint32_t height);
+
+        static void reset();
+    };
+}
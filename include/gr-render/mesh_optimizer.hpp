@@ -0,0 +1,91 @@
+#pragma once
+
+#include "buffer_layout.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gr
+{
+    class thread_pool;
+
+    struct mesh_data
+    {
+        buffer_layout layout;
+
+        std::vector<uint8_t> vertices;
+
+        std::vector<uint32_t> indices;
+
+        inline size_t get_vertex_count() const
+        {
+            return layout.get_stride() ? vertices.size() / layout.get_stride() : 0;
+        }
+    };
+
+    struct vertex_cache_statistics
+    {
+        uint32_t vertices_transformed = 0;
+
+        // average cache miss ratio: transformed vertices per triangle (0.5 .. 3.0)
+        float acmr = 0.0f;
+
+        // average transform to vertex ratio: transformed vertices per unique vertex (1.0 ..)
+        float atvr = 0.0f;
+    };
+
+    // post-transform cache size the vertex cache order targets and the
+    // statistics and overdraw clusters simulate, unless told otherwise
+    constexpr uint32_t k_vertex_cache_size = 16;
+
+    struct mesh_optimizer_options
+    {
+        uint32_t cache_size = k_vertex_cache_size;
+
+        // layout element holding the float3 position (used for overdraw sorting)
+        uint32_t position_element = 0;
+
+        bool optimize_vertex_cache = true;
+
+        bool optimize_overdraw = true;
+
+        bool optimize_vertex_fetch = true;
+    };
+
+    struct mesh_optimizer_report
+    {
+        vertex_cache_statistics before;
+
+        vertex_cache_statistics after;
+
+        uint32_t vertices_before = 0;
+
+        uint32_t vertices_after = 0;
+    };
+
+    class mesh_optimizer
+    {
+    public:
+        static vertex_cache_statistics analyze_vertex_cache(const uint32_t* indices, size_t index_count, size_t vertex_count, uint32_t cache_size = k_vertex_cache_size);
+
+        // Forsyth linear-speed vertex cache optimisation for a cache of cache_size
+        // entries (clamped to [4, 64]). dst may alias indices.
+        static void optimize_vertex_cache(uint32_t* dst, const uint32_t* indices, size_t index_count, size_t vertex_count, uint32_t cache_size = k_vertex_cache_size);
+
+        // Splits the (cache optimised) index buffer into clusters at cache flush points and
+        // sorts them so outward facing clusters are drawn first. dst may not alias indices.
+        static void optimize_overdraw(uint32_t* dst, const uint32_t* indices, size_t index_count, const float* positions, size_t vertex_count, size_t position_stride, uint32_t cache_size = k_vertex_cache_size);
+
+        // Reorders vertices by first use and drops unreferenced ones. Rewrites indices in place
+        // and returns the new vertex count.
+        static size_t optimize_vertex_fetch(void* dst, uint32_t* indices, size_t index_count, const void* vertices, size_t vertex_count, size_t vertex_size);
+
+        // Runs the enabled stages on a single mesh.
+        static mesh_optimizer_report optimize(mesh_data& mesh, const mesh_optimizer_options& options = {});
+
+        // Optimises every mesh independently across the pool. Results do not depend on the
+        // thread count. reports may be null.
+        static void optimize(mesh_data* meshes, size_t count, const mesh_optimizer_options& options, mesh_optimizer_report* reports = nullptr, thread_pool* pool = nullptr);
+    };
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "mesh_optimizer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gr
+{
+    struct mesh_lod
+    {
+        uint32_t index_offset;
+
+        uint32_t index_count;
+
+        // object space deviation from the base mesh
+        float error;
+    };
+
+    struct mesh_lod_level
+    {
+        // fraction of the base triangle count to aim for
+        float target_ratio;
+
+        // maximum object space error; <= 0 means unbounded
+        float target_error;
+    };
+
+    class mesh_simplifier
+    {
+    public:
+        // Quadric error edge collapse. Vertices are never moved, so the result indexes the
+        // same vertex buffer. Seam vertices (two vertices at one position) collapse in
+        // pairs along the seam; corners where seams meet and open borders are kept.
+        // Returns 0 when an index is out of range.
+        static size_t simplify(uint32_t* dst, const uint32_t* indices, size_t index_count, const void* vertices, size_t vertex_count,
+            const buffer_layout& layout, size_t target_index_count, float target_error, float* result_error = nullptr, uint32_t position_element = 0);
+
+        // Appends one index range per level to mesh.indices, each simplified from the previous one.
+        // The first entry returned is the base mesh; it is the only one when an index is out of range.
+        static std::vector<mesh_lod> generate_lods(mesh_data& mesh, const mesh_lod_level* levels, size_t level_count, uint32_t position_element = 0);
+    };
+
+    class lod_selector
+    {
+    public:
+        lod_selector(float viewport_height, float fov_y, float max_pixel_error = 1.0f);
+
+        // Picks the coarsest lod whose error projects to at most max_pixel_error pixels.
+        // lods must be ordered from finest to coarsest as returned by generate_lods.
+        uint32_t select(const mesh_lod* lods, size_t count, float distance, float scale = 1.0f) const;
+
+        inline float get_projection_scale() const
+        {
+            return m_projection_scale;
+        }
+
+    private:
+        // pixels per world unit at distance 1
+        float m_projection_scale;
+
+        float m_max_pixel_error;
+    };
+}
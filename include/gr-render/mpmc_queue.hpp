@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace gr
+{
+    // Bounded lock-free multi producer / multi consumer queue (Vyukov). Every
+    // cell carries a sequence number telling whether it is ready to be written
+    // or read for the current lap, so push and pop only contend on their own
+    // cursor. Capacity is rounded up to a power of two.
+    template <typename T>
+    class mpmc_queue
+    {
+    public:
+        explicit mpmc_queue(size_t capacity)
+        {
+            size_t size = 2;
+            while (size < capacity)
+                size <<= 1;
+
+            m_mask = size - 1;
+            m_cells.reset(new cell[size]);
+
+            for (size_t i = 0; i < size; i++)
+                m_cells[i].sequence.store(i, std::memory_order_relaxed);
+
+            m_enqueue.store(0, std::memory_order_relaxed);
+            m_dequeue.store(0, std::memory_order_relaxed);
+        }
+
+        mpmc_queue(const mpmc_queue&) = delete;
+        mpmc_queue& operator=(const mpmc_queue&) = delete;
+
+        // false when the queue is full; `value` is left untouched in that case
+        bool try_push(T& value)
+        {
+            cell* target;
+            size_t position = m_enqueue.load(std::memory_order_relaxed);
+
+            for (;;)
+            {
+                target = &m_cells[position & m_mask];
+                size_t sequence = target->sequence.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+                if (diff == 0)
+                {
+                    if (m_enqueue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                        break;
+                } else if (diff < 0)
+                {
+                    return false;
+                } else
+                {
+                    position = m_enqueue.load(std::memory_order_relaxed);
+                }
+            }
+
+            target->value = std::move(value);
+            target->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool try_pop(T& value)
+        {
+            cell* target;
+            size_t position = m_dequeue.load(std::memory_order_relaxed);
+
+            for (;;)
+            {
+                target = &m_cells[position & m_mask];
+                size_t sequence = target->sequence.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+
+                if (diff == 0)
+                {
+                    if (m_dequeue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                        break;
+                } else if (diff < 0)
+                {
+                    return false;
+                } else
+                {
+                    position = m_dequeue.load(std::memory_order_relaxed);
+                }
+            }
+
+            value = std::move(target->value);
+            target->value = T();
+            target->sequence.store(position + m_mask + 1, std::memory_order_release);
+            return true;
+        }
+
+        inline size_t capacity() const
+        {
+            return m_mask + 1;
+        }
+
+    private:
+        struct cell
+        {
+            std::atomic<size_t> sequence;
+
+            T value;
+        };
+
+        std::unique_ptr<cell[]> m_cells;
+
+        size_t m_mask;
+
+        alignas(64) std::atomic<size_t> m_enqueue;
+
+        alignas(64) std::atomic<size_t> m_dequeue;
+    };
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "gCommon.h"
+#include "mesh_optimizer.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace gr
+{
+    class bounds_set;
+    class thread_pool;
+
+    struct occlusion_statistics
+    {
+        uint32_t occluder_triangles = 0;
+
+        uint32_t rasterized_triangles = 0;
+
+        uint32_t tested = 0;
+
+        uint32_t culled = 0;
+    };
+
+    // CPU depth buffer occlusion culling. Occluders are rasterised into a small
+    // depth buffer (tiles in parallel, SIMD across pixels); a per 8x8 block max
+    // depth is kept so most box tests never look at individual pixels.
+    class occlusion_culler
+    {
+    public:
+        static constexpr uint32_t k_tile_size = 32;
+
+        static constexpr uint32_t k_hiz_size = 8;
+
+        occlusion_culler(uint32_t width = 256, uint32_t height = 128, thread_pool* pool = nullptr);
+
+        void begin_frame(const Matrix4x4& view_projection);
+
+        // Positions are read in place: `positions` points at the first float3 and
+        // `stride` is the vertex size in bytes. The data must stay alive until rasterize().
+        void add_occluder(const float* positions, size_t stride, size_t vertex_count, const uint32_t* indices, size_t index_count, const Matrix4x4& model);
+
+        void add_occluder(const mesh_data& mesh, const Matrix4x4& model, uint32_t position_element = 0);
+
+        void rasterize();
+
+        // true when any part of the box may be visible
+        bool is_visible(const Vector3& min, const Vector3& max) const;
+
+        // Tests the boxes of `candidates` (usually the frustum culler output) and writes the
+        // ones that pass to `visible`, keeping their order. Returns the visible count.
+        uint32_t test(const bounds_set& bounds, const uint32_t* candidates, uint32_t count, uint32_t* visible);
+
+        inline const occlusion_statistics& get_statistics() const
+        {
+            return m_statistics;
+        }
+
+        inline const float* get_depth() const
+        {
+            return m_depth.data();
+        }
+
+        inline uint32_t get_width() const
+        {
+            return m_width;
+        }
+
+        inline uint32_t get_height() const
+        {
+            return m_height;
+        }
+
+    private:
+        struct occluder
+        {
+            const float* positions;
+            size_t stride;
+            size_t vertex_count;
+            const uint32_t* indices;
+            size_t index_count;
+            float mvp[16];
+        };
+
+        struct screen_triangle
+        {
+            // edge functions: e(x, y) = a * x + b * y + c
+            float a[3], b[3], c[3];
+
+            // depth plane
+            float za, zb, zc;
+
+            int32_t min_x, min_y, max_x, max_y;
+        };
+
+        uint32_t m_width;
+
+        uint32_t m_height;
+
+        // dimensoes arredondadas para multiplos do tile
+        uint32_t m_pitch;
+
+        uint32_t m_rows;
+
+        uint32_t m_tiles_x;
+
+        uint32_t m_tiles_y;
+
+        thread_pool* m_pool;
+
+        float m_view_projection[16];
+
+        std::vector<float> m_depth;
+
+        std::vector<float> m_hiz;
+
+        std::vector<occluder> m_occluders;
+
+        // triangulos preparados por occluder, depois concatenados em m_triangles
+        std::vector<std::vector<screen_triangle>> m_setup;
+
+        std::vector<screen_triangle> m_triangles;
+
+        std::vector<std::vector<uint32_t>> m_bins;
+
+        occlusion_statistics m_statistics;
+
+        void setup_occluder(const occluder& occ, std::vector<screen_triangle>& out) const;
+
+        void rasterize_tile(uint32_t tile);
+    };
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "gCommon.h"
+
+#include <atomic>
+
+namespace gr
+{
+    enum class null_object : uint8_t
+    {
+        buffer,
+        vertex_array,
+        texture,
+        program,
+        framebuffer,
+        sampler
+    };
+
+    struct null_statistics
+    {
+        // entry points reached with the null backend active
+        uint64_t calls = 0;
+
+        uint64_t objects_created = 0;
+
+        uint64_t objects_destroyed = 0;
+
+        uint64_t validation_errors = 0;
+    };
+
+    // State behind RenderBackend::Null: the wrappers skip every GL call and only
+    // check their arguments here, so a whole application can run without a
+    // context. Object names are fake and live in the context_state of the
+    // current context, like GL names; draws, binds and bytes keep going to
+    // render_stats as usual.
+    class null_device
+    {
+    public:
+        static inline bool is_active()
+        {
+            return s_active.load(std::memory_order_relaxed);
+        }
+
+        // called by gRender::SetBackend
+        static void set_active(bool active);
+
+        // counts the call; false (and a validation error) when !valid
+        static bool check(const char* call, bool valid = true);
+
+        // never 0 and never reused in the current context
+        static u32 create_object(null_object type);
+
+        // false when name is not a live object of that type; 0 is ignored
+        static bool destroy_object(null_object type, u32 name, const char* call);
+
+        static bool is_object(null_object type, u32 name);
+
+        static void bind_program(u32 name);
+
+        static void bind_vertex_array(u32 name);
+
+        // primitive in range and a program and vertex array bound
+        static bool check_draw(const char* call, PrimitiveType primitive);
+
+        static inline const null_statistics& get_statistics()
+        {
+            return s_statistics;
+        }
+
+        // entry point of the last validation error, nullptr when there was none
+        static inline const char* get_last_error()
+        {
+            return s_last_error;
+        }
+
+        // only the counters; live objects are kept
+        static void reset_statistics();
+
+    private:
+        static std::atomic<bool> s_active;
+
+        static thread_local null_statistics s_statistics;
+
+        static thread_local const char* s_last_error;
+    };
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "index_buffer.hpp"
+
+namespace gr
+{
+    // RenderBackend::Null: keeps a fake name, never the indices.
+    class null_index_buffer : public index_buffer
+    {
+    public:
+        null_index_buffer(const void* data, uint32_t size);
+        virtual ~null_index_buffer() override;
+
+        virtual void Bind() override;
+
+        virtual void Unbind() override;
+
+        virtual void SetDebugName(const char* name) override;
+
+        virtual uint32_t GetID() const override { return m_id; }
+
+    private:
+        uint32_t m_id;
+    };
+}
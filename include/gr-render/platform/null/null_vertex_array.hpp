@@ -0,0 +1,26 @@
+#pragma once
+
+#include "vertex_array.hpp"
+
+namespace gr
+{
+    // RenderBackend::Null: checks the buffers and their layouts and records the
+    // binding for null_device::check_draw.
+    class null_vertex_array : public vertex_array
+    {
+    public:
+        null_vertex_array();
+        virtual ~null_vertex_array() override;
+
+        virtual void Bind() const override;
+
+        virtual void Unbind() const override;
+
+        virtual void AddVertexBuffer(std::shared_ptr<vertex_buffer>& vbo) override;
+
+        virtual void SetIndexBuffer(std::shared_ptr<index_buffer>& ibo) override;
+
+    private:
+        uint32_t m_id;
+    };
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "vertex_buffer.hpp"
+
+namespace gr
+{
+    // RenderBackend::Null: keeps a fake name and the size, never the data.
+    class null_vertex_buffer : public vertex_buffer
+    {
+    public:
+        null_vertex_buffer(const void* data, uint32_t size, buffer_usage usage);
+        virtual ~null_vertex_buffer() override;
+
+        virtual void Bind() override;
+
+        virtual void Unbind() override;
+
+        virtual void SetData(const void* data, uint32_t size) override;
+
+        virtual void SetDebugName(const char* name) override;
+
+        virtual uint32_t GetID() const override { return m_id; }
+
+    private:
+        uint32_t m_id;
+
+        uint32_t m_size;
+    };
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "index_buffer.hpp"
+namespace gr
+{
+    class opengl_dsa_index_buffer : public index_buffer
+    {
+    public:
+        opengl_dsa_index_buffer(const void *data, uint32_t size);
+        virtual ~opengl_dsa_index_buffer() override;
+
+        virtual void Bind() override;
+
+        virtual void Unbind() override;
+
+        virtual void SetDebugName(const char* name) override;
+
+        virtual uint32_t GetID() const override { return m_id; }
+
+    private:
+        uint32_t m_id;
+    };
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "vertex_buffer.hpp"
+namespace gr
+{
+    // OpenGL 4.5 direct state access: updates never touch the GL_ARRAY_BUFFER binding
+    class opengl_dsa_vertex_buffer : public vertex_buffer
+    {
+    public:
+        opengl_dsa_vertex_buffer(const void* data, uint32_t size, buffer_usage usage);
+        virtual ~opengl_dsa_vertex_buffer() override;
+
+        virtual void Bind() override;
+
+        virtual void Unbind() override;
+
+        virtual void SetData(const void* data, uint32_t size) override;
+
+        virtual void SetDebugName(const char* name) override;
+
+        virtual uint32_t GetID() const override { return m_id; }
+
+    private:
+        uint32_t m_size;
+
+        uint32_t m_id;
+    };
+}
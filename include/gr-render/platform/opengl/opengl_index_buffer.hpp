@@ -13,6 +13,10 @@ namespace gr
 
         virtual void Unbind() override;
 
+        virtual void SetDebugName(const char* name) override;
+
+        virtual uint32_t GetID() const override { return m_id; }
+
     private:
         uint32_t m_id;
     };
@@ -15,6 +15,10 @@ namespace gr
 
         virtual void SetData(const void* data, uint32_t size) override;
 
+        virtual void SetDebugName(const char* name) override;
+
+        virtual uint32_t GetID() const override { return m_id; }
+
     private:
         uint32_t m_size;
 
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "index_buffer.hpp"
+
+#include <vector>
+
+namespace gr
+{
+    // 32 bit indices in CPU memory for software_rasterizer.
+    class software_index_buffer : public index_buffer
+    {
+    public:
+        software_index_buffer(const void* data, uint32_t size);
+        virtual ~software_index_buffer() override {}
+
+        virtual void Bind() override {}
+
+        virtual void Unbind() override {}
+
+        // no GL name
+        virtual uint32_t GetID() const override { return 0; }
+
+        inline const uint32_t* get_data() const
+        {
+            return m_indices.data();
+        }
+
+        inline uint32_t get_count() const
+        {
+            return static_cast<uint32_t>(m_indices.size());
+        }
+
+    private:
+        std::vector<uint32_t> m_indices;
+    };
+}
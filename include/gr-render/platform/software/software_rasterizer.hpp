@@ -0,0 +1,199 @@
+#pragma once
+
+#include "gCommon.h"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace gr
+{
+    class thread_pool;
+    class vertex_array;
+
+    // RGBA8 color plus float depth. Rows go bottom to top like GL window
+    // coordinates, so get_color() can be given straight to gTexture::updateBuffer.
+    class software_target
+    {
+    public:
+        // sizes are clamped to [1, k_max_size]; keeps the fixed point setup in range
+        static constexpr uint32_t k_max_size = 4096;
+
+        software_target(uint32_t width, uint32_t height);
+
+        void clear(const Color& color, float depth = 1.0f);
+
+        void clear_depth(float depth = 1.0f);
+
+        // uploads the color as a TextureFormat_RGBA image
+        void copy_to(gTexture& texture);
+
+        inline const uint8_t* get_color() const
+        {
+            return m_color.data();
+        }
+
+        inline uint8_t* get_color()
+        {
+            return m_color.data();
+        }
+
+        inline const float* get_depth() const
+        {
+            return m_depth.data();
+        }
+
+        inline float* get_depth()
+        {
+            return m_depth.data();
+        }
+
+        inline uint32_t get_width() const
+        {
+            return m_width;
+        }
+
+        inline uint32_t get_height() const
+        {
+            return m_height;
+        }
+
+    private:
+        uint32_t m_width;
+
+        uint32_t m_height;
+
+        std::vector<uint8_t> m_color;
+
+        std::vector<float> m_depth;
+    };
+
+    enum class software_cull { none, back, front };
+
+    // Shader stages as C++ callables. They run on the pool threads at the same
+    // time and must only read shared data.
+    struct software_pipeline
+    {
+        static constexpr uint32_t k_max_varyings = 16;
+
+        // attributes[i] points at the components of attribute i of the vertex;
+        // writes the clip space position (x, y, z, w) and varying_count floats
+        std::function<void(const float* const* attributes, float* position, float* varyings)> vertex;
+
+        // receives the perspective correct varyings and writes rgba in [0, 1];
+        // returning false discards the fragment
+        std::function<bool(const float* varyings, float* color)> fragment;
+
+        uint32_t varying_count = 0;
+
+        // GL_LESS
+        bool depth_test = true;
+
+        bool depth_write = true;
+
+        // counter clockwise is front facing
+        software_cull cull = software_cull::none;
+
+        // src alpha, one minus src alpha
+        bool blend = false;
+    };
+
+    struct software_statistics
+    {
+        uint32_t vertices = 0;
+
+        uint32_t triangles = 0;
+
+        // after clipping and culling
+        uint32_t rasterized_triangles = 0;
+
+        uint32_t culled = 0;
+
+        // triangle/tile pairs
+        uint64_t binned = 0;
+
+        uint64_t fragments = 0;
+
+        uint64_t written = 0;
+    };
+
+    // Draws vertex arrays made with RenderBackend::Software. Vertices are shaded
+    // in parallel, triangles are clipped (near/far plus a guard band), snapped to
+    // 1/16 pixel and binned into 32x32 tiles in submission order; tiles are then
+    // rasterised in parallel with integer edge functions evaluated 4 pixels at a
+    // time, so the output does not depend on the thread count.
+    //
+    // Triangles only (lists, strips and fans); attributes are floats and
+    // instanced attributes read the first instance.
+    class software_rasterizer
+    {
+    public:
+        static constexpr uint32_t k_tile_size = 32;
+
+        explicit software_rasterizer(thread_pool* pool = nullptr);
+
+        // Uses the index buffer of the vertex array when it has one; count is the
+        // number of indices or vertices. false when the array is not a software one.
+        bool draw(const software_pipeline& pipeline, const vertex_array& vao, PrimitiveType primitive, uint32_t count, software_target& target);
+
+        inline const software_statistics& get_statistics() const
+        {
+            return m_statistics;
+        }
+
+        inline void reset_statistics()
+        {
+            m_statistics = software_statistics();
+        }
+
+    private:
+        struct clip_vertex;
+
+        struct triangle
+        {
+            // e(x, y) = a * x + b * y + c in 1/16 pixel units, top-left bias in c
+            int64_t a[3], b[3], c[3];
+
+            // planes over pixel coordinates: depth, 1/w, then varying / w
+            uint32_t planes;
+
+            int32_t min_x, min_y, max_x, max_y;
+        };
+
+        struct tile_counters
+        {
+            uint64_t fragments;
+
+            uint64_t written;
+        };
+
+        thread_pool* m_pool;
+
+        software_statistics m_statistics;
+
+        // saida do vertex shader: posicao (4) + varyings por vertice
+        std::vector<float> m_vertices;
+
+        std::vector<uint32_t> m_indices;
+
+        std::vector<std::vector<triangle>> m_setup;
+
+        std::vector<std::vector<float>> m_setup_planes;
+
+        std::vector<uint32_t> m_setup_culled;
+
+        std::vector<triangle> m_triangles;
+
+        std::vector<float> m_planes;
+
+        std::vector<std::vector<uint32_t>> m_bins;
+
+        std::vector<tile_counters> m_counters;
+
+        void setup_triangles(const software_pipeline& pipeline, const software_target& target, uint32_t first, uint32_t last, uint32_t chunk);
+
+        void setup_triangle(const software_pipeline& pipeline, const software_target& target, const clip_vertex* v, uint32_t chunk);
+
+        void rasterize_tile(const software_pipeline& pipeline, software_target& target, uint32_t tile, uint32_t tiles_x);
+    };
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "vertex_array.hpp"
+
+namespace gr
+{
+    // Only records the buffers; software_rasterizer reads the attributes in
+    // layout order, continuing across the vertex buffers like a VAO does.
+    class software_vertex_array : public vertex_array
+    {
+    public:
+        software_vertex_array() {}
+        virtual ~software_vertex_array() override {}
+
+        virtual void Bind() const override {}
+
+        virtual void Unbind() const override {}
+
+        virtual void AddVertexBuffer(std::shared_ptr<vertex_buffer>& vbo) override;
+
+        virtual void SetIndexBuffer(std::shared_ptr<index_buffer>& ibo) override;
+    };
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "vertex_buffer.hpp"
+
+#include <vector>
+
+namespace gr
+{
+    // Vertex data kept in CPU memory for software_rasterizer.
+    class software_vertex_buffer : public vertex_buffer
+    {
+    public:
+        software_vertex_buffer(const void* data, uint32_t size, buffer_usage usage);
+        virtual ~software_vertex_buffer() override {}
+
+        virtual void Bind() override {}
+
+        virtual void Unbind() override {}
+
+        virtual void SetData(const void* data, uint32_t size) override;
+
+        // no GL name
+        virtual uint32_t GetID() const override { return 0; }
+
+        inline const uint8_t* get_data() const
+        {
+            return m_data.data();
+        }
+
+        inline uint32_t get_size() const
+        {
+            return static_cast<uint32_t>(m_data.size());
+        }
+
+    private:
+        std::vector<uint8_t> m_data;
+    };
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+// Scoped CPU/GPU profiler. Everything here compiles to nothing unless the
+// library is built with GR_ENABLE_PROFILER.
+
+#ifdef GR_ENABLE_PROFILER
+
+#include "gCommon.h"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace gr
+{
+    struct profile_scope_stats
+    {
+        std::string name;
+
+        uint64_t samples;
+
+        // milliseconds over the rolling window
+        double cpu_min, cpu_avg, cpu_p99;
+
+        double gpu_min, gpu_avg, gpu_p99;
+
+        uint64_t gpu_samples;
+    };
+
+    class profiler
+    {
+    public:
+        // GPU timestamps are read back this many frames after they were issued.
+        static constexpr uint32_t k_frame_latency = 4;
+
+        static constexpr uint32_t k_stats_window = 256;
+
+        static void begin_frame();
+
+        static void end_frame();
+
+        // name must outlive the profiler (string literals)
+        static uint32_t begin_scope(const char* name);
+
+        static void end_scope(uint32_t event);
+
+        static void set_gpu_timing(bool enabled);
+
+        static void set_trace_capacity(size_t events);
+
+        static std::vector<profile_scope_stats> get_statistics();
+
+        static void write_chrome_trace(std::ostream& out);
+
+        static bool write_chrome_trace(const char* path);
+
+        static void release();
+    };
+
+    class profile_scope
+    {
+    public:
+        explicit profile_scope(const char* name) : m_event(profiler::begin_scope(name)) {}
+
+        ~profile_scope()
+        {
+            profiler::end_scope(m_event);
+        }
+
+        profile_scope(const profile_scope&) = delete;
+        profile_scope& operator=(const profile_scope&) = delete;
+
+    private:
+        uint32_t m_event;
+    };
+}
+
+#define GR_PROFILE_CONCAT_IMPL(a, b) a##b
+#define GR_PROFILE_CONCAT(a, b) GR_PROFILE_CONCAT_IMPL(a, b)
+
+#define GR_PROFILE_SCOPE(name) ::gr::profile_scope GR_PROFILE_CONCAT(gr_profile_scope_, __LINE__)(name)
+#define GR_PROFILE_BEGIN_FRAME() ::gr::profiler::begin_frame()
+#define GR_PROFILE_END_FRAME() ::gr::profiler::end_frame()
+
+#else // GR_ENABLE_PROFILER
+
+#define GR_PROFILE_SCOPE(name) do {} while (0)
+#define GR_PROFILE_BEGIN_FRAME() do {} while (0)
+#define GR_PROFILE_END_FRAME() do {} while (0)
+
+#endif // GR_ENABLE_PROFILER
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "gCommon.h"
+
+#include <ostream>
+#include <vector>
+
+namespace gr
+{
+    class frame_allocator;
+
+    struct frame_stats
+    {
+        uint64_t frame = 0;
+
+        uint32_t draw_calls = 0;
+
+        // subset of draw_calls
+        uint32_t instanced_draw_calls = 0;
+
+        uint64_t primitives = 0;
+
+        uint64_t vertices = 0;
+
+        uint32_t program_binds = 0;
+
+        uint32_t vertex_array_binds = 0;
+
+        uint32_t buffer_binds = 0;
+
+        uint32_t texture_binds = 0;
+
+        uint32_t framebuffer_binds = 0;
+
+        uint32_t uniform_uploads = 0;
+
+        uint64_t buffer_upload_bytes = 0;
+
+        uint64_t texture_upload_bytes = 0;
+
+        uint64_t readback_bytes = 0;
+
+        uint32_t clears = 0;
+    };
+
+    // Counters filled by the gl wrappers (gVertexArray, Shader, gTexture,
+    // gFramebuffer, gRender and the opengl_* classes). The current frame is
+    // reset by begin_frame and pushed into a fixed size history by end_frame.
+    class render_stats
+    {
+    public:
+        static constexpr uint32_t k_default_history = 120;
+
+        static void begin_frame();
+
+        static void end_frame();
+
+        static inline const frame_stats& current()
+        {
+            return s_current;
+        }
+
+        static inline frame_stats snapshot()
+        {
+            return s_current;
+        }
+
+        // after - before, field by field; frame is taken from `after`
+        static frame_stats diff(const frame_stats& before, const frame_stats& after);
+
+        static void set_history_size(uint32_t frames);
+
+        // oldest first
+        static std::vector<frame_stats> get_history();
+
+        // same, copied into `allocator` (e.g. gRender::GetFrameAllocator()) so
+        // reading the history every frame does not touch the heap
+        static const frame_stats* get_history(frame_allocator& allocator, uint32_t& count);
+
+        // one json object per line, oldest first; frames = 0 writes the whole history
+        static void write_json_lines(std::ostream& out, uint32_t frames = 0);
+
+        static bool write_json_lines(const char* path, uint32_t frames = 0);
+
+        static void reset();
+
+        static void count_draw(PrimitiveType primitive, uint32_t vertices, uint32_t instances = 1, bool instanced = false);
+
+        static inline void count_program_bind()
+        {
+            s_current.program_binds++;
+        }
+
+        static inline void count_vertex_array_bind()
+        {
+            s_current.vertex_array_binds++;
+        }
+
+        static inline void count_buffer_bind()
+        {
+            s_current.buffer_binds++;
+        }
+
+        static inline void count_texture_bind()
+        {
+            s_current.texture_binds++;
+        }
+
+        static inline void count_framebuffer_bind()
+        {
+            s_current.framebuffer_binds++;
+        }
+
+        static inline void count_uniform_upload()
+        {
+            s_current.uniform_uploads++;
+        }
+
+        static inline void count_buffer_upload(uint64_t bytes)
+        {
+            s_current.buffer_upload_bytes += bytes;
+        }
+
+        static inline void count_texture_upload(uint64_t bytes)
+        {
+            s_current.texture_upload_bytes += bytes;
+        }
+
+        static inline void count_readback(uint64_t bytes)
+        {
+            s_current.readback_bytes += bytes;
+        }
+
+        static inline void count_clear()
+        {
+            s_current.clears++;
+        }
+
+    private:
+        // por thread: cada contexto GL e dirigido por uma thread
+        static thread_local frame_stats s_current;
+
+        static thread_local std::vector<frame_stats> s_history;
+
+        static thread_local uint32_t s_history_size;
+
+        // proxima posicao de escrita no anel
+        static thread_local uint32_t s_history_head;
+
+        static thread_local uint64_t s_frame;
+
+        // i-esimo frame do historico, do mais antigo
+        static const frame_stats& history_at(size_t index);
+    };
+}
@@ -0,0 +1,211 @@
+#pragma once
+
+#include "buffer_layout.hpp"
+#include "handle_pool.hpp"
+#include "vertex_buffer.hpp"
+
+namespace gr
+{
+    struct buffer_tag;
+
+    struct vertex_array_tag;
+
+    using buffer_handle = handle<buffer_tag>;
+
+    using vertex_array_handle = handle<vertex_array_tag>;
+
+    enum class buffer_target : uint8_t { vertex, index, uniform };
+
+    // Buffers stored as parallel arrays indexed by handle slot, as an opt-in
+    // alternative to vertex_buffer/index_buffer::create for code that manages
+    // many objects. It does not replace the shared_ptr API: vertex_array and
+    // its users (sprite_batch, the draw paths) still own their buffers through
+    // shared_ptr. GL names are generated in batches.
+    // Use from the thread owning the context.
+    class buffer_pool
+    {
+    public:
+        // frames a destroy_deferred() waits for, so the GPU is done with the buffer
+        static constexpr uint32_t k_destroy_latency = 3;
+
+        explicit buffer_pool(uint32_t name_batch = 64);
+        ~buffer_pool();
+
+        buffer_pool(const buffer_pool&) = delete;
+        buffer_pool& operator=(const buffer_pool&) = delete;
+
+        // data may be null to only reserve the storage
+        buffer_handle create(buffer_target target, const void* data, uint32_t size, buffer_usage usage = buffer_usage::static_draw);
+
+        void set_data(buffer_handle buffer, const void* data, uint32_t size);
+
+        void set_layout(buffer_handle buffer, buffer_layout&& layout);
+
+        void set_debug_name(buffer_handle buffer, const char* name);
+
+        void bind(buffer_handle buffer) const;
+
+        void destroy(buffer_handle buffer);
+
+        void destroy_deferred(buffer_handle buffer);
+
+        // Call once per frame; deletes the deferred buffers that are old enough.
+        void end_frame();
+
+        inline bool is_valid(buffer_handle buffer) const
+        {
+            return m_handles.is_valid(buffer);
+        }
+
+        inline uint32_t get_id(buffer_handle buffer) const
+        {
+            return m_ids[m_handles.get_index(buffer)];
+        }
+
+        inline uint32_t get_size(buffer_handle buffer) const
+        {
+            return m_sizes[m_handles.get_index(buffer)];
+        }
+
+        inline buffer_target get_target(buffer_handle buffer) const
+        {
+            return m_targets[m_handles.get_index(buffer)];
+        }
+
+        inline const buffer_layout& get_layout(buffer_handle buffer) const
+        {
+            return m_layouts[m_handles.get_index(buffer)];
+        }
+
+        inline uint32_t get_alive() const
+        {
+            return m_handles.get_alive();
+        }
+
+    private:
+        struct deferred
+        {
+            buffer_handle buffer;
+
+            uint64_t frame;
+        };
+
+        handle_pool<buffer_tag> m_handles;
+
+        std::vector<uint32_t> m_ids;
+
+        std::vector<uint32_t> m_sizes;
+
+        std::vector<buffer_target> m_targets;
+
+        std::vector<buffer_usage> m_usages;
+
+        std::vector<buffer_layout> m_layouts;
+
+        // nomes gerados em lote e ainda nao usados
+        std::vector<uint32_t> m_names;
+
+        std::vector<deferred> m_deferred;
+
+        uint32_t m_name_batch;
+
+        uint64_t m_frame;
+
+        uint32_t take_name();
+    };
+
+    // Vertex arrays over buffer_pool buffers. Each array keeps up to
+    // k_max_vertex_buffers buffer handles in a flat array, no shared ownership:
+    // destroying a buffer still referenced by an array is the caller's problem.
+    class vertex_array_pool
+    {
+    public:
+        static constexpr uint32_t k_max_vertex_buffers = 8;
+
+        static constexpr uint32_t k_destroy_latency = buffer_pool::k_destroy_latency;
+
+        explicit vertex_array_pool(buffer_pool& buffers, uint32_t name_batch = 32);
+        ~vertex_array_pool();
+
+        vertex_array_pool(const vertex_array_pool&) = delete;
+        vertex_array_pool& operator=(const vertex_array_pool&) = delete;
+
+        vertex_array_handle create();
+
+        // Sets up the attributes from the buffer layout; false when the array is full.
+        bool add_vertex_buffer(vertex_array_handle array, buffer_handle buffer);
+
+        void set_index_buffer(vertex_array_handle array, buffer_handle buffer);
+
+        void bind(vertex_array_handle array) const;
+
+        void destroy(vertex_array_handle array);
+
+        void destroy_deferred(vertex_array_handle array);
+
+        void end_frame();
+
+        inline bool is_valid(vertex_array_handle array) const
+        {
+            return m_handles.is_valid(array);
+        }
+
+        inline uint32_t get_id(vertex_array_handle array) const
+        {
+            return m_ids[m_handles.get_index(array)];
+        }
+
+        inline buffer_handle get_index_buffer(vertex_array_handle array) const
+        {
+            return m_index_buffers[m_handles.get_index(array)];
+        }
+
+        inline uint32_t get_vertex_buffer_count(vertex_array_handle array) const
+        {
+            return m_buffer_counts[m_handles.get_index(array)];
+        }
+
+        inline const buffer_handle* get_vertex_buffers(vertex_array_handle array) const
+        {
+            return &m_vertex_buffers[m_handles.get_index(array) * k_max_vertex_buffers];
+        }
+
+        inline uint32_t get_alive() const
+        {
+            return m_handles.get_alive();
+        }
+
+    private:
+        struct deferred
+        {
+            vertex_array_handle array;
+
+            uint64_t frame;
+        };
+
+        buffer_pool& m_buffers;
+
+        handle_pool<vertex_array_tag> m_handles;
+
+        std::vector<uint32_t> m_ids;
+
+        std::vector<uint32_t> m_attribute_counts;
+
+        std::vector<uint32_t> m_buffer_counts;
+
+        std::vector<buffer_handle> m_index_buffers;
+
+        // k_max_vertex_buffers entradas por slot
+        std::vector<buffer_handle> m_vertex_buffers;
+
+        std::vector<uint32_t> m_names;
+
+        std::vector<deferred> m_deferred;
+
+        uint32_t m_name_batch;
+
+        uint64_t m_frame;
+
+        uint32_t take_name();
+    };
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+// Background upload thread on a shared EGL context. Only built when the
+// library links EGL (GR_USE_EGL).
+
+#ifdef GR_USE_EGL
+
+#include "gCommon.h"
+#include "mpmc_queue.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gr
+{
+    struct resource_uploader_stats
+    {
+        uint64_t jobs = 0;
+
+        uint64_t completed = 0;
+
+        uint64_t bytes = 0;
+    };
+
+    // Runs texture and buffer uploads on its own thread, in a context that shares
+    // objects with the render context. Every job is followed by a glFenceSync;
+    // the render thread picks the fences up in poll() and only blocks in wait().
+    //
+    // Objects must be created (and textures given their size with
+    // gTexture::allocate_levels) on the render thread. Once a job completes, bind
+    // the object again on the render thread before using it, as required for
+    // objects changed by another context.
+    class resource_uploader
+    {
+    public:
+        using ticket = uint64_t;
+
+        using completion_callback = std::function<void()>;
+
+        explicit resource_uploader(size_t queue_capacity = 256);
+        ~resource_uploader();
+
+        resource_uploader(const resource_uploader&) = delete;
+        resource_uploader& operator=(const resource_uploader&) = delete;
+
+        // Render thread, with its context current. Null display/context take the
+        // current ones. Uses EGL_KHR_surfaceless_context or a 1x1 pbuffer.
+        bool initialize(void* display = nullptr, void* share_context = nullptr);
+
+        void release();
+
+        // The jobs below return 0 when the queue is full; nothing is consumed then.
+        ticket upload_texture(const gTexture& texture, uint32_t level, std::vector<uint8_t>&& pixels, completion_callback callback = nullptr);
+
+        // glBufferData: replaces the storage of `buffer`
+        ticket upload_buffer(BufferID buffer, std::vector<uint8_t>&& data, BufferUsage usage, completion_callback callback = nullptr);
+
+        // glBufferSubData into existing storage
+        ticket update_buffer(BufferID buffer, uint32_t offset, std::vector<uint8_t>&& data, completion_callback callback = nullptr);
+
+        // Any other GL work to run on the upload context.
+        ticket submit(std::function<void()> job, completion_callback callback = nullptr);
+
+        // Render thread. Runs the callbacks of jobs whose fence signaled; returns how many.
+        uint32_t poll();
+
+        bool is_complete(ticket id) const;
+
+        // Render thread. Blocks until the job finished on the GPU; false on timeout.
+        bool wait(ticket id, uint64_t timeout_ns = UINT64_MAX);
+
+        inline bool is_running() const
+        {
+            return m_thread.joinable();
+        }
+
+        resource_uploader_stats get_stats() const;
+
+    private:
+        enum class job_type : uint8_t
+        {
+            texture,
+            buffer_data,
+            buffer_sub_data,
+            custom
+        };
+
+        struct job
+        {
+            ticket id = 0;
+
+            job_type type = job_type::custom;
+
+            uint32_t object = 0;
+
+            uint32_t level = 0;
+
+            uint32_t width = 0;
+
+            uint32_t height = 0;
+
+            uint32_t offset = 0;
+
+            TextureFormatInfo format = {};
+
+            BufferUsage usage = BufferUsage::STATIC;
+
+            std::vector<uint8_t> data;
+
+            std::function<void()> work;
+        };
+
+        struct done
+        {
+            ticket id = 0;
+
+            void* fence = nullptr;
+        };
+
+        struct pending
+        {
+            void* fence;
+
+            completion_callback callback;
+        };
+
+        mpmc_queue<job> m_jobs;
+
+        mpmc_queue<done> m_done;
+
+        std::thread m_thread;
+
+        std::mutex m_wake_mutex;
+
+        std::condition_variable m_wake;
+
+        std::atomic<bool> m_stop;
+
+        void* m_display;
+
+        void* m_context;
+
+        void* m_surface;
+
+        // render thread only
+        std::unordered_map<ticket, pending> m_pending;
+
+        ticket m_next_ticket;
+
+        std::atomic<uint64_t> m_completed;
+
+        std::atomic<uint64_t> m_bytes;
+
+        ticket enqueue(job& item, completion_callback& callback);
+
+        void drain_done();
+
+        void complete(ticket id);
+
+        void worker_loop(std::function<void(bool)> started);
+
+        void execute(job& item);
+    };
+}
+
+#endif // GR_USE_EGL
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "gCommon.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+namespace gr
+{
+    enum class sampler_filter : uint8_t { nearest, linear };
+
+    enum class sampler_mipmap : uint8_t { none, nearest, linear };
+
+    enum class sampler_wrap : uint8_t { repeat, mirror, clamp_edge, clamp_border };
+
+    // depth comparison (shadow samplers); none samples the depth itself
+    enum class sampler_compare : uint8_t { none, less_equal, greater_equal, less, greater, equal, not_equal, always, never };
+
+    struct sampler_state
+    {
+        sampler_filter min_filter = sampler_filter::linear;
+
+        sampler_filter mag_filter = sampler_filter::linear;
+
+        sampler_mipmap mipmap = sampler_mipmap::none;
+
+        sampler_wrap wrap_s = sampler_wrap::repeat;
+
+        sampler_wrap wrap_t = sampler_wrap::repeat;
+
+        sampler_wrap wrap_r = sampler_wrap::repeat;
+
+        sampler_compare compare = sampler_compare::none;
+
+        // 1 = off; clamped by the driver to its maximum
+        float max_anisotropy = 1.0f;
+
+        // ignored on GLES
+        float lod_bias = 0.0f;
+
+        float min_lod = -1000.0f;
+
+        float max_lod = 1000.0f;
+
+        uint64_t hash() const;
+
+        bool operator==(const sampler_state& other) const;
+
+        inline bool operator!=(const sampler_state& other) const
+        {
+            return !(*this == other);
+        }
+    };
+
+    struct sampler_state_hash
+    {
+        inline size_t operator()(const sampler_state& state) const
+        {
+            return static_cast<size_t>(state.hash());
+        }
+    };
+
+    // Sampler objects by state: asking twice for the same state gives the same
+    // sampler, so one image can be read with any number of filters without
+    // copies and without touching the texture's own parameters. The samplers
+    // are passed to gTexture::bind. Use from the thread owning the context.
+    class sampler_cache
+    {
+    public:
+        // units whose bound sampler is remembered to skip redundant binds
+        static constexpr uint32_t k_max_units = 32;
+
+        sampler_cache() = default;
+        ~sampler_cache();
+
+        sampler_cache(const sampler_cache&) = delete;
+        sampler_cache& operator=(const sampler_cache&) = delete;
+
+        // GL name of the sampler, created on first use
+        uint32_t get(const sampler_state& state);
+
+        // deletes every sampler; names handed out before are dead
+        void clear();
+
+        inline uint32_t get_count() const
+        {
+            return static_cast<uint32_t>(m_samplers.size());
+        }
+
+        // glBindSampler, skipped when the unit already has it; 0 goes back to
+        // the texture's parameters
+        static void bind(uint32_t unit, uint32_t sampler);
+
+        // after code outside the library changed sampler bindings; gRender::Release
+        // (context switch) calls it too
+        static void invalidate_bindings();
+
+    private:
+        std::unordered_map<sampler_state, uint32_t, sampler_state_hash> m_samplers;
+
+        static thread_local uint32_t s_bound[k_max_units];
+    };
+}
@@ -3,17 +3,72 @@
 #include "gCommon.h"
 
 #include <stdint.h>
+#include <string>
+#include <vector>
 
 namespace gr
 {
+    // bytes of one element as SetUniform reads it (Matrix3x3 = 9 floats)
+    uint32_t get_uniform_type_size(UniformType type);
+
+    // uniform block (std140 / shared layout), bound to binding point `binding`
+    struct shader_block
+    {
+        std::string name;
+
+        uint32_t index;
+
+        uint32_t binding;
+
+        uint32_t size;
+    };
+
+    struct shader_block_member
+    {
+        std::string name;
+
+        // into Shader::get_blocks()
+        uint32_t block;
+
+        UniformType type;
+
+        uint32_t count;
+
+        uint32_t offset;
+
+        uint32_t array_stride;
+
+        uint32_t matrix_stride;
+    };
+
+    struct shader_attribute
+    {
+        std::string name;
+
+        int32_t location;
+
+        // GL type (GL_FLOAT_VEC3, ...)
+        uint32_t type;
+
+        uint32_t count;
+    };
+
     class Shader
     {
     public:
         Shader();
         ~Shader();
 
+        // Links and reflects the program: every active uniform of the default
+        // block gets a ShaderUniform (type, array count and offset from the
+        // driver), numbered in name order so UniformIDs match across drivers.
+        // Samplers and blocks keep a nonzero layout(binding = N); the ones left
+        // at 0 get the lowest free units / binding points. UniformIDs stay valid
+        // until the next build.
         int build(const char **fragment, int nfrag, const char **vertex, int nvert);
 
+        // Only needed for programs without reflection (RenderBackend::Null);
+        // otherwise it returns the reflected uniform and ignores count and type.
         UniformID registry(const char *name, uint32_t count, UniformType type);
 
         template <typename T>
@@ -44,6 +99,31 @@ namespace gr
 
         UniformID findUniform(const char *name);
 
+        inline const std::vector<shader_block> &get_blocks() const
+        {
+            return m_blocks;
+        }
+
+        inline const std::vector<shader_block_member> &get_block_members() const
+        {
+            return m_block_members;
+        }
+
+        inline const std::vector<shader_attribute> &get_attributes() const
+        {
+            return m_attributes;
+        }
+
+        uint32_t find_block(const char *name) const;
+
+        int32_t find_attribute(const char *name) const;
+
+        // texture units taken by the samplers
+        inline uint32_t get_sampler_units() const
+        {
+            return m_sampler_units;
+        }
+
     private:
         ShaderID shaderID;
 
@@ -55,7 +135,27 @@ namespace gr
 
         size_t m_count;
 
+        std::vector<shader_block> m_blocks;
+
+        std::vector<shader_block_member> m_block_members;
+
+        std::vector<shader_attribute> m_attributes;
+
+        uint32_t m_sampler_units;
+
+        // the uniform table came from the driver: registry no longer asks it
+        bool m_reflected;
+
         void reallocate();
+
+        void clear_uniforms();
+
+        UniformID add_uniform(const char *name, int location, uint32_t count, UniformType type);
+
+        void reflect();
+
+        // RenderBackend::Null: checks the sources and makes a fake program
+        int build_null(const char **fragment, int nfrag, const char **vertex, int nvert);
     };
 
     template <typename T>
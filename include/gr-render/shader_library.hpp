@@ -0,0 +1,138 @@
+#pragma once
+
+#include "gCommon.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace gr
+{
+    class Shader;
+
+    // text of an #include; false when there is no such file
+    using shader_include_loader = std::function<bool(const std::string& path, std::string& source)>;
+
+    struct shader_library_statistics
+    {
+        // distinct (program, mask) pairs asked for
+        uint32_t variants = 0;
+
+        // Shader::build calls that succeeded
+        uint32_t compiled = 0;
+
+        // variants that reused a program with the same preprocessed source
+        uint32_t shared = 0;
+
+        uint32_t failures = 0;
+    };
+
+    // Shader programs with feature keywords. A variant is a program plus a
+    // 64 bit mask, bit i turning on keywords[i] as "#define KEYWORD 1" right
+    // after #version. Variants are built on first use; before that each
+    // stage is preprocessed: #include "file" (or <file>) is expanded once per
+    // file with #line markers, and only the keywords a stage mentions are
+    // defined, so masks that differ in unused keywords hash the same and
+    // share one Shader.
+    //
+    // The shaders are GL objects: use the library on the thread of its context.
+    class shader_library
+    {
+    public:
+        static constexpr uint32_t k_max_keywords = 64;
+
+        static constexpr uint32_t k_max_include_depth = 32;
+
+        shader_library() = default;
+        ~shader_library();
+
+        shader_library(const shader_library&) = delete;
+        shader_library& operator=(const shader_library&) = delete;
+
+        // used for the includes not given with add_include
+        void set_include_loader(shader_include_loader loader);
+
+        void add_include(const std::string& path, std::string source);
+
+        // GR_INVALID_ID when the name is taken or there are more than k_max_keywords
+        uint32_t add_program(const std::string& name, std::string vertex, std::string fragment, const std::vector<std::string>& keywords = {});
+
+        uint32_t find_program(const std::string& name) const;
+
+        // 0 for a keyword the program does not have
+        uint64_t get_keyword_mask(uint32_t program, const char* keyword) const;
+
+        // nullptr when preprocessing or the build failed; the failure is kept,
+        // so a broken variant is not rebuilt every frame
+        Shader* get_variant(uint32_t program, uint64_t mask);
+
+        // builds the variants now (loading screens); returns how many are usable
+        uint32_t precompile(const std::vector<std::pair<uint32_t, uint64_t>>& variants);
+
+        // deletes every Shader; programs and includes stay
+        void clear_variants();
+
+        inline const shader_library_statistics& get_statistics() const
+        {
+            return m_statistics;
+        }
+
+        // of the last failed variant
+        inline const std::string& get_last_error() const
+        {
+            return m_last_error;
+        }
+
+    private:
+        struct program
+        {
+            std::string name;
+
+            std::string vertex;
+
+            std::string fragment;
+
+            std::vector<std::string> keywords;
+
+            uint64_t valid_mask;
+
+            // mascara (so bits validos) -> shader; nullptr = variante que falhou
+            std::unordered_map<uint64_t, Shader*> variants;
+        };
+
+        std::vector<program> m_programs;
+
+        // shader of one pair of preprocessed stages, nullptr when the build failed
+        struct compiled
+        {
+            std::string vertex;
+
+            std::string fragment;
+
+            std::unique_ptr<Shader> shader;
+        };
+
+        std::unordered_map<std::string, std::string> m_includes;
+
+        shader_include_loader m_loader;
+
+        // by hash of both stages; the text is compared too, a hash match alone
+        // could hand out the shader of other sources
+        std::unordered_multimap<uint64_t, compiled> m_shaders;
+
+        shader_library_statistics m_statistics;
+
+        std::string m_last_error;
+
+        Shader* build_variant(const program& entry, uint64_t mask);
+
+        bool preprocess(const program& entry, const std::string& source, const char* stage, uint64_t mask, std::string& output);
+
+        bool expand_includes(const std::string& source, uint32_t file, uint32_t depth, std::vector<std::string>& files, std::string& output);
+
+        bool load_include(const std::string& path, std::string& source);
+    };
+}
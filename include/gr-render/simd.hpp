@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define GR_SIMD_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define GR_SIMD_SSE 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define GR_SIMD_NEON 1
+#endif
+
+// Minimal float vector wrapper used by the CPU culling and rasterisation code.
+namespace gr
+{
+    namespace simd
+    {
+#if GR_SIMD_AVX
+        constexpr int width = 8;
+
+        struct vfloat { __m256 v; };
+        struct vmask { __m256 v; };
+
+        inline vfloat load(const float* p) { return {_mm256_loadu_ps(p)}; }
+        inline void store(float* p, vfloat a) { _mm256_storeu_ps(p, a.v); }
+        inline vfloat set1(float x) { return {_mm256_set1_ps(x)}; }
+        inline vfloat ramp() { return {_mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7)}; }
+        inline vfloat operator+(vfloat a, vfloat b) { return {_mm256_add_ps(a.v, b.v)}; }
+        inline vfloat operator-(vfloat a, vfloat b) { return {_mm256_sub_ps(a.v, b.v)}; }
+        inline vfloat operator*(vfloat a, vfloat b) { return {_mm256_mul_ps(a.v, b.v)}; }
+        inline vfloat min(vfloat a, vfloat b) { return {_mm256_min_ps(a.v, b.v)}; }
+        inline vfloat max(vfloat a, vfloat b) { return {_mm256_max_ps(a.v, b.v)}; }
+        inline vfloat abs(vfloat a) { return {_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v)}; }
+        inline vfloat select(vmask m, vfloat a, vfloat b) { return {_mm256_blendv_ps(b.v, a.v, m.v)}; }
+        inline vmask operator<(vfloat a, vfloat b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)}; }
+        inline vmask operator<=(vfloat a, vfloat b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ)}; }
+        inline vmask operator>=(vfloat a, vfloat b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ)}; }
+        inline vmask operator&(vmask a, vmask b) { return {_mm256_and_ps(a.v, b.v)}; }
+        inline vmask operator|(vmask a, vmask b) { return {_mm256_or_ps(a.v, b.v)}; }
+        inline vmask mask_all() { return {_mm256_castsi256_ps(_mm256_set1_epi32(-1))}; }
+        inline uint32_t movemask(vmask m) { return static_cast<uint32_t>(_mm256_movemask_ps(m.v)); }
+#elif GR_SIMD_SSE
+        constexpr int width = 4;
+
+        struct vfloat { __m128 v; };
+        struct vmask { __m128 v; };
+
+        inline vfloat load(const float* p) { return {_mm_loadu_ps(p)}; }
+        inline void store(float* p, vfloat a) { _mm_storeu_ps(p, a.v); }
+        inline vfloat set1(float x) { return {_mm_set1_ps(x)}; }
+        inline vfloat ramp() { return {_mm_setr_ps(0, 1, 2, 3)}; }
+        inline vfloat operator+(vfloat a, vfloat b) { return {_mm_add_ps(a.v, b.v)}; }
+        inline vfloat operator-(vfloat a, vfloat b) { return {_mm_sub_ps(a.v, b.v)}; }
+        inline vfloat operator*(vfloat a, vfloat b) { return {_mm_mul_ps(a.v, b.v)}; }
+        inline vfloat min(vfloat a, vfloat b) { return {_mm_min_ps(a.v, b.v)}; }
+        inline vfloat max(vfloat a, vfloat b) { return {_mm_max_ps(a.v, b.v)}; }
+        inline vfloat abs(vfloat a) { return {_mm_andnot_ps(_mm_set1_ps(-0.0f), a.v)}; }
+        inline vfloat select(vmask m, vfloat a, vfloat b) { return {_mm_or_ps(_mm_and_ps(m.v, a.v), _mm_andnot_ps(m.v, b.v))}; }
+        inline vmask operator<(vfloat a, vfloat b) { return {_mm_cmplt_ps(a.v, b.v)}; }
+        inline vmask operator<=(vfloat a, vfloat b) { return {_mm_cmple_ps(a.v, b.v)}; }
+        inline vmask operator>=(vfloat a, vfloat b) { return {_mm_cmpge_ps(a.v, b.v)}; }
+        inline vmask operator&(vmask a, vmask b) { return {_mm_and_ps(a.v, b.v)}; }
+        inline vmask operator|(vmask a, vmask b) { return {_mm_or_ps(a.v, b.v)}; }
+        inline vmask mask_all() { return {_mm_castsi128_ps(_mm_set1_epi32(-1))}; }
+        inline uint32_t movemask(vmask m) { return static_cast<uint32_t>(_mm_movemask_ps(m.v)); }
+#elif GR_SIMD_NEON
+        constexpr int width = 4;
+
+        struct vfloat { float32x4_t v; };
+        struct vmask { uint32x4_t v; };
+
+        inline vfloat load(const float* p) { return {vld1q_f32(p)}; }
+        inline void store(float* p, vfloat a) { vst1q_f32(p, a.v); }
+        inline vfloat set1(float x) { return {vdupq_n_f32(x)}; }
+        inline vfloat ramp() { const float r[4] = {0, 1, 2, 3}; return {vld1q_f32(r)}; }
+        inline vfloat operator+(vfloat a, vfloat b) { return {vaddq_f32(a.v, b.v)}; }
+        inline vfloat operator-(vfloat a, vfloat b) { return {vsubq_f32(a.v, b.v)}; }
+        inline vfloat operator*(vfloat a, vfloat b) { return {vmulq_f32(a.v, b.v)}; }
+        inline vfloat min(vfloat a, vfloat b) { return {vminq_f32(a.v, b.v)}; }
+        inline vfloat max(vfloat a, vfloat b) { return {vmaxq_f32(a.v, b.v)}; }
+        inline vfloat abs(vfloat a) { return {vabsq_f32(a.v)}; }
+        inline vfloat select(vmask m, vfloat a, vfloat b) { return {vbslq_f32(m.v, a.v, b.v)}; }
+        inline vmask operator<(vfloat a, vfloat b) { return {vcltq_f32(a.v, b.v)}; }
+        inline vmask operator<=(vfloat a, vfloat b) { return {vcleq_f32(a.v, b.v)}; }
+        inline vmask operator>=(vfloat a, vfloat b) { return {vcgeq_f32(a.v, b.v)}; }
+        inline vmask operator&(vmask a, vmask b) { return {vandq_u32(a.v, b.v)}; }
+        inline vmask operator|(vmask a, vmask b) { return {vorrq_u32(a.v, b.v)}; }
+        inline vmask mask_all() { return {vdupq_n_u32(0xffffffffu)}; }
+        inline uint32_t movemask(vmask m)
+        {
+            const uint32_t bits[4] = {1, 2, 4, 8};
+            uint32x4_t b = vandq_u32(m.v, vld1q_u32(bits));
+            return vgetq_lane_u32(b, 0) | vgetq_lane_u32(b, 1) | vgetq_lane_u32(b, 2) | vgetq_lane_u32(b, 3);
+        }
+#else
+        constexpr int width = 1;
+
+        struct vfloat { float v; };
+        struct vmask { bool v; };
+
+        inline vfloat load(const float* p) { return {*p}; }
+        inline void store(float* p, vfloat a) { *p = a.v; }
+        inline vfloat set1(float x) { return {x}; }
+        inline vfloat ramp() { return {0.0f}; }
+        inline vfloat operator+(vfloat a, vfloat b) { return {a.v + b.v}; }
+        inline vfloat operator-(vfloat a, vfloat b) { return {a.v - b.v}; }
+        inline vfloat operator*(vfloat a, vfloat b) { return {a.v * b.v}; }
+        inline vfloat min(vfloat a, vfloat b) { return {a.v < b.v ? a.v : b.v}; }
+        inline vfloat max(vfloat a, vfloat b) { return {a.v > b.v ? a.v : b.v}; }
+        inline vfloat abs(vfloat a) { return {std::fabs(a.v)}; }
+        inline vfloat select(vmask m, vfloat a, vfloat b) { return m.v ? a : b; }
+        inline vmask operator<(vfloat a, vfloat b) { return {a.v < b.v}; }
+        inline vmask operator<=(vfloat a, vfloat b) { return {a.v <= b.v}; }
+        inline vmask operator>=(vfloat a, vfloat b) { return {a.v >= b.v}; }
+        inline vmask operator&(vmask a, vmask b) { return {a.v && b.v}; }
+        inline vmask operator|(vmask a, vmask b) { return {a.v || b.v}; }
+        inline vmask mask_all() { return {true}; }
+        inline uint32_t movemask(vmask m) { return m.v ? 1u : 0u; }
+#endif
+
+        inline vfloat fmadd(vfloat a, vfloat b, vfloat c) { return a * b + c; }
+
+        inline int count_trailing_zeros(uint32_t x)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_ctz(x);
+#else
+            int n = 0;
+            while (!(x & 1u)) { x >>= 1; n++; }
+            return n;
+#endif
+        }
+    }
+}
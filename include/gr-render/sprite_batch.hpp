@@ -0,0 +1,132 @@
+#pragma once
+
+#include "gCommon.h"
+#include "vertex_array.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace gr
+{
+    struct sprite_vertex
+    {
+        float x, y;
+        float u, v;
+        float r, g, b, a;
+        float texture;
+    };
+
+    struct nine_slice
+    {
+        // bordas no destino, em pixels
+        float left, right, top, bottom;
+
+        // bordas na textura, em uv
+        float uv_left, uv_right, uv_top, uv_bottom;
+    };
+
+    struct sprite_batch_stats
+    {
+        uint32_t quads = 0;
+
+        uint32_t draw_calls = 0;
+
+        // flushes forced by running out of texture slots
+        uint32_t texture_flushes = 0;
+
+        // flushes forced by projection, clip or capacity
+        uint32_t state_flushes = 0;
+    };
+
+    // Batches textured quads into one streamed vertex buffer over a static index
+    // pattern. Up to `max_textures` textures share a draw through a sampler array.
+    //
+    // Clip rects are in window pixels (glScissor space) and quads are expected in
+    // the same space. Axis aligned quads are clipped on the CPU; rotated quads fall
+    // back to the scissor test, which makes the clip rect part of the batch state.
+    //
+    // Vertices are staged in gRender::GetFrameAllocator(), so keep each
+    // begin/end between two gRender::BeginFrame calls.
+    class sprite_batch
+    {
+    public:
+        sprite_batch(uint32_t max_quads = 10000, uint32_t max_textures = 16);
+        ~sprite_batch();
+
+        bool initialize();
+
+        void release();
+
+        void begin(const Matrix4x4& projection);
+
+        void end();
+
+        void flush();
+
+        void set_projection(const Matrix4x4& projection);
+
+        void set_clip_rect(const Rect& rect);
+
+        void clear_clip_rect();
+
+        void draw_quad(const Rect& rect, const Color& color);
+
+        void draw_quad(const Rect& rect, gTexture* texture, const Rect& uv, const Color& color);
+
+        // rotation in radians around `origin`, given in the same space as rect
+        void draw_quad(const Rect& rect, float rotation, const Vector2& origin, gTexture* texture, const Rect& uv, const Color& color);
+
+        void draw_nine_slice(const Rect& rect, gTexture* texture, const Rect& uv, const nine_slice& slice, const Color& color);
+
+        inline const sprite_batch_stats& get_stats() const
+        {
+            return m_stats;
+        }
+
+    private:
+        uint32_t m_max_quads;
+
+        uint32_t m_max_textures;
+
+        std::shared_ptr<vertex_array> m_vertex_array;
+
+        std::shared_ptr<vertex_buffer> m_vertex_buffer;
+
+        std::shared_ptr<index_buffer> m_index_buffer;
+
+        std::unique_ptr<Shader> m_shader;
+
+        std::unique_ptr<gTexture> m_white;
+
+        UniformID m_projection_uniform;
+
+        UniformID m_textures_uniform;
+
+        Matrix4x4 m_projection;
+
+        // max_quads * 4 vertices no frame_allocator do gRender
+        sprite_vertex* m_vertices;
+
+        uint32_t m_vertex_count;
+
+        // frame_allocator::get_resets() quando m_vertices foi tirado
+        uint32_t m_staging_resets;
+
+        std::vector<gTexture*> m_textures;
+
+        Rect m_clip;
+
+        bool m_clip_enabled;
+
+        // o lote atual usa scissor (contem quads rotacionados sob clip)
+        bool m_batch_scissor;
+
+        sprite_batch_stats m_stats;
+
+        float acquire_slot(gTexture* texture);
+
+        void acquire_staging();
+
+        void push_quad(const float* xs, const float* ys, const Rect& uv, const Color& color, float slot);
+    };
+}
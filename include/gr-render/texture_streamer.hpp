@@ -0,0 +1,203 @@
+#pragma once
+
+#include "gCommon.h"
+#include "gTexture.h"
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace gr
+{
+    class thread_pool;
+
+    // Fills `pixels` with mip `level` (width x height texels). Runs on a pool thread.
+    using texture_level_loader = std::function<bool(uint32_t level, uint32_t width, uint32_t height, std::vector<uint8_t>& pixels)>;
+
+    struct streaming_texture_desc
+    {
+        uint32_t width;
+
+        uint32_t height;
+
+        // 0 = full chain
+        uint32_t levels = 0;
+
+        TextureFormat format = TextureFormat_RGBA;
+
+        TextureFlags_ clamping = gTextureFlags_Clamp_Repeat;
+
+        const char* name = nullptr;
+    };
+
+    struct texture_streamer_stats
+    {
+        uint64_t resident_bytes = 0;
+
+        uint64_t budget = 0;
+
+        uint32_t textures = 0;
+
+        uint32_t loads_in_flight = 0;
+
+        // last update()
+        uint32_t uploads = 0;
+
+        uint32_t evictions = 0;
+
+        // loads dropped because nothing could be evicted to make room
+        uint32_t rejected = 0;
+
+        // loads whose loader failed
+        uint32_t failed = 0;
+    };
+
+    // Streams the mip chain of 2D textures under a memory budget.
+    //
+    // Textures start with only their tail (mips up to k_tail_size) resident. The
+    // caller reports the finest mip it needs every frame; update() then loads the
+    // next finer level of the most urgent textures on the thread pool and uploads
+    // finished levels on the render thread, one level per texture at a time. The
+    // texture base level is clamped to the finest resident mip so it is always
+    // complete. When an upload does not fit, the finest mips of the least recently
+    // used textures are released. A level whose loader fails
+    // k_max_load_attempts times in a row is not loaded again, and the texture
+    // stays at the coarser mips.
+    class texture_streamer
+    {
+    public:
+        static constexpr uint32_t k_tail_size = 64;
+
+        static constexpr uint32_t k_max_load_attempts = 3;
+
+        texture_streamer(uint64_t budget, thread_pool* pool = nullptr);
+        ~texture_streamer();
+
+        texture_streamer(const texture_streamer&) = delete;
+        texture_streamer& operator=(const texture_streamer&) = delete;
+
+        // Loads the tail synchronously. Returns GR_INVALID_ID if the tail can not be loaded.
+        uint32_t create(const streaming_texture_desc& desc, texture_level_loader loader);
+
+        void destroy(uint32_t handle);
+
+        gTexture* get_texture(uint32_t handle);
+
+        // Reports that `level` (or finer) is needed this frame; higher priority loads first.
+        void request(uint32_t handle, uint32_t level, float priority = 1.0f);
+
+        // Render thread. Uploads at most `max_uploads` finished levels and schedules new loads.
+        void update(uint32_t max_uploads = 4);
+
+        void set_budget(uint64_t budget);
+
+        void set_max_in_flight(uint32_t loads);
+
+        uint32_t get_resident_level(uint32_t handle) const;
+
+        inline const texture_streamer_stats& get_stats() const
+        {
+            return m_stats;
+        }
+
+        // Mip that gives about one texel per pixel for a texture covering
+        // screen_width x screen_height pixels.
+        static uint32_t required_level(uint32_t width, uint32_t height, float screen_width, float screen_height);
+
+    private:
+        struct entry
+        {
+            std::unique_ptr<gTexture> texture;
+
+            std::shared_ptr<texture_level_loader> loader;
+
+            uint32_t width;
+
+            uint32_t height;
+
+            uint32_t levels;
+
+            uint32_t pixel_size;
+
+            // mips [resident, levels) are resident
+            uint32_t resident;
+
+            // primeiro mip da cauda, nunca liberado
+            uint32_t tail;
+
+            uint32_t wanted;
+
+            float priority;
+
+            uint64_t last_used;
+
+            uint32_t generation;
+
+            // m_release_epoch quando a ultima carga foi recusada por falta de espaco
+            uint64_t rejected_epoch;
+
+            // falhas seguidas do loader no proximo mip
+            uint32_t failures;
+
+            // mip que esgotou as tentativas, GR_INVALID_ID se nenhum
+            uint32_t failed_level;
+
+            bool loading;
+
+            bool alive;
+        };
+
+        struct loaded_level
+        {
+            uint32_t handle;
+
+            uint32_t generation;
+
+            uint32_t level;
+
+            bool ok;
+
+            std::vector<uint8_t> pixels;
+        };
+
+        // shared with the load tasks so they can outlive the streamer
+        struct completion_queue
+        {
+            std::mutex mutex;
+
+            std::vector<loaded_level> levels;
+
+            bool closed = false;
+        };
+
+        thread_pool* m_pool;
+
+        std::shared_ptr<completion_queue> m_completed;
+
+        std::vector<entry> m_entries;
+
+        std::vector<uint32_t> m_free;
+
+        uint64_t m_budget;
+
+        uint64_t m_frame;
+
+        // incremented whenever resident memory is given back
+        uint64_t m_release_epoch;
+
+        uint32_t m_max_in_flight;
+
+        texture_streamer_stats m_stats;
+
+        uint64_t level_size(const entry& e, uint32_t level) const;
+
+        uint64_t resident_size(const entry& e) const;
+
+        bool evict_one(uint32_t exclude);
+
+        void upload(uint32_t handle, loaded_level& level);
+
+        void schedule();
+    };
+}
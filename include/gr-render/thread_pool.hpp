@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gr
+{
+    class thread_pool
+    {
+    public:
+        // threads == 0 usa std::thread::hardware_concurrency()
+        explicit thread_pool(uint32_t threads = 0);
+        ~thread_pool();
+
+        thread_pool(const thread_pool&) = delete;
+        thread_pool& operator=(const thread_pool&) = delete;
+
+        static thread_pool& get_default();
+
+        void submit(std::function<void()> task);
+
+        // Blocks until the queue is empty and no task is running.
+        void wait();
+
+        // Calls func(begin, end) over [0, count) in chunks of `grain` items.
+        // The calling thread takes part, so it is safe to call from inside a task.
+        void parallel_for(uint32_t count, uint32_t grain, const std::function<void(uint32_t begin, uint32_t end)>& func);
+
+        inline uint32_t get_thread_count() const
+        {
+            return static_cast<uint32_t>(m_workers.size()) + 1;
+        }
+
+    private:
+        std::vector<std::thread> m_workers;
+
+        std::deque<std::function<void()>> m_tasks;
+
+        std::mutex m_mutex;
+
+        std::condition_variable m_task_cv;
+
+        std::condition_variable m_idle_cv;
+
+        uint32_t m_active;
+
+        bool m_stop;
+
+        void worker_loop();
+    };
+}
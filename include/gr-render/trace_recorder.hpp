@@ -0,0 +1,244 @@
+#pragma once
+
+#include "gCommon.h"
+
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+#include <vector>
+
+namespace gr
+{
+    // Packets of a trace file. Objects are named by the address of their wrapper
+    // (trace_recorder::key), gVertexArray buffers and framebuffers by their GL name.
+    // The payload is the record() arguments in order: plain values as raw bytes,
+    // strings as u32 size + characters + '\0', trace_blob as u32 size + bytes.
+    enum class trace_op : uint16_t
+    {
+        frame_begin = 1,
+        frame_end,
+
+        // gRender
+        background_color,           // f32 r, g, b, a
+        viewport,                   // f32 x, y, w, h
+        scissor,                    // f32 x, y, w, h
+        enable,                     // u32 state, u8 value
+        render_state,               // u64 state, u32 value
+
+        // vertex_buffer / index_buffer / vertex_array
+        vertex_buffer_create,       // key, u32 usage, blob
+        vertex_buffer_data,         // key, blob
+        vertex_buffer_destroy,      // key
+        index_buffer_create,        // key, blob
+        index_buffer_destroy,       // key
+        vertex_array_create,        // key
+        vertex_array_add_buffer,    // key, vertex buffer key, blob of {u32 type, u8 normalized, u8 instanced, u16} per element
+        vertex_array_index_buffer,  // key, index buffer key
+        vertex_array_bind,          // key
+        vertex_array_destroy,       // key
+
+        // gVertexArray
+        legacy_array_create,        // key
+        legacy_array_bind,          // key, 0 unbinds
+        legacy_array_destroy,       // key
+        buffer_create,              // u32 id, u32 type, blob
+        buffer_destroy,             // u32 id
+        buffer_bind,                // u32 id
+        buffer_resize,              // u32 size, u32 usage
+        buffer_update,              // u32 offset, blob
+        attrib,                     // u8 index, u16 size, u16 stride, u64 offset, u8 integer
+        attrib_divisor,             // u8 index, u8 divisor
+        draw_elements,              // u32 primitive, u32 count, u64 offset, u32 instances, u8 instanced
+        draw_arrays,                // u32 primitive, u32 count, u32 instances, u8 instanced
+
+        // Shader
+        shader_build,               // key, string fragment, string vertex
+        shader_uniform,             // key, u32 count, u32 type, string name
+        shader_set_uniform,         // key, string name, blob
+        shader_bind,                // key, 0 unbinds
+        shader_destroy,             // key
+
+        // gTexture
+        texture_update,             // key, u32 width, u32 height, u16 format, u32 flags, blob
+        texture_allocate,           // key, u32 width, u32 height, u32 levels, u16 format, u32 flags
+        texture_level,              // key, u32 level, blob
+        texture_bind,               // key, u32 unit, u32 sampler
+        texture_destroy,            // key
+
+        // gFramebuffer
+        framebuffer_create,         // u32 id
+        framebuffer_bind,           // u32 id, 0 is the default framebuffer
+        framebuffer_texture,        // texture key, u32 attachment, u32 textarget
+        framebuffer_destroy,        // u32 id
+
+        // sampler_cache
+        sampler_create,             // u32 sampler, sampler_state
+        sampler_bind,               // u32 unit, u32 sampler
+
+        // GL work the trace cannot describe; gr-replay stops on it
+        unsupported                 // string call
+    };
+
+    struct trace_blob
+    {
+        const void* data;
+
+        uint32_t size;
+    };
+
+    // Captures what the wrappers do into a binary trace, per thread like
+    // render_stats. Packets are buffered and written once per frame
+    // (gRender::EndFrame), so recording costs a memcpy per call.
+    //
+    // Captured: gRender state, vertex_buffer/index_buffer/vertex_array,
+    // gVertexArray, Shader, gTexture, gFramebuffer and sampler_cache;
+    // command_replayer goes through those wrappers. buffer_pool,
+    // vertex_array_pool, vertex_format_cache and material uniform blocks only
+    // leave a trace_op::unsupported packet. Replay it with gr-replay.
+    class trace_recorder
+    {
+    public:
+        static constexpr uint32_t k_magic = 0x52545247; // "GRTR"
+
+        static constexpr uint32_t k_version = 3;
+
+        // frames == 0 records until stop()
+        static bool start(const char* path, uint32_t frames = 0);
+
+        static void stop();
+
+        static inline bool is_recording()
+        {
+            return s_recording;
+        }
+
+        // called by gRender::EndFrame
+        static void end_frame();
+
+        template <typename... Args>
+        static void record(trace_op op, const Args&... args);
+
+        static inline uint64_t key(const void* object)
+        {
+            return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(object));
+        }
+
+    private:
+        static thread_local bool s_recording;
+
+        static thread_local std::vector<uint8_t> s_buffer;
+
+        static thread_local std::ofstream s_file;
+
+        // frames que faltam; 0 = sem limite
+        static thread_local uint32_t s_frames_left;
+
+        static void flush();
+
+        static inline void write_bytes(const void* data, size_t size)
+        {
+            size_t offset = s_buffer.size();
+            s_buffer.resize(offset + size);
+            if (size > 0)
+                std::memcpy(s_buffer.data() + offset, data, size);
+        }
+
+        template <typename T>
+        static inline void put(const T& value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "trace values are copied as raw bytes");
+            write_bytes(&value, sizeof(T));
+        }
+
+        static inline void put(const trace_blob& blob)
+        {
+            uint32_t size = blob.data != nullptr ? blob.size : 0;
+            put(size);
+            write_bytes(blob.data, size);
+        }
+
+        static inline void put(const char* text)
+        {
+            uint32_t size = text != nullptr ? static_cast<uint32_t>(strlen(text)) : 0;
+            put(size);
+            write_bytes(text, size);
+            s_buffer.push_back(0);
+        }
+
+        static inline void put(char* text)
+        {
+            put(static_cast<const char*>(text));
+        }
+    };
+
+    template <typename... Args>
+    inline void trace_recorder::record(trace_op op, const Args&... args)
+    {
+        if (!s_recording)
+            return;
+
+        size_t start = s_buffer.size();
+
+        put(static_cast<uint16_t>(op));
+        put(static_cast<uint16_t>(0));
+        put(static_cast<uint32_t>(0));
+
+        int expand[] = {0, (put(args), 0)...};
+        (void)expand;
+
+        uint32_t size = static_cast<uint32_t>(s_buffer.size() - start - 8);
+        std::memcpy(s_buffer.data() + start + 4, &size, sizeof(size));
+    }
+
+    // Reads the packets of a trace file in order.
+    class trace_reader
+    {
+    public:
+        bool open(const char* path);
+
+        // false at the end of the file or on a truncated packet
+        bool next();
+
+        inline trace_op get_op() const
+        {
+            return m_op;
+        }
+
+        template <typename T>
+        inline T read()
+        {
+            T value{};
+            if (m_cursor + sizeof(T) <= m_end)
+                std::memcpy(&value, m_data.data() + m_cursor, sizeof(T));
+            else
+                m_overrun = true;
+
+            m_cursor += sizeof(T);
+            return value;
+        }
+
+        // points into the file data; valid until the reader is destroyed
+        trace_blob read_blob();
+
+        const char* read_string();
+
+        // a read went past the end of the current packet
+        inline bool has_overrun() const
+        {
+            return m_overrun;
+        }
+
+    private:
+        std::vector<uint8_t> m_data;
+
+        size_t m_next = 0;
+
+        size_t m_cursor = 0;
+
+        size_t m_end = 0;
+
+        trace_op m_op = trace_op::frame_begin;
+
+        bool m_overrun = false;
+    };
+}
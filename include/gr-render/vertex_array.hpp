@@ -12,10 +12,13 @@ namespace gr
 
         std::shared_ptr<index_buffer> m_index_buffer;
 
+        // records the buffer and its layout when a trace is being captured
+        void trace_add_vertex_buffer(const vertex_buffer& vbo) const;
+
     public:
         static std::shared_ptr<vertex_array> create();
 
-        virtual ~vertex_array() {}
+        virtual ~vertex_array();
 
         virtual void Bind() const = 0;
 
@@ -25,10 +28,15 @@ namespace gr
 
         virtual void SetIndexBuffer(std::shared_ptr<index_buffer>& ibo) = 0;
 
-        inline std::vector<std::shared_ptr<vertex_buffer>> GetVertexBuffers()
+        inline const std::vector<std::shared_ptr<vertex_buffer>>& GetVertexBuffers() const
         {
             return m_vertex_buffers;
         }
+
+        inline const std::shared_ptr<index_buffer>& GetIndexBuffer() const
+        {
+            return m_index_buffer;
+        }
     };
 }
 
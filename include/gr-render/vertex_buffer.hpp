@@ -14,7 +14,7 @@ namespace gr
     public:
         static std::shared_ptr<vertex_buffer> create(const void* data, uint32_t size, buffer_usage usage);
 
-        virtual ~vertex_buffer() {}
+        virtual ~vertex_buffer();
 
         virtual void Bind() = 0;
 
@@ -22,11 +22,22 @@ namespace gr
 
         virtual void SetData(const void* data, uint32_t size) = 0;
 
+        // label shown by memory_tracker
+        virtual void SetDebugName(const char* /*name*/) {}
+
+        // GL name of the buffer
+        virtual uint32_t GetID() const = 0;
+
         inline void SetLayout(const buffer_layout& layout)
         {
             m_layout = layout;
         }
 
+        inline void SetLayout(buffer_layout&& layout)
+        {
+            m_layout = std::move(layout);
+        }
+
         inline const buffer_layout& GetLayout() const
         {
             return m_layout;
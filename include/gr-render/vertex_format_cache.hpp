@@ -0,0 +1,107 @@
+#pragma once
+
+// Separate vertex format / buffer binding (OpenGL 4.3, ARB_vertex_attrib_binding).
+// Not available on OpenGL ES 3.0.
+
+#include "gCommon.h"
+
+#if !GR_OPENGLES3
+
+#include "buffer_layout.hpp"
+
+#include <unordered_map>
+
+namespace gr
+{
+    class vertex_buffer;
+    class index_buffer;
+
+    // one vertex buffer binding point
+    struct vertex_stream
+    {
+        const buffer_layout* layout = nullptr;
+
+        uint32_t buffer = 0;
+
+        uint32_t offset = 0;
+    };
+
+    // One VAO per unique vertex format instead of one per mesh. The attribute
+    // formats are specified once when the VAO is made; switching meshes of the
+    // same format only rebinds the vertex buffer (glBindVertexBuffer) and, if it
+    // changed, the index buffer.
+    //
+    // Stream i uses binding point i and its attributes follow the ones of the
+    // previous streams. VAOs belong to the context, so use one cache per context.
+    // Without OpenGL 4.3 / ARB_vertex_attrib_binding no VAO is made:
+    // get_vertex_array returns 0 and bind false, and the caller keeps its own
+    // per-mesh vertex arrays.
+    class vertex_format_cache
+    {
+    public:
+        static constexpr uint32_t k_max_streams = 4;
+
+        vertex_format_cache() = default;
+        ~vertex_format_cache();
+
+        vertex_format_cache(const vertex_format_cache&) = delete;
+        vertex_format_cache& operator=(const vertex_format_cache&) = delete;
+
+        // VAO for the format; 0 when count is 0, above k_max_streams or unsupported
+        uint32_t get_vertex_array(const vertex_stream* streams, uint32_t count);
+
+        bool bind(const vertex_stream* streams, uint32_t count, uint32_t index_buffer = 0);
+
+        bool bind(const vertex_buffer& vbo, const index_buffer* ibo = nullptr);
+
+        // Forget what is bound; call after code outside the cache binds a VAO.
+        // Buffers deleted through grr::delete_buffers are forgotten on their own.
+        void reset_bindings();
+
+        void release();
+
+        inline uint32_t get_vertex_array_count() const
+        {
+            return static_cast<uint32_t>(m_formats.size());
+        }
+
+    private:
+        struct format
+        {
+            uint64_t hash;
+
+            uint32_t id;
+
+            uint32_t count;
+
+            buffer_layout layouts[k_max_streams];
+
+            // estado de binding gravado no VAO
+            uint32_t buffers[k_max_streams];
+
+            uint32_t offsets[k_max_streams];
+
+            uint32_t index_buffer;
+        };
+
+        std::unordered_multimap<uint64_t, format> m_formats;
+
+        format* m_current = nullptr;
+
+        // grr::get_buffer_deletions() when the buffer names were last valid
+        uint32_t m_buffer_deletions = 0;
+
+        // -1 = ainda nao consultado
+        int m_supported = -1;
+
+        format* find(uint64_t hash, const vertex_stream* streams, uint32_t count);
+
+        format* create(uint64_t hash, const vertex_stream* streams, uint32_t count);
+
+        void forget_buffers();
+
+        static bool matches(const format& entry, const vertex_stream* streams, uint32_t count);
+    };
+}
+
+#endif // !GR_OPENGLES3
@@ -0,0 +1,305 @@
+#include "command_arena.hpp"
+
+#include "gFramebuffer.h"
+#include "gRender.h"
+#include "gTexture.h"
+#include "gVertexArray.h"
+#include "shader.hpp"
+#include "vertex_array.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace gr
+{
+    command_arena::command_arena(uint32_t max_commands, size_t data_size)
+        :
+            m_commands(new render_command[max_commands]),
+            m_data(data_size),
+            m_capacity(max_commands),
+            m_size(0),
+            m_key(0),
+            m_overflow(false)
+    {}
+
+    void command_arena::reset()
+    {
+        m_size = 0;
+        m_data.reset();
+        m_key = 0;
+        m_overflow = false;
+    }
+
+    bool command_arena::bind_shader(Shader* shader)
+    {
+        render_command* command = push(command_type::bind_shader);
+        if (command == nullptr)
+            return false;
+
+        command->shader = shader;
+        return true;
+    }
+
+    bool command_arena::set_uniform(Shader* shader, UniformID id, const void* data)
+    {
+        if (id == GR_INVALID_ID || id >= shader->GetUniformCount())
+            return false;
+
+        size_t size = shader->GetUniforms()[id].stride;
+
+        render_command* command = push(command_type::set_uniform);
+        if (command == nullptr)
+            return false;
+
+        void* copy = allocate(size);
+
+        memcpy(copy, data, size);
+
+        command->uniform.shader = shader;
+        command->uniform.data = copy;
+        command->uniform.id = id;
+        return true;
+    }
+
+    bool command_arena::bind_texture(gTexture* texture, uint32_t unit)
+    {
+        render_command* command = push(command_type::bind_texture);
+        if (command == nullptr)
+            return false;
+
+        command->texture = texture;
+        command->unit = static_cast<uint16_t>(unit);
+        return true;
+    }
+
+    bool command_arena::bind_vertex_array(vertex_array* array)
+    {
+        render_command* command = push(command_type::bind_vertex_array);
+        if (command == nullptr)
+            return false;
+
+        command->array = array;
+        return true;
+    }
+
+    bool command_arena::bind_vertex_array(gVertexArray* array)
+    {
+        render_command* command = push(command_type::bind_legacy_vertex_array);
+        if (command == nullptr)
+            return false;
+
+        command->legacy_array = array;
+        return true;
+    }
+
+    bool command_arena::bind_framebuffer(u32 framebuffer)
+    {
+        render_command* command = push(command_type::bind_framebuffer);
+        if (command == nullptr)
+            return false;
+
+        command->framebuffer = framebuffer;
+        return true;
+    }
+
+    bool command_arena::set_enable(GEnum state, bool value)
+    {
+        render_command* command = push(command_type::set_enable);
+        if (command == nullptr)
+            return false;
+
+        command->enable.state = state;
+        command->enable.value = value;
+        return true;
+    }
+
+    bool command_arena::set_viewport(const Rect& bounds)
+    {
+        render_command* command = push(command_type::set_viewport);
+        if (command == nullptr)
+            return false;
+
+        command->rect = bounds;
+        return true;
+    }
+
+    bool command_arena::set_scissor(const Rect& bounds)
+    {
+        render_command* command = push(command_type::set_scissor);
+        if (command == nullptr)
+            return false;
+
+        command->rect = bounds;
+        return true;
+    }
+
+    bool command_arena::draw_elements(PrimitiveType primitive, uint32_t count, uint64_t offset, uint32_t instances)
+    {
+        render_command* command = push(command_type::draw_elements);
+        if (command == nullptr)
+            return false;
+
+        command->primitive = static_cast<uint8_t>(primitive);
+        command->count = count;
+        command->draw.offset = offset;
+        command->draw.instances = instances;
+        return true;
+    }
+
+    bool command_arena::draw_arrays(PrimitiveType primitive, uint32_t count, uint32_t instances)
+    {
+        render_command* command = push(command_type::draw_arrays);
+        if (command == nullptr)
+            return false;
+
+        command->primitive = static_cast<uint8_t>(primitive);
+        command->count = count;
+        command->draw.offset = 0;
+        command->draw.instances = instances;
+        return true;
+    }
+
+    // ********** private ********** //
+    render_command* command_arena::push(command_type type)
+    {
+        if (m_size >= m_capacity)
+        {
+            m_overflow = true;
+            return nullptr;
+        }
+
+        render_command* command = &m_commands[m_size++];
+        command->key = m_key;
+        command->type = type;
+        command->primitive = 0;
+        command->unit = 0;
+        command->count = 0;
+        return command;
+    }
+
+    void* command_arena::allocate(size_t size)
+    {
+        return m_data.allocate(size, 16);
+    }
+
+    void command_replayer::submit(command_arena* const* arenas, uint32_t count)
+    {
+        m_stats = command_replay_stats();
+
+        m_order.clear();
+        for (uint32_t a = 0; a < count; a++)
+        {
+            const render_command* commands = arenas[a]->get_commands();
+            for (uint32_t i = 0; i < arenas[a]->size(); i++)
+                m_order.push_back({commands[i].key, a, i});
+        }
+
+        // (key, arena, posicao) e unico, entao a ordem final nao depende do sort
+        std::sort(m_order.begin(), m_order.end(), [](const command_ref& a, const command_ref& b) {
+            if (a.key != b.key)
+                return a.key < b.key;
+            if (a.arena != b.arena)
+                return a.arena < b.arena;
+            return a.index < b.index;
+        });
+
+        Shader* shader = nullptr;
+        const void* array = nullptr;
+        gTexture* textures[k_max_texture_units] = {};
+
+        for (const command_ref& ref : m_order)
+        {
+            const render_command& command = arenas[ref.arena]->get_commands()[ref.index];
+            m_stats.commands++;
+
+            switch (command.type)
+            {
+                case command_type::bind_shader:
+                    if (command.shader == shader)
+                    {
+                        m_stats.redundant++;
+                        break;
+                    }
+                    shader = command.shader;
+                    shader->bind();
+                    break;
+                case command_type::set_uniform:
+                    // a ordenacao pode juntar o uniform ao programa de outro comando
+                    if (command.uniform.shader != shader)
+                    {
+                        shader = command.uniform.shader;
+                        shader->bind();
+                    }
+                    shader->SetUniform(command.uniform.id, command.uniform.data);
+                    break;
+                case command_type::bind_texture:
+                    if (command.unit < k_max_texture_units)
+                    {
+                        if (textures[command.unit] == command.texture)
+                        {
+                            m_stats.redundant++;
+                            break;
+                        }
+                        textures[command.unit] = command.texture;
+                    }
+                    command.texture->bind(command.unit);
+                    break;
+                case command_type::bind_vertex_array:
+                    if (command.array == array)
+                    {
+                        m_stats.redundant++;
+                        break;
+                    }
+                    array = command.array;
+                    command.array->Bind();
+                    break;
+                case command_type::bind_legacy_vertex_array:
+                    if (command.legacy_array == array)
+                    {
+                        m_stats.redundant++;
+                        break;
+                    }
+                    array = command.legacy_array;
+                    command.legacy_array->bind();
+                    break;
+                case command_type::bind_framebuffer:
+                    gFramebuffer::Bind(command.framebuffer);
+                    break;
+                case command_type::set_enable:
+                    gRender::SetEnable(command.enable.state, command.enable.value);
+                    break;
+                case command_type::set_viewport:
+                    gRender::SetViewport(command.rect);
+                    break;
+                case command_type::set_scissor:
+                    gRender::SetScissor(command.rect);
+                    break;
+                case command_type::draw_elements:
+                {
+                    PrimitiveType primitive = static_cast<PrimitiveType>(command.primitive);
+                    const void* offset = reinterpret_cast<const void*>(static_cast<uintptr_t>(command.draw.offset));
+
+                    if (command.draw.instances)
+                        gVertexArray::DrawElementsInstanced(primitive, command.count, offset, command.draw.instances);
+                    else
+                        gVertexArray::DrawElements(primitive, command.count, offset);
+
+                    m_stats.draws++;
+                    break;
+                }
+                case command_type::draw_arrays:
+                {
+                    PrimitiveType primitive = static_cast<PrimitiveType>(command.primitive);
+
+                    if (command.draw.instances)
+                        gVertexArray::DrawArraysInstanced(primitive, command.count, command.draw.instances);
+                    else
+                        gVertexArray::DrawArrays(primitive, command.count);
+
+                    m_stats.draws++;
+                    break;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,304 @@
+#include "context.hpp"
+
+#ifdef GR_USE_EGL
+
+#include "gRender.h"
+#include "gl.h"
+#include "memory_tracker.hpp"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <atomic>
+#include <cstring>
+
+namespace gr
+{
+    namespace
+    {
+        thread_local context* t_current = nullptr;
+
+        std::atomic<uint32_t> s_next_index{1};
+
+        bool has_extension(const char* extensions, const char* name)
+        {
+            if (extensions == nullptr)
+                return false;
+
+            size_t length = strlen(name);
+            for (const char* it = strstr(extensions, name); it != nullptr; it = strstr(it + length, name))
+            {
+                if ((it == extensions || it[-1] == ' ') && (it[length] == ' ' || it[length] == '\0'))
+                    return true;
+            }
+            return false;
+        }
+
+        // um display para o processo inteiro; eglInitialize so uma vez
+        EGLDisplay get_headless_display()
+        {
+            static std::mutex mutex;
+            static EGLDisplay display = EGL_NO_DISPLAY;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (display != EGL_NO_DISPLAY)
+                return display;
+
+            EGLDisplay candidate = EGL_NO_DISPLAY;
+
+            const char* client = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+            auto get_platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+
+            if (get_platform_display != nullptr && has_extension(client, "EGL_MESA_platform_surfaceless"))
+                candidate = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+
+            if (candidate == EGL_NO_DISPLAY && get_platform_display != nullptr && has_extension(client, "EGL_EXT_platform_device"))
+            {
+                auto query_devices = reinterpret_cast<PFNEGLQUERYDEVICESEXTPROC>(eglGetProcAddress("eglQueryDevicesEXT"));
+
+                EGLDeviceEXT device;
+                EGLint count = 0;
+                if (query_devices != nullptr && query_devices(1, &device, &count) && count > 0)
+                    candidate = get_platform_display(EGL_PLATFORM_DEVICE_EXT, device, nullptr);
+            }
+
+            if (candidate == EGL_NO_DISPLAY)
+                candidate = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+            if (candidate == EGL_NO_DISPLAY || !eglInitialize(candidate, nullptr, nullptr))
+                return EGL_NO_DISPLAY;
+
+            display = candidate;
+            return display;
+        }
+    }
+
+    std::unique_ptr<context> context::create_headless(const context_config& config)
+    {
+        EGLDisplay display = get_headless_display();
+        if (display == EGL_NO_DISPLAY)
+            return nullptr;
+
+        EGLenum api = config.gles ? EGL_OPENGL_ES_API : EGL_OPENGL_API;
+        if (!eglBindAPI(api))
+            return nullptr;
+
+        EGLint config_attribs[] = {
+            EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+            EGL_RENDERABLE_TYPE, config.gles ? EGL_OPENGL_ES3_BIT : EGL_OPENGL_BIT,
+            EGL_RED_SIZE, 8,
+            EGL_GREEN_SIZE, 8,
+            EGL_BLUE_SIZE, 8,
+            EGL_ALPHA_SIZE, 8,
+            EGL_DEPTH_SIZE, 24,
+            EGL_NONE
+        };
+
+        EGLConfig egl_config;
+        EGLint count = 0;
+        if (!eglChooseConfig(display, config_attribs, &egl_config, 1, &count) || count == 0)
+            return nullptr;
+
+        std::vector<EGLint> context_attribs;
+        if (config.gles)
+        {
+            context_attribs = {EGL_CONTEXT_CLIENT_VERSION, 3};
+        } else
+        {
+            context_attribs = {EGL_CONTEXT_MAJOR_VERSION, config.major, EGL_CONTEXT_MINOR_VERSION, config.minor};
+            if (config.core_profile)
+            {
+                context_attribs.push_back(EGL_CONTEXT_OPENGL_PROFILE_MASK);
+                context_attribs.push_back(EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT);
+            }
+        }
+        context_attribs.push_back(EGL_NONE);
+
+        EGLContext egl_context = eglCreateContext(display, egl_config, EGL_NO_CONTEXT, context_attribs.data());
+        if (egl_context == EGL_NO_CONTEXT)
+            return nullptr;
+
+        EGLSurface surface = EGL_NO_SURFACE;
+        if (!has_extension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context"))
+        {
+            EGLint pbuffer_attribs[] = {EGL_WIDTH, static_cast<EGLint>(config.width), EGL_HEIGHT, static_cast<EGLint>(config.height), EGL_NONE};
+            surface = eglCreatePbufferSurface(display, egl_config, pbuffer_attribs);
+            if (surface == EGL_NO_SURFACE)
+            {
+                eglDestroyContext(display, egl_context);
+                return nullptr;
+            }
+        }
+
+        std::unique_ptr<context> result(new context());
+        result->m_display = display;
+        result->m_context = egl_context;
+        result->m_surface = surface;
+        result->m_api = api;
+        result->m_index = s_next_index++;
+        result->m_path = config.path;
+        return result;
+    }
+
+    context::~context()
+    {
+        if (t_current == this)
+            done_current();
+
+        if (m_surface != EGL_NO_SURFACE)
+            eglDestroySurface(m_display, m_surface);
+
+        if (m_context != EGL_NO_CONTEXT)
+            eglDestroyContext(m_display, m_context);
+    }
+
+    bool context::make_current()
+    {
+        eglBindAPI(m_api);
+        if (!eglMakeCurrent(m_display, m_surface, m_surface, m_context))
+            return false;
+
+        if (t_current != this)
+        {
+            // o cache de estado da thread era de outro contexto
+            gRender::Release();
+            context_state::set_current(&m_state);
+            t_current = this;
+        }
+
+        memory_tracker::set_thread_context(m_index);
+
+        if (!m_initialized)
+        {
+            if (!gRender::Initialize(m_path))
+            {
+                done_current();
+                return false;
+            }
+
+            m_path = gRender::GetRenderPath();
+            m_initialized = true;
+        } else
+        {
+            grr::set_direct_state_access(m_path == RenderPath::DirectStateAccess);
+        }
+
+        return true;
+    }
+
+    void context::done_current()
+    {
+        eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+        if (t_current == this)
+        {
+            context_state::set_current(nullptr);
+            t_current = nullptr;
+        }
+
+        memory_tracker::set_thread_context(0);
+    }
+
+    context* context::get_current()
+    {
+        return t_current;
+    }
+
+    context_pool::context_pool(uint32_t contexts, const context_config& config) : m_active(0), m_live(0), m_stop(false)
+    {
+        if (contexts == 0)
+            contexts = std::thread::hardware_concurrency();
+        if (contexts == 0)
+            contexts = 1;
+
+        for (uint32_t i = 0; i < contexts; i++)
+        {
+            std::unique_ptr<context> ctx = context::create_headless(config);
+            if (ctx == nullptr)
+                break;
+
+            m_contexts.push_back(std::move(ctx));
+        }
+
+        m_live = static_cast<uint32_t>(m_contexts.size());
+
+        m_workers.reserve(m_contexts.size());
+        for (auto& ctx : m_contexts)
+            m_workers.emplace_back(&context_pool::worker_loop, this, std::ref(*ctx));
+    }
+
+    context_pool::~context_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_job_cv.notify_all();
+
+        for (auto& worker : m_workers)
+            worker.join();
+    }
+
+    void context_pool::submit(job task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_live == 0)
+                return;
+
+            m_jobs.push_back(std::move(task));
+        }
+        m_job_cv.notify_one();
+    }
+
+    void context_pool::wait()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idle_cv.wait(lock, [this]() { return (m_jobs.empty() && m_active == 0) || m_live == 0; });
+    }
+
+    // ********** private ********** //
+    void context_pool::worker_loop(context& ctx)
+    {
+        if (!ctx.make_current())
+        {
+            // os outros contextos ficam com os jobs; sem nenhum, descarta
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_live == 0)
+            {
+                m_jobs.clear();
+                m_idle_cv.notify_all();
+            }
+            return;
+        }
+
+        for (;;)
+        {
+            job task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_job_cv.wait(lock, [this]() { return m_stop || !m_jobs.empty(); });
+
+                if (m_stop && m_jobs.empty())
+                    break;
+
+                task = std::move(m_jobs.front());
+                m_jobs.pop_front();
+                m_active++;
+            }
+
+            task(ctx);
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_active--;
+                if (m_jobs.empty() && m_active == 0)
+                    m_idle_cv.notify_all();
+            }
+        }
+
+        ctx.done_current();
+    }
+}
+
+#endif // GR_USE_EGL
@@ -0,0 +1,21 @@
+#include "context_state.hpp"
+
+namespace gr
+{
+    namespace
+    {
+        thread_local context_state t_thread_state;
+
+        thread_local context_state* t_current = nullptr;
+    }
+
+    context_state& context_state::current()
+    {
+        return t_current != nullptr ? *t_current : t_thread_state;
+    }
+
+    void context_state::set_current(context_state* state)
+    {
+        t_current = state;
+    }
+}
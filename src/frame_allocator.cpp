@@ -0,0 +1,69 @@
+#include "frame_allocator.hpp"
+
+namespace gr
+{
+    frame_allocator::frame_allocator(size_t block_size)
+        :
+            m_block_size(block_size ? block_size : 1),
+            m_offset(0),
+            m_used(0),
+            m_capacity(0),
+            m_peak(0),
+            m_resets(0)
+    {
+        m_blocks.reserve(8);
+        add_block(m_block_size);
+    }
+
+    void* frame_allocator::allocate(size_t size, size_t alignment)
+    {
+        block* current = &m_blocks.back();
+
+        uintptr_t base = reinterpret_cast<uintptr_t>(current->data.get());
+        uintptr_t address = (base + m_offset + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+
+        if (address + size > base + current->size)
+        {
+            // bloco novo com folga para o alinhamento
+            size_t needed = size + alignment;
+            add_block(needed > m_block_size ? needed : m_block_size);
+
+            current = &m_blocks.back();
+            base = reinterpret_cast<uintptr_t>(current->data.get());
+            address = (base + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+        }
+
+        size_t end = static_cast<size_t>(address - base) + size;
+        m_used += end - m_offset;
+        m_offset = end;
+
+        return reinterpret_cast<void*>(address);
+    }
+
+    void frame_allocator::reset()
+    {
+        if (m_used > m_peak)
+            m_peak = m_used;
+
+        if (m_blocks.size() > 1)
+        {
+            size_t size = m_capacity;
+
+            m_blocks.clear();
+            m_capacity = 0;
+            add_block(size);
+        }
+
+        m_offset = 0;
+        m_used = 0;
+        m_resets++;
+    }
+
+    // ********** private ********** //
+    void frame_allocator::add_block(size_t size)
+    {
+        m_blocks.push_back({std::unique_ptr<uint8_t[]>(new uint8_t[size]), size});
+        m_capacity += size;
+        m_offset = 0;
+    }
+}
@@ -0,0 +1,228 @@
+#include "frustum_culler.hpp"
+
+#include "simd.hpp"
+#include "thread_pool.hpp"
+
+#include <cmath>
+#include <cstring>
+
+namespace gr
+{
+    namespace
+    {
+        constexpr uint32_t k_cull_grain = 16384;
+
+        static_assert(k_cull_grain % bounds_set::k_block == 0, "grain must be a multiple of the block size");
+        static_assert(bounds_set::k_block % simd::width == 0, "block must be a multiple of the simd width");
+
+        inline Plane normalize_plane(float x, float y, float z, float w)
+        {
+            float length = std::sqrt(x * x + y * y + z * z);
+            float inv = length > 0.0f ? 1.0f / length : 0.0f;
+            return {x * inv, y * inv, z * inv, w * inv};
+        }
+
+        struct plane_vectors
+        {
+            simd::vfloat x[6], y[6], z[6], w[6];
+            simd::vfloat ax[6], ay[6], az[6];
+        };
+
+        uint32_t cull_range(const frustum& f, const bounds_set& bounds, uint32_t begin, uint32_t end, uint32_t* out)
+        {
+            plane_vectors planes;
+            for (int p = 0; p < 6; p++)
+            {
+                planes.x[p] = simd::set1(f.planes[p].x);
+                planes.y[p] = simd::set1(f.planes[p].y);
+                planes.z[p] = simd::set1(f.planes[p].z);
+                planes.w[p] = simd::set1(f.planes[p].w);
+                planes.ax[p] = simd::set1(std::fabs(f.planes[p].x));
+                planes.ay[p] = simd::set1(std::fabs(f.planes[p].y));
+                planes.az[p] = simd::set1(std::fabs(f.planes[p].z));
+            }
+
+            const float* sx = bounds.sphere_x();
+            const float* sy = bounds.sphere_y();
+            const float* sz = bounds.sphere_z();
+            const float* sr = bounds.sphere_r();
+
+            const float* bx = bounds.box_center(0);
+            const float* by = bounds.box_center(1);
+            const float* bz = bounds.box_center(2);
+            const float* ex = bounds.box_extent(0);
+            const float* ey = bounds.box_extent(1);
+            const float* ez = bounds.box_extent(2);
+
+            const simd::vfloat zero = simd::set1(0.0f);
+
+            uint32_t written = 0;
+
+            for (uint32_t block = begin; block < end; block += bounds_set::k_block)
+            {
+                // esferas primeiro: blocos sem nenhuma esfera visivel nem leem as caixas
+                uint32_t bits = 0;
+
+                for (uint32_t lane = 0; lane < bounds_set::k_block; lane += simd::width)
+                {
+                    uint32_t i = block + lane;
+
+                    simd::vfloat cx = simd::load(sx + i), cy = simd::load(sy + i), cz = simd::load(sz + i), r = simd::load(sr + i);
+
+                    simd::vmask visible = simd::mask_all();
+                    for (int p = 0; p < 6; p++)
+                    {
+                        simd::vfloat d = cx * planes.x[p] + cy * planes.y[p] + cz * planes.z[p] + planes.w[p] + r;
+                        visible = visible & (d >= zero);
+                    }
+
+                    bits |= simd::movemask(visible) << lane;
+                }
+
+                if (bits == 0)
+                    continue;
+
+                uint32_t box_bits = 0;
+
+                for (uint32_t lane = 0; lane < bounds_set::k_block; lane += simd::width)
+                {
+                    uint32_t i = block + lane;
+
+                    simd::vfloat px = simd::load(bx + i), py = simd::load(by + i), pz = simd::load(bz + i);
+                    simd::vfloat hx = simd::load(ex + i), hy = simd::load(ey + i), hz = simd::load(ez + i);
+
+                    // distancia do centro + projecao das extensoes na normal
+                    simd::vmask visible = simd::mask_all();
+                    for (int p = 0; p < 6; p++)
+                    {
+                        simd::vfloat d = px * planes.x[p] + py * planes.y[p] + pz * planes.z[p] + planes.w[p]
+                                       + hx * planes.ax[p] + hy * planes.ay[p] + hz * planes.az[p];
+                        visible = visible & (d >= zero);
+                    }
+
+                    box_bits |= simd::movemask(visible) << lane;
+                }
+
+                bits &= box_bits;
+
+                if (block + bounds_set::k_block > end)
+                    bits &= (1u << (end - block)) - 1u;
+
+                while (bits)
+                {
+                    int lane = simd::count_trailing_zeros(bits);
+                    out[written++] = block + static_cast<uint32_t>(lane);
+                    bits &= bits - 1u;
+                }
+            }
+
+            return written;
+        }
+    }
+
+    frustum frustum::from_matrix(const Matrix4x4& view_projection)
+    {
+        static_assert(sizeof(Matrix4x4) == sizeof(float) * 16, "Matrix4x4 must be 16 packed floats");
+
+        const float* m = reinterpret_cast<const float*>(&view_projection);
+
+        // linha i da matriz column-major: (m[i], m[4 + i], m[8 + i], m[12 + i])
+        auto row = [m](int i, int k) { return m[k * 4 + i]; };
+
+        frustum result;
+        for (int i = 0; i < 3; i++)
+        {
+            result.planes[i * 2 + 0] = normalize_plane(row(3, 0) + row(i, 0), row(3, 1) + row(i, 1), row(3, 2) + row(i, 2), row(3, 3) + row(i, 3));
+            result.planes[i * 2 + 1] = normalize_plane(row(3, 0) - row(i, 0), row(3, 1) - row(i, 1), row(3, 2) - row(i, 2), row(3, 3) - row(i, 3));
+        }
+        return result;
+    }
+
+    uint32_t bounds_set::add(const Vector3& center, float radius, const Vector3& min, const Vector3& max)
+    {
+        uint32_t index = m_count;
+        resize_padded(m_count + 1);
+        m_count++;
+
+        set(index, center, radius, min, max);
+        return index;
+    }
+
+    void bounds_set::set(uint32_t index, const Vector3& center, float radius, const Vector3& min, const Vector3& max)
+    {
+        m_sphere[0][index] = center.x;
+        m_sphere[1][index] = center.y;
+        m_sphere[2][index] = center.z;
+        m_sphere[3][index] = radius;
+
+        m_box_center[0][index] = (min.x + max.x) * 0.5f;
+        m_box_center[1][index] = (min.y + max.y) * 0.5f;
+        m_box_center[2][index] = (min.z + max.z) * 0.5f;
+
+        m_box_extent[0][index] = (max.x - min.x) * 0.5f;
+        m_box_extent[1][index] = (max.y - min.y) * 0.5f;
+        m_box_extent[2][index] = (max.z - min.z) * 0.5f;
+    }
+
+    void bounds_set::reserve(uint32_t count)
+    {
+        uint32_t padded = (count + k_block - 1) / k_block * k_block;
+        for (auto& v : m_sphere) v.reserve(padded);
+        for (auto& v : m_box_center) v.reserve(padded);
+        for (auto& v : m_box_extent) v.reserve(padded);
+    }
+
+    void bounds_set::clear()
+    {
+        for (auto& v : m_sphere) v.clear();
+        for (auto& v : m_box_center) v.clear();
+        for (auto& v : m_box_extent) v.clear();
+        m_count = 0;
+    }
+
+    void bounds_set::resize_padded(uint32_t count)
+    {
+        uint32_t padded = (count + k_block - 1) / k_block * k_block;
+        if (padded == m_sphere[0].size())
+            return;
+
+        for (auto& v : m_sphere) v.resize(padded, 0.0f);
+        for (auto& v : m_box_center) v.resize(padded, 0.0f);
+        for (auto& v : m_box_extent) v.resize(padded, 0.0f);
+    }
+
+    uint32_t frustum_culler::cull(const frustum& frustum, const bounds_set& bounds, uint32_t* visible, thread_pool* pool)
+    {
+        uint32_t count = bounds.size();
+        if (count == 0)
+            return 0;
+
+        if (pool == nullptr)
+            pool = &thread_pool::get_default();
+
+        uint32_t chunks = (count + k_cull_grain - 1) / k_cull_grain;
+        if (chunks == 1)
+            return cull_range(frustum, bounds, 0, count, visible);
+
+        // cada chunk escreve na propria faixa de `visible`; depois compacta em ordem
+        std::vector<uint32_t> written(chunks);
+
+        pool->parallel_for(count, k_cull_grain, [&](uint32_t begin, uint32_t end) {
+            written[begin / k_cull_grain] = cull_range(frustum, bounds, begin, end, visible + begin);
+        });
+
+        uint32_t total = written[0];
+        for (uint32_t c = 1; c < chunks; c++)
+        {
+            std::memmove(visible + total, visible + c * k_cull_grain, written[c] * sizeof(uint32_t));
+            total += written[c];
+        }
+        return total;
+    }
+
+    void frustum_culler::cull(const frustum& frustum, const bounds_set& bounds, std::vector<uint32_t>& visible, thread_pool* pool)
+    {
+        visible.resize(bounds.size());
+        visible.resize(cull(frustum, bounds, visible.data(), pool));
+    }
+}
@@ -3,6 +3,9 @@
 #include <stdarg.h>
 #include <stdio.h>
 
-// char last_engine_error[1024];
+namespace grr {
+    // ultima mensagem medium/high entregue por gr::gl_debug::flush
+    char last_engine_error[1024] = {};
+} // namespace grr
 
 
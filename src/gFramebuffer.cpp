@@ -3,11 +3,15 @@
 #include "gRenderbuffer.h"
 #include "gTexture.h"
 #include "gl.h"
+#include "platform/null/null_device.hpp"
+#include "render_stats.hpp"
+#include "trace_recorder.hpp"
 
 #include <cassert>
+#include <cstring>
 
 namespace gr {
-    u32 gFramebuffer::s_current = 0;
+    thread_local u32 gFramebuffer::s_current = 0;
 
     std::unordered_map<gFramebufferFlags, u32> gFramebuffer::m_apiFramebuffer{
         {gFramebufferFlags_Color_Attachiment0, GL_COLOR_ATTACHMENT0},
@@ -28,14 +32,30 @@ namespace gr {
 
     u32 gFramebuffer::Create() {
         u32 id;
-        GL_CALL(glCreateFramebuffers(1, &id));
+        if (null_device::is_active()) {
+            null_device::check("gFramebuffer::Create");
+            id = null_device::create_object(null_object::framebuffer);
+        } else {
+            GL_CALL(glCreateFramebuffers(1, &id));
+        }
+
+        trace_recorder::record(trace_op::framebuffer_create, static_cast<uint32_t>(id));
         return id;
     }
 
     void gFramebuffer::Bind(u32 id) {
-        GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, id));
+        if (null_device::is_active()) {
+            if (!null_device::check("gFramebuffer::Bind", id == 0 || null_device::is_object(null_object::framebuffer, id)))
+                return;
+        } else {
+            GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, id));
+        }
 
         s_current = id;
+
+        render_stats::count_framebuffer_bind();
+
+        trace_recorder::record(trace_op::framebuffer_bind, static_cast<uint32_t>(id));
     }
 
     void gFramebuffer::SetRenderbuffer(gFramebufferFlags attachment) {
@@ -43,13 +63,33 @@ namespace gr {
 
     void gFramebuffer::SetTexture(gTexture* texture, gFramebufferFlags attachment, gFramebufferFlags textarget)
     {
+        trace_recorder::record(trace_op::framebuffer_texture, trace_recorder::key(texture), static_cast<uint32_t>(attachment), static_cast<uint32_t>(textarget));
+
+        if (null_device::is_active()) {
+            bool valid = texture != nullptr && texture->isValid() && s_current != 0 &&
+                m_apiFramebuffer.count(attachment) != 0 && m_apiFramebuffer.count(textarget) != 0;
+            if (null_device::check("gFramebuffer::SetTexture", valid))
+                texture->set_render_target();
+            return;
+        }
+
         GL_CALL(glFramebufferTexture2D(GL_FRAMEBUFFER, m_apiFramebuffer[attachment], m_apiFramebuffer[textarget], texture->getTextureID(), 0));
+
+        texture->set_render_target();
     }
 
     void gFramebuffer::Unbind() {
-        GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+        if (null_device::is_active()) {
+            null_device::check("gFramebuffer::Unbind");
+        } else {
+            GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+        }
 
         s_current = 0;
+
+        render_stats::count_framebuffer_bind();
+
+        trace_recorder::record(trace_op::framebuffer_bind, static_cast<uint32_t>(0));
     }
 
     void gFramebuffer::Destroy(u32 id) {
@@ -57,60 +97,98 @@ namespace gr {
             return;
         }
 
-        GL_CALL(glDeleteFramebuffers(1, &id));
+        if (null_device::is_active()) {
+            null_device::destroy_object(null_object::framebuffer, id, "gFramebuffer::Destroy");
+        } else {
+            GL_CALL(glDeleteFramebuffers(1, &id));
+        }
+
+        trace_recorder::record(trace_op::framebuffer_destroy, static_cast<uint32_t>(id));
     }
 
     void gFramebuffer::GetPixels(u8 attachmentID, int x, int y, u32 width, u32 height, TextureFormat format, void *pixels) {
-        GL_CALL(glBindFramebuffer(GL_READ_FRAMEBUFFER, s_current));
-        GL_CALL(glReadBuffer(GL_COLOR_ATTACHMENT0 + attachmentID));
+        const bool null_backend = null_device::is_active();
+        if (!null_backend) {
+            GL_CALL(glBindFramebuffer(GL_READ_FRAMEBUFFER, s_current));
+            GL_CALL(glReadBuffer(GL_COLOR_ATTACHMENT0 + attachmentID));
+        }
+
+        GLenum fmt = GL_NONE;
+        GLenum type = GL_NONE;
 
         switch (format) {
             case TextureFormat_RGB:
             case TextureFormat_SRGB:
             case TextureFormat_RGB888:
-                GL_CALL(glReadPixels(x, y, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels));
+                fmt = GL_RGB;
+                type = GL_UNSIGNED_BYTE;
                 break;
             case TextureFormat_RGB565:
-                GL_CALL(glReadPixels(x, y, width, height, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, pixels));
+                fmt = GL_RGB;
+                type = GL_UNSIGNED_SHORT_5_6_5;
                 break;
             case TextureFormat_RGB444:
-                GL_CALL(glReadPixels(x, y, width, height, GL_RGB, GL_UNSIGNED_SHORT_4_4_4_4, pixels));
+                fmt = GL_RGB;
+                type = GL_UNSIGNED_SHORT_4_4_4_4;
                 break;
             case TextureFormat_RGBA:
             case TextureFormat_SRGBA:
             case TextureFormat_RGBA8888:
-                GL_CALL(glReadPixels(x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels));
+                fmt = GL_RGBA;
+                type = GL_UNSIGNED_BYTE;
                 break;
             case TextureFormat_RGBA4444:
-                GL_CALL(glReadPixels(x, y, width, height, GL_RGBA, GL_UNSIGNED_SHORT_4_4_4_4, pixels));
+                fmt = GL_RGBA;
+                type = GL_UNSIGNED_SHORT_4_4_4_4;
                 break;
             case TextureFormat_DepthComponent:
-                GL_CALL(glReadPixels(x, y, width, height, GL_DEPTH_COMPONENT, GL_FLOAT, pixels));
+                fmt = GL_DEPTH_COMPONENT;
+                type = GL_FLOAT;
                 break;
             case TextureFormat_RGB16F:
             case TextureFormat_RGB32F:
-                GL_CALL(glReadPixels(x, y, width, height, GL_RGB, GL_FLOAT, pixels));
+                fmt = GL_RGB;
+                type = GL_FLOAT;
                 break;
             case TextureFormat_RGBA16F:
             case TextureFormat_RGBA32F:
-                GL_CALL(glReadPixels(x, y, width, height, GL_RGBA, GL_FLOAT, pixels));
+                fmt = GL_RGBA;
+                type = GL_FLOAT;
                 break;
             case TextureFormat_RED_INTEGER:
-                GL_CALL(glReadPixels(x, y, width, height, GL_RED_INTEGER, GL_INT, pixels));
+                fmt = GL_RED_INTEGER;
+                type = GL_INT;
                 break;
             case TextureFormat_RED:
-                GL_CALL(glReadPixels(x, y, width, height, GL_RED, GL_UNSIGNED_BYTE, pixels));
+                fmt = GL_RED;
+                type = GL_UNSIGNED_BYTE;
                 break;
         default:
             break;
         }
+
+        if (null_backend) {
+            // le zeros, sempre do mesmo jeito
+            if (null_device::check("gFramebuffer::GetPixels", fmt != GL_NONE && pixels != nullptr && x >= 0 && y >= 0)) {
+                uint64_t size = static_cast<uint64_t>(width) * height * grr::get_pixel_size(fmt, type);
+                std::memset(pixels, 0, size);
+
+                render_stats::count_readback(size);
+            }
+            return;
+        }
+
+        if (fmt != GL_NONE) {
+            GL_CALL(glReadPixels(x, y, width, height, fmt, type, pixels));
+
+            render_stats::count_readback(static_cast<uint64_t>(width) * height * grr::get_pixel_size(fmt, type));
+        }
+
         GL_CALL(glReadBuffer(GL_NONE));
         GL_CALL(glBindFramebuffer(GL_READ_FRAMEBUFFER, 0));
     }
 
     void gFramebuffer::Release() {
-        m_apiFramebuffer.clear();
-
         s_current = 0;
     }
 
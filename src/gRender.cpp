@@ -1,18 +1,30 @@
 #include "gRender.h"
 
+#include "frame_allocator.hpp"
 #include "gFramebuffer.h"
+#include "gl_debug.hpp"
+#include "material.hpp"
+#include "platform/null/null_device.hpp"
+#include "render_stats.hpp"
+#include "sampler_cache.hpp"
+#include "trace_recorder.hpp"
 
 #include "gl.h"
 
+#include <atomic>
+
 static const GLenum GL_ENABLE_DISABLE_MAP[] = {
     GL_CULL_FACE,
     GL_DEPTH_TEST,
     GL_MULTISAMPLE,
     GL_FRAMEBUFFER_SRGB,
-    GL_BLEND
+    GL_BLEND,
+    GL_SCISSOR_TEST
 };
 
 namespace gr {
+    static std::atomic<RenderBackend> s_backend{RenderBackend::OpenGL};
+
     std::unordered_map<BufferBindingTarget, u32> gRender::m_bufferMap {
         {BufferBindingTarget::GR_ARRAY_BUFFER, GL_ARRAY_BUFFER},
         {BufferBindingTarget::GR_ELEMENT_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER}
@@ -33,21 +45,43 @@ namespace gr {
 
     void gRender::SetBackgroundColor(const Color &color)
     {
+        trace_recorder::record(trace_op::background_color, color.r, color.g, color.b, color.a);
+
         GetInstance().setBackgroundColor(color);
     }
 
     void gRender::SetViewport(const Rect &bounds)
     {
+        trace_recorder::record(trace_op::viewport, static_cast<float>(bounds.x), static_cast<float>(bounds.y), static_cast<float>(bounds.w), static_cast<float>(bounds.h));
+
         GetInstance().setViewport(bounds);
     }
 
     void gRender::SetEnable(GEnum state, bool value)
     {
+        trace_recorder::record(trace_op::enable, static_cast<uint32_t>(state), static_cast<uint8_t>(value));
+
         GetInstance().setEnable(state, value);
     }
 
+    void gRender::SetScissor(const Rect &bounds)
+    {
+        trace_recorder::record(trace_op::scissor, static_cast<float>(bounds.x), static_cast<float>(bounds.y), static_cast<float>(bounds.w), static_cast<float>(bounds.h));
+
+        GetInstance().setScissor(bounds);
+    }
+
     void gRender::SetRenderState(RenderState state, u32 value)
     {
+        trace_recorder::record(trace_op::render_state, static_cast<uint64_t>(state), static_cast<uint32_t>(value));
+
+        if (null_device::is_active()) {
+            bool valid = state == GR_BACKGROUND || state == GR_CULL || state == GR_DEPTH_MASK || state == GR_DEPTH_FUNC || state == GR_SRC_ALPHA;
+            if (null_device::check("gRender::SetRenderState", valid) && state == GR_BACKGROUND)
+                render_stats::count_clear();
+            return;
+        }
+
         switch (state) {
         case GR_BACKGROUND: {
             GLbitfield filter = 0;
@@ -57,7 +91,10 @@ namespace gr {
             if ((value & GR_COLOR_BUFFER) == GR_COLOR_BUFFER) {
                 filter |= GL_COLOR_BUFFER_BIT;
             }
-            return GL_CALL(glClear(filter));
+            GL_CALL(glClear(filter));
+
+            render_stats::count_clear();
+            break;
         }
         case GR_CULL: {
             if ((value & GR_FRONT) == GR_FRONT && (value & GR_BACK) == GR_BACK) {
@@ -68,14 +105,14 @@ namespace gr {
             return GL_CALL(glCullFace(GL_FRONT));
         }
         case GR_DEPTH_MASK: {
-            GL_CALL(glDepthMask(m_renderStateMap[value]));
+            GL_CALL(glDepthMask(GetGLRenderState(value)));
             break;
         }
         case GR_DEPTH_FUNC: {
-            return GL_CALL(glDepthFunc(m_renderStateMap[value]));
+            return GL_CALL(glDepthFunc(GetGLRenderState(value)));
         }
         case GR_SRC_ALPHA: {
-            glBlendFunc(GL_SRC_ALPHA, m_renderStateMap[value]);
+            glBlendFunc(GL_SRC_ALPHA, GetGLRenderState(value));
             break;
         }
         default:
@@ -100,26 +137,111 @@ namespace gr {
         #undef GET_ENUM_NAME
     }
 
-    bool gRender::Initialize() {
+    void gRender::BeginFrame()
+    {
+        GetFrameAllocator().reset();
+
+        render_stats::begin_frame();
+
+        trace_recorder::record(trace_op::frame_begin);
+    }
+
+    void gRender::EndFrame()
+    {
+        render_stats::end_frame();
+
+        trace_recorder::record(trace_op::frame_end);
+        trace_recorder::end_frame();
+
+        gl_debug::flush();
+    }
+
+    const frame_stats& gRender::GetFrameStats()
+    {
+        return render_stats::current();
+    }
+
+    frame_allocator& gRender::GetFrameAllocator()
+    {
+        static thread_local frame_allocator allocator;
+        return allocator;
+    }
+
+    bool gRender::Initialize(RenderPath path) {
+        // sem contexto: nada para carregar
+        if (null_device::is_active()) {
+            grr::set_direct_state_access(false);
+            return path != RenderPath::DirectStateAccess;
+        }
+
         #if !GR_OPENGLES3
-        if (glewInit() != GLEW_OK) {
+        GLenum result = glewInit();
+        #ifdef GLEW_ERROR_NO_GLX_DISPLAY
+        // contextos EGL (headless) nao tem display GLX; os ponteiros GL ainda carregam
+        if (result == GLEW_ERROR_NO_GLX_DISPLAY)
+            result = glewContextInit();
+        #endif
+        if (result != GLEW_OK) {
             return false;
         }
         #endif
+
+        bool dsa = path != RenderPath::Classic && grr::supports_direct_state_access();
+        if (path == RenderPath::DirectStateAccess && !dsa) {
+            return false;
+        }
+
+        grr::set_direct_state_access(dsa);
+
+        #ifdef DEBUG_MODE
+        // sincrono: o callback roda dentro do GL_CALL e o call site e o certo;
+        // sem KHR_debug volta ao glGetError depois de cada GL_CALL
+        gl_debug_config config;
+        config.synchronous = true;
+        if (!gl_debug::enable(config))
+            gl_debug::set_error_sampling(1);
+        #endif
         return true;
     }
 
-    void gRender::Release() {
-        m_bufferMap.clear();
+    // so leitura: a tabela e compartilhada por todas as threads
+    u32 gRender::GetGLRenderState(u32 value) {
+        auto it = m_renderStateMap.find(value);
+        return it != m_renderStateMap.end() ? it->second : 0;
+    }
+
+    RenderPath gRender::GetRenderPath() {
+        return grr::use_direct_state_access() ? RenderPath::DirectStateAccess : RenderPath::Classic;
+    }
+
+    void gRender::SetBackend(RenderBackend backend) {
+        s_backend = backend;
+
+        null_device::set_active(backend == RenderBackend::Null);
+    }
+
+    RenderBackend gRender::GetBackend() {
+        return s_backend;
+    }
 
-        m_renderStateMap.clear();
+    void gRender::Release() {
+        // as tabelas de enums sao constantes e compartilhadas entre contextos;
+        // so o cache de estado desta thread volta ao inicial
+        GetInstance() = gRender();
 
         gFramebuffer::Release();
+
+        // samplers presos as unidades tambem sao do contexto anterior
+        sampler_cache::invalidate_bindings();
+
+        // e as paginas de uniform buffer dos materiais
+        material::detach_pages();
     }
 
     gRender& gRender::GetInstance()
     {
-        static gRender instance;
+        // cache de estado por thread: cada contexto GL vive em uma thread
+        static thread_local gRender instance;
         return instance;
     }
 
@@ -127,6 +249,7 @@ namespace gr {
         :
             s_BackgroundColor(Color::black),
             s_ViewportBounds{0.0f, 0.0f, 0.0f, 0.0f},
+            s_ScissorBounds{0.0f, 0.0f, 0.0f, 0.0f},
             s_StateMask(0)
     {}
 
@@ -135,7 +258,11 @@ namespace gr {
         if (color.r != s_BackgroundColor.r || color.g != s_BackgroundColor.g || 
             color.b != s_BackgroundColor.b || color.a != s_BackgroundColor.a) 
         {
-            GL_CALL(glClearColor(color.r, color.g, color.b, color.a));
+            if (null_device::is_active()) {
+                null_device::check("gRender::SetBackgroundColor");
+            } else {
+                GL_CALL(glClearColor(color.r, color.g, color.b, color.a));
+            }
             s_BackgroundColor = color;
         }
     }
@@ -145,13 +272,34 @@ namespace gr {
         if (bounds.x != s_ViewportBounds.x || bounds.y != s_ViewportBounds.y || 
             bounds.w != s_ViewportBounds.w || bounds.h != s_ViewportBounds.h)
         {
-            GL_CALL(glViewport(bounds.x, bounds.y, bounds.w, bounds.h));
+            if (null_device::is_active()) {
+                null_device::check("gRender::SetViewport", bounds.w >= 0 && bounds.h >= 0);
+            } else {
+                GL_CALL(glViewport(bounds.x, bounds.y, bounds.w, bounds.h));
+            }
             s_ViewportBounds = bounds;
         }
     }
 
+    void gRender::setScissor(const Rect& bounds)
+    {
+        if (bounds.x != s_ScissorBounds.x || bounds.y != s_ScissorBounds.y || 
+            bounds.w != s_ScissorBounds.w || bounds.h != s_ScissorBounds.h)
+        {
+            if (null_device::is_active()) {
+                null_device::check("gRender::SetScissor", bounds.w >= 0 && bounds.h >= 0);
+            } else {
+                GL_CALL(glScissor(bounds.x, bounds.y, bounds.w, bounds.h));
+            }
+            s_ScissorBounds = bounds;
+        }
+    }
+
     void gRender::setEnable(GEnum state, bool value)
     {
+        if (null_device::is_active() && !null_device::check("gRender::SetEnable", state < sizeof(GL_ENABLE_DISABLE_MAP) / sizeof(GL_ENABLE_DISABLE_MAP[0])))
+            return;
+
         uint32_t bit = 1ULL << state;
 
         uint8_t enabled = s_StateMask & bit;
@@ -161,12 +309,14 @@ namespace gr {
             {
                 s_StateMask |= bit;
 
-                glEnable(GL_ENABLE_DISABLE_MAP[state]);
+                if (!null_device::is_active())
+                    glEnable(GL_ENABLE_DISABLE_MAP[state]);
             } else
             {
                 s_StateMask &= ~bit;
 
-                glDisable(GL_ENABLE_DISABLE_MAP[state]);
+                if (!null_device::is_active())
+                    glDisable(GL_ENABLE_DISABLE_MAP[state]);
             }
         }
     }
@@ -2,9 +2,21 @@
 
 #include "gCommon.h"
 #include "gl.h"
+#include "memory_tracker.hpp"
+#include "platform/null/null_device.hpp"
+#include "render_stats.hpp"
+#include "sampler_cache.hpp"
+#include "trace_recorder.hpp"
+
+#include <algorithm>
 
 namespace gr
 {
+    // anexada a um framebuffer conta como render target
+    static memory_category tracked_as(bool render_target)
+    {
+        return render_target ? memory_category::render_target : memory_category::texture;
+    }
 
     const TextureFormatInfo gTexture::TextureFormatInfoMapping[20] = {
         {GL_RGB,                GL_RGB,             GL_UNSIGNED_BYTE},          // TextureFormat_RGB        - 0
@@ -133,6 +145,8 @@ namespace gr
         GLenum target = (texture->type == TEXTURE_TYPE_CUBE) ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
 
         glBindTexture(target, texture->id);
+
+        render_stats::count_texture_bind();
     }
 
     void UnbindTexture(Texture *texture)
@@ -156,11 +170,17 @@ namespace gr
             {
                 glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, internalFmt, 
                              texture->width, texture->height, 0, fmt, type, faces[i]);
+
+                if (faces[i] != nullptr)
+                    render_stats::count_texture_upload(static_cast<uint64_t>(texture->width) * texture->height * grr::get_pixel_size(fmt, type));
             }
         }
         else
         {
             glTexImage2D(GL_TEXTURE_2D, 0, internalFmt, texture->width, texture->height, 0, fmt, type, pixels);
+
+            if (pixels != nullptr)
+                render_stats::count_texture_upload(static_cast<uint64_t>(texture->width) * texture->height * grr::get_pixel_size(fmt, type));
         }
 
         if (texture->filter >= TEXTURE_FILTER_NEAREST_MIPMAP)
@@ -202,11 +222,17 @@ namespace gr
     }
 
     void gTexture::Unbind(u32 index) {
+        if (null_device::is_active())
+        {
+            null_device::check("gTexture::Unbind");
+            return;
+        }
+
         GL_CALL(glActiveTexture(GL_TEXTURE0 + index));
         GL_CALL(glBindTexture(GL_TEXTURE_2D, 0));
     }
 
-    gTexture::gTexture() : m_width(0), m_height(0), textureID(GR_INVALID_ID), m_active(0), texture_flags(0), m_format(TextureFormat_RGB)
+    gTexture::gTexture() : m_height(0), m_width(0), m_levels(1), textureID(GR_INVALID_ID), texture_flags(0), m_active(0), m_format(TextureFormat_RGB), m_immutable(false), m_applied_flags(0), m_render_target(false)
     {
         set_format(TextureFormat_RGB);
         set_texture(gTextureFlags_Texture);
@@ -216,11 +242,42 @@ namespace gr
 
     void gTexture::updateBuffer(u32 width, u32 height, void *pixels)
     {
+        if (trace_recorder::is_recording())
+        {
+            auto &info = TextureFormatInfoMapping[m_format];
+            uint32_t size = pixels != nullptr ? width * height * grr::get_pixel_size(info.format, info.type) : 0;
+
+            trace_recorder::record(trace_op::texture_update, trace_recorder::key(this), static_cast<uint32_t>(width), static_cast<uint32_t>(height),
+                static_cast<uint16_t>(m_format), static_cast<uint32_t>(texture_flags), trace_blob{pixels, size});
+        }
+
+        if (null_device::is_active())
+            return update_buffer_null(width, height, pixels);
+
+#if !GR_OPENGLES3
+        if (grr::use_direct_state_access() && use_immutable_storage(width, height, pixels))
+            return update_buffer_dsa(width, height, pixels);
+#endif
+
+        // storage imutavel nao muda de tamanho: a textura passa a ser mutavel,
+        // so esta vez com um nome novo
+        if (m_immutable)
+        {
+            memory_tracker::untrack(tracked_as(m_render_target), textureID);
+            GL_CALL(glDeleteTextures(1, &textureID));
+
+            textureID = GR_INVALID_ID;
+            m_immutable = false;
+        }
+
         m_width = width;
         m_height = height;
 
         if (!isValid())
+        {
             GL_CALL(glGenTextures(1, &textureID));
+            m_applied_flags = 0;
+        }
 
         GL_CALL(glBindTexture(getTargetTexture(), textureID));
 
@@ -245,37 +302,196 @@ namespace gr
             auto &info = TextureFormatInfoMapping[m_format];
 
             GL_CALL(glTexImage2D(internalTarget, 0, info.internalformat, width, height, 0, info.format, info.type, pixels));
+
+            if (pixels != nullptr)
+                render_stats::count_texture_upload(static_cast<uint64_t>(width) * height * grr::get_pixel_size(info.format, info.type));
         }
 
+        memory_tracker::track(tracked_as(m_render_target), textureID, get_memory_size(), m_debug_name.empty() ? nullptr : m_debug_name.c_str());
+
         // apply mipmaps
         apply_mipmaps();
 
-        // texture clamping
-        apply_clamping();
-
-        // filtro de textura
-        apply_filtering();
+        // clamping e filtro
+        apply_sampling();
 
         GL_CALL(glBindTexture(getTargetTexture(), 0));
     }
 
 
+    void gTexture::allocate_levels(u32 width, u32 height, u32 levels)
+    {
+        trace_recorder::record(trace_op::texture_allocate, trace_recorder::key(this), static_cast<uint32_t>(width), static_cast<uint32_t>(height),
+            static_cast<uint32_t>(levels), static_cast<uint16_t>(m_format), static_cast<uint32_t>(texture_flags));
+
+        m_width = width;
+        m_height = height;
+        m_levels = levels ? levels : memory_tracker::mip_levels(width, height);
+
+        set_texture(gTextureFlags_Texture);
+        if (m_levels > 1)
+            texture_flags |= gTextureFlags_MipMaps;
+
+        if (null_device::is_active())
+        {
+            if (!null_device::check("gTexture::allocate_levels", width > 0 && height > 0))
+                return;
+
+            if (!isValid())
+                textureID = null_device::create_object(null_object::texture);
+            m_immutable = false;
+            return;
+        }
+
+        // niveis sao especificados um a um (e liberados), entao nada de storage imutavel
+        if (m_immutable)
+        {
+            memory_tracker::untrack(tracked_as(m_render_target), textureID);
+            GL_CALL(glDeleteTextures(1, &textureID));
+
+            textureID = GR_INVALID_ID;
+            m_immutable = false;
+        }
+
+        if (!isValid())
+        {
+            GL_CALL(glGenTextures(1, &textureID));
+            m_applied_flags = 0;
+        }
+
+        GL_CALL(glBindTexture(GL_TEXTURE_2D, textureID));
+
+        GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0));
+        GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, m_levels - 1));
+
+        apply_sampling();
+
+        GL_CALL(glBindTexture(GL_TEXTURE_2D, 0));
+    }
+
+    void gTexture::update_level(u32 level, const void *pixels)
+    {
+        u32 width = std::max(m_width >> level, 1u);
+        u32 height = std::max(m_height >> level, 1u);
+
+        auto &info = TextureFormatInfoMapping[m_format];
+
+        trace_recorder::record(trace_op::texture_level, trace_recorder::key(this), static_cast<uint32_t>(level),
+            trace_blob{pixels, pixels != nullptr ? width * height * grr::get_pixel_size(info.format, info.type) : 0});
+
+        if (null_device::is_active())
+        {
+            if (!null_device::check("gTexture::update_level", isValid() && level < m_levels))
+                return;
+        }
+        else
+        {
+            GL_CALL(glBindTexture(GL_TEXTURE_2D, textureID));
+            GL_CALL(glTexImage2D(GL_TEXTURE_2D, level, info.internalformat, width, height, 0, info.format, info.type, pixels));
+            GL_CALL(glBindTexture(GL_TEXTURE_2D, 0));
+        }
+
+        if (pixels != nullptr)
+            render_stats::count_texture_upload(static_cast<uint64_t>(width) * height * get_pixel_size());
+    }
+
+    void gTexture::release_level(u32 level)
+    {
+        if (null_device::is_active())
+        {
+            null_device::check("gTexture::release_level", isValid() && level < m_levels);
+            return;
+        }
+
+        auto &info = TextureFormatInfoMapping[m_format];
+
+        GL_CALL(glBindTexture(GL_TEXTURE_2D, textureID));
+        GL_CALL(glTexImage2D(GL_TEXTURE_2D, level, info.internalformat, 0, 0, 0, info.format, info.type, nullptr));
+        GL_CALL(glBindTexture(GL_TEXTURE_2D, 0));
+    }
+
+    void gTexture::set_level_range(u32 base, u32 max)
+    {
+        if (null_device::is_active())
+        {
+            null_device::check("gTexture::set_level_range", isValid() && base <= max);
+            return;
+        }
+
+#if !GR_OPENGLES3
+        if (grr::use_direct_state_access())
+        {
+            set_parameter(GL_TEXTURE_BASE_LEVEL, base);
+            set_parameter(GL_TEXTURE_MAX_LEVEL, max);
+            return;
+        }
+#endif
+        GL_CALL(glBindTexture(getTargetTexture(), textureID));
+        GL_CALL(glTexParameteri(getTargetTexture(), GL_TEXTURE_BASE_LEVEL, base));
+        GL_CALL(glTexParameteri(getTargetTexture(), GL_TEXTURE_MAX_LEVEL, max));
+        GL_CALL(glBindTexture(getTargetTexture(), 0));
+    }
+
     gTexture::~gTexture()
     {
+        trace_recorder::record(trace_op::texture_destroy, trace_recorder::key(this));
+
         if (textureID == GR_INVALID_ID)
             return;
-        glDeleteTextures(1, &textureID);
+
+        memory_tracker::untrack(tracked_as(m_render_target), textureID);
+
+        if (null_device::is_active())
+            null_device::destroy_object(null_object::texture, textureID, "gTexture::~gTexture");
+        else
+            glDeleteTextures(1, &textureID);
     }
 
-    void gTexture::bind(u32 index) {
+    void gTexture::bind(u32 index, u32 sampler) {
+        trace_recorder::record(trace_op::texture_bind, trace_recorder::key(this), static_cast<uint32_t>(index), static_cast<uint32_t>(sampler));
+
         m_active = GL_TEXTURE0 + index;
-        
+
+        sampler_cache::bind(index, sampler);
+
+        if (null_device::is_active())
+        {
+            if (null_device::check("gTexture::bind", isValid()))
+                render_stats::count_texture_bind();
+            return;
+        }
+
+#if !GR_OPENGLES3
+        if (grr::use_direct_state_access())
+        {
+            GL_CALL(glBindTextureUnit(index, textureID));
+
+            render_stats::count_texture_bind();
+            return;
+        }
+#endif
+
         GL_CALL(glActiveTexture(m_active));
 
         GL_CALL(glBindTexture(getTargetTexture(), textureID));
+
+        render_stats::count_texture_bind();
     }
 
     void gTexture::unbind() {
+        if (null_device::is_active())
+        {
+            null_device::check("gTexture::unbind");
+            return;
+        }
+
+#if !GR_OPENGLES3
+        if (grr::use_direct_state_access())
+        {
+            GL_CALL(glBindTextureUnit(m_active - GL_TEXTURE0, 0));
+            return;
+        }
+#endif
         GL_CALL(glActiveTexture(m_active));
         GL_CALL(glBindTexture(getTargetTexture(), 0));
     }
@@ -346,6 +562,67 @@ namespace gr
         texture_flags |= gTextureFlags_MipMaps;
     }
 
+    void gTexture::set_debug_name(const char* name)
+    {
+        m_debug_name = name != nullptr ? name : "";
+
+        if (isValid())
+            memory_tracker::set_debug_name(tracked_as(m_render_target), textureID, m_debug_name.c_str());
+    }
+
+    void gTexture::set_render_target()
+    {
+        if (m_render_target)
+            return;
+
+        // o registro muda de categoria; mesmo nome, mesmo tamanho
+        if (isValid())
+        {
+            memory_tracker::untrack(memory_category::texture, textureID);
+            memory_tracker::track(memory_category::render_target, textureID, get_memory_size(), m_debug_name.empty() ? nullptr : m_debug_name.c_str());
+        }
+
+        m_render_target = true;
+    }
+
+    bool gTexture::is_render_target() const
+    {
+        return m_render_target;
+    }
+
+    u64 gTexture::get_memory_size() const
+    {
+        return memory_tracker::texture_size(m_width, m_height, get_pixel_size(),
+                                            (texture_flags & gTextureFlags_MipMaps) ? 0 : 1, isCubemap() ? 6 : 1);
+    }
+
+    u32 gTexture::get_pixel_size() const
+    {
+        auto &info = TextureFormatInfoMapping[m_format];
+
+        return grr::get_pixel_size(info.format, info.type);
+    }
+
+    u32 gTexture::get_level_count() const
+    {
+        return m_levels;
+    }
+
+    u32 gTexture::get_width() const
+    {
+        return m_width;
+    }
+
+    u32 gTexture::get_height() const
+    {
+        return m_height;
+    }
+
+    const TextureFormatInfo& gTexture::get_format_info() const
+    {
+        return TextureFormatInfoMapping[m_format];
+    }
+
     // ********** private ********** //
     void gTexture::apply_clamping() const
     {
@@ -365,9 +642,9 @@ namespace gr
             wrapt = GL_CLAMP_TO_BORDER;
         }
 
-        GL_CALL(glTexParameteri(getTargetTexture(), GL_TEXTURE_WRAP_S, wraps));
-        GL_CALL(glTexParameteri(getTargetTexture(), GL_TEXTURE_WRAP_R, wrapr));
-        GL_CALL(glTexParameteri(getTargetTexture(), GL_TEXTURE_WRAP_T, wrapt));
+        set_parameter(GL_TEXTURE_WRAP_S, wraps);
+        set_parameter(GL_TEXTURE_WRAP_R, wrapr);
+        set_parameter(GL_TEXTURE_WRAP_T, wrapt);
     }
 
     void gTexture::apply_filtering() const
@@ -410,15 +687,136 @@ namespace gr
             magFilter = GL_NEAREST;
         }
 
-        GL_CALL(glTexParameteri(getTargetTexture(), GL_TEXTURE_MIN_FILTER, minFilter));
-        GL_CALL(glTexParameteri(getTargetTexture(), GL_TEXTURE_MAG_FILTER, magFilter));
+        set_parameter(GL_TEXTURE_MIN_FILTER, minFilter);
+        set_parameter(GL_TEXTURE_MAG_FILTER, magFilter);
     }
 
     void gTexture::apply_mipmaps() const
     {
+        if (!(texture_flags & gTextureFlags_MipMaps))
+            return;
 
-        if (texture_flags & gTextureFlags_MipMaps)
-            GL_CALL(glGenerateMipmap(getTargetTexture()));
+#if !GR_OPENGLES3
+        if (grr::use_direct_state_access())
+        {
+            GL_CALL(glGenerateTextureMipmap(textureID));
+            return;
+        }
+#endif
+        GL_CALL(glGenerateMipmap(getTargetTexture()));
+    }
+
+    void gTexture::apply_sampling()
+    {
+        u32 flags = texture_flags & (gTextureFlags_MipMaps | gTextureFlags_Texture | gTextureFlags_Cubemap |
+            gTextureFlags_Filter_Linear | gTextureFlags_Filter_Nearest | gTextureFlags_Filter_Trilinear | gTextureFlags_Filter_Bilinear |
+            gTextureFlags_Clamp_Repeat | gTextureFlags_Clamp_Border | gTextureFlags_Clamp_Edge);
+
+        if (flags == m_applied_flags)
+            return;
+
+        apply_clamping();
+
+        apply_filtering();
+
+        m_applied_flags = flags;
+    }
+
+    // com DSA nao precisa da textura ligada
+    void gTexture::set_parameter(u32 name, int32_t value) const
+    {
+#if !GR_OPENGLES3
+        if (grr::use_direct_state_access())
+        {
+            GL_CALL(glTextureParameteri(textureID, name, value));
+            return;
+        }
+#endif
+        GL_CALL(glTexParameteri(getTargetTexture(), name, value));
+    }
+
+    void gTexture::update_buffer_null(u32 width, u32 height, const void* pixels)
+    {
+        if (!null_device::check("gTexture::updateBuffer", m_format < 20 && width > 0 && height > 0))
+            return;
+
+        if (!isValid())
+            textureID = null_device::create_object(null_object::texture);
+
+        m_width = width;
+        m_height = height;
+        m_levels = (texture_flags & gTextureFlags_MipMaps) ? memory_tracker::mip_levels(width, height) : 1;
+        m_immutable = false;
+
+        if (pixels != nullptr)
+            render_stats::count_texture_upload(static_cast<uint64_t>(width) * height * get_pixel_size());
+
+        memory_tracker::track(tracked_as(m_render_target), textureID, get_memory_size(), m_debug_name.empty() ? nullptr : m_debug_name.c_str());
+    }
+
+#if !GR_OPENGLES3
+    bool gTexture::use_immutable_storage(u32 width, u32 height, const void* pixels) const
+    {
+        // sem pixels e um render target: fica mutavel para poder mudar de
+        // tamanho sem trocar o nome que o framebuffer guardou
+        if (!isValid())
+            return pixels != nullptr;
+
+        u32 levels = (texture_flags & gTextureFlags_MipMaps) ? memory_tracker::mip_levels(width, height) : 1;
+        return m_immutable && width == m_width && height == m_height && levels == m_levels;
+    }
+
+    void gTexture::update_buffer_dsa(u32 width, u32 height, void* pixels)
+    {
+        auto &info = TextureFormatInfoMapping[m_format];
+
+        u32 levels = (texture_flags & gTextureFlags_MipMaps) ? memory_tracker::mip_levels(width, height) : 1;
+
+        // use_immutable_storage: ou nao tem nome ainda ou o storage ja serve
+        if (!isValid())
+        {
+            GL_CALL(glCreateTextures(getTargetTexture(), 1, &textureID));
+            GL_CALL(glTextureStorage2D(textureID, levels, grr::get_sized_internal_format(info.internalformat, info.type), width, height));
+
+            m_immutable = true;
+            m_applied_flags = 0;
+        }
+
+        m_width = width;
+        m_height = height;
+        m_levels = levels;
+
+        if (pixels != nullptr)
+        {
+            if (isCubemap())
+            {
+                GLint face = 0;
+                if (texture_flags & gTextureFlags_Cubemap_Negative_X)
+                    face = 1;
+                else if (texture_flags & gTextureFlags_Cubemap_Positive_Y)
+                    face = 2;
+                else if (texture_flags & gTextureFlags_Cubemap_Negative_Y)
+                    face = 3;
+                else if (texture_flags & gTextureFlags_Cubemap_Positive_Z)
+                    face = 4;
+                else if (texture_flags & gTextureFlags_Cubemap_Negative_Z)
+                    face = 5;
+
+                GL_CALL(glTextureSubImage3D(textureID, 0, 0, 0, face, width, height, 1, info.format, info.type, pixels));
+            } else
+            {
+                GL_CALL(glTextureSubImage2D(textureID, 0, 0, 0, width, height, info.format, info.type, pixels));
+            }
+
+            render_stats::count_texture_upload(static_cast<uint64_t>(width) * height * grr::get_pixel_size(info.format, info.type));
+        }
+
+        memory_tracker::track(tracked_as(m_render_target), textureID, get_memory_size(), m_debug_name.empty() ? nullptr : m_debug_name.c_str());
+
+        apply_mipmaps();
+
+        apply_sampling();
     }
+#endif
 
 } // namespace gr
@@ -1,7 +1,12 @@
 #include "gVertexArray.h"
 
+#include "context_state.hpp"
 #include "gCommon.h"
 #include "gl.h"
+#include "memory_tracker.hpp"
+#include "platform/null/null_device.hpp"
+#include "render_stats.hpp"
+#include "trace_recorder.hpp"
 #include <cstddef>
 #include <cstdint>
 
@@ -9,18 +14,44 @@ namespace gr
 {
     gVertexArray::gVertexArray() : vertexID(GR_INVALID_ID)
     {
-        GL_CALL(glGenVertexArrays(1, &vertexID));
+        if (null_device::is_active())
+        {
+            null_device::check("gVertexArray::gVertexArray");
+            vertexID = null_device::create_object(null_object::vertex_array);
+        }
+        else
+        {
+            GL_CALL(glGenVertexArrays(1, &vertexID));
+        }
+
+        trace_recorder::record(trace_op::legacy_array_create, trace_recorder::key(this));
     }
 
     gVertexArray::~gVertexArray()
     {
-        if (vertexID != GR_INVALID_ID)
+        trace_recorder::record(trace_op::legacy_array_destroy, trace_recorder::key(this));
+
+        if (vertexID == GR_INVALID_ID)
+            return;
+
+        if (null_device::is_active())
+            null_device::destroy_object(null_object::vertex_array, vertexID, "gVertexArray::~gVertexArray");
+        else
             glDeleteVertexArrays(1, &vertexID);
     }
 
-    gVertexArray *gVertexArray::m_instance = nullptr;
-
-    u32 gVertexArray::s_currentBuffer = 0;
+    static memory_category buffer_category(u32 target)
+    {
+        switch (target)
+        {
+            case GL_ARRAY_BUFFER:
+                return memory_category::vertex_buffer;
+            case GL_ELEMENT_ARRAY_BUFFER:
+                return memory_category::index_buffer;
+            default:
+                return memory_category::other_buffer;
+        }
+    }
 
     std::array<std::uint32_t, 5> gVertexArray::bufferMappings = {
         GL_ARRAY_BUFFER,            // BufferType::VBO
@@ -40,64 +71,161 @@ namespace gr
         GL_TRIANGLE_FAN
     };
 
-    std::unordered_map<BufferID, u32> gVertexArray::m_bufferIndex;
-
     BufferID gVertexArray::CreateBuffer(BufferType_ target, const void *data, std::size_t size)
     {
+        context_state& state = context_state::current();
+
+        const bool null_backend = null_device::is_active();
+        if (null_backend && !null_device::check("gVertexArray::CreateBuffer", target < bufferMappings.size()))
+            return GR_INVALID_ID;
+
         BufferID bufferID = 0;
-        GL_CALL(glGenBuffers(1, &bufferID));
+        if (null_backend)
+        {
+            bufferID = null_device::create_object(null_object::buffer);
+        }
+        else
+        {
+            GL_CALL(glGenBuffers(1, &bufferID));
+        }
         if (!bufferID)
             return GR_INVALID_ID;
 
         if (data != nullptr && size > 0)
         {
-            GL_CALL(glBindBuffer(bufferMappings[target], bufferID));
-            GL_CALL(glBufferData(bufferMappings[target], size, data, GL_STATIC_DRAW));
-            GL_CALL(glBindBuffer(bufferMappings[target], 0));
+            if (!null_backend)
+            {
+                GL_CALL(glBindBuffer(bufferMappings[target], bufferID));
+                GL_CALL(glBufferData(bufferMappings[target], size, data, GL_STATIC_DRAW));
+                GL_CALL(glBindBuffer(bufferMappings[target], 0));
+            }
+
+            render_stats::count_buffer_upload(size);
+
+            memory_tracker::track(buffer_category(bufferMappings[target]), bufferID, size);
         }
 
-        m_bufferIndex.emplace(bufferID, bufferMappings[target]);
+        state.buffer_targets.emplace(bufferID, bufferMappings[target]);
+
+        trace_recorder::record(trace_op::buffer_create, static_cast<uint32_t>(bufferID), static_cast<uint32_t>(target), trace_blob{size > 0 ? data : nullptr, static_cast<uint32_t>(size)});
 
         return bufferID;
     }
 
     void gVertexArray::DeleteBuffer(BufferID index)
     {
-        auto it = m_bufferIndex.find(index);
-        if (it == m_bufferIndex.end())
+        context_state& state = context_state::current();
+
+        auto it = state.buffer_targets.find(index);
+        if (it == state.buffer_targets.end())
         {
+            if (null_device::is_active())
+                null_device::check("gVertexArray::DeleteBuffer", false);
             return;
         }
 
-        GL_CALL(glDeleteBuffers(1, &index));
+        if (null_device::is_active())
+        {
+            null_device::destroy_object(null_object::buffer, index, "gVertexArray::DeleteBuffer");
+        }
+        else
+        {
+            GL_CALL(glDeleteBuffers(1, &index));
+        }
+
+        trace_recorder::record(trace_op::buffer_destroy, static_cast<uint32_t>(index));
+
+        memory_tracker::untrack(buffer_category(it->second), index);
+
+        state.buffer_targets.erase(it);
+    }
+
+    void gVertexArray::SetBufferName(BufferID index, const char* name)
+    {
+        context_state& state = context_state::current();
 
-        m_bufferIndex.erase(it);
+        auto it = state.buffer_targets.find(index);
+        if (it == state.buffer_targets.end())
+            return;
+
+        memory_tracker::set_debug_name(buffer_category(it->second), index, name);
     }
 
     void gVertexArray::Bind(u32 index)
     {
-        s_currentBuffer = m_bufferIndex[index];
+        context_state& state = context_state::current();
+
+        auto it = state.buffer_targets.find(index);
+        if (null_device::is_active())
+            null_device::check("gVertexArray::Bind", it != state.buffer_targets.end());
+        if (it == state.buffer_targets.end())
+            return;
 
-        GL_CALL(glBindBuffer(m_bufferIndex[index], index));
+        state.current_buffer = it->second;
+        state.current_buffer_id = index;
+
+        if (!null_device::is_active())
+        {
+            GL_CALL(glBindBuffer(it->second, index));
+        }
+
+        trace_recorder::record(trace_op::buffer_bind, static_cast<uint32_t>(index));
+
+        render_stats::count_buffer_bind();
     }
 
     void gVertexArray::SetAttrib(u8 index, u16 size, u16 stride, const void *pointer) {
+        trace_recorder::record(trace_op::attrib, index, size, stride, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(pointer)), static_cast<uint8_t>(0));
+
+        if (null_device::is_active())
+        {
+            null_device::check("gVertexArray::SetAttrib", size >= 1 && size <= 4 && context_state::current().bound_array != nullptr);
+            return;
+        }
+
         GL_CALL(glVertexAttribPointer(static_cast<GLuint>(index), static_cast<GLint>(size), GL_FLOAT, GL_FALSE, static_cast<GLsizei>(stride), pointer));
         GL_CALL(glEnableVertexAttribArray(static_cast<GLuint>(index)));
     }
 
     void gVertexArray::SetAttribI(u8 index, u16 size, u16 stride, const void *pointer) {
+        trace_recorder::record(trace_op::attrib, index, size, stride, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(pointer)), static_cast<uint8_t>(1));
+
+        if (null_device::is_active())
+        {
+            null_device::check("gVertexArray::SetAttribI", size >= 1 && size <= 4 && context_state::current().bound_array != nullptr);
+            return;
+        }
+
         GL_CALL(glVertexAttribIPointer(static_cast<GLuint>(index), static_cast<GLint>(size), GL_INT, static_cast<GLsizei>(stride), pointer));
         GL_CALL(glEnableVertexAttribArray(static_cast<GLuint>(index)));
     }
 
     void gVertexArray::SetAttribDivisor(u8 index, u8 divisor) {
+        trace_recorder::record(trace_op::attrib_divisor, index, divisor);
+
+        if (null_device::is_active())
+        {
+            null_device::check("gVertexArray::SetAttribDivisor", context_state::current().bound_array != nullptr);
+            return;
+        }
+
         GL_CALL(glVertexAttribDivisor(static_cast<GLuint>(index), divisor));
     }
 
     void gVertexArray::UpdateResizeBuffer(u32 size, BufferUsage usage) {
+        context_state& state = context_state::current();
+
+        trace_recorder::record(trace_op::buffer_resize, static_cast<uint32_t>(size), static_cast<uint32_t>(usage));
+
+        if (null_device::is_active())
+        {
+            if (null_device::check("gVertexArray::UpdateResizeBuffer", state.current_buffer != 0))
+                memory_tracker::track(buffer_category(state.current_buffer), state.current_buffer_id, size);
+            return;
+        }
+
         int arraySize = 0;
-        GL_CALL(glGetBufferParameteriv(s_currentBuffer, GL_BUFFER_SIZE,  &arraySize));
+        GL_CALL(glGetBufferParameteriv(state.current_buffer, GL_BUFFER_SIZE,  &arraySize));
 
         GLenum num = 0;
 
@@ -113,47 +241,139 @@ namespace gr
             break;
         }
         
-        while (size > arraySize)
+        while (size > static_cast<u32>(arraySize))
         {
-            GL_CALL(glBufferData(s_currentBuffer, size, nullptr, num));
+            GL_CALL(glBufferData(state.current_buffer, size, nullptr, num));
+
+            GL_CALL(glGetBufferParameteriv(state.current_buffer, GL_BUFFER_SIZE,  &arraySize));
 
-            GL_CALL(glGetBufferParameteriv(s_currentBuffer, GL_BUFFER_SIZE,  &arraySize));
+            memory_tracker::track(buffer_category(state.current_buffer), state.current_buffer_id, size);
         }
     }
 
     void gVertexArray::SetBufferUpdate(u32 offset, u32 size, const void *data) {
-        GL_CALL(glBufferSubData(s_currentBuffer, offset, size, data));
+        context_state& state = context_state::current();
+
+        trace_recorder::record(trace_op::buffer_update, static_cast<uint32_t>(offset), trace_blob{data, size});
+
+        if (null_device::is_active())
+        {
+            if (!null_device::check("gVertexArray::SetBufferUpdate", state.current_buffer != 0 && (data != nullptr || size == 0)))
+                return;
+        }
+        else
+        {
+            GL_CALL(glBufferSubData(state.current_buffer, offset, size, data));
+        }
+
+        render_stats::count_buffer_upload(size);
     }
 
     void gVertexArray::DrawElementsInstanced(PrimitiveType primitive, u32 count, const void *indices, u32 primcount) {
-        GL_CALL(glDrawElementsInstanced(primitiveMappings[primitive], count, GL_UNSIGNED_INT, indices, primcount));
+        if (null_device::is_active())
+        {
+            if (!null_device::check_draw("gVertexArray::DrawElementsInstanced", primitive))
+                return;
+        }
+        else
+        {
+            GL_CALL(glDrawElementsInstanced(primitiveMappings[primitive], count, GL_UNSIGNED_INT, indices, primcount));
+        }
+
+        render_stats::count_draw(primitive, count, primcount, true);
+
+        trace_recorder::record(trace_op::draw_elements, static_cast<uint32_t>(primitive), static_cast<uint32_t>(count),
+            static_cast<uint64_t>(reinterpret_cast<uintptr_t>(indices)), static_cast<uint32_t>(primcount), static_cast<uint8_t>(1));
     }
 
     void gVertexArray::DrawElements(PrimitiveType primitive, u32 count, const void* indices) {
-        GL_CALL(glDrawElements(primitiveMappings[primitive], count, GL_UNSIGNED_INT, indices));
+        if (null_device::is_active())
+        {
+            if (!null_device::check_draw("gVertexArray::DrawElements", primitive))
+                return;
+        }
+        else
+        {
+            GL_CALL(glDrawElements(primitiveMappings[primitive], count, GL_UNSIGNED_INT, indices));
+        }
+
+        render_stats::count_draw(primitive, count);
+
+        trace_recorder::record(trace_op::draw_elements, static_cast<uint32_t>(primitive), static_cast<uint32_t>(count),
+            static_cast<uint64_t>(reinterpret_cast<uintptr_t>(indices)), static_cast<uint32_t>(1), static_cast<uint8_t>(0));
     }
 
     void gVertexArray::DrawArrays(PrimitiveType primitive, u32 count)
     {
-        GL_CALL(glDrawArrays(primitiveMappings[primitive], 0, count));
+        if (null_device::is_active())
+        {
+            if (!null_device::check_draw("gVertexArray::DrawArrays", primitive))
+                return;
+        }
+        else
+        {
+            GL_CALL(glDrawArrays(primitiveMappings[primitive], 0, count));
+        }
+
+        render_stats::count_draw(primitive, count);
+
+        trace_recorder::record(trace_op::draw_arrays, static_cast<uint32_t>(primitive), static_cast<uint32_t>(count), static_cast<uint32_t>(1), static_cast<uint8_t>(0));
     }
 
     void gVertexArray::DrawArraysInstanced(PrimitiveType primitive, u32 count, u32 primcount) {
-        glDrawArraysInstanced(primitiveMappings[primitive], 0, count, primcount);
+        if (null_device::is_active())
+        {
+            if (!null_device::check_draw("gVertexArray::DrawArraysInstanced", primitive))
+                return;
+        }
+        else
+        {
+            glDrawArraysInstanced(primitiveMappings[primitive], 0, count, primcount);
+        }
+
+        render_stats::count_draw(primitive, count, primcount, true);
+
+        trace_recorder::record(trace_op::draw_arrays, static_cast<uint32_t>(primitive), static_cast<uint32_t>(count), static_cast<uint32_t>(primcount), static_cast<uint8_t>(1));
     }
 
     void gVertexArray::bind()
     {
-        GL_CALL(glBindVertexArray(vertexID));
+        context_state& state = context_state::current();
 
-        m_instance = this;
+        if (null_device::is_active())
+        {
+            null_device::check("gVertexArray::bind", is_valid());
+            null_device::bind_vertex_array(vertexID);
+        }
+        else
+        {
+            GL_CALL(glBindVertexArray(vertexID));
+        }
+
+        state.bound_array = this;
+
+        render_stats::count_vertex_array_bind();
+
+        trace_recorder::record(trace_op::legacy_array_bind, trace_recorder::key(this));
     }
 
     void gVertexArray::unbind()
     {
-        glBindVertexArray(0);
+        context_state& state = context_state::current();
+
+        if (null_device::is_active())
+        {
+            null_device::check("gVertexArray::unbind");
+            null_device::bind_vertex_array(0);
+        }
+        else
+        {
+            glBindVertexArray(0);
+        }
+
+        state.bound_array = nullptr;
 
-        m_instance = nullptr;
+        trace_recorder::record(trace_op::legacy_array_bind, static_cast<uint64_t>(0));
     }
 
     bool gVertexArray::is_valid() const
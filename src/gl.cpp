@@ -1,6 +1,6 @@
 #include "gl.h"
 
-#include <sstream>
+#include <cstring>
 
 namespace grr {
     const char* get_enum_name(GLenum err) {
@@ -23,16 +23,147 @@ namespace grr {
         #undef GETENUMNAME
     }
 
-    void check_erros_opengl(const std::string &name, const std::string &file) {
-        int numErrors = 0;
-        GLenum err;
+    uint32_t get_pixel_size(GLenum format, GLenum type) {
+        switch (type) {
+            case GL_UNSIGNED_BYTE_3_3_2:
+                return 1;
+            case GL_UNSIGNED_SHORT_4_4_4_4:
+            case GL_UNSIGNED_SHORT_5_6_5:
+            case GL_UNSIGNED_SHORT_5_5_5_1:
+                return 2;
+            default:
+                break;
+        }
+
+        uint32_t components = 4;
+        switch (format) {
+            case GL_RED:
+            case GL_RED_INTEGER:
+            case GL_DEPTH_COMPONENT:
+                components = 1;
+                break;
+            case GL_RG:
+            case GL_RG_INTEGER:
+                components = 2;
+                break;
+            case GL_RGB:
+            case GL_RGB_INTEGER:
+                components = 3;
+                break;
+            default:
+                break;
+        }
 
-        std::ostringstream oss;
+        switch (type) {
+            case GL_BYTE:
+            case GL_UNSIGNED_BYTE:
+                return components;
+            case GL_SHORT:
+            case GL_UNSIGNED_SHORT:
+            case GL_HALF_FLOAT:
+                return components * 2;
+            default:
+                return components * 4;
+        }
+    }
+
+    GLenum get_sized_internal_format(GLenum internalformat, GLenum type) {
+        switch (internalformat) {
+            case GL_RGB:
+                #if !GR_OPENGLES3
+                if (type == GL_UNSIGNED_BYTE_3_3_2)
+                    return GL_R3_G3_B2;
+                #endif
+                if (type == GL_UNSIGNED_SHORT_5_6_5)
+                    return GL_RGB565;
+                return GL_RGB8;
+            case GL_RGBA:
+                return GL_RGBA8;
+            case GL_SRGB:
+                return GL_SRGB8;
+            case GL_SRGB_ALPHA:
+                return GL_SRGB8_ALPHA8;
+            case GL_RED:
+                return GL_R8;
+            case GL_RG:
+                return GL_RG8;
+            case GL_DEPTH_COMPONENT:
+                return type == GL_FLOAT ? GL_DEPTH_COMPONENT32F : GL_DEPTH_COMPONENT24;
+            default:
+                return internalformat;
+        }
+    }
 
-        while ((err = glGetError()) != GL_NO_ERROR) {
-            numErrors++;
-            oss << file << " " << name << " - " << get_enum_name(err) << std::endl;
-            // throw std::runtime_error(oss.str());
+    GLenum get_base_type(gr::shader_data_type type) {
+        switch (type) {
+            case gr::shader_data_type::Float:
+            case gr::shader_data_type::Float2:
+            case gr::shader_data_type::Float3:
+            case gr::shader_data_type::Float4:
+                return GL_FLOAT;
         }
+        return 0;
+    }
+
+    // por thread, como o contexto corrente
+    static thread_local bool s_direct_state_access = false;
+
+    static thread_local uint32_t s_buffer_deletions = 0;
+
+    #if !GR_OPENGLES3
+    static bool supports(GLint need_major, GLint need_minor, const char* extension) {
+        GLint major = 0, minor = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        glGetIntegerv(GL_MINOR_VERSION, &minor);
+
+        if (major > need_major || (major == need_major && minor >= need_minor))
+            return true;
+
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++) {
+            const char* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+            if (name != nullptr && strcmp(name, extension) == 0)
+                return true;
+        }
+        return false;
+    }
+    #endif
+
+    bool supports_direct_state_access() {
+        #if GR_OPENGLES3
+        return false;
+        #else
+        return supports(4, 5, "GL_ARB_direct_state_access");
+        #endif
+    }
+
+    bool supports_vertex_attrib_binding() {
+        #if GR_OPENGLES3
+        return false;
+        #else
+        return supports(4, 3, "GL_ARB_vertex_attrib_binding");
+        #endif
+    }
+
+    bool use_direct_state_access() {
+        return s_direct_state_access;
+    }
+
+    void set_direct_state_access(bool enabled) {
+        #if GR_OPENGLES3
+        s_direct_state_access = false;
+        #else
+        s_direct_state_access = enabled;
+        #endif
+    }
+
+    void delete_buffers(GLsizei count, const GLuint* buffers) {
+        glDeleteBuffers(count, buffers);
+        s_buffer_deletions++;
+    }
+
+    uint32_t get_buffer_deletions() {
+        return s_buffer_deletions;
     }
 } // namespace grr
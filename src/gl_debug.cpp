@@ -0,0 +1,432 @@
+#include "gl_debug.hpp"
+
+#include "gError.h"
+#include "gl.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+namespace grr
+{
+    thread_local call_site current_call_site = {nullptr, nullptr, 0};
+
+    std::atomic<uint32_t> error_sample_interval{0};
+
+    thread_local uint32_t error_sample_count = 0;
+
+    static void report_error(GLenum err, const char* text, size_t length, const call_site& site)
+    {
+#if GR_OPENGLES3
+        gr::gl_debug::report(0, 0, err, gr::gl_debug_severity::high, text, length, site);
+#else
+        gr::gl_debug::report(GL_DEBUG_SOURCE_API, GL_DEBUG_TYPE_ERROR, err, gr::gl_debug_severity::high, text, length, site);
+#endif
+    }
+
+    void sample_errors()
+    {
+        GLenum err;
+        while ((err = glGetError()) != GL_NO_ERROR)
+        {
+            const char* name = get_enum_name(err);
+            report_error(err, name, strlen(name), current_call_site);
+        }
+    }
+
+    void check_erros_opengl(const std::string &name, const std::string &file)
+    {
+        GLenum err;
+        while ((err = glGetError()) != GL_NO_ERROR)
+        {
+            // as strings sao temporarias: o local vai no texto, nao no call_site
+            std::string text = file + " " + name + " - " + get_enum_name(err);
+            report_error(err, text.c_str(), text.size(), {nullptr, nullptr, 0});
+        }
+    }
+}
+
+namespace gr
+{
+    namespace
+    {
+        struct ring_slot
+        {
+            std::atomic<uint32_t> sequence;
+
+            gl_debug_message message;
+        };
+
+        // fila limitada de Vyukov: cada slot diz de quem e a vez pelo sequence
+        struct message_ring
+        {
+            ring_slot slots[gl_debug::k_ring_size];
+
+            std::atomic<uint32_t> head{0};
+
+            std::atomic<uint32_t> tail{0};
+
+            message_ring()
+            {
+                for (uint32_t i = 0; i < gl_debug::k_ring_size; i++)
+                    slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+
+            bool push(const gl_debug_message& message)
+            {
+                uint32_t pos = head.load(std::memory_order_relaxed);
+                for (;;)
+                {
+                    ring_slot& slot = slots[pos % gl_debug::k_ring_size];
+                    int32_t diff = static_cast<int32_t>(slot.sequence.load(std::memory_order_acquire) - pos);
+
+                    if (diff == 0)
+                    {
+                        if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        {
+                            slot.message = message;
+                            slot.sequence.store(pos + 1, std::memory_order_release);
+                            return true;
+                        }
+                    }
+                    else if (diff < 0)
+                    {
+                        return false;
+                    }
+                    else
+                    {
+                        pos = head.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            bool pop(gl_debug_message& message)
+            {
+                uint32_t pos = tail.load(std::memory_order_relaxed);
+                for (;;)
+                {
+                    ring_slot& slot = slots[pos % gl_debug::k_ring_size];
+                    int32_t diff = static_cast<int32_t>(slot.sequence.load(std::memory_order_acquire) - (pos + 1));
+
+                    if (diff == 0)
+                    {
+                        if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        {
+                            message = slot.message;
+                            slot.sequence.store(pos + gl_debug::k_ring_size, std::memory_order_release);
+                            return true;
+                        }
+                    }
+                    else if (diff < 0)
+                    {
+                        return false;
+                    }
+                    else
+                    {
+                        pos = tail.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+        };
+
+        static_assert((gl_debug::k_ring_size & (gl_debug::k_ring_size - 1)) == 0, "the ring index wraps with the sequence");
+
+        message_ring s_ring;
+
+        // chave 0 = slot livre
+        std::atomic<uint64_t> s_seen[gl_debug::k_dedup_size];
+
+        std::atomic<bool> s_deduplicate{true};
+
+        // assincrono: o callback pode rodar na thread do driver ou depois do
+        // GL_CALL, entao o call site da thread nao e o da mensagem
+        std::atomic<bool> s_synchronous{false};
+
+        std::atomic<uint8_t> s_min_severity{static_cast<uint8_t>(gl_debug_severity::notification)};
+
+        std::atomic<uint64_t> s_received{0};
+
+        std::atomic<uint64_t> s_filtered{0};
+
+        std::atomic<uint64_t> s_duplicates{0};
+
+        std::atomic<uint64_t> s_dropped{0};
+
+        std::function<void(const gl_debug_message&)> s_sink;
+
+        constexpr uint32_t k_max_probe = 16;
+
+        const char* severity_name(gl_debug_severity severity)
+        {
+            switch (severity)
+            {
+                case gl_debug_severity::high:
+                    return "high";
+                case gl_debug_severity::medium:
+                    return "medium";
+                case gl_debug_severity::low:
+                    return "low";
+                default:
+                    return "notification";
+            }
+        }
+
+        void print_message(const gl_debug_message& message)
+        {
+            if (message.file != nullptr)
+                fprintf(stderr, "%s(%d) : %s - [%s] %s\n", message.file, message.line, message.call, severity_name(message.severity), message.text);
+            else
+                fprintf(stderr, "[%s] %s\n", severity_name(message.severity), message.text);
+        }
+
+        // true the first time the key shows up; a full neighbourhood counts as new
+        bool first_time(uint64_t key)
+        {
+            key |= 1;
+
+            for (uint32_t i = 0; i < k_max_probe; i++)
+            {
+                std::atomic<uint64_t>& slot = s_seen[(key + i) % gl_debug::k_dedup_size];
+
+                uint64_t current = slot.load(std::memory_order_relaxed);
+                if (current == key)
+                    return false;
+
+                if (current == 0 && slot.compare_exchange_strong(current, key, std::memory_order_relaxed))
+                    return true;
+
+                if (current == key)
+                    return false;
+            }
+            return true;
+        }
+
+        // sem call site o texto separa as mensagens com o mesmo id
+        uint64_t message_key(uint32_t source, uint32_t type, uint32_t id, const char* text, size_t length, const grr::call_site& site)
+        {
+            // FNV-1a
+            uint64_t hash = 14695981039346656037ull;
+            auto mix = [&hash](uint64_t value) {
+                hash ^= value;
+                hash *= 1099511628211ull;
+            };
+
+            mix(source);
+            mix(type);
+            mix(id);
+            if (site.file != nullptr)
+            {
+                mix(reinterpret_cast<uintptr_t>(site.file));
+                mix(static_cast<uint64_t>(site.line));
+            }
+            else if (text != nullptr)
+            {
+                for (size_t i = 0; i < length; i++)
+                    mix(static_cast<uint8_t>(text[i]));
+            }
+            return hash;
+        }
+
+#if !GR_OPENGLES3
+        gl_debug_severity from_gl_severity(GLenum severity)
+        {
+            switch (severity)
+            {
+                case GL_DEBUG_SEVERITY_HIGH:
+                    return gl_debug_severity::high;
+                case GL_DEBUG_SEVERITY_MEDIUM:
+                    return gl_debug_severity::medium;
+                case GL_DEBUG_SEVERITY_LOW:
+                    return gl_debug_severity::low;
+                default:
+                    return gl_debug_severity::notification;
+            }
+        }
+
+        void GLAPIENTRY debug_callback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void*)
+        {
+            size_t size = length >= 0 ? static_cast<size_t>(length) : strlen(message);
+
+            const grr::call_site unknown = {nullptr, nullptr, 0};
+            const grr::call_site& site = s_synchronous.load(std::memory_order_relaxed) ? grr::current_call_site : unknown;
+
+            gl_debug::report(source, type, id, from_gl_severity(severity), message, size, site);
+        }
+
+        bool supports_debug_output()
+        {
+            GLint major = 0, minor = 0;
+            glGetIntegerv(GL_MAJOR_VERSION, &major);
+            glGetIntegerv(GL_MINOR_VERSION, &minor);
+
+            if (major > 4 || (major == 4 && minor >= 3))
+                return true;
+
+            GLint count = 0;
+            glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+            for (GLint i = 0; i < count; i++)
+            {
+                const char* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+                if (name != nullptr && strcmp(name, "GL_KHR_debug") == 0)
+                    return true;
+            }
+            return false;
+        }
+#endif
+    }
+
+    bool gl_debug::enable(const gl_debug_config& config)
+    {
+#if GR_OPENGLES3
+        (void)config;
+        return false;
+#else
+        if (!supports_debug_output())
+            return false;
+
+        s_deduplicate.store(config.deduplicate, std::memory_order_relaxed);
+        s_synchronous.store(config.synchronous, std::memory_order_relaxed);
+        s_min_severity.store(static_cast<uint8_t>(config.min_severity), std::memory_order_relaxed);
+
+        glEnable(GL_DEBUG_OUTPUT);
+        if (config.synchronous)
+            glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+        else
+            glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+
+        // o driver nem monta as mensagens abaixo do minimo
+        const GLenum severities[] = {GL_DEBUG_SEVERITY_NOTIFICATION, GL_DEBUG_SEVERITY_LOW, GL_DEBUG_SEVERITY_MEDIUM, GL_DEBUG_SEVERITY_HIGH};
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            GLboolean enabled = i >= static_cast<uint32_t>(config.min_severity) ? GL_TRUE : GL_FALSE;
+            glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, severities[i], 0, nullptr, enabled);
+        }
+
+        glDebugMessageCallback(debug_callback, nullptr);
+        return true;
+#endif
+    }
+
+    void gl_debug::disable()
+    {
+#if !GR_OPENGLES3
+        if (!supports_debug_output())
+            return;
+
+        glDebugMessageCallback(nullptr, nullptr);
+        glDisable(GL_DEBUG_OUTPUT);
+#endif
+    }
+
+    void gl_debug::ignore(uint32_t source, uint32_t type, uint32_t id)
+    {
+#if GR_OPENGLES3
+        (void)source;
+        (void)type;
+        (void)id;
+#else
+        GLuint ids[1] = {id};
+        glDebugMessageControl(source, type, GL_DONT_CARE, 1, ids, GL_FALSE);
+#endif
+    }
+
+    void gl_debug::set_error_sampling(uint32_t interval)
+    {
+        grr::error_sample_interval.store(interval, std::memory_order_relaxed);
+    }
+
+    uint32_t gl_debug::get_error_sampling()
+    {
+        return grr::error_sample_interval.load(std::memory_order_relaxed);
+    }
+
+    void gl_debug::report(uint32_t source, uint32_t type, uint32_t id, gl_debug_severity severity,
+                          const char* text, size_t length, const grr::call_site& site)
+    {
+        s_received.fetch_add(1, std::memory_order_relaxed);
+
+        if (static_cast<uint8_t>(severity) < s_min_severity.load(std::memory_order_relaxed))
+        {
+            s_filtered.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        if (s_deduplicate.load(std::memory_order_relaxed) && !first_time(message_key(source, type, id, text, length, site)))
+        {
+            s_duplicates.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        gl_debug_message message;
+        message.source = source;
+        message.type = type;
+        message.id = id;
+        message.severity = severity;
+        message.call = site.call;
+        message.file = site.file;
+        message.line = site.line;
+
+        size_t size = std::min(length, sizeof(message.text) - 1);
+        if (text != nullptr)
+            memcpy(message.text, text, size);
+        else
+            size = 0;
+        message.text[size] = '\0';
+
+        if (!s_ring.push(message))
+            s_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint32_t gl_debug::flush()
+    {
+        uint32_t count = 0;
+
+        gl_debug_message message;
+        while (s_ring.pop(message))
+        {
+            if (message.severity >= gl_debug_severity::medium)
+            {
+                if (message.file != nullptr)
+                    snprintf(grr::last_engine_error, sizeof(grr::last_engine_error), "%s(%d) : %s - %s", message.file, message.line, message.call, message.text);
+                else
+                    snprintf(grr::last_engine_error, sizeof(grr::last_engine_error), "%s", message.text);
+            }
+
+            if (s_sink)
+                s_sink(message);
+            else
+                print_message(message);
+
+            count++;
+        }
+
+        return count;
+    }
+
+    void gl_debug::set_sink(std::function<void(const gl_debug_message&)> sink)
+    {
+        s_sink = std::move(sink);
+    }
+
+    gl_debug_statistics gl_debug::get_statistics()
+    {
+        gl_debug_statistics statistics;
+        statistics.received = s_received.load(std::memory_order_relaxed);
+        statistics.filtered = s_filtered.load(std::memory_order_relaxed);
+        statistics.duplicates = s_duplicates.load(std::memory_order_relaxed);
+        statistics.dropped = s_dropped.load(std::memory_order_relaxed);
+        return statistics;
+    }
+
+    void gl_debug::reset()
+    {
+        for (auto& slot : s_seen)
+            slot.store(0, std::memory_order_relaxed);
+
+        s_received.store(0, std::memory_order_relaxed);
+        s_filtered.store(0, std::memory_order_relaxed);
+        s_duplicates.store(0, std::memory_order_relaxed);
+        s_dropped.store(0, std::memory_order_relaxed);
+    }
+}
@@ -1,11 +1,46 @@
 #include "index_buffer.hpp"
 
+#include "platform/null/null_index_buffer.hpp"
+#include "platform/opengl/opengl_dsa_index_buffer.hpp"
 #include "platform/opengl/opengl_index_buffer.hpp"
+#include "platform/software/software_index_buffer.hpp"
+
+#include "gRender.h"
+#include "gl.h"
+#include "trace_recorder.hpp"
 
 namespace gr
 {
+    namespace
+    {
+        std::shared_ptr<index_buffer> create_backend(const void* data, uint32_t size)
+        {
+            RenderBackend backend = gRender::GetBackend();
+            if (backend == RenderBackend::Software)
+                return std::make_shared<software_index_buffer>(data, size);
+
+            if (backend == RenderBackend::Null)
+                return std::make_shared<null_index_buffer>(data, size);
+
+#if !GR_OPENGLES3
+            if (grr::use_direct_state_access())
+                return std::make_shared<opengl_dsa_index_buffer>(data, size);
+#endif
+            return std::make_shared<opengl_index_buffer>(data, size);
+        }
+    }
+
     std::shared_ptr<index_buffer> index_buffer::create(const void *data, uint32_t size)
     {
-        return std::make_shared<opengl_index_buffer>(data, size);
+        std::shared_ptr<index_buffer> ibo = create_backend(data, size);
+
+        trace_recorder::record(trace_op::index_buffer_create, trace_recorder::key(ibo.get()), trace_blob{data, size});
+
+        return ibo;
+    }
+
+    index_buffer::~index_buffer()
+    {
+        trace_recorder::record(trace_op::index_buffer_destroy, trace_recorder::key(this));
     }
 }
@@ -0,0 +1,424 @@
+#include "material.hpp"
+
+#include "gTexture.h"
+#include "gl.h"
+#include "memory_tracker.hpp"
+#include "platform/null/null_device.hpp"
+#include "render_stats.hpp"
+#include "shader.hpp"
+#include "trace_recorder.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace gr
+{
+    namespace
+    {
+        constexpr uint32_t k_page_size = 64 * 1024;
+
+        struct uniform_page
+        {
+            uint32_t buffer;
+
+            uint32_t size;
+
+            uint32_t used;
+        };
+
+        struct uniform_range
+        {
+            uint32_t buffer;
+
+            uint32_t offset;
+
+            uint32_t capacity;
+        };
+
+        // Ranges of every material of this thread's context. Freed ranges are
+        // reused by capacity, which matches well since materials of one shader
+        // share the block size; the pages go away with the last material.
+        struct uniform_pages
+        {
+            std::vector<uniform_page> pages;
+
+            std::vector<uniform_range> free;
+
+            uint32_t live = 0;
+
+            uint32_t alignment = 0;
+
+            // sobe a cada troca de contexto; faixas de antes nao voltam para ca
+            uint32_t epoch = 0;
+
+            uniform_range allocate(uint32_t size)
+            {
+                if (alignment == 0)
+                {
+                    GLint value = 0;
+                    if (!null_device::is_active())
+                        GL_CALL(glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &value));
+                    alignment = value > 0 ? static_cast<uint32_t>(value) : 256;
+                }
+
+                uint32_t capacity = std::max((size + alignment - 1) / alignment * alignment, alignment);
+                live++;
+
+                for (size_t i = 0; i < free.size(); i++)
+                {
+                    if (free[i].capacity == capacity)
+                    {
+                        uniform_range range = free[i];
+                        free[i] = free.back();
+                        free.pop_back();
+                        return range;
+                    }
+                }
+
+                if (pages.empty() || pages.back().used + capacity > pages.back().size)
+                {
+                    uniform_page page;
+                    page.size = std::max(k_page_size, capacity);
+                    page.used = 0;
+
+                    if (null_device::is_active())
+                    {
+                        page.buffer = null_device::create_object(null_object::buffer);
+                    }
+                    else
+                    {
+                        GL_CALL(glGenBuffers(1, &page.buffer));
+                        GL_CALL(glBindBuffer(GL_UNIFORM_BUFFER, page.buffer));
+                        GL_CALL(glBufferData(GL_UNIFORM_BUFFER, page.size, nullptr, GL_DYNAMIC_DRAW));
+                        GL_CALL(glBindBuffer(GL_UNIFORM_BUFFER, 0));
+                    }
+
+                    memory_tracker::track(memory_category::uniform_buffer, page.buffer, page.size, "material");
+
+                    pages.push_back(page);
+                }
+
+                uniform_page& page = pages.back();
+
+                uniform_range range = {page.buffer, page.used, capacity};
+                page.used += capacity;
+                return range;
+            }
+
+            void release(const uniform_range& range)
+            {
+                free.push_back(range);
+
+                if (--live > 0)
+                    return;
+
+                for (auto& page : pages)
+                {
+                    memory_tracker::untrack(memory_category::uniform_buffer, page.buffer);
+
+                    if (null_device::is_active())
+                        null_device::destroy_object(null_object::buffer, page.buffer, "material::~material");
+                    else
+                        GL_CALL(glDeleteBuffers(1, &page.buffer));
+                }
+
+                pages.clear();
+                free.clear();
+            }
+
+            // Another context is current now: the pages are names of the old
+            // one, so they are dropped without GL calls and go with it.
+            void detach()
+            {
+                for (auto& page : pages)
+                    memory_tracker::untrack(memory_category::uniform_buffer, page.buffer);
+
+                pages.clear();
+                free.clear();
+                live = 0;
+                alignment = 0;
+                epoch++;
+            }
+        };
+
+        // por thread, como o cache de estado do gRender: cada contexto vive em uma thread
+        thread_local uniform_pages s_pages;
+
+        inline uint32_t column_count(UniformType type)
+        {
+            return type == UniformType::MAT3 ? 3 : type == UniformType::MAT4 ? 4 : 1;
+        }
+    }
+
+    material::material(Shader* shader, const char* block_name)
+        :
+            m_shader(shader),
+            m_block(GR_INVALID_ID),
+            m_binding(0),
+            m_buffer(0),
+            m_offset(0),
+            m_capacity(0),
+            m_pages_epoch(0),
+            m_dirty(false)
+    {
+        if (m_shader == nullptr)
+            return;
+
+        if (block_name != nullptr)
+            m_block = m_shader->find_block(block_name);
+
+        if (m_block != GR_INVALID_ID)
+        {
+            const shader_block& block = m_shader->get_blocks()[m_block];
+            m_binding = block.binding;
+
+            for (const auto& member : m_shader->get_block_members())
+            {
+                if (member.block != block.index)
+                    continue;
+
+                parameter entry;
+                entry.name = member.name;
+                entry.type = member.type;
+                entry.count = member.count;
+                entry.offset = member.offset;
+                entry.array_stride = member.array_stride;
+                entry.matrix_stride = member.matrix_stride;
+                entry.uniform = GR_INVALID_ID;
+                entry.assigned = false;
+                entry.dirty = false;
+                m_parameters.push_back(std::move(entry));
+            }
+
+            m_data.assign(block.size, 0);
+
+            uniform_range range = s_pages.allocate(block.size);
+            m_buffer = range.buffer;
+            m_offset = range.offset;
+            m_capacity = range.capacity;
+            m_pages_epoch = s_pages.epoch;
+
+            // o conteudo da faixa e indefinido ate o primeiro upload
+            m_dirty = true;
+            return;
+        }
+
+        // sem bloco: o blob segue a tabela de uniforms, sem padding
+        const ShaderUniform* uniforms = m_shader->GetUniforms();
+        for (size_t i = 0; i < m_shader->GetUniformCount(); i++)
+        {
+            const ShaderUniform& uniform = uniforms[i];
+            if (uniform.type == UniformType::SAMPLER2D || uniform.type == UniformType::SAMPLERCUBE)
+                continue;
+
+            uint32_t element_size = get_uniform_type_size(uniform.type);
+
+            parameter entry;
+            entry.name = uniform.name;
+            entry.type = uniform.type;
+            entry.count = element_size ? uniform.stride / element_size : 0;
+            entry.offset = uniform.offset;
+            entry.array_stride = element_size;
+            entry.matrix_stride = element_size / column_count(uniform.type);
+            entry.uniform = static_cast<UniformID>(i);
+            entry.assigned = false;
+            entry.dirty = false;
+            m_parameters.push_back(std::move(entry));
+        }
+
+        m_data.assign(m_shader->GetUniformBufferSize(), 0);
+    }
+
+    material::~material()
+    {
+        if (m_buffer != 0 && m_pages_epoch == s_pages.epoch)
+            s_pages.release({m_buffer, m_offset, m_capacity});
+    }
+
+    void material::detach_pages()
+    {
+        s_pages.detach();
+    }
+
+    bool material::set(const char* name, const void* data, uint32_t size)
+    {
+        if (name == nullptr || data == nullptr)
+            return false;
+
+        for (auto& entry : m_parameters)
+        {
+            if (entry.name != name)
+                continue;
+
+            uint32_t element_size = get_uniform_type_size(entry.type);
+            if (size == 0 || element_size == 0 || size % element_size != 0 || size / element_size > entry.count)
+                return false;
+
+            bool changed = write(entry, static_cast<const uint8_t*>(data), size / element_size);
+            if (changed || !entry.assigned)
+            {
+                entry.assigned = true;
+                entry.dirty = true;
+                m_dirty = true;
+            }
+            return true;
+        }
+
+        return false;
+    }
+
+    bool material::set_texture(const char* name, gTexture* texture, uint32_t element, uint32_t sampler)
+    {
+        if (m_shader == nullptr || name == nullptr)
+            return false;
+
+        UniformID id = m_shader->findUniform(name);
+        if (id == GR_INVALID_ID)
+            return false;
+
+        // so samplers refletidos tem unidade conhecida
+        const ShaderUniform& uniform = m_shader->GetUniforms()[id];
+        if (uniform.unit == GR_INVALID_ID || element >= uniform.count)
+            return false;
+
+        uint32_t unit = uniform.unit + element;
+
+        for (size_t i = 0; i < m_textures.size(); i++)
+        {
+            if (m_textures[i].unit != unit)
+                continue;
+
+            if (texture != nullptr)
+                m_textures[i] = {unit, texture, sampler};
+            else
+                m_textures.erase(m_textures.begin() + i);
+            return true;
+        }
+
+        if (texture != nullptr)
+            m_textures.push_back({unit, texture, sampler});
+        return true;
+    }
+
+    void material::bind(const material* previous)
+    {
+        if (m_shader == nullptr || (previous == this && !m_dirty))
+            return;
+
+        if (previous == nullptr || previous->m_shader != m_shader)
+            m_shader->bind();
+
+        if (m_block != GR_INVALID_ID)
+        {
+            // o buffer compartilhado e glBindBufferRange ficam fora do trace
+            trace_recorder::record(trace_op::unsupported, "material::bind (uniform block)");
+
+            if (m_dirty)
+                upload();
+
+            if (previous != this)
+            {
+                if (null_device::is_active())
+                    null_device::check("material::bind", null_device::is_object(null_object::buffer, m_buffer));
+                else
+                    GL_CALL(glBindBufferRange(GL_UNIFORM_BUFFER, m_binding, m_buffer, m_offset, m_data.size()));
+
+                render_stats::count_buffer_bind();
+            }
+        }
+        else
+        {
+            // uniforms sao estado do programa: outro material pode te-los trocado
+            bool all = previous != this;
+            for (auto& entry : m_parameters)
+            {
+                if (entry.assigned && (all || entry.dirty))
+                    m_shader->SetUniform(entry.uniform, &m_data[entry.offset]);
+
+                entry.dirty = false;
+            }
+        }
+
+        m_dirty = false;
+
+        if (previous != this)
+            bind_textures(previous);
+    }
+
+    // ********** private ********** //
+    bool material::write(parameter& entry, const uint8_t* data, uint32_t elements)
+    {
+        uint32_t columns = column_count(entry.type);
+        uint32_t column_size = get_uniform_type_size(entry.type) / columns;
+
+        bool changed = false;
+        for (uint32_t e = 0; e < elements; e++)
+        {
+            uint8_t* element = &m_data[entry.offset + e * entry.array_stride];
+            for (uint32_t c = 0; c < columns; c++)
+            {
+                // std140 alinha cada coluna de matriz em matrix_stride
+                uint8_t* column = element + c * entry.matrix_stride;
+                if (memcmp(column, data, column_size) != 0)
+                {
+                    memcpy(column, data, column_size);
+                    changed = true;
+                }
+                data += column_size;
+            }
+        }
+
+        return changed;
+    }
+
+    void material::upload()
+    {
+        uint32_t size = static_cast<uint32_t>(m_data.size());
+
+        if (null_device::is_active())
+        {
+            null_device::check("material::upload", null_device::is_object(null_object::buffer, m_buffer));
+        }
+        else
+        {
+#if !GR_OPENGLES3
+            if (grr::use_direct_state_access())
+            {
+                GL_CALL(glNamedBufferSubData(m_buffer, m_offset, size, m_data.data()));
+            }
+            else
+#endif
+            {
+                GL_CALL(glBindBuffer(GL_UNIFORM_BUFFER, m_buffer));
+                GL_CALL(glBufferSubData(GL_UNIFORM_BUFFER, m_offset, size, m_data.data()));
+            }
+        }
+
+        for (auto& entry : m_parameters)
+            entry.dirty = false;
+
+        render_stats::count_buffer_upload(size);
+    }
+
+    void material::bind_textures(const material* previous) const
+    {
+        for (const auto& binding : m_textures)
+        {
+            bool bound = false;
+            if (previous != nullptr)
+            {
+                for (const auto& other : previous->m_textures)
+                {
+                    if (other.unit == binding.unit && other.texture == binding.texture && other.sampler == binding.sampler)
+                    {
+                        bound = true;
+                        break;
+                    }
+                }
+            }
+
+            if (!bound)
+                binding.texture->bind(binding.unit, binding.sampler);
+        }
+    }
+}
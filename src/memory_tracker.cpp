@@ -0,0 +1,263 @@
+#include "memory_tracker.hpp"
+
+#include <algorithm>
+#include <mutex>
+
+namespace gr
+{
+    namespace
+    {
+        constexpr size_t k_categories = static_cast<size_t>(memory_category::count);
+
+        struct allocation_record
+        {
+            uint64_t bytes;
+
+            std::string name;
+        };
+
+        struct tracker_state
+        {
+            std::mutex mutex;
+
+            std::unordered_map<uint64_t, allocation_record> allocations;
+
+            memory_category_stats categories[k_categories];
+
+            uint64_t total = 0;
+
+            uint64_t peak = 0;
+
+            memory_budget_callback callback;
+        };
+
+        tracker_state& state()
+        {
+            static tracker_state instance;
+            return instance;
+        }
+
+        thread_local uint32_t t_context = 0;
+
+        // contexto (24 bits) | categoria (8 bits) | nome GL
+        inline uint64_t make_key(memory_category category, uint32_t id)
+        {
+            return (static_cast<uint64_t>(t_context) << 40) | (static_cast<uint64_t>(category) << 32) | id;
+        }
+    }
+
+    void memory_tracker::set_thread_context(uint32_t context)
+    {
+        t_context = context & 0xffffff;
+    }
+
+    void memory_tracker::track(memory_category category, uint32_t id, uint64_t bytes, const char* name)
+    {
+        tracker_state& s = state();
+
+        memory_budget_callback callback;
+        uint64_t used = 0, budget = 0;
+
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+
+            memory_category_stats& stats = s.categories[static_cast<size_t>(category)];
+
+            auto result = s.allocations.emplace(make_key(category, id), allocation_record{0, std::string()});
+            allocation_record& record = result.first->second;
+
+            if (result.second)
+                stats.allocations++;
+
+            stats.bytes = stats.bytes - record.bytes + bytes;
+            s.total = s.total - record.bytes + bytes;
+
+            record.bytes = bytes;
+            if (name != nullptr)
+                record.name = name;
+
+            stats.peak = std::max(stats.peak, stats.bytes);
+            s.peak = std::max(s.peak, s.total);
+
+            if (stats.budget && stats.bytes > stats.budget && s.callback)
+            {
+                callback = s.callback;
+                used = stats.bytes;
+                budget = stats.budget;
+            }
+        }
+
+        if (callback)
+            callback(category, used, budget);
+    }
+
+    void memory_tracker::untrack(memory_category category, uint32_t id)
+    {
+        tracker_state& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+
+        auto it = s.allocations.find(make_key(category, id));
+        if (it == s.allocations.end())
+            return;
+
+        memory_category_stats& stats = s.categories[static_cast<size_t>(category)];
+        stats.bytes -= it->second.bytes;
+        stats.allocations--;
+        s.total -= it->second.bytes;
+
+        s.allocations.erase(it);
+    }
+
+    void memory_tracker::set_debug_name(memory_category category, uint32_t id, const char* name)
+    {
+        tracker_state& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+
+        auto it = s.allocations.find(make_key(category, id));
+        if (it != s.allocations.end())
+            it->second.name = name != nullptr ? name : "";
+    }
+
+    memory_category_stats memory_tracker::get_stats(memory_category category)
+    {
+        tracker_state& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+
+        return s.categories[static_cast<size_t>(category)];
+    }
+
+    uint64_t memory_tracker::get_total()
+    {
+        tracker_state& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+
+        return s.total;
+    }
+
+    uint64_t memory_tracker::get_peak()
+    {
+        tracker_state& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+
+        return s.peak;
+    }
+
+    std::vector<memory_allocation> memory_tracker::get_allocations()
+    {
+        tracker_state& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+
+        std::vector<memory_allocation> result;
+        result.reserve(s.allocations.size());
+
+        for (const auto& entry : s.allocations)
+        {
+            memory_allocation allocation;
+            allocation.category = static_cast<memory_category>((entry.first >> 32) & 0xff);
+            allocation.context = static_cast<uint32_t>(entry.first >> 40);
+            allocation.id = static_cast<uint32_t>(entry.first);
+            allocation.bytes = entry.second.bytes;
+            allocation.name = entry.second.name;
+            result.push_back(std::move(allocation));
+        }
+
+        std::sort(result.begin(), result.end(), [](const memory_allocation& a, const memory_allocation& b) {
+            return a.bytes > b.bytes;
+        });
+
+        return result;
+    }
+
+    void memory_tracker::set_budget(memory_category category, uint64_t bytes)
+    {
+        tracker_state& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+
+        s.categories[static_cast<size_t>(category)].budget = bytes;
+    }
+
+    void memory_tracker::set_budget_callback(memory_budget_callback callback)
+    {
+        tracker_state& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+
+        s.callback = std::move(callback);
+    }
+
+    bool memory_tracker::can_allocate(memory_category category, uint64_t bytes)
+    {
+        tracker_state& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+
+        const memory_category_stats& stats = s.categories[static_cast<size_t>(category)];
+        return !stats.budget || stats.bytes + bytes <= stats.budget;
+    }
+
+    const char* memory_tracker::get_category_name(memory_category category)
+    {
+        switch (category)
+        {
+            case memory_category::vertex_buffer:
+                return "vertex_buffer";
+            case memory_category::index_buffer:
+                return "index_buffer";
+            case memory_category::uniform_buffer:
+                return "uniform_buffer";
+            case memory_category::other_buffer:
+                return "other_buffer";
+            case memory_category::texture:
+                return "texture";
+            case memory_category::render_target:
+                return "render_target";
+            default:
+                return "undefined";
+        }
+    }
+
+    uint64_t memory_tracker::texture_size(uint32_t width, uint32_t height, uint32_t pixel_size, uint32_t levels, uint32_t faces)
+    {
+        if (!levels)
+            levels = mip_levels(width, height);
+
+        uint64_t bytes = 0;
+        for (uint32_t level = 0; level < levels; level++)
+        {
+            bytes += static_cast<uint64_t>(width) * height * pixel_size;
+
+            width = std::max(width >> 1, 1u);
+            height = std::max(height >> 1, 1u);
+        }
+
+        return bytes * faces;
+    }
+
+    uint32_t memory_tracker::mip_levels(uint32_t width, uint32_t height)
+    {
+        uint32_t size = std::max(width, height);
+
+        uint32_t levels = 1;
+        while (size > 1)
+        {
+            size >>= 1;
+            levels++;
+        }
+        return levels;
+    }
+
+    void memory_tracker::reset()
+    {
+        tracker_state& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+
+        s.allocations.clear();
+        // budgets sobrevivem ao reset
+        for (memory_category_stats& stats : s.categories)
+        {
+            uint64_t budget = stats.budget;
+            stats = memory_category_stats();
+            stats.budget = budget;
+        }
+        s.total = 0;
+        s.peak = 0;
+    }
+}
@@ -0,0 +1,460 @@
+#include "mesh_optimizer.hpp"
+
+#include "gCommon.h"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace gr
+{
+    namespace
+    {
+        constexpr int kForsythMinCacheSize = 4;
+        constexpr int kForsythMaxCacheSize = 64;
+        constexpr int kForsythMaxValence = 32;
+
+        struct forsyth_tables
+        {
+            float valence[kForsythMaxValence + 1];
+
+            forsyth_tables()
+            {
+                valence[0] = 0.0f;
+                for (int i = 1; i <= kForsythMaxValence; i++)
+                    valence[i] = 2.0f / std::sqrt(float(i));
+            }
+        };
+
+        const forsyth_tables& get_forsyth_tables()
+        {
+            static const forsyth_tables tables;
+            return tables;
+        }
+
+        // score da posicao no cache simulado; os 3 do ultimo triangulo valem menos
+        void forsyth_cache_scores(float* scores, int cache_size)
+        {
+            for (int i = 0; i < cache_size; i++)
+            {
+                if (i < 3)
+                    scores[i] = 0.75f;
+                else
+                    scores[i] = std::pow(1.0f - float(i - 3) / float(cache_size - 3), 1.5f);
+            }
+        }
+
+        float forsyth_vertex_score(const float* cache_scores, int cache_position, uint32_t live_triangles)
+        {
+            if (live_triangles == 0)
+                return -1.0f;
+
+            const forsyth_tables& tables = get_forsyth_tables();
+
+            float score = cache_position < 0 ? 0.0f : cache_scores[cache_position];
+            score += tables.valence[live_triangles < kForsythMaxValence ? live_triangles : kForsythMaxValence];
+            return score;
+        }
+
+        inline const float* read_position(const uint8_t* base, size_t stride, uint32_t index)
+        {
+            return reinterpret_cast<const float*>(base + index * stride);
+        }
+    }
+
+    vertex_cache_statistics mesh_optimizer::analyze_vertex_cache(const uint32_t* indices, size_t index_count, size_t vertex_count, uint32_t cache_size)
+    {
+        vertex_cache_statistics result;
+        if (index_count < 3 || vertex_count == 0 || cache_size == 0)
+            return result;
+
+        // FIFO: o vertice esta no cache se foi inserido ha menos de cache_size misses
+        std::vector<uint32_t> stamps(vertex_count, 0);
+        std::vector<uint8_t> referenced(vertex_count, 0);
+
+        uint32_t misses = 0;
+        uint32_t unique = 0;
+
+        for (size_t i = 0; i < index_count; i++)
+        {
+            uint32_t index = indices[i];
+            if (index >= vertex_count)
+                continue;
+
+            if (!referenced[index])
+            {
+                referenced[index] = 1;
+                unique++;
+            }
+
+            if (stamps[index] == 0 || misses + 1 - stamps[index] > cache_size)
+            {
+                misses++;
+                stamps[index] = misses;
+            }
+        }
+
+        result.vertices_transformed = misses;
+        result.acmr = float(misses) / float(index_count / 3);
+        result.atvr = unique ? float(misses) / float(unique) : 0.0f;
+        return result;
+    }
+
+    void mesh_optimizer::optimize_vertex_cache(uint32_t* dst, const uint32_t* indices, size_t index_count, size_t vertex_count, uint32_t cache_size)
+    {
+        size_t triangle_count = index_count / 3;
+        if (triangle_count == 0 || vertex_count == 0)
+            return;
+
+        const int cache_capacity = static_cast<int>(std::min<uint32_t>(std::max<uint32_t>(cache_size, kForsythMinCacheSize), kForsythMaxCacheSize));
+
+        float cache_scores[kForsythMaxCacheSize];
+        forsyth_cache_scores(cache_scores, cache_capacity);
+
+        std::vector<uint32_t> source(indices, indices + triangle_count * 3);
+
+        // adjacencia vertice -> triangulos
+        std::vector<uint32_t> live(vertex_count, 0);
+        for (uint32_t index : source)
+            live[index]++;
+
+        std::vector<uint32_t> offsets(vertex_count + 1, 0);
+        for (size_t v = 0; v < vertex_count; v++)
+            offsets[v + 1] = offsets[v] + live[v];
+
+        std::vector<uint32_t> adjacency(source.size());
+        {
+            std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+            for (size_t t = 0; t < triangle_count; t++)
+            {
+                for (int k = 0; k < 3; k++)
+                    adjacency[fill[source[t * 3 + k]]++] = static_cast<uint32_t>(t);
+            }
+        }
+
+        std::vector<float> vertex_score(vertex_count);
+        for (size_t v = 0; v < vertex_count; v++)
+            vertex_score[v] = forsyth_vertex_score(cache_scores, -1, live[v]);
+
+        std::vector<uint8_t> emitted(triangle_count, 0);
+
+        uint32_t cache[kForsythMaxCacheSize + 3];
+        uint32_t cache_count = 0;
+
+        uint32_t new_cache[kForsythMaxCacheSize + 3];
+
+        size_t input_cursor = 0;
+        size_t output = 0;
+
+        int64_t best = -1;
+        float best_score = -1.0f;
+
+        while (output < triangle_count)
+        {
+            if (best < 0)
+            {
+                // cache sem candidatos: proximo triangulo pela ordem de entrada
+                while (input_cursor < triangle_count && emitted[input_cursor])
+                    input_cursor++;
+
+                best = static_cast<int64_t>(input_cursor);
+            }
+
+            uint32_t triangle = static_cast<uint32_t>(best);
+            const uint32_t* tri = &source[triangle * 3];
+
+            dst[output * 3 + 0] = tri[0];
+            dst[output * 3 + 1] = tri[1];
+            dst[output * 3 + 2] = tri[2];
+            output++;
+
+            emitted[triangle] = 1;
+
+            // remove o triangulo das listas de adjacencia
+            for (int k = 0; k < 3; k++)
+            {
+                uint32_t v = tri[k];
+                uint32_t* list = &adjacency[offsets[v]];
+                for (uint32_t i = 0; i < live[v]; i++)
+                {
+                    if (list[i] == triangle)
+                    {
+                        list[i] = list[live[v] - 1];
+                        break;
+                    }
+                }
+                live[v]--;
+            }
+
+            // o triangulo emitido vai para o inicio do cache
+            uint32_t new_count = 0;
+            for (int k = 0; k < 3; k++)
+                new_cache[new_count++] = tri[k];
+
+            for (uint32_t i = 0; i < cache_count; i++)
+            {
+                uint32_t v = cache[i];
+                if (v != tri[0] && v != tri[1] && v != tri[2])
+                    new_cache[new_count++] = v;
+            }
+
+            if (new_count > static_cast<uint32_t>(cache_capacity) + 3)
+                new_count = cache_capacity + 3;
+
+            for (uint32_t i = 0; i < new_count; i++)
+            {
+                uint32_t v = new_cache[i];
+                int position = i < static_cast<uint32_t>(cache_capacity) ? static_cast<int>(i) : -1;
+
+                vertex_score[v] = forsyth_vertex_score(cache_scores, position, live[v]);
+            }
+
+            best = -1;
+            best_score = -1.0f;
+
+            for (uint32_t i = 0; i < new_count; i++)
+            {
+                uint32_t v = new_cache[i];
+                const uint32_t* list = &adjacency[offsets[v]];
+                for (uint32_t j = 0; j < live[v]; j++)
+                {
+                    uint32_t t = list[j];
+                    const uint32_t* other = &source[t * 3];
+
+                    float score = vertex_score[other[0]] + vertex_score[other[1]] + vertex_score[other[2]];
+
+                    if (score > best_score || (score == best_score && t < best))
+                    {
+                        best = t;
+                        best_score = score;
+                    }
+                }
+            }
+
+            // vertices que sairam do cache
+            uint32_t kept = std::min(new_count, static_cast<uint32_t>(cache_capacity));
+            std::memcpy(cache, new_cache, kept * sizeof(uint32_t));
+            cache_count = kept;
+        }
+    }
+
+    void mesh_optimizer::optimize_overdraw(uint32_t* dst, const uint32_t* indices, size_t index_count, const float* positions, size_t vertex_count, size_t position_stride, uint32_t cache_size)
+    {
+        size_t triangle_count = index_count / 3;
+        if (triangle_count == 0 || vertex_count == 0 || positions == nullptr)
+            return;
+
+        const uint8_t* base = reinterpret_cast<const uint8_t*>(positions);
+
+        // clusters comecam onde o cache e' esvaziado (os 3 vertices erram)
+        std::vector<uint32_t> clusters;
+        {
+            std::vector<uint32_t> stamps(vertex_count, 0);
+            uint32_t misses = 0;
+
+            for (size_t t = 0; t < triangle_count; t++)
+            {
+                uint32_t triangle_misses = 0;
+                for (int k = 0; k < 3; k++)
+                {
+                    uint32_t index = indices[t * 3 + k];
+                    if (stamps[index] == 0 || misses + 1 - stamps[index] > cache_size)
+                    {
+                        misses++;
+                        stamps[index] = misses;
+                        triangle_misses++;
+                    }
+                }
+
+                if (t == 0 || triangle_misses == 3)
+                    clusters.push_back(static_cast<uint32_t>(t));
+            }
+        }
+
+        size_t cluster_count = clusters.size();
+        clusters.push_back(static_cast<uint32_t>(triangle_count));
+
+        std::vector<float> centroids(cluster_count * 3, 0.0f);
+        std::vector<float> normals(cluster_count * 3, 0.0f);
+
+        float mesh_centroid[3] = {0.0f, 0.0f, 0.0f};
+        float mesh_area = 0.0f;
+
+        for (size_t c = 0; c < cluster_count; c++)
+        {
+            float area_sum = 0.0f;
+            float center[3] = {0.0f, 0.0f, 0.0f};
+            float normal[3] = {0.0f, 0.0f, 0.0f};
+
+            for (uint32_t t = clusters[c]; t < clusters[c + 1]; t++)
+            {
+                const float* p0 = read_position(base, position_stride, indices[t * 3 + 0]);
+                const float* p1 = read_position(base, position_stride, indices[t * 3 + 1]);
+                const float* p2 = read_position(base, position_stride, indices[t * 3 + 2]);
+
+                float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+                float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+
+                float n[3] = {
+                    e1[1] * e2[2] - e1[2] * e2[1],
+                    e1[2] * e2[0] - e1[0] * e2[2],
+                    e1[0] * e2[1] - e1[1] * e2[0]
+                };
+
+                float area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+                for (int k = 0; k < 3; k++)
+                {
+                    center[k] += (p0[k] + p1[k] + p2[k]) / 3.0f * area;
+                    normal[k] += n[k];
+                }
+                area_sum += area;
+            }
+
+            float inv_area = area_sum > 0.0f ? 1.0f / area_sum : 0.0f;
+            float normal_length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            float inv_normal = normal_length > 0.0f ? 1.0f / normal_length : 0.0f;
+
+            for (int k = 0; k < 3; k++)
+            {
+                centroids[c * 3 + k] = center[k] * inv_area;
+                normals[c * 3 + k] = normal[k] * inv_normal;
+
+                mesh_centroid[k] += center[k];
+            }
+            mesh_area += area_sum;
+        }
+
+        if (mesh_area > 0.0f)
+        {
+            for (int k = 0; k < 3; k++)
+                mesh_centroid[k] /= mesh_area;
+        }
+
+        std::vector<float> sort_keys(cluster_count);
+        for (size_t c = 0; c < cluster_count; c++)
+        {
+            float dx = centroids[c * 3 + 0] - mesh_centroid[0];
+            float dy = centroids[c * 3 + 1] - mesh_centroid[1];
+            float dz = centroids[c * 3 + 2] - mesh_centroid[2];
+
+            sort_keys[c] = dx * normals[c * 3 + 0] + dy * normals[c * 3 + 1] + dz * normals[c * 3 + 2];
+        }
+
+        std::vector<uint32_t> order(cluster_count);
+        for (size_t c = 0; c < cluster_count; c++)
+            order[c] = static_cast<uint32_t>(c);
+
+        // clusters voltados para fora primeiro; stable_sort mantem o resultado deterministico
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return sort_keys[a] > sort_keys[b];
+        });
+
+        size_t output = 0;
+        for (uint32_t c : order)
+        {
+            size_t begin = clusters[c] * 3;
+            size_t end = clusters[c + 1] * 3;
+
+            std::memcpy(dst + output, indices + begin, (end - begin) * sizeof(uint32_t));
+            output += end - begin;
+        }
+    }
+
+    size_t mesh_optimizer::optimize_vertex_fetch(void* dst, uint32_t* indices, size_t index_count, const void* vertices, size_t vertex_count, size_t vertex_size)
+    {
+        std::vector<uint32_t> remap(vertex_count, GR_INVALID_ID);
+
+        const uint8_t* src = static_cast<const uint8_t*>(vertices);
+        uint8_t* out = static_cast<uint8_t*>(dst);
+
+        uint32_t next = 0;
+        for (size_t i = 0; i < index_count; i++)
+        {
+            uint32_t index = indices[i];
+            if (remap[index] == GR_INVALID_ID)
+            {
+                remap[index] = next;
+                std::memcpy(out + size_t(next) * vertex_size, src + size_t(index) * vertex_size, vertex_size);
+                next++;
+            }
+            indices[i] = remap[index];
+        }
+
+        return next;
+    }
+
+    mesh_optimizer_report mesh_optimizer::optimize(mesh_data& mesh, const mesh_optimizer_options& options)
+    {
+        mesh_optimizer_report report;
+
+        size_t vertex_count = mesh.get_vertex_count();
+        size_t index_count = mesh.indices.size() - mesh.indices.size() % 3;
+
+        report.vertices_before = static_cast<uint32_t>(vertex_count);
+        report.vertices_after = static_cast<uint32_t>(vertex_count);
+
+        if (vertex_count == 0 || index_count == 0)
+            return report;
+
+        for (size_t i = 0; i < index_count; i++)
+        {
+            if (mesh.indices[i] >= vertex_count)
+                return report;
+        }
+
+        report.before = analyze_vertex_cache(mesh.indices.data(), index_count, vertex_count, options.cache_size);
+
+        if (options.optimize_vertex_cache)
+            optimize_vertex_cache(mesh.indices.data(), mesh.indices.data(), index_count, vertex_count, options.cache_size);
+
+        const auto& elements = mesh.layout.get_elements();
+        if (options.optimize_overdraw && options.position_element < elements.size() &&
+            elements[options.position_element].get_component_count() >= 3)
+        {
+            const auto& position = elements[options.position_element];
+
+            std::vector<uint32_t> sorted(index_count);
+            optimize_overdraw(sorted.data(), mesh.indices.data(), index_count,
+                reinterpret_cast<const float*>(mesh.vertices.data() + position.offset),
+                vertex_count, mesh.layout.get_stride(), options.cache_size);
+
+            std::copy(sorted.begin(), sorted.end(), mesh.indices.begin());
+        }
+
+        if (options.optimize_vertex_fetch)
+        {
+            std::vector<uint8_t> vertices(mesh.vertices.size());
+
+            size_t stride = mesh.layout.get_stride();
+            size_t count = optimize_vertex_fetch(vertices.data(), mesh.indices.data(), index_count, mesh.vertices.data(), vertex_count, stride);
+
+            vertices.resize(count * stride);
+            mesh.vertices.swap(vertices);
+
+            vertex_count = count;
+        }
+
+        report.after = analyze_vertex_cache(mesh.indices.data(), index_count, vertex_count, options.cache_size);
+        report.vertices_after = static_cast<uint32_t>(vertex_count);
+
+        return report;
+    }
+
+    void mesh_optimizer::optimize(mesh_data* meshes, size_t count, const mesh_optimizer_options& options, mesh_optimizer_report* reports, thread_pool* pool)
+    {
+        if (pool == nullptr)
+            pool = &thread_pool::get_default();
+
+        // cada mesh e' independente, entao a ordem de execucao nao muda o resultado
+        pool->parallel_for(static_cast<uint32_t>(count), 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++)
+            {
+                mesh_optimizer_report report = optimize(meshes[i], options);
+                if (reports != nullptr)
+                    reports[i] = report;
+            }
+        });
+    }
+}
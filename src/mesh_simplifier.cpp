@@ -0,0 +1,598 @@
+#include "mesh_simplifier.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace gr
+{
+    namespace
+    {
+        struct quadric
+        {
+            double a2, ab, ac, ad;
+            double b2, bc, bd;
+            double c2, cd;
+            double d2;
+            double w;
+        };
+
+        inline void quadric_add(quadric& q, const quadric& o)
+        {
+            q.a2 += o.a2; q.ab += o.ab; q.ac += o.ac; q.ad += o.ad;
+            q.b2 += o.b2; q.bc += o.bc; q.bd += o.bd;
+            q.c2 += o.c2; q.cd += o.cd;
+            q.d2 += o.d2;
+            q.w += o.w;
+        }
+
+        inline quadric quadric_from_plane(double a, double b, double c, double d, double w)
+        {
+            return {
+                a * a * w, a * b * w, a * c * w, a * d * w,
+                b * b * w, b * c * w, b * d * w,
+                c * c * w, c * d * w,
+                d * d * w,
+                w
+            };
+        }
+
+        // erro quadratico medio ponderado pela area
+        inline double quadric_error(const quadric& q, const float* p)
+        {
+            double x = p[0], y = p[1], z = p[2];
+
+            double r = q.a2 * x * x + q.b2 * y * y + q.c2 * z * z
+                     + 2.0 * (q.ab * x * y + q.ac * x * z + q.bc * y * z)
+                     + 2.0 * (q.ad * x + q.bd * y + q.cd * z)
+                     + q.d2;
+
+            return q.w > 0.0 ? std::fabs(r) / q.w : 0.0;
+        }
+
+        inline void triangle_normal(const float* p0, const float* p1, const float* p2, float* n)
+        {
+            float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+            float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+
+            n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+            n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+            n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+        }
+
+        constexpr uint32_t k_none = UINT32_MAX;
+
+        // seam_from = k_none: sem par; senao o outro lado da costura colapsa junto
+        struct collapse
+        {
+            uint32_t from;
+            uint32_t to;
+            uint32_t seam_from;
+            uint32_t seam_to;
+            double cost;
+        };
+
+        class simplifier_context
+        {
+        public:
+            simplifier_context(const void* vertices, size_t vertex_count, size_t stride, size_t position_offset,
+                const uint32_t* indices, size_t index_count)
+                : m_vertices(static_cast<const uint8_t*>(vertices)), m_base(m_vertices + position_offset), m_stride(stride), m_vertex_count(vertex_count),
+                  m_quadrics(vertex_count, quadric{}), m_locked(vertex_count, 0), m_canonical(vertex_count), m_position_id(vertex_count), m_sibling(vertex_count)
+            {
+                deduplicate();
+                classify(indices, index_count);
+                accumulate_quadrics(indices, index_count);
+            }
+
+            inline const float* position(uint32_t index) const
+            {
+                return reinterpret_cast<const float*>(m_base + index * m_stride);
+            }
+
+            // simplifica `indices` no lugar; retorna o maior erro aceito
+            float run(std::vector<uint32_t>& indices, size_t target_index_count, float max_error);
+
+        private:
+            const uint8_t* m_vertices;
+
+            const uint8_t* m_base;
+
+            size_t m_stride;
+
+            size_t m_vertex_count;
+
+            std::vector<quadric> m_quadrics;
+
+            std::vector<uint8_t> m_locked;
+
+            // primeiro vertice com os mesmos bytes; os indices usam so esses
+            std::vector<uint32_t> m_canonical;
+
+            std::vector<uint32_t> m_position_id;
+
+            // o outro vertice na mesma posicao quando ela esta numa costura; senao o proprio
+            std::vector<uint32_t> m_sibling;
+
+            void deduplicate();
+
+            void classify(const uint32_t* indices, size_t index_count);
+
+            void accumulate_quadrics(const uint32_t* indices, size_t index_count);
+
+            bool flips(uint32_t from, uint32_t to, const std::vector<uint32_t>& indices, const uint32_t* triangles, uint32_t triangle_count) const;
+
+            // vertice na posicao `position` ligado a `from` por uma aresta; k_none se nenhum ou mais de um
+            uint32_t find_twin(uint32_t from, uint32_t position, const std::vector<uint32_t>& indices,
+                const std::vector<uint32_t>& offsets, const std::vector<uint32_t>& adjacency) const;
+        };
+
+        // Vertices with the same bytes (flat shaded faces that share a plane, meshes
+        // that were never welded) are one vertex for the simplifier.
+        void simplifier_context::deduplicate()
+        {
+            std::vector<uint32_t> order(m_vertex_count);
+            for (size_t i = 0; i < m_vertex_count; i++)
+                order[i] = static_cast<uint32_t>(i);
+
+            auto less = [this](uint32_t a, uint32_t b) {
+                int result = std::memcmp(m_vertices + a * m_stride, m_vertices + b * m_stride, m_stride);
+                return result != 0 ? result < 0 : a < b;
+            };
+            std::sort(order.begin(), order.end(), less);
+
+            for (size_t i = 0; i < m_vertex_count; i++)
+            {
+                bool same = i > 0 && std::memcmp(m_vertices + order[i] * m_stride, m_vertices + order[i - 1] * m_stride, m_stride) == 0;
+                m_canonical[order[i]] = same ? m_canonical[order[i - 1]] : order[i];
+            }
+        }
+
+        void simplifier_context::classify(const uint32_t* indices, size_t index_count)
+        {
+            // agrupa vertices com a mesma posicao: mais de um vertice por posicao = costura de atributos
+            std::vector<uint32_t> order(m_vertex_count);
+            for (size_t i = 0; i < m_vertex_count; i++)
+                order[i] = static_cast<uint32_t>(i);
+
+            auto less = [this](uint32_t a, uint32_t b) {
+                const float* pa = position(a);
+                const float* pb = position(b);
+                if (pa[0] != pb[0]) return pa[0] < pb[0];
+                if (pa[1] != pb[1]) return pa[1] < pb[1];
+                if (pa[2] != pb[2]) return pa[2] < pb[2];
+                return a < b;
+            };
+            std::sort(order.begin(), order.end(), less);
+
+            std::vector<uint32_t>& position_id = m_position_id;
+            uint32_t group = 0;
+            for (size_t i = 0; i < m_vertex_count; i++)
+            {
+                if (i > 0 && std::memcmp(position(order[i]), position(order[i - 1]), sizeof(float) * 3) != 0)
+                    group++;
+
+                position_id[order[i]] = group;
+            }
+
+            std::vector<uint8_t> referenced(m_vertex_count, 0);
+            for (size_t i = 0; i < index_count; i++)
+                referenced[m_canonical[indices[i]]] = 1;
+
+            // Two vertices at a position are a seam passing through it: they collapse
+            // together. More than two is a corner where seams meet and stays put.
+            for (size_t v = 0; v < m_vertex_count; v++)
+                m_sibling[v] = static_cast<uint32_t>(v);
+
+            for (size_t i = 0; i < m_vertex_count;)
+            {
+                size_t j = i;
+                uint32_t wedges[3];
+                uint32_t wedge_count = 0;
+                for (; j < m_vertex_count && position_id[order[j]] == position_id[order[i]]; j++)
+                {
+                    uint32_t v = order[j];
+                    if (!referenced[v])
+                        continue;
+
+                    if (wedge_count < 3)
+                        wedges[wedge_count] = v;
+                    wedge_count++;
+                }
+
+                if (wedge_count == 2)
+                {
+                    m_sibling[wedges[0]] = wedges[1];
+                    m_sibling[wedges[1]] = wedges[0];
+                }
+                else if (wedge_count > 2)
+                {
+                    for (size_t k = i; k < j; k++)
+                        m_locked[order[k]] = 1;
+                }
+                i = j;
+            }
+
+            // arestas de borda (1 triangulo) ou nao-manifold (> 2) travam seus vertices
+            std::vector<uint64_t> edges;
+            edges.reserve(index_count);
+            for (size_t t = 0; t + 2 < index_count; t += 3)
+            {
+                for (int k = 0; k < 3; k++)
+                {
+                    uint64_t a = position_id[indices[t + k]];
+                    uint64_t b = position_id[indices[t + (k + 1) % 3]];
+                    if (a == b)
+                        continue;
+
+                    edges.push_back(a < b ? (a << 32) | b : (b << 32) | a);
+                }
+            }
+            std::sort(edges.begin(), edges.end());
+
+            std::vector<uint8_t> locked_position(group + 1, 0);
+            for (size_t i = 0; i < edges.size();)
+            {
+                size_t j = i;
+                while (j < edges.size() && edges[j] == edges[i])
+                    j++;
+
+                if (j - i != 2)
+                {
+                    locked_position[edges[i] >> 32] = 1;
+                    locked_position[edges[i] & 0xffffffffu] = 1;
+                }
+                i = j;
+            }
+
+            for (size_t v = 0; v < m_vertex_count; v++)
+            {
+                if (locked_position[position_id[v]])
+                    m_locked[v] = 1;
+            }
+        }
+
+        void simplifier_context::accumulate_quadrics(const uint32_t* indices, size_t index_count)
+        {
+            for (size_t t = 0; t + 2 < index_count; t += 3)
+            {
+                const uint32_t tri[3] = {m_canonical[indices[t + 0]], m_canonical[indices[t + 1]], m_canonical[indices[t + 2]]};
+
+                const float* p0 = position(tri[0]);
+                const float* p1 = position(tri[1]);
+                const float* p2 = position(tri[2]);
+
+                float n[3];
+                triangle_normal(p0, p1, p2, n);
+
+                double length = std::sqrt(double(n[0]) * n[0] + double(n[1]) * n[1] + double(n[2]) * n[2]);
+                if (length <= 0.0)
+                    continue;
+
+                double a = n[0] / length, b = n[1] / length, c = n[2] / length;
+                double d = -(a * p0[0] + b * p0[1] + c * p0[2]);
+
+                quadric q = quadric_from_plane(a, b, c, d, length * 0.5);
+
+                for (int k = 0; k < 3; k++)
+                    quadric_add(m_quadrics[tri[k]], q);
+            }
+        }
+
+        bool simplifier_context::flips(uint32_t from, uint32_t to, const std::vector<uint32_t>& indices, const uint32_t* triangles, uint32_t triangle_count) const
+        {
+            for (uint32_t i = 0; i < triangle_count; i++)
+            {
+                const uint32_t* tri = &indices[triangles[i] * 3];
+                if (tri[0] == to || tri[1] == to || tri[2] == to)
+                    continue;
+
+                const float* p[3];
+                const float* q[3];
+                for (int k = 0; k < 3; k++)
+                {
+                    p[k] = position(tri[k]);
+                    q[k] = tri[k] == from ? position(to) : p[k];
+                }
+
+                float before[3], after[3];
+                triangle_normal(p[0], p[1], p[2], before);
+                triangle_normal(q[0], q[1], q[2], after);
+
+                float dot = before[0] * after[0] + before[1] * after[1] + before[2] * after[2];
+                float after_length = after[0] * after[0] + after[1] * after[1] + after[2] * after[2];
+
+                if (dot <= 0.0f || after_length <= FLT_MIN)
+                    return true;
+            }
+            return false;
+        }
+
+        uint32_t simplifier_context::find_twin(uint32_t from, uint32_t position, const std::vector<uint32_t>& indices,
+            const std::vector<uint32_t>& offsets, const std::vector<uint32_t>& adjacency) const
+        {
+            uint32_t twin = k_none;
+            for (uint32_t i = offsets[from]; i < offsets[from + 1]; i++)
+            {
+                const uint32_t* tri = &indices[adjacency[i] * 3];
+                for (int k = 0; k < 3; k++)
+                {
+                    if (m_position_id[tri[k]] != position || tri[k] == twin)
+                        continue;
+
+                    if (twin != k_none)
+                        return k_none;
+                    twin = tri[k];
+                }
+            }
+            return twin;
+        }
+
+        float simplifier_context::run(std::vector<uint32_t>& indices, size_t target_index_count, float max_error)
+        {
+            double limit = max_error > 0.0f ? double(max_error) * double(max_error) : DBL_MAX;
+            double accepted = 0.0;
+
+            std::vector<uint32_t> offsets(m_vertex_count + 1);
+            std::vector<uint32_t> adjacency;
+            std::vector<uint32_t> remap(m_vertex_count);
+            std::vector<uint8_t> touched(m_vertex_count);
+            std::vector<collapse> candidates;
+
+            for (uint32_t& index : indices)
+                index = m_canonical[index];
+
+            while (indices.size() > target_index_count)
+            {
+                size_t triangle_count = indices.size() / 3;
+
+                // adjacencia vertice -> triangulos da passada atual
+                std::fill(offsets.begin(), offsets.end(), 0);
+                for (uint32_t index : indices)
+                    offsets[index + 1]++;
+                for (size_t v = 0; v < m_vertex_count; v++)
+                    offsets[v + 1] += offsets[v];
+
+                adjacency.resize(indices.size());
+                {
+                    std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+                    for (size_t t = 0; t < triangle_count; t++)
+                    {
+                        for (int k = 0; k < 3; k++)
+                            adjacency[fill[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+                    }
+                }
+
+                // melhor colapso por vertice de origem
+                candidates.clear();
+                for (size_t v = 0; v < m_vertex_count; v++)
+                {
+                    if (m_locked[v] || offsets[v] == offsets[v + 1])
+                        continue;
+
+                    // costura: o par sai uma vez so, pelo menor dos dois
+                    uint32_t sibling = m_sibling[v];
+                    if (sibling < v)
+                        continue;
+
+                    collapse best = {static_cast<uint32_t>(v), 0, k_none, k_none, DBL_MAX};
+
+                    for (uint32_t i = offsets[v]; i < offsets[v + 1]; i++)
+                    {
+                        const uint32_t* tri = &indices[adjacency[i] * 3];
+                        for (int k = 0; k < 3; k++)
+                        {
+                            uint32_t to = tri[k];
+                            if (m_position_id[to] == m_position_id[v])
+                                continue;
+
+                            quadric q = m_quadrics[v];
+                            quadric_add(q, m_quadrics[to]);
+
+                            // o outro lado tem que seguir pela mesma aresta, senao a costura mudaria de forma
+                            uint32_t seam_to = k_none;
+                            if (sibling != v)
+                            {
+                                seam_to = find_twin(sibling, m_position_id[to], indices, offsets, adjacency);
+                                if (seam_to == k_none)
+                                    continue;
+
+                                quadric_add(q, m_quadrics[sibling]);
+                                if (seam_to != to)
+                                    quadric_add(q, m_quadrics[seam_to]);
+                            }
+
+                            double cost = quadric_error(q, position(to));
+                            if (cost < best.cost || (cost == best.cost && to < best.to))
+                            {
+                                best.to = to;
+                                best.seam_from = sibling != v ? sibling : k_none;
+                                best.seam_to = seam_to;
+                                best.cost = cost;
+                            }
+                        }
+                    }
+
+                    if (best.cost <= limit)
+                        candidates.push_back(best);
+                }
+
+                if (candidates.empty())
+                    break;
+
+                std::stable_sort(candidates.begin(), candidates.end(), [](const collapse& a, const collapse& b) {
+                    return a.cost < b.cost;
+                });
+
+                for (size_t v = 0; v < m_vertex_count; v++)
+                    remap[v] = static_cast<uint32_t>(v);
+                std::fill(touched.begin(), touched.end(), 0);
+
+                size_t remaining = triangle_count;
+                size_t target_triangles = target_index_count / 3;
+                size_t collapsed = 0;
+
+                auto flips_from = [&](uint32_t from, uint32_t to) {
+                    return flips(from, to, indices, &adjacency[offsets[from]], offsets[from + 1] - offsets[from]);
+                };
+
+                // triangulos que contem a aresta degeneram; os vizinhos ficam travados nesta passada
+                auto apply = [&](uint32_t from, uint32_t to) {
+                    for (uint32_t i = offsets[from]; i < offsets[from + 1]; i++)
+                    {
+                        const uint32_t* tri = &indices[adjacency[i] * 3];
+                        if (tri[0] == to || tri[1] == to || tri[2] == to)
+                            remaining--;
+
+                        for (int k = 0; k < 3; k++)
+                            touched[tri[k]] = 1;
+                    }
+
+                    remap[from] = to;
+                    quadric_add(m_quadrics[to], m_quadrics[from]);
+                };
+
+                for (const collapse& c : candidates)
+                {
+                    if (remaining <= target_triangles)
+                        break;
+
+                    bool seam = c.seam_from != k_none;
+
+                    if (touched[c.from] || touched[c.to] || (seam && (touched[c.seam_from] || touched[c.seam_to])))
+                        continue;
+
+                    if (flips_from(c.from, c.to) || (seam && flips_from(c.seam_from, c.seam_to)))
+                        continue;
+
+                    apply(c.from, c.to);
+                    if (seam)
+                        apply(c.seam_from, c.seam_to);
+
+                    accepted = std::max(accepted, c.cost);
+                    collapsed++;
+                }
+
+                if (collapsed == 0)
+                    break;
+
+                size_t write = 0;
+                for (size_t t = 0; t < triangle_count; t++)
+                {
+                    uint32_t a = remap[indices[t * 3 + 0]];
+                    uint32_t b = remap[indices[t * 3 + 1]];
+                    uint32_t c = remap[indices[t * 3 + 2]];
+
+                    if (a == b || b == c || a == c)
+                        continue;
+
+                    indices[write++] = a;
+                    indices[write++] = b;
+                    indices[write++] = c;
+                }
+                indices.resize(write);
+            }
+
+            return static_cast<float>(std::sqrt(accepted));
+        }
+    }
+
+    size_t mesh_simplifier::simplify(uint32_t* dst, const uint32_t* indices, size_t index_count, const void* vertices, size_t vertex_count,
+        const buffer_layout& layout, size_t target_index_count, float target_error, float* result_error, uint32_t position_element)
+    {
+        const auto& elements = layout.get_elements();
+        if (position_element >= elements.size() || elements[position_element].get_component_count() < 3)
+            return 0;
+
+        index_count -= index_count % 3;
+
+        for (size_t i = 0; i < index_count; i++)
+        {
+            if (indices[i] >= vertex_count)
+                return 0;
+        }
+
+        simplifier_context context(vertices, vertex_count, layout.get_stride(), elements[position_element].offset, indices, index_count);
+
+        std::vector<uint32_t> result(indices, indices + index_count);
+        float error = context.run(result, target_index_count, target_error);
+
+        std::copy(result.begin(), result.end(), dst);
+
+        if (result_error != nullptr)
+            *result_error = error;
+
+        return result.size();
+    }
+
+    std::vector<mesh_lod> mesh_simplifier::generate_lods(mesh_data& mesh, const mesh_lod_level* levels, size_t level_count, uint32_t position_element)
+    {
+        std::vector<mesh_lod> lods;
+
+        const auto& elements = mesh.layout.get_elements();
+        size_t base_count = mesh.indices.size() - mesh.indices.size() % 3;
+        size_t vertex_count = mesh.get_vertex_count();
+
+        lods.push_back({0, static_cast<uint32_t>(base_count), 0.0f});
+
+        if (position_element >= elements.size() || elements[position_element].get_component_count() < 3 || base_count == 0)
+            return lods;
+
+        for (size_t i = 0; i < base_count; i++)
+        {
+            if (mesh.indices[i] >= vertex_count)
+                return lods;
+        }
+
+        // as quadricas acumulam desde a malha base, entao o erro de cada nivel e' relativo a ela
+        simplifier_context context(mesh.vertices.data(), vertex_count, mesh.layout.get_stride(), elements[position_element].offset,
+            mesh.indices.data(), base_count);
+
+        std::vector<uint32_t> current(mesh.indices.begin(), mesh.indices.begin() + base_count);
+        float error = 0.0f;
+
+        for (size_t i = 0; i < level_count; i++)
+        {
+            size_t target = static_cast<size_t>(double(base_count / 3) * levels[i].target_ratio) * 3;
+
+            error = std::max(error, context.run(current, target, levels[i].target_error));
+
+            if (current.empty() || current.size() == lods.back().index_count)
+                break;
+
+            std::vector<uint32_t> ordered(current.size());
+            mesh_optimizer::optimize_vertex_cache(ordered.data(), current.data(), current.size(), vertex_count);
+
+            lods.push_back({static_cast<uint32_t>(mesh.indices.size()), static_cast<uint32_t>(ordered.size()), error});
+            mesh.indices.insert(mesh.indices.end(), ordered.begin(), ordered.end());
+        }
+
+        return lods;
+    }
+
+    lod_selector::lod_selector(float viewport_height, float fov_y, float max_pixel_error)
+        : m_projection_scale(viewport_height / (2.0f * std::tan(fov_y * 0.5f))), m_max_pixel_error(max_pixel_error)
+    {}
+
+    uint32_t lod_selector::select(const mesh_lod* lods, size_t count, float distance, float scale) const
+    {
+        if (count == 0)
+            return 0;
+
+        if (distance <= 0.0f)
+            return 0;
+
+        float pixels_per_unit = m_projection_scale * scale / distance;
+
+        uint32_t selected = 0;
+        for (size_t i = 1; i < count; i++)
+        {
+            if (lods[i].error * pixels_per_unit > m_max_pixel_error)
+                break;
+
+            selected = static_cast<uint32_t>(i);
+        }
+        return selected;
+    }
+}
@@ -0,0 +1,386 @@
+#include "occlusion_culler.hpp"
+
+#include "frustum_culler.hpp"
+#include "simd.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace gr
+{
+    namespace
+    {
+        constexpr float k_min_w = 1e-5f;
+
+        constexpr uint32_t k_test_grain = 1024;
+
+        // out = a * b, column-major
+        void multiply(const float* a, const float* b, float* out)
+        {
+            for (int c = 0; c < 4; c++)
+            {
+                for (int r = 0; r < 4; r++)
+                {
+                    out[c * 4 + r] = a[0 * 4 + r] * b[c * 4 + 0] + a[1 * 4 + r] * b[c * 4 + 1]
+                                   + a[2 * 4 + r] * b[c * 4 + 2] + a[3 * 4 + r] * b[c * 4 + 3];
+                }
+            }
+        }
+
+        inline void transform(const float* m, float x, float y, float z, float* out)
+        {
+            out[0] = m[0] * x + m[4] * y + m[8] * z + m[12];
+            out[1] = m[1] * x + m[5] * y + m[9] * z + m[13];
+            out[2] = m[2] * x + m[6] * y + m[10] * z + m[14];
+            out[3] = m[3] * x + m[7] * y + m[11] * z + m[15];
+        }
+    }
+
+    occlusion_culler::occlusion_culler(uint32_t width, uint32_t height, thread_pool* pool)
+        : m_width(width), m_height(height), m_pool(pool ? pool : &thread_pool::get_default())
+    {
+        m_tiles_x = (width + k_tile_size - 1) / k_tile_size;
+        m_tiles_y = (height + k_tile_size - 1) / k_tile_size;
+
+        m_pitch = m_tiles_x * k_tile_size;
+        m_rows = m_tiles_y * k_tile_size;
+
+        m_depth.assign(m_pitch * m_rows, 1.0f);
+        m_hiz.assign((m_pitch / k_hiz_size) * (m_rows / k_hiz_size), 1.0f);
+        m_bins.resize(m_tiles_x * m_tiles_y);
+
+        std::memset(m_view_projection, 0, sizeof(m_view_projection));
+    }
+
+    void occlusion_culler::begin_frame(const Matrix4x4& view_projection)
+    {
+        static_assert(sizeof(Matrix4x4) == sizeof(float) * 16, "Matrix4x4 must be 16 packed floats");
+
+        std::memcpy(m_view_projection, &view_projection, sizeof(m_view_projection));
+
+        m_occluders.clear();
+        m_statistics = occlusion_statistics();
+    }
+
+    void occlusion_culler::add_occluder(const float* positions, size_t stride, size_t vertex_count, const uint32_t* indices, size_t index_count, const Matrix4x4& model)
+    {
+        if (positions == nullptr || indices == nullptr || index_count < 3)
+            return;
+
+        occluder occ;
+        occ.positions = positions;
+        occ.stride = stride;
+        occ.vertex_count = vertex_count;
+        occ.indices = indices;
+        occ.index_count = index_count - index_count % 3;
+        multiply(m_view_projection, reinterpret_cast<const float*>(&model), occ.mvp);
+
+        m_occluders.push_back(occ);
+        m_statistics.occluder_triangles += static_cast<uint32_t>(occ.index_count / 3);
+    }
+
+    void occlusion_culler::add_occluder(const mesh_data& mesh, const Matrix4x4& model, uint32_t position_element)
+    {
+        const auto& elements = mesh.layout.get_elements();
+        if (position_element >= elements.size() || elements[position_element].get_component_count() < 3)
+            return;
+
+        add_occluder(reinterpret_cast<const float*>(mesh.vertices.data() + elements[position_element].offset), mesh.layout.get_stride(),
+            mesh.get_vertex_count(), mesh.indices.data(), mesh.indices.size(), model);
+    }
+
+    void occlusion_culler::setup_occluder(const occluder& occ, std::vector<screen_triangle>& out) const
+    {
+        const uint8_t* base = reinterpret_cast<const uint8_t*>(occ.positions);
+
+        float half_w = m_width * 0.5f;
+        float half_h = m_height * 0.5f;
+
+        out.clear();
+
+        for (size_t t = 0; t < occ.index_count; t += 3)
+        {
+            float sx[3], sy[3], sz[3];
+            bool valid = true;
+
+            for (int k = 0; k < 3; k++)
+            {
+                uint32_t index = occ.indices[t + k];
+                if (index >= occ.vertex_count)
+                {
+                    valid = false;
+                    break;
+                }
+
+                const float* p = reinterpret_cast<const float*>(base + index * occ.stride);
+
+                float clip[4];
+                transform(occ.mvp, p[0], p[1], p[2], clip);
+
+                // cruza o near plane: descartar o oclusor e' sempre conservador
+                if (clip[3] < k_min_w || clip[2] < -clip[3])
+                {
+                    valid = false;
+                    break;
+                }
+
+                float inv_w = 1.0f / clip[3];
+                sx[k] = (clip[0] * inv_w + 1.0f) * half_w;
+                sy[k] = (clip[1] * inv_w + 1.0f) * half_h;
+                sz[k] = clip[2] * inv_w * 0.5f + 0.5f;
+            }
+
+            if (!valid)
+                continue;
+
+            float area = (sx[1] - sx[0]) * (sy[2] - sy[0]) - (sx[2] - sx[0]) * (sy[1] - sy[0]);
+            if (area <= 0.0f)
+                continue;
+
+            screen_triangle tri;
+            tri.min_x = std::max(0, static_cast<int32_t>(std::floor(std::min({sx[0], sx[1], sx[2]}))));
+            tri.min_y = std::max(0, static_cast<int32_t>(std::floor(std::min({sy[0], sy[1], sy[2]}))));
+            tri.max_x = std::min(static_cast<int32_t>(m_width) - 1, static_cast<int32_t>(std::ceil(std::max({sx[0], sx[1], sx[2]}))));
+            tri.max_y = std::min(static_cast<int32_t>(m_height) - 1, static_cast<int32_t>(std::ceil(std::max({sy[0], sy[1], sy[2]}))));
+
+            if (tri.min_x > tri.max_x || tri.min_y > tri.max_y)
+                continue;
+
+            for (int k = 0; k < 3; k++)
+            {
+                int j = (k + 1) % 3;
+                tri.a[k] = sy[k] - sy[j];
+                tri.b[k] = sx[j] - sx[k];
+                tri.c[k] = -(tri.a[k] * sx[k] + tri.b[k] * sy[k]);
+            }
+
+            float inv_area = 1.0f / area;
+            tri.za = ((sz[1] - sz[0]) * (sy[2] - sy[0]) - (sz[2] - sz[0]) * (sy[1] - sy[0])) * inv_area;
+            tri.zb = ((sz[2] - sz[0]) * (sx[1] - sx[0]) - (sz[1] - sz[0]) * (sx[2] - sx[0])) * inv_area;
+            tri.zc = sz[0] - tri.za * sx[0] - tri.zb * sy[0];
+
+            out.push_back(tri);
+        }
+    }
+
+    void occlusion_culler::rasterize()
+    {
+        std::fill(m_depth.begin(), m_depth.end(), 1.0f);
+        std::fill(m_hiz.begin(), m_hiz.end(), 1.0f);
+
+        // transformacao e setup por oclusor
+        m_setup.resize(m_occluders.size());
+        m_pool->parallel_for(static_cast<uint32_t>(m_occluders.size()), 1, [this](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++)
+                setup_occluder(m_occluders[i], m_setup[i]);
+        });
+
+        m_triangles.clear();
+        for (auto& setup : m_setup)
+            m_triangles.insert(m_triangles.end(), setup.begin(), setup.end());
+
+        m_statistics.rasterized_triangles = static_cast<uint32_t>(m_triangles.size());
+
+        // binning serial mantem a ordem dos triangulos em cada tile
+        for (auto& bin : m_bins)
+            bin.clear();
+
+        for (uint32_t i = 0; i < m_triangles.size(); i++)
+        {
+            const screen_triangle& tri = m_triangles[i];
+
+            uint32_t tx0 = tri.min_x / k_tile_size, tx1 = tri.max_x / k_tile_size;
+            uint32_t ty0 = tri.min_y / k_tile_size, ty1 = tri.max_y / k_tile_size;
+
+            for (uint32_t ty = ty0; ty <= ty1; ty++)
+            {
+                for (uint32_t tx = tx0; tx <= tx1; tx++)
+                    m_bins[ty * m_tiles_x + tx].push_back(i);
+            }
+        }
+
+        m_pool->parallel_for(m_tiles_x * m_tiles_y, 1, [this](uint32_t begin, uint32_t end) {
+            for (uint32_t tile = begin; tile < end; tile++)
+                rasterize_tile(tile);
+        });
+    }
+
+    void occlusion_culler::rasterize_tile(uint32_t tile)
+    {
+        int32_t tile_x = static_cast<int32_t>((tile % m_tiles_x) * k_tile_size);
+        int32_t tile_y = static_cast<int32_t>((tile / m_tiles_x) * k_tile_size);
+
+        const simd::vfloat zero = simd::set1(0.0f);
+        const simd::vfloat lane_offset = simd::ramp() + simd::set1(0.5f);
+
+        for (uint32_t index : m_bins[tile])
+        {
+            const screen_triangle& tri = m_triangles[index];
+
+            int32_t x0 = std::max(tri.min_x, tile_x);
+            int32_t x1 = std::min(tri.max_x, tile_x + static_cast<int32_t>(k_tile_size) - 1);
+            int32_t y0 = std::max(tri.min_y, tile_y);
+            int32_t y1 = std::min(tri.max_y, tile_y + static_cast<int32_t>(k_tile_size) - 1);
+
+            // alinha o inicio da linha a largura do simd; o tile e' multiplo dela
+            x0 = tile_x + (x0 - tile_x) / simd::width * simd::width;
+
+            simd::vfloat a0 = simd::set1(tri.a[0]), a1 = simd::set1(tri.a[1]), a2 = simd::set1(tri.a[2]);
+            simd::vfloat za = simd::set1(tri.za);
+
+            for (int32_t y = y0; y <= y1; y++)
+            {
+                float py = y + 0.5f;
+
+                simd::vfloat r0 = simd::set1(tri.b[0] * py + tri.c[0]);
+                simd::vfloat r1 = simd::set1(tri.b[1] * py + tri.c[1]);
+                simd::vfloat r2 = simd::set1(tri.b[2] * py + tri.c[2]);
+                simd::vfloat rz = simd::set1(tri.zb * py + tri.zc);
+
+                float* row = &m_depth[y * m_pitch];
+
+                for (int32_t x = x0; x <= x1; x += simd::width)
+                {
+                    simd::vfloat px = simd::set1(static_cast<float>(x)) + lane_offset;
+
+                    simd::vmask inside = (a0 * px + r0 >= zero) & (a1 * px + r1 >= zero) & (a2 * px + r2 >= zero);
+
+                    simd::vfloat z = za * px + rz;
+                    simd::vfloat current = simd::load(row + x);
+
+                    simd::store(row + x, simd::select(inside & (z < current), z, current));
+                }
+            }
+        }
+
+        // max por bloco para o teste hierarquico
+        uint32_t blocks_x = m_pitch / k_hiz_size;
+        for (uint32_t by = 0; by < k_tile_size; by += k_hiz_size)
+        {
+            for (uint32_t bx = 0; bx < k_tile_size; bx += k_hiz_size)
+            {
+                float max_depth = 0.0f;
+                for (uint32_t y = 0; y < k_hiz_size; y++)
+                {
+                    const float* row = &m_depth[(tile_y + by + y) * m_pitch + tile_x + bx];
+                    for (uint32_t x = 0; x < k_hiz_size; x++)
+                        max_depth = std::max(max_depth, row[x]);
+                }
+
+                m_hiz[((tile_y + by) / k_hiz_size) * blocks_x + (tile_x + bx) / k_hiz_size] = max_depth;
+            }
+        }
+    }
+
+    bool occlusion_culler::is_visible(const Vector3& min, const Vector3& max) const
+    {
+        float half_w = m_width * 0.5f;
+        float half_h = m_height * 0.5f;
+
+        float min_x = 1e30f, min_y = 1e30f, max_x = -1e30f, max_y = -1e30f;
+        float min_z = 1.0f;
+
+        for (int i = 0; i < 8; i++)
+        {
+            float clip[4];
+            transform(m_view_projection, (i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z, clip);
+
+            if (clip[3] < k_min_w || clip[2] < -clip[3])
+                return true;
+
+            float inv_w = 1.0f / clip[3];
+            float sx = (clip[0] * inv_w + 1.0f) * half_w;
+            float sy = (clip[1] * inv_w + 1.0f) * half_h;
+            float sz = clip[2] * inv_w * 0.5f + 0.5f;
+
+            min_x = std::min(min_x, sx);
+            max_x = std::max(max_x, sx);
+            min_y = std::min(min_y, sy);
+            max_y = std::max(max_y, sy);
+            min_z = std::min(min_z, sz);
+        }
+
+        int32_t x0 = std::max(0, static_cast<int32_t>(std::floor(min_x)));
+        int32_t y0 = std::max(0, static_cast<int32_t>(std::floor(min_y)));
+        int32_t x1 = std::min(static_cast<int32_t>(m_width) - 1, static_cast<int32_t>(std::floor(max_x)));
+        int32_t y1 = std::min(static_cast<int32_t>(m_height) - 1, static_cast<int32_t>(std::floor(max_y)));
+
+        // fora da tela e' responsabilidade do frustum culling
+        if (x0 > x1 || y0 > y1)
+            return true;
+
+        uint32_t blocks_x = m_pitch / k_hiz_size;
+
+        for (int32_t by = y0 / k_hiz_size; by <= y1 / static_cast<int32_t>(k_hiz_size); by++)
+        {
+            for (int32_t bx = x0 / k_hiz_size; bx <= x1 / static_cast<int32_t>(k_hiz_size); bx++)
+            {
+                if (min_z > m_hiz[by * blocks_x + bx])
+                    continue;
+
+                int32_t py0 = std::max(y0, by * static_cast<int32_t>(k_hiz_size));
+                int32_t py1 = std::min(y1, (by + 1) * static_cast<int32_t>(k_hiz_size) - 1);
+                int32_t px0 = std::max(x0, bx * static_cast<int32_t>(k_hiz_size));
+                int32_t px1 = std::min(x1, (bx + 1) * static_cast<int32_t>(k_hiz_size) - 1);
+
+                for (int32_t y = py0; y <= py1; y++)
+                {
+                    const float* row = &m_depth[y * m_pitch];
+                    for (int32_t x = px0; x <= px1; x++)
+                    {
+                        if (min_z <= row[x])
+                            return true;
+                    }
+                }
+            }
+        }
+
+        return false;
+    }
+
+    uint32_t occlusion_culler::test(const bounds_set& bounds, const uint32_t* candidates, uint32_t count, uint32_t* visible)
+    {
+        uint32_t chunks = (count + k_test_grain - 1) / k_test_grain;
+        std::vector<uint32_t> written(chunks);
+
+        const float* cx = bounds.box_center(0);
+        const float* cy = bounds.box_center(1);
+        const float* cz = bounds.box_center(2);
+        const float* ex = bounds.box_extent(0);
+        const float* ey = bounds.box_extent(1);
+        const float* ez = bounds.box_extent(2);
+
+        m_pool->parallel_for(count, k_test_grain, [&](uint32_t begin, uint32_t end) {
+            uint32_t* out = visible + begin;
+            uint32_t n = 0;
+
+            for (uint32_t i = begin; i < end; i++)
+            {
+                uint32_t object = candidates[i];
+
+                Vector3 min{cx[object] - ex[object], cy[object] - ey[object], cz[object] - ez[object]};
+                Vector3 max{cx[object] + ex[object], cy[object] + ey[object], cz[object] + ez[object]};
+
+                if (is_visible(min, max))
+                    out[n++] = object;
+            }
+
+            written[begin / k_test_grain] = n;
+        });
+
+        uint32_t total = 0;
+        for (uint32_t c = 0; c < chunks; c++)
+        {
+            if (total != c * k_test_grain)
+                std::memmove(visible + total, visible + c * k_test_grain, written[c] * sizeof(uint32_t));
+            total += written[c];
+        }
+
+        m_statistics.tested += count;
+        m_statistics.culled += count - total;
+
+        return total;
+    }
+}
@@ -0,0 +1,94 @@
+#include "platform/null/null_device.hpp"
+
+#include "context_state.hpp"
+
+namespace gr
+{
+    std::atomic<bool> null_device::s_active{false};
+
+    thread_local null_statistics null_device::s_statistics;
+
+    thread_local const char* null_device::s_last_error = nullptr;
+
+    void null_device::set_active(bool active)
+    {
+        s_active.store(active, std::memory_order_relaxed);
+    }
+
+    bool null_device::check(const char* call, bool valid)
+    {
+        s_statistics.calls++;
+
+        if (!valid)
+        {
+            s_statistics.validation_errors++;
+            s_last_error = call;
+        }
+
+        return valid;
+    }
+
+    u32 null_device::create_object(null_object type)
+    {
+        context_state& state = context_state::current();
+
+        u32 name = state.null_next_name++;
+        state.null_objects.emplace(name, type);
+
+        s_statistics.objects_created++;
+        return name;
+    }
+
+    bool null_device::destroy_object(null_object type, u32 name, const char* call)
+    {
+        if (name == 0)
+            return true;
+
+        context_state& state = context_state::current();
+
+        auto it = state.null_objects.find(name);
+        if (!check(call, it != state.null_objects.end() && it->second == type))
+            return false;
+
+        state.null_objects.erase(it);
+
+        if (state.null_program == name)
+            state.null_program = 0;
+        if (state.null_vertex_array == name)
+            state.null_vertex_array = 0;
+
+        s_statistics.objects_destroyed++;
+        return true;
+    }
+
+    bool null_device::is_object(null_object type, u32 name)
+    {
+        const context_state& state = context_state::current();
+
+        auto it = state.null_objects.find(name);
+        return it != state.null_objects.end() && it->second == type;
+    }
+
+    void null_device::bind_program(u32 name)
+    {
+        context_state::current().null_program = name;
+    }
+
+    void null_device::bind_vertex_array(u32 name)
+    {
+        context_state::current().null_vertex_array = name;
+    }
+
+    bool null_device::check_draw(const char* call, PrimitiveType primitive)
+    {
+        const context_state& state = context_state::current();
+
+        return check(call, primitive <= TRIANGLES_FAN && state.null_program != 0 && state.null_vertex_array != 0);
+    }
+
+    void null_device::reset_statistics()
+    {
+        s_statistics = null_statistics();
+        s_last_error = nullptr;
+    }
+}
@@ -0,0 +1,44 @@
+#include "platform/null/null_index_buffer.hpp"
+
+#include "memory_tracker.hpp"
+#include "platform/null/null_device.hpp"
+#include "render_stats.hpp"
+
+namespace gr
+{
+    null_index_buffer::null_index_buffer(const void* data, uint32_t size) : m_id(0)
+    {
+        null_device::check("index_buffer::create", size % sizeof(uint32_t) == 0);
+
+        m_id = null_device::create_object(null_object::buffer);
+
+        if (data != nullptr)
+            render_stats::count_buffer_upload(size);
+
+        memory_tracker::track(memory_category::index_buffer, m_id, size);
+    }
+
+    null_index_buffer::~null_index_buffer()
+    {
+        memory_tracker::untrack(memory_category::index_buffer, m_id);
+
+        null_device::destroy_object(null_object::buffer, m_id, "index_buffer::~index_buffer");
+    }
+
+    void null_index_buffer::Bind()
+    {
+        null_device::check("index_buffer::Bind");
+
+        render_stats::count_buffer_bind();
+    }
+
+    void null_index_buffer::Unbind()
+    {
+        null_device::check("index_buffer::Unbind");
+    }
+
+    void null_index_buffer::SetDebugName(const char* name)
+    {
+        memory_tracker::set_debug_name(memory_category::index_buffer, m_id, name);
+    }
+}
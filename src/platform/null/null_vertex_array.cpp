@@ -0,0 +1,57 @@
+#include "platform/null/null_vertex_array.hpp"
+
+#include "platform/null/null_device.hpp"
+#include "render_stats.hpp"
+#include "trace_recorder.hpp"
+
+namespace gr
+{
+    null_vertex_array::null_vertex_array() : m_id(0)
+    {
+        null_device::check("vertex_array::create");
+
+        m_id = null_device::create_object(null_object::vertex_array);
+    }
+
+    null_vertex_array::~null_vertex_array()
+    {
+        null_device::destroy_object(null_object::vertex_array, m_id, "vertex_array::~vertex_array");
+    }
+
+    void null_vertex_array::Bind() const
+    {
+        trace_recorder::record(trace_op::vertex_array_bind, trace_recorder::key(this));
+
+        null_device::check("vertex_array::Bind");
+        null_device::bind_vertex_array(m_id);
+
+        render_stats::count_vertex_array_bind();
+    }
+
+    void null_vertex_array::Unbind() const
+    {
+        null_device::check("vertex_array::Unbind");
+        null_device::bind_vertex_array(0);
+    }
+
+    void null_vertex_array::AddVertexBuffer(std::shared_ptr<vertex_buffer>& vbo)
+    {
+        // o layout precisa vir antes, como nos outros backends
+        if (!null_device::check("vertex_array::AddVertexBuffer", vbo != nullptr && !vbo->GetLayout().get_elements().empty()))
+            return;
+
+        trace_add_vertex_buffer(*vbo);
+
+        m_vertex_buffers.push_back(vbo);
+    }
+
+    void null_vertex_array::SetIndexBuffer(std::shared_ptr<index_buffer>& ibo)
+    {
+        if (!null_device::check("vertex_array::SetIndexBuffer", ibo != nullptr))
+            return;
+
+        trace_recorder::record(trace_op::vertex_array_index_buffer, trace_recorder::key(this), trace_recorder::key(ibo.get()));
+
+        m_index_buffer = ibo;
+    }
+}
@@ -0,0 +1,64 @@
+#include "platform/null/null_vertex_buffer.hpp"
+
+#include "memory_tracker.hpp"
+#include "platform/null/null_device.hpp"
+#include "render_stats.hpp"
+#include "trace_recorder.hpp"
+
+namespace gr
+{
+    null_vertex_buffer::null_vertex_buffer(const void* data, uint32_t size, buffer_usage usage) : m_id(0), m_size(size)
+    {
+        null_device::check("vertex_buffer::create");
+
+        m_id = null_device::create_object(null_object::buffer);
+        m_usage = usage;
+
+        memory_tracker::track(memory_category::vertex_buffer, m_id, size);
+
+        if (data != nullptr)
+            render_stats::count_buffer_upload(size);
+    }
+
+    null_vertex_buffer::~null_vertex_buffer()
+    {
+        memory_tracker::untrack(memory_category::vertex_buffer, m_id);
+
+        null_device::destroy_object(null_object::buffer, m_id, "vertex_buffer::~vertex_buffer");
+    }
+
+    void null_vertex_buffer::Bind()
+    {
+        null_device::check("vertex_buffer::Bind");
+
+        render_stats::count_buffer_bind();
+    }
+
+    void null_vertex_buffer::Unbind()
+    {
+        null_device::check("vertex_buffer::Unbind");
+    }
+
+    void null_vertex_buffer::SetData(const void* data, uint32_t size)
+    {
+        trace_recorder::record(trace_op::vertex_buffer_data, trace_recorder::key(this), trace_blob{data, size});
+
+        if (!null_device::check("vertex_buffer::SetData", data != nullptr || size == 0))
+            return;
+
+        if (size > m_size)
+        {
+            m_size = size;
+
+            memory_tracker::track(memory_category::vertex_buffer, m_id, size);
+        }
+
+        render_stats::count_buffer_bind();
+        render_stats::count_buffer_upload(size);
+    }
+
+    void null_vertex_buffer::SetDebugName(const char* name)
+    {
+        memory_tracker::set_debug_name(memory_category::vertex_buffer, m_id, name);
+    }
+}
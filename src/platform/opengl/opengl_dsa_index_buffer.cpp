@@ -0,0 +1,48 @@
+#include "platform/opengl/opengl_dsa_index_buffer.hpp"
+
+#include "gl.h"
+#include "memory_tracker.hpp"
+#include "render_stats.hpp"
+
+#if !GR_OPENGLES3
+
+namespace gr
+{
+    opengl_dsa_index_buffer::opengl_dsa_index_buffer(const void* data, uint32_t size) : m_id(0)
+    {
+        // sem bind: nao troca o element array do VAO ligado
+        glCreateBuffers(1, &m_id);
+        glNamedBufferData(m_id, size, data, GL_STATIC_DRAW);
+
+        if (data != nullptr)
+            render_stats::count_buffer_upload(size);
+
+        memory_tracker::track(memory_category::index_buffer, m_id, size);
+    }
+
+    opengl_dsa_index_buffer::~opengl_dsa_index_buffer()
+    {
+        memory_tracker::untrack(memory_category::index_buffer, m_id);
+
+        grr::delete_buffers(1, &m_id);
+    }
+
+    void opengl_dsa_index_buffer::Bind()
+    {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
+
+        render_stats::count_buffer_bind();
+    }
+
+    void opengl_dsa_index_buffer::Unbind()
+    {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+
+    void opengl_dsa_index_buffer::SetDebugName(const char* name)
+    {
+        memory_tracker::set_debug_name(memory_category::index_buffer, m_id, name);
+    }
+}
+
+#endif // !GR_OPENGLES3
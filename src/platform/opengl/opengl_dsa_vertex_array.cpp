@@ -0,0 +1,79 @@
+#include "platform/opengl/opengl_dsa_vertex_array.hpp"
+
+#include "gl.h"
+#include "render_stats.hpp"
+#include "trace_recorder.hpp"
+
+#if !GR_OPENGLES3
+
+namespace gr
+{
+    opengl_dsa_vertex_array::opengl_dsa_vertex_array() : m_vertex_buffer_index(0), m_id(0)
+    {
+        glCreateVertexArrays(1, &m_id);
+    }
+
+    opengl_dsa_vertex_array::~opengl_dsa_vertex_array()
+    {
+        glDeleteVertexArrays(1, &m_id);
+    }
+
+    void opengl_dsa_vertex_array::Bind() const
+    {
+        trace_recorder::record(trace_op::vertex_array_bind, trace_recorder::key(this));
+
+        glBindVertexArray(m_id);
+
+        render_stats::count_vertex_array_bind();
+    }
+
+    void opengl_dsa_vertex_array::Unbind() const
+    {
+        glBindVertexArray(0);
+    }
+
+    void opengl_dsa_vertex_array::AddVertexBuffer(std::shared_ptr<vertex_buffer>& vbo)
+    {
+        trace_add_vertex_buffer(*vbo);
+
+        const auto& layout = vbo->GetLayout();
+
+        // um binding por buffer; o divisor e do binding, entao vale para o buffer inteiro
+        GLuint binding = static_cast<GLuint>(m_vertex_buffers.size());
+        bool instanced = false;
+
+        for (const auto& element : layout)
+        {
+            glEnableVertexArrayAttrib(m_id, m_vertex_buffer_index);
+            glVertexArrayAttribFormat(
+                m_id,
+                m_vertex_buffer_index,
+                element.get_component_count(),
+                grr::get_base_type(element.type),
+                element.normalized ? GL_TRUE : GL_FALSE,
+                static_cast<GLuint>(element.offset)
+            );
+            glVertexArrayAttribBinding(m_id, m_vertex_buffer_index, binding);
+
+            instanced |= element.instanced;
+
+            m_vertex_buffer_index++;
+        }
+
+        glVertexArrayVertexBuffer(m_id, binding, vbo->GetID(), 0, layout.get_stride());
+        glVertexArrayBindingDivisor(m_id, binding, instanced ? 1 : 0);
+
+        m_vertex_buffers.push_back(vbo);
+    }
+
+    void opengl_dsa_vertex_array::SetIndexBuffer(std::shared_ptr<index_buffer>& ibo)
+    {
+        trace_recorder::record(trace_op::vertex_array_index_buffer, trace_recorder::key(this), trace_recorder::key(ibo.get()));
+
+        glVertexArrayElementBuffer(m_id, ibo->GetID());
+
+        m_index_buffer = ibo;
+    }
+}
+
+#endif // !GR_OPENGLES3
@@ -0,0 +1,69 @@
+#include "platform/opengl/opengl_dsa_vertex_buffer.hpp"
+
+#include "gl.h"
+#include "memory_tracker.hpp"
+#include "render_stats.hpp"
+#include "trace_recorder.hpp"
+
+#if !GR_OPENGLES3
+
+namespace gr
+{
+    opengl_dsa_vertex_buffer::opengl_dsa_vertex_buffer(const void* data, uint32_t size, buffer_usage usage) : m_size(size), m_id(0)
+    {
+        glCreateBuffers(1, &m_id);
+        glNamedBufferData(m_id, size, data, usage == buffer_usage::static_draw ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW);
+
+        m_usage = usage;
+
+        memory_tracker::track(memory_category::vertex_buffer, m_id, size);
+
+        if (data != nullptr)
+            render_stats::count_buffer_upload(size);
+    }
+
+    opengl_dsa_vertex_buffer::~opengl_dsa_vertex_buffer()
+    {
+        memory_tracker::untrack(memory_category::vertex_buffer, m_id);
+
+        grr::delete_buffers(1, &m_id);
+    }
+
+    void opengl_dsa_vertex_buffer::Bind()
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, m_id);
+
+        render_stats::count_buffer_bind();
+    }
+
+    void opengl_dsa_vertex_buffer::Unbind()
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    void opengl_dsa_vertex_buffer::SetData(const void* data, uint32_t size)
+    {
+        trace_recorder::record(trace_op::vertex_buffer_data, trace_recorder::key(this), trace_blob{data, size});
+
+        if (size > m_size)
+        {
+            m_size = size;
+
+            glNamedBufferData(m_id, size, data, m_usage == buffer_usage::static_draw ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW);
+
+            memory_tracker::track(memory_category::vertex_buffer, m_id, size);
+        } else
+        {
+            glNamedBufferSubData(m_id, 0, size, data);
+        }
+
+        render_stats::count_buffer_upload(size);
+    }
+
+    void opengl_dsa_vertex_buffer::SetDebugName(const char* name)
+    {
+        memory_tracker::set_debug_name(memory_category::vertex_buffer, m_id, name);
+    }
+}
+
+#endif // !GR_OPENGLES3
@@ -1,6 +1,8 @@
 #include "platform/opengl/opengl_index_buffer.hpp"
 
 #include "gl.h"
+#include "memory_tracker.hpp"
+#include "render_stats.hpp"
 
 namespace gr
 {
@@ -11,20 +13,34 @@ namespace gr
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+        if (data != nullptr)
+            render_stats::count_buffer_upload(size);
+
+        memory_tracker::track(memory_category::index_buffer, m_id, size);
     }
 
     opengl_index_buffer::~opengl_index_buffer()
     {
-        glDeleteBuffers(1, &m_id);
+        memory_tracker::untrack(memory_category::index_buffer, m_id);
+
+        grr::delete_buffers(1, &m_id);
     }
 
     void opengl_index_buffer::Bind()
     {
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
+
+        render_stats::count_buffer_bind();
     }
 
     void opengl_index_buffer::Unbind()
     {
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     }
+
+    void opengl_index_buffer::SetDebugName(const char* name)
+    {
+        memory_tracker::set_debug_name(memory_category::index_buffer, m_id, name);
+    }
 }
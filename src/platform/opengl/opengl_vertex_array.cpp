@@ -1,27 +1,12 @@
 #include "platform/opengl/opengl_vertex_array.hpp"
 
 #include "gl.h"
-
-
-static GLenum shader_data_type_to_opengl_base_type(gr::shader_data_type type)
-{
-    switch (type)
-    {
-        case gr::shader_data_type::Float:
-            return GL_FLOAT;
-        case gr::shader_data_type::Float2:
-            return GL_FLOAT;
-        case gr::shader_data_type::Float3:
-            return GL_FLOAT;
-        case gr::shader_data_type::Float4:
-            return GL_FLOAT;
-    }
-    return 0; 
-}
+#include "render_stats.hpp"
+#include "trace_recorder.hpp"
 
 namespace gr
 {
-    opengl_vertex_array::opengl_vertex_array() : m_id(0), m_vertex_buffer_index(0)
+    opengl_vertex_array::opengl_vertex_array() : m_vertex_buffer_index(0), m_id(0)
     {
         glGenVertexArrays(1, &m_id);
     }
@@ -33,7 +18,11 @@ namespace gr
 
     void opengl_vertex_array::Bind() const
     {
+        trace_recorder::record(trace_op::vertex_array_bind, trace_recorder::key(this));
+
         glBindVertexArray(m_id);
+
+        render_stats::count_vertex_array_bind();
     }
 
     void opengl_vertex_array::Unbind() const
@@ -43,6 +32,8 @@ namespace gr
 
     void opengl_vertex_array::AddVertexBuffer(std::shared_ptr<vertex_buffer>& vbo)
     {
+        trace_add_vertex_buffer(*vbo);
+
         Bind();
         vbo->Bind();
 
@@ -55,7 +46,7 @@ namespace gr
             glVertexAttribPointer(
                 m_vertex_buffer_index,
                 element.get_component_count(),
-                shader_data_type_to_opengl_base_type(element.type),
+                grr::get_base_type(element.type),
                 element.normalized ? GL_TRUE : GL_FALSE,
                 layout.get_stride(),
                 (const void*)element.offset
@@ -74,6 +65,8 @@ namespace gr
 
     void opengl_vertex_array::SetIndexBuffer(std::shared_ptr<index_buffer>& ibo)
     {
+        trace_recorder::record(trace_op::vertex_array_index_buffer, trace_recorder::key(this), trace_recorder::key(ibo.get()));
+
         Bind();
         ibo->Bind();
         Unbind();
@@ -1,11 +1,14 @@
 #include "platform/opengl/opengl_vertex_buffer.hpp"
 
 #include "gl.h"
+#include "memory_tracker.hpp"
+#include "render_stats.hpp"
+#include "trace_recorder.hpp"
 #include <iostream>
 
 namespace gr
 {
-    opengl_vertex_buffer::opengl_vertex_buffer(const void* data, uint32_t size, buffer_usage usage) : m_id(0), m_size(size)
+    opengl_vertex_buffer::opengl_vertex_buffer(const void* data, uint32_t size, buffer_usage usage) : m_size(size), m_id(0)
     {
         glGenBuffers(1, &m_id);
 
@@ -14,16 +17,25 @@ namespace gr
         glBindBuffer(GL_ARRAY_BUFFER, 0);
 
         m_usage = usage;
+
+        memory_tracker::track(memory_category::vertex_buffer, m_id, size);
+
+        if (data != nullptr)
+            render_stats::count_buffer_upload(size);
     }
 
     opengl_vertex_buffer::~opengl_vertex_buffer()
     {
-        glDeleteBuffers(1, &m_id);
+        memory_tracker::untrack(memory_category::vertex_buffer, m_id);
+
+        grr::delete_buffers(1, &m_id);
     }
 
     void opengl_vertex_buffer::Bind()
     {
         glBindBuffer(GL_ARRAY_BUFFER, m_id);
+
+        render_stats::count_buffer_bind();
     }
 
     void opengl_vertex_buffer::Unbind()
@@ -33,14 +45,26 @@ namespace gr
 
     void opengl_vertex_buffer::SetData(const void* data, uint32_t size)
     {
+        trace_recorder::record(trace_op::vertex_buffer_data, trace_recorder::key(this), trace_blob{data, size});
+
         glBindBuffer(GL_ARRAY_BUFFER, m_id);
         if (size > m_size)
         {
             m_size = size;
 
             glBufferData(GL_ARRAY_BUFFER, size, data, m_usage == buffer_usage::static_draw ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW);
+
+            memory_tracker::track(memory_category::vertex_buffer, m_id, size);
         }
         glBufferSubData(GL_ARRAY_BUFFER, 0, size, data);
         glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        render_stats::count_buffer_bind();
+        render_stats::count_buffer_upload(size);
+    }
+
+    void opengl_vertex_buffer::SetDebugName(const char* name)
+    {
+        memory_tracker::set_debug_name(memory_category::vertex_buffer, m_id, name);
     }
 }
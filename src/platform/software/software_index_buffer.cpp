@@ -0,0 +1,12 @@
+#include "platform/software/software_index_buffer.hpp"
+
+#include <cstring>
+
+namespace gr
+{
+    software_index_buffer::software_index_buffer(const void* data, uint32_t size) : m_indices(size / sizeof(uint32_t))
+    {
+        if (data != nullptr && !m_indices.empty())
+            std::memcpy(m_indices.data(), data, m_indices.size() * sizeof(uint32_t));
+    }
+}
@@ -0,0 +1,651 @@
+#include "platform/software/software_rasterizer.hpp"
+
+#include "platform/software/software_index_buffer.hpp"
+#include "platform/software/software_vertex_buffer.hpp"
+
+#include "gTexture.h"
+#include "render_stats.hpp"
+#include "simd.hpp"
+#include "thread_pool.hpp"
+#include "vertex_array.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace gr
+{
+    namespace
+    {
+        constexpr float k_subpixel = 16.0f;
+
+        // metade da faixa do ponto fixo; com k_max_size as arestas cabem em int64
+        // e, dentro de um tile, em int32
+        constexpr float k_guard_band = 8000.0f;
+
+        constexpr float k_min_w = 1e-5f;
+
+        constexpr uint32_t k_max_attributes = 16;
+
+        constexpr uint32_t k_max_clip_vertices = 16;
+
+        constexpr uint32_t k_vertex_grain = 256;
+
+        constexpr uint32_t k_triangle_grain = 512;
+
+        // 4 edge values, one per pixel of a row
+#if GR_SIMD_SSE || GR_SIMD_AVX
+        struct vint4 { __m128i v; };
+
+        inline vint4 set1_i(int32_t x) { return {_mm_set1_epi32(x)}; }
+        inline vint4 ramp_i(int32_t step) { return {_mm_setr_epi32(0, step, step * 2, step * 3)}; }
+        inline vint4 operator+(vint4 a, vint4 b) { return {_mm_add_epi32(a.v, b.v)}; }
+        inline vint4 operator|(vint4 a, vint4 b) { return {_mm_or_si128(a.v, b.v)}; }
+        inline uint32_t sign_mask(vint4 a) { return static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(a.v))); }
+#elif GR_SIMD_NEON
+        struct vint4 { int32x4_t v; };
+
+        inline vint4 set1_i(int32_t x) { return {vdupq_n_s32(x)}; }
+        inline vint4 ramp_i(int32_t step) { const int32_t r[4] = {0, step, step * 2, step * 3}; return {vld1q_s32(r)}; }
+        inline vint4 operator+(vint4 a, vint4 b) { return {vaddq_s32(a.v, b.v)}; }
+        inline vint4 operator|(vint4 a, vint4 b) { return {vorrq_s32(a.v, b.v)}; }
+        inline uint32_t sign_mask(vint4 a)
+        {
+            const int32_t shifts[4] = {0, 1, 2, 3};
+            uint32x4_t bits = vshlq_u32(vshrq_n_u32(vreinterpretq_u32_s32(a.v), 31), vld1q_s32(shifts));
+#if defined(__aarch64__)
+            return vaddvq_u32(bits);
+#else
+            // ARMv7 nao tem soma horizontal
+            uint32x2_t sum = vadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+            return vget_lane_u32(vpadd_u32(sum, sum), 0);
+#endif
+        }
+#else
+        struct vint4 { int32_t v[4]; };
+
+        inline vint4 set1_i(int32_t x) { return {{x, x, x, x}}; }
+        inline vint4 ramp_i(int32_t step) { return {{0, step, step * 2, step * 3}}; }
+        inline vint4 operator+(vint4 a, vint4 b) { return {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}}; }
+        inline vint4 operator|(vint4 a, vint4 b) { return {{a.v[0] | b.v[0], a.v[1] | b.v[1], a.v[2] | b.v[2], a.v[3] | b.v[3]}}; }
+        inline uint32_t sign_mask(vint4 a)
+        {
+            return (a.v[0] < 0 ? 1u : 0u) | (a.v[1] < 0 ? 2u : 0u) | (a.v[2] < 0 ? 4u : 0u) | (a.v[3] < 0 ? 8u : 0u);
+        }
+#endif
+
+        struct attribute
+        {
+            const uint8_t* data;
+
+            uint32_t stride;
+
+            bool instanced;
+        };
+
+        inline uint8_t to_unorm8(float x)
+        {
+            x = std::min(std::max(x, 0.0f), 1.0f);
+            return static_cast<uint8_t>(x * 255.0f + 0.5f);
+        }
+
+        inline float plane_at(const float* plane, float x, float y)
+        {
+            return plane[0] * x + plane[1] * y + plane[2];
+        }
+    }
+
+    struct software_rasterizer::clip_vertex
+    {
+        // x, y, z, w e os varyings
+        float data[4 + software_pipeline::k_max_varyings];
+    };
+
+    software_target::software_target(uint32_t width, uint32_t height)
+        : m_width(std::min(std::max(width, 1u), k_max_size)), m_height(std::min(std::max(height, 1u), k_max_size))
+    {
+        m_color.assign(static_cast<size_t>(m_width) * m_height * 4, 0);
+        m_depth.assign(static_cast<size_t>(m_width) * m_height, 1.0f);
+    }
+
+    void software_target::clear(const Color& color, float depth)
+    {
+        const uint8_t rgba[4] = {to_unorm8(color.r), to_unorm8(color.g), to_unorm8(color.b), to_unorm8(color.a)};
+
+        for (size_t i = 0; i < m_color.size(); i += 4)
+        {
+            m_color[i + 0] = rgba[0];
+            m_color[i + 1] = rgba[1];
+            m_color[i + 2] = rgba[2];
+            m_color[i + 3] = rgba[3];
+        }
+
+        clear_depth(depth);
+    }
+
+    void software_target::clear_depth(float depth)
+    {
+        std::fill(m_depth.begin(), m_depth.end(), depth);
+    }
+
+    void software_target::copy_to(gTexture& texture)
+    {
+        texture.set_format(TextureFormat_RGBA8888);
+        texture.updateBuffer(m_width, m_height, m_color.data());
+    }
+
+    software_rasterizer::software_rasterizer(thread_pool* pool) : m_pool(pool ? pool : &thread_pool::get_default())
+    {
+    }
+
+    bool software_rasterizer::draw(const software_pipeline& pipeline, const vertex_array& vao, PrimitiveType primitive, uint32_t count, software_target& target)
+    {
+        if (!pipeline.vertex || !pipeline.fragment || pipeline.varying_count > software_pipeline::k_max_varyings)
+            return false;
+
+        if (primitive != TRIANGLES && primitive != TRIANGLES_STRIP && primitive != TRIANGLES_FAN)
+            return false;
+
+        // atributos na ordem do layout, como os indices de um VAO
+        attribute attributes[k_max_attributes];
+        uint32_t attribute_count = 0;
+        uint32_t vertex_count = UINT32_MAX;
+
+        for (const auto& vbo : vao.GetVertexBuffers())
+        {
+            const software_vertex_buffer* buffer = dynamic_cast<const software_vertex_buffer*>(vbo.get());
+            if (buffer == nullptr)
+                return false;
+
+            const buffer_layout& layout = buffer->GetLayout();
+            uint32_t stride = layout.get_stride();
+            bool instanced = false;
+
+            for (const auto& element : layout)
+            {
+                if (attribute_count == k_max_attributes)
+                    return false;
+
+                attributes[attribute_count++] = {buffer->get_data() + element.offset, stride, element.instanced};
+                instanced |= element.instanced;
+            }
+
+            if (!instanced && stride > 0)
+                vertex_count = std::min(vertex_count, buffer->get_size() / stride);
+        }
+
+        if (vertex_count == UINT32_MAX)
+            vertex_count = 0;
+
+        const software_index_buffer* ibo = nullptr;
+        if (vao.GetIndexBuffer() != nullptr)
+        {
+            ibo = dynamic_cast<const software_index_buffer*>(vao.GetIndexBuffer().get());
+            if (ibo == nullptr)
+                return false;
+
+            count = std::min(count, ibo->get_count());
+        } else
+        {
+            count = std::min(count, vertex_count);
+        }
+
+        render_stats::count_draw(primitive, count);
+
+        // strips e fans viram lista
+        auto source = [ibo](uint32_t i) { return ibo != nullptr ? ibo->get_data()[i] : i; };
+
+        m_indices.clear();
+        if (primitive == TRIANGLES)
+        {
+            for (uint32_t i = 0; i + 2 < count; i += 3)
+                m_indices.insert(m_indices.end(), {source(i), source(i + 1), source(i + 2)});
+        } else if (primitive == TRIANGLES_STRIP)
+        {
+            for (uint32_t i = 0; i + 2 < count; i++)
+            {
+                if (i & 1)
+                    m_indices.insert(m_indices.end(), {source(i + 1), source(i), source(i + 2)});
+                else
+                    m_indices.insert(m_indices.end(), {source(i), source(i + 1), source(i + 2)});
+            }
+        } else
+        {
+            for (uint32_t i = 1; i + 1 < count; i++)
+                m_indices.insert(m_indices.end(), {source(0), source(i), source(i + 1)});
+        }
+
+        uint32_t triangle_count = static_cast<uint32_t>(m_indices.size() / 3);
+        if (triangle_count == 0)
+            return true;
+
+        // sem indice so os vertices desenhados passam pelo shader
+        uint32_t shaded = ibo != nullptr ? vertex_count : std::min(vertex_count, count);
+        uint32_t vertex_size = 4 + pipeline.varying_count;
+
+        m_vertices.resize(static_cast<size_t>(shaded) * vertex_size);
+        m_pool->parallel_for(shaded, k_vertex_grain, [&](uint32_t begin, uint32_t end) {
+            const float* inputs[k_max_attributes];
+            for (uint32_t v = begin; v < end; v++)
+            {
+                for (uint32_t a = 0; a < attribute_count; a++)
+                    inputs[a] = reinterpret_cast<const float*>(attributes[a].data + (attributes[a].instanced ? 0 : static_cast<size_t>(v) * attributes[a].stride));
+
+                float* out = &m_vertices[static_cast<size_t>(v) * vertex_size];
+                pipeline.vertex(inputs, out, out + 4);
+            }
+        });
+
+        // clipping e setup por bloco; a concatenacao mantem a ordem de submissao
+        uint32_t chunks = (triangle_count + k_triangle_grain - 1) / k_triangle_grain;
+        m_setup.resize(chunks);
+        m_setup_planes.resize(chunks);
+        m_setup_culled.assign(chunks, 0);
+
+        m_pool->parallel_for(chunks, 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t chunk = begin; chunk < end; chunk++)
+            {
+                uint32_t first = chunk * k_triangle_grain;
+                setup_triangles(pipeline, target, first, std::min(first + k_triangle_grain, triangle_count), chunk);
+            }
+        });
+
+        m_triangles.clear();
+        m_planes.clear();
+        for (uint32_t chunk = 0; chunk < chunks; chunk++)
+        {
+            uint32_t base = static_cast<uint32_t>(m_planes.size());
+            for (triangle tri : m_setup[chunk])
+            {
+                tri.planes += base;
+                m_triangles.push_back(tri);
+            }
+            m_planes.insert(m_planes.end(), m_setup_planes[chunk].begin(), m_setup_planes[chunk].end());
+
+            m_statistics.culled += m_setup_culled[chunk];
+        }
+
+        m_statistics.vertices += shaded;
+        m_statistics.triangles += triangle_count;
+        m_statistics.rasterized_triangles += static_cast<uint32_t>(m_triangles.size());
+
+        // binning serial mantem a ordem dos triangulos em cada tile
+        uint32_t tiles_x = (target.get_width() + k_tile_size - 1) / k_tile_size;
+        uint32_t tiles_y = (target.get_height() + k_tile_size - 1) / k_tile_size;
+
+        m_bins.resize(tiles_x * tiles_y);
+        for (auto& bin : m_bins)
+            bin.clear();
+
+        for (uint32_t i = 0; i < m_triangles.size(); i++)
+        {
+            const triangle& tri = m_triangles[i];
+
+            uint32_t tx0 = tri.min_x / k_tile_size, tx1 = tri.max_x / k_tile_size;
+            uint32_t ty0 = tri.min_y / k_tile_size, ty1 = tri.max_y / k_tile_size;
+
+            for (uint32_t ty = ty0; ty <= ty1; ty++)
+            {
+                for (uint32_t tx = tx0; tx <= tx1; tx++)
+                    m_bins[ty * tiles_x + tx].push_back(i);
+            }
+
+            m_statistics.binned += (tx1 - tx0 + 1) * (ty1 - ty0 + 1);
+        }
+
+        m_counters.assign(tiles_x * tiles_y, tile_counters{0, 0});
+        m_pool->parallel_for(tiles_x * tiles_y, 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t tile = begin; tile < end; tile++)
+                rasterize_tile(pipeline, target, tile, tiles_x);
+        });
+
+        for (const auto& counters : m_counters)
+        {
+            m_statistics.fragments += counters.fragments;
+            m_statistics.written += counters.written;
+        }
+
+        return true;
+    }
+
+    // ********** private ********** //
+    void software_rasterizer::setup_triangles(const software_pipeline& pipeline, const software_target& target, uint32_t first, uint32_t last, uint32_t chunk)
+    {
+        m_setup[chunk].clear();
+        m_setup_planes[chunk].clear();
+
+        uint32_t vertex_size = 4 + pipeline.varying_count;
+        uint32_t shaded = static_cast<uint32_t>(m_vertices.size() / vertex_size);
+
+        // x <= g * w mantem as coordenadas de tela dentro de +-k_guard_band
+        float guard_x = 2.0f * k_guard_band / target.get_width() - 1.0f;
+        float guard_y = 2.0f * k_guard_band / target.get_height() - 1.0f;
+
+        // (x, y, z, w) . plane >= 0 e' dentro
+        const float planes[7][4] = {
+            {0.0f, 0.0f, 1.0f, 1.0f},       // near
+            {0.0f, 0.0f, -1.0f, 1.0f},      // far
+            {1.0f, 0.0f, 0.0f, guard_x},
+            {-1.0f, 0.0f, 0.0f, guard_x},
+            {0.0f, 1.0f, 0.0f, guard_y},
+            {0.0f, -1.0f, 0.0f, guard_y},
+            {0.0f, 0.0f, 0.0f, 1.0f}        // w > k_min_w
+        };
+
+        auto distance = [&](const float* p, int plane) {
+            const float* d = planes[plane];
+            return d[0] * p[0] + d[1] * p[1] + d[2] * p[2] + d[3] * p[3] - (plane == 6 ? k_min_w : 0.0f);
+        };
+
+        clip_vertex polygon[2][k_max_clip_vertices];
+
+        for (uint32_t t = first; t < last; t++)
+        {
+            const uint32_t* indices = &m_indices[t * 3];
+            if (indices[0] >= shaded || indices[1] >= shaded || indices[2] >= shaded)
+                continue;
+
+            uint32_t outside = 0;
+            for (int k = 0; k < 3; k++)
+            {
+                std::copy_n(&m_vertices[static_cast<size_t>(indices[k]) * vertex_size], vertex_size, polygon[0][k].data);
+
+                for (int plane = 0; plane < 7; plane++)
+                {
+                    if (distance(polygon[0][k].data, plane) < 0.0f)
+                        outside |= 1u << plane;
+                }
+            }
+
+            if (outside == 0)
+            {
+                setup_triangle(pipeline, target, polygon[0], chunk);
+                continue;
+            }
+
+            // Sutherland-Hodgman so contra os planos cruzados
+            uint32_t count = 3;
+            int current = 0;
+            for (int plane = 0; plane < 7 && count >= 3; plane++)
+            {
+                if ((outside & (1u << plane)) == 0)
+                    continue;
+
+                const clip_vertex* in = polygon[current];
+                clip_vertex* out = polygon[current ^ 1];
+                uint32_t out_count = 0;
+
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    const clip_vertex& a = in[i];
+                    const clip_vertex& b = in[(i + 1) % count];
+                    float da = distance(a.data, plane);
+                    float db = distance(b.data, plane);
+
+                    if (da >= 0.0f)
+                        out[out_count++] = a;
+
+                    if ((da >= 0.0f) != (db >= 0.0f))
+                    {
+                        float s = da / (da - db);
+                        clip_vertex& v = out[out_count++];
+                        for (uint32_t c = 0; c < vertex_size; c++)
+                            v.data[c] = a.data[c] + (b.data[c] - a.data[c]) * s;
+                    }
+                }
+
+                count = out_count;
+                current ^= 1;
+            }
+
+            if (count < 3)
+            {
+                m_setup_culled[chunk]++;
+                continue;
+            }
+
+            const clip_vertex* clipped = polygon[current];
+            for (uint32_t i = 1; i + 1 < count; i++)
+            {
+                const clip_vertex fan[3] = {clipped[0], clipped[i], clipped[i + 1]};
+                setup_triangle(pipeline, target, fan, chunk);
+            }
+        }
+    }
+
+    void software_rasterizer::setup_triangle(const software_pipeline& pipeline, const software_target& target, const clip_vertex* v, uint32_t chunk)
+    {
+        float half_w = target.get_width() * 0.5f;
+        float half_h = target.get_height() * 0.5f;
+
+        int64_t x[3], y[3];
+        float inv_w[3], z[3];
+
+        for (int k = 0; k < 3; k++)
+        {
+            const float* p = v[k].data;
+
+            inv_w[k] = 1.0f / p[3];
+            x[k] = static_cast<int64_t>(std::lround((p[0] * inv_w[k] + 1.0f) * half_w * k_subpixel));
+            y[k] = static_cast<int64_t>(std::lround((p[1] * inv_w[k] + 1.0f) * half_h * k_subpixel));
+            z[k] = p[2] * inv_w[k] * 0.5f + 0.5f;
+        }
+
+        int64_t area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+        bool front = area > 0;
+
+        if (area == 0 || (pipeline.cull == software_cull::back && !front) || (pipeline.cull == software_cull::front && front))
+        {
+            m_setup_culled[chunk]++;
+            return;
+        }
+
+        // ordem anti-horaria daqui em diante
+        int order[3] = {0, 1, 2};
+        if (!front)
+        {
+            std::swap(order[1], order[2]);
+            area = -area;
+        }
+
+        triangle tri;
+
+        int64_t min_x = INT64_MAX, min_y = INT64_MAX, max_x = INT64_MIN, max_y = INT64_MIN;
+        for (int k = 0; k < 3; k++)
+        {
+            int i = order[k], j = order[(k + 1) % 3];
+
+            tri.a[k] = y[i] - y[j];
+            tri.b[k] = x[j] - x[i];
+            tri.c[k] = -(tri.a[k] * x[i] + tri.b[k] * y[i]);
+
+            // top-left: a aresta compartilhada fica com um triangulo so
+            if (!(tri.a[k] > 0 || (tri.a[k] == 0 && tri.b[k] > 0)))
+                tri.c[k] -= 1;
+
+            min_x = std::min(min_x, x[i]);
+            min_y = std::min(min_y, y[i]);
+            max_x = std::max(max_x, x[i]);
+            max_y = std::max(max_y, y[i]);
+        }
+
+        // pixels cujo centro (16 * p + 8) cai no retangulo
+        const int64_t half = static_cast<int64_t>(k_subpixel) / 2;
+        tri.min_x = static_cast<int32_t>(std::max<int64_t>(0, (min_x - half + 15) >> 4));
+        tri.min_y = static_cast<int32_t>(std::max<int64_t>(0, (min_y - half + 15) >> 4));
+        tri.max_x = static_cast<int32_t>(std::min<int64_t>(target.get_width() - 1, (max_x - half) >> 4));
+        tri.max_y = static_cast<int32_t>(std::min<int64_t>(target.get_height() - 1, (max_y - half) >> 4));
+
+        if (tri.min_x > tri.max_x || tri.min_y > tri.max_y)
+        {
+            m_setup_culled[chunk]++;
+            return;
+        }
+
+        // planos sobre as posicoes ja arredondadas, em pixels
+        float sx[3], sy[3];
+        for (int k = 0; k < 3; k++)
+        {
+            sx[k] = x[order[k]] / k_subpixel;
+            sy[k] = y[order[k]] / k_subpixel;
+        }
+
+        double inv_area = (k_subpixel * k_subpixel) / static_cast<double>(area);
+        double dx1 = sx[1] - sx[0], dy1 = sy[1] - sy[0];
+        double dx2 = sx[2] - sx[0], dy2 = sy[2] - sy[0];
+
+        std::vector<float>& planes = m_setup_planes[chunk];
+        tri.planes = static_cast<uint32_t>(planes.size());
+
+        auto add_plane = [&](float q0, float q1, float q2) {
+            double qa = ((q1 - q0) * dy2 - (q2 - q0) * dy1) * inv_area;
+            double qb = ((q2 - q0) * dx1 - (q1 - q0) * dx2) * inv_area;
+            planes.push_back(static_cast<float>(qa));
+            planes.push_back(static_cast<float>(qb));
+            planes.push_back(static_cast<float>(q0 - qa * sx[0] - qb * sy[0]));
+        };
+
+        add_plane(z[order[0]], z[order[1]], z[order[2]]);
+        add_plane(inv_w[order[0]], inv_w[order[1]], inv_w[order[2]]);
+
+        for (uint32_t i = 0; i < pipeline.varying_count; i++)
+        {
+            add_plane(v[order[0]].data[4 + i] * inv_w[order[0]], v[order[1]].data[4 + i] * inv_w[order[1]],
+                v[order[2]].data[4 + i] * inv_w[order[2]]);
+        }
+
+        m_setup[chunk].push_back(tri);
+    }
+
+    void software_rasterizer::rasterize_tile(const software_pipeline& pipeline, software_target& target, uint32_t tile, uint32_t tiles_x)
+    {
+        const int32_t width = static_cast<int32_t>(target.get_width());
+        const int32_t height = static_cast<int32_t>(target.get_height());
+
+        const int32_t tile_x = static_cast<int32_t>((tile % tiles_x) * k_tile_size);
+        const int32_t tile_y = static_cast<int32_t>((tile / tiles_x) * k_tile_size);
+
+        uint8_t* color = target.get_color();
+        float* depth = target.get_depth();
+
+        tile_counters& counters = m_counters[tile];
+
+        float varyings[software_pipeline::k_max_varyings];
+        float rgba[4];
+
+        for (uint32_t index : m_bins[tile])
+        {
+            const triangle& tri = m_triangles[index];
+            const float* planes = &m_planes[tri.planes];
+
+            int32_t x0 = std::max(tri.min_x, tile_x);
+            int32_t x1 = std::min({tri.max_x, tile_x + static_cast<int32_t>(k_tile_size) - 1, width - 1});
+            int32_t y0 = std::max(tri.min_y, tile_y);
+            int32_t y1 = std::min({tri.max_y, tile_y + static_cast<int32_t>(k_tile_size) - 1, height - 1});
+
+            if (x0 > x1 || y0 > y1)
+                continue;
+
+            // inicio da linha alinhado a 4 pixels dentro do tile
+            int32_t xs = tile_x + (x0 - tile_x) / 4 * 4;
+
+            auto edge = [&tri](int k, int32_t px, int32_t py) {
+                return tri.a[k] * (px * 16 + 8) + tri.b[k] * (py * 16 + 8) + tri.c[k];
+            };
+
+            // teste nos cantos: a aresta e' linear, o minimo e o maximo estao neles
+            bool rejected = false;
+            bool partial[3];
+            for (int k = 0; k < 3 && !rejected; k++)
+            {
+                int64_t e00 = edge(k, x0, y0), e10 = edge(k, x1, y0), e01 = edge(k, x0, y1), e11 = edge(k, x1, y1);
+                int64_t lo = std::min({e00, e10, e01, e11});
+                int64_t hi = std::max({e00, e10, e01, e11});
+
+                rejected = hi < 0;
+                partial[k] = lo < 0;
+            }
+
+            if (rejected)
+                continue;
+
+            // arestas parciais cruzam o retangulo: os valores dentro dele cabem em int32
+            vint4 row[3], step_x[3];
+            int32_t step_y[3];
+            for (int k = 0; k < 3; k++)
+            {
+                if (partial[k])
+                {
+                    row[k] = set1_i(static_cast<int32_t>(edge(k, xs, y0))) + ramp_i(static_cast<int32_t>(tri.a[k] * 16));
+                    step_x[k] = set1_i(static_cast<int32_t>(tri.a[k] * 64));
+                    step_y[k] = static_cast<int32_t>(tri.b[k] * 16);
+                } else
+                {
+                    row[k] = set1_i(0);
+                    step_x[k] = set1_i(0);
+                    step_y[k] = 0;
+                }
+            }
+
+            for (int32_t py = y0; py <= y1; py++)
+            {
+                vint4 e0 = row[0], e1 = row[1], e2 = row[2];
+                float fy = py + 0.5f;
+
+                for (int32_t px = xs; px <= x1; px += 4)
+                {
+                    uint32_t mask = ~sign_mask(e0 | e1 | e2) & 0xFu;
+
+                    e0 = e0 + step_x[0];
+                    e1 = e1 + step_x[1];
+                    e2 = e2 + step_x[2];
+
+                    while (mask != 0)
+                    {
+                        int lane = simd::count_trailing_zeros(mask);
+                        mask &= mask - 1;
+
+                        int32_t x = px + lane;
+                        if (x < x0 || x > x1)
+                            continue;
+
+                        float fx = x + 0.5f;
+                        size_t pixel = static_cast<size_t>(py) * width + x;
+
+                        float z = plane_at(planes, fx, fy);
+                        if (pipeline.depth_test && !(z < depth[pixel]))
+                            continue;
+
+                        float w = 1.0f / plane_at(planes + 3, fx, fy);
+                        for (uint32_t i = 0; i < pipeline.varying_count; i++)
+                            varyings[i] = plane_at(planes + 6 + i * 3, fx, fy) * w;
+
+                        counters.fragments++;
+
+                        if (!pipeline.fragment(varyings, rgba))
+                            continue;
+
+                        uint8_t* out = color + pixel * 4;
+                        if (pipeline.blend)
+                        {
+                            float alpha = std::min(std::max(rgba[3], 0.0f), 1.0f);
+                            for (int c = 0; c < 4; c++)
+                                out[c] = to_unorm8(rgba[c] * alpha + (out[c] / 255.0f) * (1.0f - alpha));
+                        } else
+                        {
+                            for (int c = 0; c < 4; c++)
+                                out[c] = to_unorm8(rgba[c]);
+                        }
+
+                        if (pipeline.depth_test && pipeline.depth_write)
+                            depth[pixel] = z;
+
+                        counters.written++;
+                    }
+                }
+
+                for (int k = 0; k < 3; k++)
+                    row[k] = row[k] + set1_i(step_y[k]);
+            }
+        }
+    }
+}
@@ -0,0 +1,20 @@
+#include "platform/software/software_vertex_array.hpp"
+
+#include "trace_recorder.hpp"
+
+namespace gr
+{
+    void software_vertex_array::AddVertexBuffer(std::shared_ptr<vertex_buffer>& vbo)
+    {
+        trace_add_vertex_buffer(*vbo);
+
+        m_vertex_buffers.push_back(vbo);
+    }
+
+    void software_vertex_array::SetIndexBuffer(std::shared_ptr<index_buffer>& ibo)
+    {
+        trace_recorder::record(trace_op::vertex_array_index_buffer, trace_recorder::key(this), trace_recorder::key(ibo.get()));
+
+        m_index_buffer = ibo;
+    }
+}
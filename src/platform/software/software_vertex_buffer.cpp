@@ -0,0 +1,28 @@
+#include "platform/software/software_vertex_buffer.hpp"
+
+#include "trace_recorder.hpp"
+
+#include <cstring>
+
+namespace gr
+{
+    software_vertex_buffer::software_vertex_buffer(const void* data, uint32_t size, buffer_usage usage) : m_data(size)
+    {
+        m_usage = usage;
+
+        if (data != nullptr && size > 0)
+            std::memcpy(m_data.data(), data, size);
+    }
+
+    void software_vertex_buffer::SetData(const void* data, uint32_t size)
+    {
+        trace_recorder::record(trace_op::vertex_buffer_data, trace_recorder::key(this), trace_blob{data, size});
+
+        // como o glBufferSubData: so cresce
+        if (size > m_data.size())
+            m_data.resize(size);
+
+        if (data != nullptr && size > 0)
+            std::memcpy(m_data.data(), data, size);
+    }
+}
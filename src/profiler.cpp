@@ -0,0 +1,422 @@
+#include "profiler.hpp"
+
+#ifdef GR_ENABLE_PROFILER
+
+#include "gl.h"
+#include "platform/null/null_device.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace gr
+{
+    namespace
+    {
+        constexpr uint32_t k_query_chunk = 64;
+
+        struct profile_event
+        {
+            const char* name;
+            uint64_t cpu_begin;
+            uint64_t cpu_end;
+            uint32_t gpu_begin;
+            uint32_t gpu_end;
+            uint32_t thread;
+        };
+
+        struct frame_slot
+        {
+            std::vector<profile_event> events;
+
+            std::vector<uint32_t> queries;
+
+            uint32_t used_queries = 0;
+        };
+
+        struct trace_event
+        {
+            const char* name;
+            uint64_t timestamp;
+            uint64_t duration;
+            uint32_t thread;
+            bool gpu;
+        };
+
+        struct rolling_window
+        {
+            double cpu[profiler::k_stats_window];
+            double gpu[profiler::k_stats_window];
+            uint32_t cpu_count = 0;
+            uint32_t gpu_count = 0;
+            uint64_t samples = 0;
+            uint64_t gpu_samples = 0;
+        };
+
+        struct profiler_state
+        {
+            std::mutex mutex;
+
+            frame_slot frames[profiler::k_frame_latency];
+
+            uint32_t current = 0;
+
+            uint64_t frame_index = 0;
+
+            bool in_frame = false;
+
+            bool gpu_enabled = true;
+
+            bool calibrated = false;
+
+            // cpu_ns - gpu_ns, medido na primeira begin_frame
+            int64_t gpu_offset = 0;
+
+            std::thread::id render_thread;
+
+            std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+            std::vector<trace_event> trace;
+
+            size_t trace_capacity = 1 << 20;
+
+            std::unordered_map<std::string, rolling_window> stats;
+        };
+
+        profiler_state& state()
+        {
+            static profiler_state instance;
+            return instance;
+        }
+
+        uint64_t now_ns(const profiler_state& s)
+        {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s.epoch).count());
+        }
+
+        uint32_t thread_index()
+        {
+            static std::atomic<uint32_t> next{0};
+            thread_local uint32_t index = next++;
+            return index;
+        }
+
+        // RenderBackend::Null nao tem queries: so tempos de CPU
+        inline bool gpu_timing(const profiler_state& s)
+        {
+            return s.gpu_enabled && !null_device::is_active();
+        }
+
+        uint32_t issue_timestamp(profiler_state& s)
+        {
+#if !GR_OPENGLES3
+            if (!gpu_timing(s) || !s.in_frame || std::this_thread::get_id() != s.render_thread)
+                return GR_INVALID_ID;
+
+            frame_slot& slot = s.frames[s.current];
+            if (slot.used_queries == slot.queries.size())
+            {
+                size_t first = slot.queries.size();
+                slot.queries.resize(first + k_query_chunk);
+                GL_CALL(glGenQueries(k_query_chunk, &slot.queries[first]));
+            }
+
+            uint32_t index = slot.used_queries++;
+            GL_CALL(glQueryCounter(slot.queries[index], GL_TIMESTAMP));
+            return index;
+#else
+            return GR_INVALID_ID;
+#endif
+        }
+
+        void push_sample(double* window, uint32_t& count, uint64_t total, double value)
+        {
+            window[total % profiler::k_stats_window] = value;
+            if (count < profiler::k_stats_window)
+                count++;
+        }
+
+        void record(profiler_state& s, const profile_event& e, bool has_gpu, uint64_t gpu_begin, uint64_t gpu_end)
+        {
+            rolling_window& window = s.stats[e.name];
+
+            uint64_t cpu_duration = e.cpu_end > e.cpu_begin ? e.cpu_end - e.cpu_begin : 0;
+            push_sample(window.cpu, window.cpu_count, window.samples, cpu_duration * 1e-6);
+            window.samples++;
+
+            if (s.trace.size() < s.trace_capacity)
+                s.trace.push_back({e.name, e.cpu_begin, cpu_duration, e.thread, false});
+
+            if (!has_gpu)
+                return;
+
+            uint64_t gpu_duration = gpu_end > gpu_begin ? gpu_end - gpu_begin : 0;
+            push_sample(window.gpu, window.gpu_count, window.gpu_samples, gpu_duration * 1e-6);
+            window.gpu_samples++;
+
+            if (s.trace.size() < s.trace_capacity)
+            {
+                int64_t timestamp = static_cast<int64_t>(gpu_begin) + s.gpu_offset;
+                s.trace.push_back({e.name, static_cast<uint64_t>(std::max<int64_t>(timestamp, 0)), gpu_duration, 0, true});
+            }
+        }
+
+        // Consome os eventos de um frame antigo. Timestamps que ainda nao chegaram sao
+        // descartados: o profiler nunca espera pela GPU.
+        void resolve(profiler_state& s, frame_slot& slot)
+        {
+            bool available = false;
+
+#if !GR_OPENGLES3
+            if (slot.used_queries > 0)
+            {
+                GLuint ready = 0;
+                GL_CALL(glGetQueryObjectuiv(slot.queries[slot.used_queries - 1], GL_QUERY_RESULT_AVAILABLE, &ready));
+                available = ready != 0;
+            }
+#endif
+
+            for (const profile_event& e : slot.events)
+            {
+                uint64_t gpu_begin = 0, gpu_end = 0;
+                bool has_gpu = available && e.gpu_begin != GR_INVALID_ID && e.gpu_end != GR_INVALID_ID;
+
+#if !GR_OPENGLES3
+                if (has_gpu)
+                {
+                    GLuint64 value = 0;
+                    GL_CALL(glGetQueryObjectui64v(slot.queries[e.gpu_begin], GL_QUERY_RESULT, &value));
+                    gpu_begin = value;
+                    GL_CALL(glGetQueryObjectui64v(slot.queries[e.gpu_end], GL_QUERY_RESULT, &value));
+                    gpu_end = value;
+                }
+#endif
+
+                if (e.cpu_end != 0)
+                    record(s, e, has_gpu, gpu_begin, gpu_end);
+            }
+
+            slot.events.clear();
+            slot.used_queries = 0;
+        }
+
+        double percentile(const double* window, uint32_t count, double p)
+        {
+            std::vector<double> sorted(window, window + count);
+            std::sort(sorted.begin(), sorted.end());
+
+            size_t index = static_cast<size_t>(p * count);
+            return sorted[std::min<size_t>(index, count - 1)];
+        }
+
+        void write_json_string(std::ostream& out, const char* text)
+        {
+            out << '"';
+            for (const char* c = text; *c; c++)
+            {
+                if (*c == '"' || *c == '\\')
+                    out << '\\' << *c;
+                else if (static_cast<unsigned char>(*c) < 0x20)
+                    out << ' ';
+                else
+                    out << *c;
+            }
+            out << '"';
+        }
+    }
+
+    void profiler::begin_frame()
+    {
+        profiler_state& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+
+        s.render_thread = std::this_thread::get_id();
+
+#if !GR_OPENGLES3
+        if (gpu_timing(s) && !s.calibrated)
+        {
+            GLint64 gpu = 0;
+            GL_CALL(glGetInteger64v(GL_TIMESTAMP, &gpu));
+            s.gpu_offset = static_cast<int64_t>(now_ns(s)) - gpu;
+            s.calibrated = true;
+        }
+#endif
+
+        s.current = static_cast<uint32_t>(s.frame_index % k_frame_latency);
+        resolve(s, s.frames[s.current]);
+
+        s.in_frame = true;
+    }
+
+    void profiler::end_frame()
+    {
+        profiler_state& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+
+        s.in_frame = false;
+        s.frame_index++;
+    }
+
+    uint32_t profiler::begin_scope(const char* name)
+    {
+        profiler_state& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+
+        frame_slot& slot = s.frames[s.current];
+
+        profile_event e;
+        e.name = name;
+        e.thread = thread_index();
+        e.gpu_begin = issue_timestamp(s);
+        e.gpu_end = GR_INVALID_ID;
+        e.cpu_end = 0;
+        e.cpu_begin = now_ns(s);
+
+        slot.events.push_back(e);
+        return static_cast<uint32_t>(slot.events.size() - 1);
+    }
+
+    void profiler::end_scope(uint32_t event)
+    {
+        profiler_state& s = state();
+        uint64_t end = now_ns(s);
+
+        std::lock_guard<std::mutex> lock(s.mutex);
+
+        frame_slot& slot = s.frames[s.current];
+        if (event >= slot.events.size())
+            return;
+
+        profile_event& e = slot.events[event];
+        e.cpu_end = end;
+
+        if (e.gpu_begin != GR_INVALID_ID)
+            e.gpu_end = issue_timestamp(s);
+    }
+
+    void profiler::set_gpu_timing(bool enabled)
+    {
+        profiler_state& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+
+        s.gpu_enabled = enabled;
+    }
+
+    void profiler::set_trace_capacity(size_t events)
+    {
+        profiler_state& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+
+        s.trace_capacity = events;
+        if (s.trace.size() > events)
+            s.trace.resize(events);
+    }
+
+    std::vector<profile_scope_stats> profiler::get_statistics()
+    {
+        profiler_state& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+
+        std::vector<profile_scope_stats> result;
+        result.reserve(s.stats.size());
+
+        for (const auto& entry : s.stats)
+        {
+            const rolling_window& w = entry.second;
+
+            profile_scope_stats stats = {};
+            stats.name = entry.first;
+            stats.samples = w.samples;
+            stats.gpu_samples = w.gpu_samples;
+
+            if (w.cpu_count)
+            {
+                stats.cpu_min = *std::min_element(w.cpu, w.cpu + w.cpu_count);
+                for (uint32_t i = 0; i < w.cpu_count; i++)
+                    stats.cpu_avg += w.cpu[i];
+                stats.cpu_avg /= w.cpu_count;
+                stats.cpu_p99 = percentile(w.cpu, w.cpu_count, 0.99);
+            }
+
+            if (w.gpu_count)
+            {
+                stats.gpu_min = *std::min_element(w.gpu, w.gpu + w.gpu_count);
+                for (uint32_t i = 0; i < w.gpu_count; i++)
+                    stats.gpu_avg += w.gpu[i];
+                stats.gpu_avg /= w.gpu_count;
+                stats.gpu_p99 = percentile(w.gpu, w.gpu_count, 0.99);
+            }
+
+            result.push_back(stats);
+        }
+
+        std::sort(result.begin(), result.end(), [](const profile_scope_stats& a, const profile_scope_stats& b) {
+            return a.name < b.name;
+        });
+
+        return result;
+    }
+
+    void profiler::write_chrome_trace(std::ostream& out)
+    {
+        profiler_state& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+
+        out << "{\"traceEvents\":[\n";
+        out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"CPU\"}},\n";
+        out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"GPU\"}}";
+
+        for (const trace_event& e : s.trace)
+        {
+            out << ",\n{\"name\":";
+            write_json_string(out, e.name);
+            out << ",\"cat\":\"" << (e.gpu ? "gpu" : "cpu") << "\",\"ph\":\"X\""
+                << ",\"ts\":" << e.timestamp / 1000.0
+                << ",\"dur\":" << e.duration / 1000.0
+                << ",\"pid\":" << (e.gpu ? 1 : 0)
+                << ",\"tid\":" << e.thread << "}";
+        }
+
+        out << "\n]}\n";
+    }
+
+    bool profiler::write_chrome_trace(const char* path)
+    {
+        std::ofstream file(path);
+        if (!file)
+            return false;
+
+        write_chrome_trace(file);
+        return file.good();
+    }
+
+    void profiler::release()
+    {
+        profiler_state& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+
+        for (frame_slot& slot : s.frames)
+        {
+            resolve(s, slot);
+
+#if !GR_OPENGLES3
+            if (!slot.queries.empty())
+                GL_CALL(glDeleteQueries(static_cast<GLsizei>(slot.queries.size()), slot.queries.data()));
+#endif
+            slot.queries.clear();
+        }
+
+        s.trace.clear();
+        s.stats.clear();
+        s.frame_index = 0;
+        s.current = 0;
+        s.in_frame = false;
+        s.calibrated = false;
+    }
+}
+
+#endif // GR_ENABLE_PROFILER
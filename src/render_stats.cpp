@@ -0,0 +1,183 @@
+#include "render_stats.hpp"
+
+#include "frame_allocator.hpp"
+
+#include <fstream>
+
+#define GR_FRAME_STATS_FIELDS(X) \
+    X(draw_calls)                \
+    X(instanced_draw_calls)      \
+    X(primitives)                \
+    X(vertices)                  \
+    X(program_binds)             \
+    X(vertex_array_binds)        \
+    X(buffer_binds)              \
+    X(texture_binds)             \
+    X(framebuffer_binds)         \
+    X(uniform_uploads)           \
+    X(buffer_upload_bytes)       \
+    X(texture_upload_bytes)      \
+    X(readback_bytes)            \
+    X(clears)
+
+namespace gr
+{
+    thread_local frame_stats render_stats::s_current;
+
+    thread_local std::vector<frame_stats> render_stats::s_history;
+
+    thread_local uint32_t render_stats::s_history_size = render_stats::k_default_history;
+
+    thread_local uint32_t render_stats::s_history_head = 0;
+
+    thread_local uint64_t render_stats::s_frame = 0;
+
+    static uint64_t primitive_count(PrimitiveType primitive, uint32_t vertices)
+    {
+        switch (primitive)
+        {
+            case POINTS:
+                return vertices;
+            case LINES:
+                return vertices / 2;
+            case LINE_LOOP:
+                return vertices > 1 ? vertices : 0;
+            case LINE_STRIP:
+                return vertices > 1 ? vertices - 1 : 0;
+            case TRIANGLES:
+                return vertices / 3;
+            case TRIANGLES_STRIP:
+            case TRIANGLES_FAN:
+                return vertices > 2 ? vertices - 2 : 0;
+            default:
+                return 0;
+        }
+    }
+
+    void render_stats::begin_frame()
+    {
+        s_current = frame_stats();
+        s_current.frame = s_frame;
+    }
+
+    void render_stats::end_frame()
+    {
+        if (s_history_size)
+        {
+            if (s_history.size() < s_history_size)
+            {
+                // reserva tudo de uma vez: depois do primeiro frame nao aloca mais
+                if (s_history.capacity() < s_history_size)
+                    s_history.reserve(s_history_size);
+                s_history.push_back(s_current);
+            }
+            else
+                s_history[s_history_head] = s_current;
+
+            s_history_head = (s_history_head + 1) % s_history_size;
+        }
+
+        s_frame++;
+    }
+
+    frame_stats render_stats::diff(const frame_stats& before, const frame_stats& after)
+    {
+        frame_stats result;
+        result.frame = after.frame;
+
+        #define GR_DIFF_FIELD(name) result.name = after.name - before.name;
+        GR_FRAME_STATS_FIELDS(GR_DIFF_FIELD)
+        #undef GR_DIFF_FIELD
+
+        return result;
+    }
+
+    void render_stats::set_history_size(uint32_t frames)
+    {
+        std::vector<frame_stats> history = get_history();
+        if (history.size() > frames)
+            history.erase(history.begin(), history.end() - frames);
+
+        s_history = std::move(history);
+        s_history_size = frames;
+        s_history_head = frames ? static_cast<uint32_t>(s_history.size()) % frames : 0;
+    }
+
+    std::vector<frame_stats> render_stats::get_history()
+    {
+        std::vector<frame_stats> result;
+        result.reserve(s_history.size());
+        for (size_t i = 0; i < s_history.size(); i++)
+            result.push_back(history_at(i));
+        return result;
+    }
+
+    const frame_stats* render_stats::get_history(frame_allocator& allocator, uint32_t& count)
+    {
+        count = static_cast<uint32_t>(s_history.size());
+
+        frame_stats* result = allocator.allocate_array<frame_stats>(count);
+        for (uint32_t i = 0; i < count; i++)
+            result[i] = history_at(i);
+        return result;
+    }
+
+    void render_stats::write_json_lines(std::ostream& out, uint32_t frames)
+    {
+        size_t first = 0;
+        if (frames && frames < s_history.size())
+            first = s_history.size() - frames;
+
+        // direto do anel, sem copiar o historico
+        for (size_t i = first; i < s_history.size(); i++)
+        {
+            const frame_stats& stats = history_at(i);
+
+            out << "{\"frame\":" << stats.frame;
+
+            #define GR_WRITE_FIELD(name) out << ",\"" #name "\":" << stats.name;
+            GR_FRAME_STATS_FIELDS(GR_WRITE_FIELD)
+            #undef GR_WRITE_FIELD
+
+            out << "}\n";
+        }
+    }
+
+    bool render_stats::write_json_lines(const char* path, uint32_t frames)
+    {
+        std::ofstream file(path, std::ios::app);
+        if (!file)
+            return false;
+
+        write_json_lines(file, frames);
+        return file.good();
+    }
+
+    void render_stats::reset()
+    {
+        s_current = frame_stats();
+        s_history.clear();
+        s_history_head = 0;
+        s_frame = 0;
+    }
+
+    void render_stats::count_draw(PrimitiveType primitive, uint32_t vertices, uint32_t instances, bool instanced)
+    {
+        s_current.draw_calls++;
+        if (instanced)
+            s_current.instanced_draw_calls++;
+
+        s_current.vertices += static_cast<uint64_t>(vertices) * instances;
+        s_current.primitives += primitive_count(primitive, vertices) * instances;
+    }
+
+    // ********** private ********** //
+    const frame_stats& render_stats::history_at(size_t index)
+    {
+        // o anel so gira depois de cheio
+        if (s_history.size() < s_history_size)
+            return s_history[index];
+
+        return s_history[(s_history_head + index) % s_history.size()];
+    }
+}
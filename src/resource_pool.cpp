@@ -0,0 +1,446 @@
+#include "resource_pool.hpp"
+
+#include "gl.h"
+#include "gl_debug.hpp"
+#include "memory_tracker.hpp"
+#include "platform/null/null_device.hpp"
+#include "render_stats.hpp"
+#include "trace_recorder.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+namespace gr
+{
+    void report_invalid_handle(uint32_t value)
+    {
+        char text[64];
+        snprintf(text, sizeof(text), "use of a destroyed or foreign handle 0x%08x", value);
+
+        // o ultimo GL_CALL nao tem nada a ver com o handle: sem call site
+#if GR_OPENGLES3
+        gl_debug::report(0, 0, 0, gl_debug_severity::high, text, strlen(text), {nullptr, nullptr, 0});
+#else
+        gl_debug::report(GL_DEBUG_SOURCE_APPLICATION, GL_DEBUG_TYPE_ERROR, 0, gl_debug_severity::high, text, strlen(text), {nullptr, nullptr, 0});
+#endif
+    }
+
+    namespace
+    {
+        inline GLenum buffer_target_to_opengl(buffer_target target)
+        {
+            switch (target)
+            {
+                case buffer_target::index:
+                    return GL_ELEMENT_ARRAY_BUFFER;
+                case buffer_target::uniform:
+                    return GL_UNIFORM_BUFFER;
+                default:
+                    return GL_ARRAY_BUFFER;
+            }
+        }
+
+        inline memory_category buffer_target_to_category(buffer_target target)
+        {
+            switch (target)
+            {
+                case buffer_target::index:
+                    return memory_category::index_buffer;
+                case buffer_target::uniform:
+                    return memory_category::uniform_buffer;
+                default:
+                    return memory_category::vertex_buffer;
+            }
+        }
+
+        inline GLenum buffer_usage_to_opengl(buffer_usage usage)
+        {
+            return usage == buffer_usage::static_draw ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW;
+        }
+
+        // RenderBackend::Null: os nomes vem do null_device, sem lote
+        inline void delete_buffer_names(GLsizei count, const GLuint* names)
+        {
+            if (!null_device::is_active())
+            {
+                grr::delete_buffers(count, names);
+                return;
+            }
+
+            for (GLsizei i = 0; i < count; i++)
+                null_device::destroy_object(null_object::buffer, names[i], "buffer_pool::destroy");
+        }
+
+        inline void delete_vertex_array_names(GLsizei count, const GLuint* names)
+        {
+            if (!null_device::is_active())
+            {
+                glDeleteVertexArrays(count, names);
+                return;
+            }
+
+            for (GLsizei i = 0; i < count; i++)
+                null_device::destroy_object(null_object::vertex_array, names[i], "vertex_array_pool::destroy");
+        }
+
+        template <typename T>
+        inline void grow(std::vector<T>& values, uint32_t size, const T& value = T())
+        {
+            if (values.size() < size)
+                values.resize(size, value);
+        }
+    }
+
+    buffer_pool::buffer_pool(uint32_t name_batch)
+        :
+            m_name_batch(name_batch ? name_batch : 1),
+            m_frame(0)
+    {}
+
+    buffer_pool::~buffer_pool()
+    {
+        for (uint32_t i = 0; i < m_handles.get_capacity(); i++)
+        {
+            if (m_ids[i] == 0)
+                continue;
+
+            memory_tracker::untrack(buffer_target_to_category(m_targets[i]), m_ids[i]);
+            delete_buffer_names(1, &m_ids[i]);
+        }
+
+        if (!m_names.empty())
+            delete_buffer_names(static_cast<GLsizei>(m_names.size()), m_names.data());
+    }
+
+    buffer_handle buffer_pool::create(buffer_target target, const void* data, uint32_t size, buffer_usage usage)
+    {
+        trace_recorder::record(trace_op::unsupported, "buffer_pool::create");
+
+        buffer_handle buffer = m_handles.allocate();
+        if (buffer.is_null())
+            return buffer;
+
+        uint32_t capacity = m_handles.get_capacity();
+        grow(m_ids, capacity, 0u);
+        grow(m_sizes, capacity, 0u);
+        grow(m_targets, capacity, buffer_target::vertex);
+        grow(m_usages, capacity, buffer_usage::static_draw);
+        grow(m_layouts, capacity);
+
+        uint32_t index = buffer.index();
+        uint32_t id = take_name();
+
+        m_ids[index] = id;
+        m_sizes[index] = size;
+        m_targets[index] = target;
+        m_usages[index] = usage;
+
+        // copy write: nao mexe no element array do VAO ligado
+        if (!null_device::is_active())
+        {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, id);
+            glBufferData(GL_COPY_WRITE_BUFFER, size, data, buffer_usage_to_opengl(usage));
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        }
+
+        memory_tracker::track(buffer_target_to_category(target), id, size);
+
+        if (data != nullptr)
+            render_stats::count_buffer_upload(size);
+
+        return buffer;
+    }
+
+    void buffer_pool::set_data(buffer_handle buffer, const void* data, uint32_t size)
+    {
+        trace_recorder::record(trace_op::unsupported, "buffer_pool::set_data");
+
+        uint32_t index = m_handles.get_index(buffer);
+
+        const bool null_backend = null_device::is_active();
+        if (null_backend && !null_device::check("buffer_pool::set_data", data != nullptr || size == 0))
+            return;
+
+        if (!null_backend)
+            glBindBuffer(GL_COPY_WRITE_BUFFER, m_ids[index]);
+
+        if (size > m_sizes[index])
+        {
+            m_sizes[index] = size;
+
+            if (!null_backend)
+                glBufferData(GL_COPY_WRITE_BUFFER, size, data, buffer_usage_to_opengl(m_usages[index]));
+
+            memory_tracker::track(buffer_target_to_category(m_targets[index]), m_ids[index], size);
+        } else if (!null_backend)
+        {
+            glBufferSubData(GL_COPY_WRITE_BUFFER, 0, size, data);
+        }
+
+        if (!null_backend)
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        render_stats::count_buffer_upload(size);
+    }
+
+    void buffer_pool::set_layout(buffer_handle buffer, buffer_layout&& layout)
+    {
+        m_layouts[m_handles.get_index(buffer)] = std::move(layout);
+    }
+
+    void buffer_pool::set_debug_name(buffer_handle buffer, const char* name)
+    {
+        uint32_t index = m_handles.get_index(buffer);
+
+        memory_tracker::set_debug_name(buffer_target_to_category(m_targets[index]), m_ids[index], name);
+    }
+
+    void buffer_pool::bind(buffer_handle buffer) const
+    {
+        trace_recorder::record(trace_op::unsupported, "buffer_pool::bind");
+
+        uint32_t index = m_handles.get_index(buffer);
+
+        if (null_device::is_active())
+            null_device::check("buffer_pool::bind", null_device::is_object(null_object::buffer, m_ids[index]));
+        else
+            glBindBuffer(buffer_target_to_opengl(m_targets[index]), m_ids[index]);
+
+        render_stats::count_buffer_bind();
+    }
+
+    void buffer_pool::destroy(buffer_handle buffer)
+    {
+        if (!m_handles.is_valid(buffer))
+            return;
+
+        uint32_t index = buffer.index();
+
+        memory_tracker::untrack(buffer_target_to_category(m_targets[index]), m_ids[index]);
+        delete_buffer_names(1, &m_ids[index]);
+
+        m_ids[index] = 0;
+        m_sizes[index] = 0;
+        m_layouts[index] = buffer_layout();
+
+        m_handles.release(buffer);
+    }
+
+    void buffer_pool::destroy_deferred(buffer_handle buffer)
+    {
+        if (m_handles.is_valid(buffer))
+            m_deferred.push_back({buffer, m_frame});
+    }
+
+    void buffer_pool::end_frame()
+    {
+        m_frame++;
+
+        size_t kept = 0;
+        for (size_t i = 0; i < m_deferred.size(); i++)
+        {
+            if (m_frame - m_deferred[i].frame >= k_destroy_latency)
+                destroy(m_deferred[i].buffer);
+            else
+                m_deferred[kept++] = m_deferred[i];
+        }
+        m_deferred.resize(kept);
+    }
+
+    // ********** private ********** //
+    uint32_t buffer_pool::take_name()
+    {
+        if (null_device::is_active())
+            return null_device::create_object(null_object::buffer);
+
+        if (m_names.empty())
+        {
+            m_names.resize(m_name_batch);
+            glGenBuffers(static_cast<GLsizei>(m_name_batch), m_names.data());
+        }
+
+        uint32_t id = m_names.back();
+        m_names.pop_back();
+        return id;
+    }
+
+    vertex_array_pool::vertex_array_pool(buffer_pool& buffers, uint32_t name_batch)
+        :
+            m_buffers(buffers),
+            m_name_batch(name_batch ? name_batch : 1),
+            m_frame(0)
+    {}
+
+    vertex_array_pool::~vertex_array_pool()
+    {
+        for (uint32_t i = 0; i < m_handles.get_capacity(); i++)
+        {
+            if (m_ids[i] != 0)
+                delete_vertex_array_names(1, &m_ids[i]);
+        }
+
+        if (!m_names.empty())
+            delete_vertex_array_names(static_cast<GLsizei>(m_names.size()), m_names.data());
+    }
+
+    vertex_array_handle vertex_array_pool::create()
+    {
+        trace_recorder::record(trace_op::unsupported, "vertex_array_pool::create");
+
+        vertex_array_handle array = m_handles.allocate();
+        if (array.is_null())
+            return array;
+
+        uint32_t capacity = m_handles.get_capacity();
+        grow(m_ids, capacity, 0u);
+        grow(m_attribute_counts, capacity, 0u);
+        grow(m_buffer_counts, capacity, 0u);
+        grow(m_index_buffers, capacity);
+        grow(m_vertex_buffers, capacity * k_max_vertex_buffers);
+
+        uint32_t index = array.index();
+
+        m_ids[index] = take_name();
+        m_attribute_counts[index] = 0;
+        m_buffer_counts[index] = 0;
+        m_index_buffers[index] = buffer_handle();
+
+        return array;
+    }
+
+    bool vertex_array_pool::add_vertex_buffer(vertex_array_handle array, buffer_handle buffer)
+    {
+        trace_recorder::record(trace_op::unsupported, "vertex_array_pool::add_vertex_buffer");
+
+        uint32_t index = m_handles.get_index(array);
+        if (m_buffer_counts[index] >= k_max_vertex_buffers)
+            return false;
+
+        const buffer_layout& layout = m_buffers.get_layout(buffer);
+
+        if (null_device::is_active())
+        {
+            // como o null_vertex_array: o layout precisa vir antes
+            if (!null_device::check("vertex_array_pool::add_vertex_buffer", !layout.get_elements().empty()))
+                return false;
+
+            m_attribute_counts[index] += static_cast<uint32_t>(layout.get_elements().size());
+            m_vertex_buffers[index * k_max_vertex_buffers + m_buffer_counts[index]++] = buffer;
+            return true;
+        }
+
+        glBindVertexArray(m_ids[index]);
+        glBindBuffer(GL_ARRAY_BUFFER, m_buffers.get_id(buffer));
+
+        uint32_t& attribute = m_attribute_counts[index];
+        for (const auto& element : layout)
+        {
+            glEnableVertexAttribArray(attribute);
+            glVertexAttribPointer(
+                attribute,
+                element.get_component_count(),
+                grr::get_base_type(element.type),
+                element.normalized ? GL_TRUE : GL_FALSE,
+                layout.get_stride(),
+                (const void*)element.offset
+            );
+            glVertexAttribDivisor(attribute, element.instanced);
+
+            attribute++;
+        }
+
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        m_vertex_buffers[index * k_max_vertex_buffers + m_buffer_counts[index]++] = buffer;
+        return true;
+    }
+
+    void vertex_array_pool::set_index_buffer(vertex_array_handle array, buffer_handle buffer)
+    {
+        trace_recorder::record(trace_op::unsupported, "vertex_array_pool::set_index_buffer");
+
+        uint32_t index = m_handles.get_index(array);
+
+        if (null_device::is_active())
+        {
+            null_device::check("vertex_array_pool::set_index_buffer", null_device::is_object(null_object::buffer, m_buffers.get_id(buffer)));
+        } else
+        {
+            glBindVertexArray(m_ids[index]);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_buffers.get_id(buffer));
+            glBindVertexArray(0);
+        }
+
+        m_index_buffers[index] = buffer;
+    }
+
+    void vertex_array_pool::bind(vertex_array_handle array) const
+    {
+        trace_recorder::record(trace_op::unsupported, "vertex_array_pool::bind");
+
+        uint32_t id = m_ids[m_handles.get_index(array)];
+
+        if (null_device::is_active())
+        {
+            null_device::check("vertex_array_pool::bind", null_device::is_object(null_object::vertex_array, id));
+            null_device::bind_vertex_array(id);
+        } else
+        {
+            glBindVertexArray(id);
+        }
+
+        render_stats::count_vertex_array_bind();
+    }
+
+    void vertex_array_pool::destroy(vertex_array_handle array)
+    {
+        if (!m_handles.is_valid(array))
+            return;
+
+        uint32_t index = array.index();
+
+        delete_vertex_array_names(1, &m_ids[index]);
+        m_ids[index] = 0;
+
+        m_handles.release(array);
+    }
+
+    void vertex_array_pool::destroy_deferred(vertex_array_handle array)
+    {
+        if (m_handles.is_valid(array))
+            m_deferred.push_back({array, m_frame});
+    }
+
+    void vertex_array_pool::end_frame()
+    {
+        m_frame++;
+
+        size_t kept = 0;
+        for (size_t i = 0; i < m_deferred.size(); i++)
+        {
+            if (m_frame - m_deferred[i].frame >= k_destroy_latency)
+                destroy(m_deferred[i].array);
+            else
+                m_deferred[kept++] = m_deferred[i];
+        }
+        m_deferred.resize(kept);
+    }
+
+    // ********** private ********** //
+    uint32_t vertex_array_pool::take_name()
+    {
+        if (null_device::is_active())
+            return null_device::create_object(null_object::vertex_array);
+
+        if (m_names.empty())
+        {
+            m_names.resize(m_name_batch);
+            glGenVertexArrays(static_cast<GLsizei>(m_name_batch), m_names.data());
+        }
+
+        uint32_t id = m_names.back();
+        m_names.pop_back();
+        return id;
+    }
+}
@@ -0,0 +1,416 @@
+#include "resource_uploader.hpp"
+
+#ifdef GR_USE_EGL
+
+#include "gTexture.h"
+#include "gl.h"
+
+#include <EGL/egl.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <future>
+
+namespace gr
+{
+    resource_uploader::resource_uploader(size_t queue_capacity)
+        :
+            m_jobs(queue_capacity),
+            m_done(queue_capacity * 2),
+            m_stop(false),
+            m_display(EGL_NO_DISPLAY),
+            m_context(EGL_NO_CONTEXT),
+            m_surface(EGL_NO_SURFACE),
+            m_next_ticket(1),
+            m_completed(0),
+            m_bytes(0)
+    {}
+
+    resource_uploader::~resource_uploader()
+    {
+        release();
+    }
+
+    bool resource_uploader::initialize(void* display, void* share_context)
+    {
+        if (is_running())
+            return true;
+
+        EGLDisplay egl_display = display != nullptr ? static_cast<EGLDisplay>(display) : eglGetCurrentDisplay();
+        EGLContext share = share_context != nullptr ? static_cast<EGLContext>(share_context) : eglGetCurrentContext();
+        if (egl_display == EGL_NO_DISPLAY || share == EGL_NO_CONTEXT)
+            return false;
+
+        EGLint config_id = 0, client_type = 0, count = 0;
+        eglQueryContext(egl_display, share, EGL_CONFIG_ID, &config_id);
+        eglQueryContext(egl_display, share, EGL_CONTEXT_CLIENT_TYPE, &client_type);
+
+        EGLint config_attribs[] = {EGL_CONFIG_ID, config_id, EGL_NONE};
+        EGLConfig config;
+        if (!eglChooseConfig(egl_display, config_attribs, &config, 1, &count) || count == 0)
+            return false;
+
+        // mesma versao/perfil do contexto de render
+        std::vector<EGLint> context_attribs;
+        if (client_type == EGL_OPENGL_ES_API)
+        {
+            EGLint version = 3;
+            eglQueryContext(egl_display, share, EGL_CONTEXT_CLIENT_VERSION, &version);
+            context_attribs = {EGL_CONTEXT_CLIENT_VERSION, version};
+        } else
+        {
+            GLint major = 0, minor = 0;
+            glGetIntegerv(GL_MAJOR_VERSION, &major);
+            glGetIntegerv(GL_MINOR_VERSION, &minor);
+            context_attribs = {EGL_CONTEXT_MAJOR_VERSION, major, EGL_CONTEXT_MINOR_VERSION, minor};
+
+#if !GR_OPENGLES3
+            GLint profile = 0;
+            glGetIntegerv(GL_CONTEXT_PROFILE_MASK, &profile);
+            if (profile & GL_CONTEXT_CORE_PROFILE_BIT)
+            {
+                context_attribs.push_back(EGL_CONTEXT_OPENGL_PROFILE_MASK);
+                context_attribs.push_back(EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT);
+            }
+#endif
+        }
+        context_attribs.push_back(EGL_NONE);
+
+        eglBindAPI(client_type);
+
+        EGLContext context = eglCreateContext(egl_display, config, share, context_attribs.data());
+        if (context == EGL_NO_CONTEXT)
+            return false;
+
+        EGLSurface surface = EGL_NO_SURFACE;
+
+        const char* extensions = eglQueryString(egl_display, EGL_EXTENSIONS);
+        if (extensions == nullptr || strstr(extensions, "EGL_KHR_surfaceless_context") == nullptr)
+        {
+            EGLint pbuffer_attribs[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+            surface = eglCreatePbufferSurface(egl_display, config, pbuffer_attribs);
+            if (surface == EGL_NO_SURFACE)
+            {
+                eglDestroyContext(egl_display, context);
+                return false;
+            }
+        }
+
+        m_display = egl_display;
+        m_context = context;
+        m_surface = surface;
+        m_stop = false;
+
+        std::promise<bool> started;
+        std::future<bool> result = started.get_future();
+
+        m_thread = std::thread([this, client_type, &started]() {
+            eglBindAPI(client_type);
+            worker_loop([&started](bool ok) { started.set_value(ok); });
+        });
+
+        if (!result.get())
+        {
+            m_thread.join();
+            release();
+            return false;
+        }
+
+        return true;
+    }
+
+    void resource_uploader::release()
+    {
+        if (m_thread.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_wake_mutex);
+                m_stop = true;
+            }
+            m_wake.notify_all();
+
+            m_thread.join();
+        }
+
+        // jobs que nao chegaram a rodar
+        job item;
+        while (m_jobs.try_pop(item))
+            ;
+
+        drain_done();
+        for (auto& entry : m_pending)
+        {
+            if (entry.second.fence != nullptr)
+                glDeleteSync(static_cast<GLsync>(entry.second.fence));
+        }
+        m_pending.clear();
+
+        if (m_context != EGL_NO_CONTEXT)
+            eglDestroyContext(static_cast<EGLDisplay>(m_display), static_cast<EGLContext>(m_context));
+        if (m_surface != EGL_NO_SURFACE)
+            eglDestroySurface(static_cast<EGLDisplay>(m_display), static_cast<EGLSurface>(m_surface));
+
+        m_context = EGL_NO_CONTEXT;
+        m_surface = EGL_NO_SURFACE;
+        m_display = EGL_NO_DISPLAY;
+    }
+
+    resource_uploader::ticket resource_uploader::upload_texture(const gTexture& texture, uint32_t level, std::vector<uint8_t>&& pixels, completion_callback callback)
+    {
+        job item;
+        item.type = job_type::texture;
+        item.object = texture.getTextureID();
+        item.level = level;
+        item.width = std::max(texture.get_width() >> level, 1u);
+        item.height = std::max(texture.get_height() >> level, 1u);
+        item.format = texture.get_format_info();
+        item.data.swap(pixels);
+
+        ticket id = enqueue(item, callback);
+        if (!id)
+            pixels.swap(item.data);
+        return id;
+    }
+
+    resource_uploader::ticket resource_uploader::upload_buffer(BufferID buffer, std::vector<uint8_t>&& data, BufferUsage usage, completion_callback callback)
+    {
+        job item;
+        item.type = job_type::buffer_data;
+        item.object = buffer;
+        item.usage = usage;
+        item.data.swap(data);
+
+        ticket id = enqueue(item, callback);
+        if (!id)
+            data.swap(item.data);
+        return id;
+    }
+
+    resource_uploader::ticket resource_uploader::update_buffer(BufferID buffer, uint32_t offset, std::vector<uint8_t>&& data, completion_callback callback)
+    {
+        job item;
+        item.type = job_type::buffer_sub_data;
+        item.object = buffer;
+        item.offset = offset;
+        item.data.swap(data);
+
+        ticket id = enqueue(item, callback);
+        if (!id)
+            data.swap(item.data);
+        return id;
+    }
+
+    resource_uploader::ticket resource_uploader::submit(std::function<void()> job_work, completion_callback callback)
+    {
+        job item;
+        item.type = job_type::custom;
+        item.work = std::move(job_work);
+
+        return enqueue(item, callback);
+    }
+
+    uint32_t resource_uploader::poll()
+    {
+        drain_done();
+
+        std::vector<ticket> finished;
+        for (auto& entry : m_pending)
+        {
+            if (entry.second.fence == nullptr)
+                continue;
+
+            GLenum status = glClientWaitSync(static_cast<GLsync>(entry.second.fence), 0, 0);
+            if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED)
+                finished.push_back(entry.first);
+        }
+
+        // callbacks em ordem de submissao
+        std::sort(finished.begin(), finished.end());
+        for (ticket id : finished)
+            complete(id);
+
+        return static_cast<uint32_t>(finished.size());
+    }
+
+    bool resource_uploader::is_complete(ticket id) const
+    {
+        return id != 0 && id < m_next_ticket && m_pending.find(id) == m_pending.end();
+    }
+
+    bool resource_uploader::wait(ticket id, uint64_t timeout_ns)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        for (;;)
+        {
+            drain_done();
+
+            auto it = m_pending.find(id);
+            if (it == m_pending.end())
+                return id != 0 && id < m_next_ticket;
+
+            uint64_t elapsed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+            if (elapsed >= timeout_ns)
+                return false;
+
+            if (it->second.fence != nullptr)
+            {
+                GLenum status = glClientWaitSync(static_cast<GLsync>(it->second.fence), 0, timeout_ns - elapsed);
+                if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED)
+                {
+                    complete(id);
+                    return true;
+                }
+                return false;
+            }
+
+            // o worker ainda nao chegou neste job
+            if (!is_running())
+                return false;
+            std::this_thread::yield();
+        }
+    }
+
+    resource_uploader_stats resource_uploader::get_stats() const
+    {
+        resource_uploader_stats stats;
+        stats.jobs = m_next_ticket - 1;
+        stats.completed = m_completed.load(std::memory_order_relaxed);
+        stats.bytes = m_bytes.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    // ********** private ********** //
+    resource_uploader::ticket resource_uploader::enqueue(job& item, completion_callback& callback)
+    {
+        if (!is_running())
+            return 0;
+
+        item.id = m_next_ticket;
+        if (!m_jobs.try_push(item))
+            return 0;
+
+        m_pending.emplace(m_next_ticket, pending{nullptr, std::move(callback)});
+
+        {
+            std::lock_guard<std::mutex> lock(m_wake_mutex);
+        }
+        m_wake.notify_one();
+
+        return m_next_ticket++;
+    }
+
+    void resource_uploader::drain_done()
+    {
+        done item;
+        while (m_done.try_pop(item))
+        {
+            auto it = m_pending.find(item.id);
+            if (it != m_pending.end())
+                it->second.fence = item.fence;
+            else
+                glDeleteSync(static_cast<GLsync>(item.fence));
+        }
+    }
+
+    void resource_uploader::complete(ticket id)
+    {
+        auto it = m_pending.find(id);
+        if (it == m_pending.end())
+            return;
+
+        completion_callback callback = std::move(it->second.callback);
+
+        glDeleteSync(static_cast<GLsync>(it->second.fence));
+        m_pending.erase(it);
+
+        if (callback)
+            callback();
+    }
+
+    void resource_uploader::worker_loop(std::function<void(bool)> started)
+    {
+        EGLDisplay display = static_cast<EGLDisplay>(m_display);
+        EGLSurface surface = static_cast<EGLSurface>(m_surface);
+
+        if (!eglMakeCurrent(display, surface, surface, static_cast<EGLContext>(m_context)))
+        {
+            started(false);
+            return;
+        }
+
+        GL_CALL(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+
+        started(true);
+
+        job item;
+        while (true)
+        {
+            if (!m_jobs.try_pop(item))
+            {
+                std::unique_lock<std::mutex> lock(m_wake_mutex);
+                if (m_stop)
+                    break;
+
+                m_wake.wait_for(lock, std::chrono::milliseconds(10));
+                continue;
+            }
+
+            execute(item);
+
+            done result;
+            result.id = item.id;
+            result.fence = GL_CALL(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+
+            // sem flush o fence pode nunca ser visto pelo outro contexto
+            GL_CALL(glFlush());
+
+            m_bytes.fetch_add(item.data.size(), std::memory_order_relaxed);
+            m_completed.fetch_add(1, std::memory_order_relaxed);
+
+            item = job();
+
+            while (!m_done.try_push(result))
+            {
+                if (m_stop)
+                {
+                    glDeleteSync(static_cast<GLsync>(result.fence));
+                    break;
+                }
+                std::this_thread::yield();
+            }
+        }
+
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglReleaseThread();
+    }
+
+    void resource_uploader::execute(job& item)
+    {
+        switch (item.type)
+        {
+            case job_type::texture:
+                GL_CALL(glBindTexture(GL_TEXTURE_2D, item.object));
+                GL_CALL(glTexImage2D(GL_TEXTURE_2D, item.level, item.format.internalformat, item.width, item.height, 0, item.format.format, item.format.type, item.data.data()));
+                GL_CALL(glBindTexture(GL_TEXTURE_2D, 0));
+                break;
+            case job_type::buffer_data:
+                GL_CALL(glBindBuffer(GL_COPY_WRITE_BUFFER, item.object));
+                GL_CALL(glBufferData(GL_COPY_WRITE_BUFFER, item.data.size(), item.data.data(), item.usage == BufferUsage::DYNAMIC ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW));
+                GL_CALL(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+                break;
+            case job_type::buffer_sub_data:
+                GL_CALL(glBindBuffer(GL_COPY_WRITE_BUFFER, item.object));
+                GL_CALL(glBufferSubData(GL_COPY_WRITE_BUFFER, item.offset, item.data.size(), item.data.data()));
+                GL_CALL(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+                break;
+            case job_type::custom:
+                if (item.work)
+                    item.work();
+                break;
+        }
+    }
+}
+
+#endif // GR_USE_EGL
@@ -0,0 +1,208 @@
+#include "sampler_cache.hpp"
+
+#include "gl.h"
+#include "platform/null/null_device.hpp"
+#include "trace_recorder.hpp"
+
+#include <cstring>
+
+#ifndef GL_TEXTURE_MAX_ANISOTROPY
+#define GL_TEXTURE_MAX_ANISOTROPY 0x84FE
+#endif
+
+namespace gr
+{
+    thread_local uint32_t sampler_cache::s_bound[sampler_cache::k_max_units] = {};
+
+    namespace
+    {
+        GLint wrap_to_opengl(sampler_wrap wrap)
+        {
+            switch (wrap)
+            {
+                case sampler_wrap::mirror:
+                    return GL_MIRRORED_REPEAT;
+                case sampler_wrap::clamp_edge:
+                    return GL_CLAMP_TO_EDGE;
+                case sampler_wrap::clamp_border:
+#ifdef GL_CLAMP_TO_BORDER
+                    return GL_CLAMP_TO_BORDER;
+#else
+                    return GL_CLAMP_TO_EDGE;
+#endif
+                default:
+                    return GL_REPEAT;
+            }
+        }
+
+        GLint min_filter_to_opengl(sampler_filter filter, sampler_mipmap mipmap)
+        {
+            bool linear = filter == sampler_filter::linear;
+            switch (mipmap)
+            {
+                case sampler_mipmap::nearest:
+                    return linear ? GL_LINEAR_MIPMAP_NEAREST : GL_NEAREST_MIPMAP_NEAREST;
+                case sampler_mipmap::linear:
+                    return linear ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_LINEAR;
+                default:
+                    return linear ? GL_LINEAR : GL_NEAREST;
+            }
+        }
+
+        GLint compare_to_opengl(sampler_compare compare)
+        {
+            switch (compare)
+            {
+                case sampler_compare::greater_equal:
+                    return GL_GEQUAL;
+                case sampler_compare::less:
+                    return GL_LESS;
+                case sampler_compare::greater:
+                    return GL_GREATER;
+                case sampler_compare::equal:
+                    return GL_EQUAL;
+                case sampler_compare::not_equal:
+                    return GL_NOTEQUAL;
+                case sampler_compare::always:
+                    return GL_ALWAYS;
+                case sampler_compare::never:
+                    return GL_NEVER;
+                default:
+                    return GL_LEQUAL;
+            }
+        }
+
+        // -0.0 e 0.0 sao iguais no operator==, entao tem que dar o mesmo hash
+        uint32_t float_bits(float value)
+        {
+            if (value == 0.0f)
+                return 0;
+
+            uint32_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+            return bits;
+        }
+    }
+
+    uint64_t sampler_state::hash() const
+    {
+        // FNV-1a
+        uint64_t hash = 14695981039346656037ull;
+        auto mix = [&hash](uint64_t value) {
+            hash ^= value;
+            hash *= 1099511628211ull;
+        };
+
+        mix(static_cast<uint64_t>(min_filter) | static_cast<uint64_t>(mag_filter) << 8 | static_cast<uint64_t>(mipmap) << 16 |
+            static_cast<uint64_t>(wrap_s) << 24 | static_cast<uint64_t>(wrap_t) << 32 | static_cast<uint64_t>(wrap_r) << 40 |
+            static_cast<uint64_t>(compare) << 48);
+        mix(float_bits(max_anisotropy));
+        mix(float_bits(lod_bias));
+        mix(float_bits(min_lod));
+        mix(float_bits(max_lod));
+        return hash;
+    }
+
+    bool sampler_state::operator==(const sampler_state& other) const
+    {
+        return min_filter == other.min_filter && mag_filter == other.mag_filter && mipmap == other.mipmap &&
+            wrap_s == other.wrap_s && wrap_t == other.wrap_t && wrap_r == other.wrap_r && compare == other.compare &&
+            max_anisotropy == other.max_anisotropy && lod_bias == other.lod_bias &&
+            min_lod == other.min_lod && max_lod == other.max_lod;
+    }
+
+    sampler_cache::~sampler_cache()
+    {
+        clear();
+    }
+
+    uint32_t sampler_cache::get(const sampler_state& state)
+    {
+        auto it = m_samplers.find(state);
+        if (it != m_samplers.end())
+            return it->second;
+
+        uint32_t sampler = 0;
+        if (null_device::is_active())
+        {
+            sampler = null_device::create_object(null_object::sampler);
+        }
+        else
+        {
+            GL_CALL(glGenSamplers(1, &sampler));
+
+            GL_CALL(glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, min_filter_to_opengl(state.min_filter, state.mipmap)));
+            GL_CALL(glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, state.mag_filter == sampler_filter::linear ? GL_LINEAR : GL_NEAREST));
+            GL_CALL(glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, wrap_to_opengl(state.wrap_s)));
+            GL_CALL(glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, wrap_to_opengl(state.wrap_t)));
+            GL_CALL(glSamplerParameteri(sampler, GL_TEXTURE_WRAP_R, wrap_to_opengl(state.wrap_r)));
+            GL_CALL(glSamplerParameterf(sampler, GL_TEXTURE_MIN_LOD, state.min_lod));
+            GL_CALL(glSamplerParameterf(sampler, GL_TEXTURE_MAX_LOD, state.max_lod));
+
+            if (state.compare != sampler_compare::none)
+            {
+                GL_CALL(glSamplerParameteri(sampler, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE));
+                GL_CALL(glSamplerParameteri(sampler, GL_TEXTURE_COMPARE_FUNC, compare_to_opengl(state.compare)));
+            }
+
+#if !GR_OPENGLES3
+            if (state.lod_bias != 0.0f)
+                GL_CALL(glSamplerParameterf(sampler, GL_TEXTURE_LOD_BIAS, state.lod_bias));
+#endif
+
+            // EXT/ARB_texture_filter_anisotropic: sem a extensao o driver so reclama
+            if (state.max_anisotropy > 1.0f)
+                GL_CALL(glSamplerParameterf(sampler, GL_TEXTURE_MAX_ANISOTROPY, state.max_anisotropy));
+        }
+
+        m_samplers.emplace(state, sampler);
+
+        trace_recorder::record(trace_op::sampler_create, sampler, state);
+        return sampler;
+    }
+
+    void sampler_cache::clear()
+    {
+        for (const auto& entry : m_samplers)
+        {
+            if (null_device::is_active())
+                null_device::destroy_object(null_object::sampler, entry.second, "sampler_cache::clear");
+            else
+                GL_CALL(glDeleteSamplers(1, &entry.second));
+        }
+
+        m_samplers.clear();
+
+        // samplers apagados saem das unidades, e os nomes podem voltar
+        invalidate_bindings();
+    }
+
+    void sampler_cache::bind(uint32_t unit, uint32_t sampler)
+    {
+        // antes do filtro: o trace pode ter comecado com a unidade ja ligada
+        trace_recorder::record(trace_op::sampler_bind, unit, sampler);
+
+        if (unit < k_max_units)
+        {
+            if (s_bound[unit] == sampler)
+                return;
+
+            s_bound[unit] = sampler;
+        }
+
+        if (null_device::is_active())
+        {
+            null_device::check("sampler_cache::bind", sampler == 0 || null_device::is_object(null_object::sampler, sampler));
+            return;
+        }
+
+        GL_CALL(glBindSampler(unit, sampler));
+    }
+
+    void sampler_cache::invalidate_bindings()
+    {
+        // desconhecido: o proximo bind de cada unidade sempre vai ao driver
+        for (uint32_t i = 0; i < k_max_units; i++)
+            s_bound[i] = GR_INVALID_ID;
+    }
+}
@@ -4,24 +4,147 @@
 #include "gl.h"
 
 #include "gError.h"
+#include "platform/null/null_device.hpp"
+#include "render_stats.hpp"
+#include "trace_recorder.hpp"
 
+#include <algorithm>
 #include <cstddef>
 #include <string.h>
+#include <vector>
 
 namespace gr
 {
-    Shader::Shader() : shaderID(GR_INVALID_ID), m_uniforms(nullptr), m_count(0), m_capacity(0), m_buffer_size(0)
-    {}
+    // glShaderSource concatena as strings; o trace guarda o resultado
+    static std::string join_sources(const char **sources, int count)
+    {
+        std::string result;
+        for (int i = 0; i < count; i++)
+            result += sources[i];
+        return result;
+    }
 
-    Shader::~Shader()
+    uint32_t get_uniform_type_size(UniformType type)
     {
-        for (size_t i=0;i<m_count;i++)
+        switch (type)
         {
-            ShaderUniform &uniform = m_uniforms[i];
+            case UniformType::SAMPLERCUBE:
+            case UniformType::SAMPLER2D:
+            case UniformType::BOOL:
+            case UniformType::INT:
+                return sizeof(GLint);
+            case UniformType::FLOAT:
+                return sizeof(GLfloat);
+            case UniformType::VEC2:
+                return sizeof(Vector2);
+            case UniformType::VEC3:
+                return sizeof(Vector3);
+            case UniformType::VEC4:
+                return sizeof(Vector4);
+            case UniformType::MAT3:
+                return sizeof(Matrix3x3);
+            case UniformType::MAT4:
+                return sizeof(Matrix4x4);
+            default:
+                return 0;
+        }
+    }
+
+    // false for the GL types UniformType has no name for (ivec, uint, ...)
+    static bool from_gl_type(GLenum gl_type, UniformType &type)
+    {
+        switch (gl_type)
+        {
+            case GL_BOOL:
+                type = UniformType::BOOL;
+                return true;
+            case GL_INT:
+                type = UniformType::INT;
+                return true;
+            case GL_FLOAT:
+                type = UniformType::FLOAT;
+                return true;
+            case GL_FLOAT_VEC2:
+                type = UniformType::VEC2;
+                return true;
+            case GL_FLOAT_VEC3:
+                type = UniformType::VEC3;
+                return true;
+            case GL_FLOAT_VEC4:
+                type = UniformType::VEC4;
+                return true;
+            case GL_FLOAT_MAT3:
+                type = UniformType::MAT3;
+                return true;
+            case GL_FLOAT_MAT4:
+                type = UniformType::MAT4;
+                return true;
+            // todos os samplers recebem uma unidade com glUniform1iv
+            case GL_SAMPLER_2D:
+            case GL_SAMPLER_2D_SHADOW:
+            case GL_SAMPLER_2D_ARRAY:
+            case GL_SAMPLER_2D_ARRAY_SHADOW:
+            case GL_SAMPLER_3D:
+            case GL_INT_SAMPLER_2D:
+            case GL_UNSIGNED_INT_SAMPLER_2D:
+                type = UniformType::SAMPLER2D;
+                return true;
+            case GL_SAMPLER_CUBE:
+            case GL_SAMPLER_CUBE_SHADOW:
+                type = UniformType::SAMPLERCUBE;
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    static void take_units(std::vector<bool> &used, uint32_t first, uint32_t count)
+    {
+        if (used.size() < first + count)
+            used.resize(first + count, false);
+
+        for (uint32_t i = 0; i < count; i++)
+            used[first + i] = true;
+    }
 
-            if (uniform.name != NULL)
-                free(uniform.name);
+    // primeira sequencia de `count` unidades livres
+    static uint32_t find_free_units(const std::vector<bool> &used, uint32_t count)
+    {
+        uint32_t first = 0, run = 0;
+        for (uint32_t i = 0; i < used.size() && run < count; i++)
+        {
+            if (used[i])
+            {
+                first = i + 1;
+                run = 0;
+            }
+            else
+            {
+                run++;
+            }
         }
+        return first;
+    }
+
+    // "u_lights[0]" -> "u_lights"
+    static void strip_array_suffix(char *name)
+    {
+        size_t length = strlen(name);
+        if (length > 3 && strcmp(name + length - 3, "[0]") == 0)
+            name[length - 3] = '\0';
+    }
+
+    Shader::Shader() : shaderID(GR_INVALID_ID), m_uniforms(nullptr), m_buffer_size(0), m_capacity(0), m_count(0), m_sampler_units(0), m_reflected(false)
+    {}
+
+    Shader::~Shader()
+    {
+        trace_recorder::record(trace_op::shader_destroy, trace_recorder::key(this));
+
+        if (null_device::is_active() && shaderID != GR_INVALID_ID)
+            null_device::destroy_object(null_object::program, shaderID, "Shader::~Shader");
+
+        clear_uniforms();
 
         if (m_uniforms != nullptr)
             free(m_uniforms);
@@ -29,6 +152,9 @@ namespace gr
 
     int Shader::build(const char **fragment, int nfrag, const char **vertex, int nvert)
     {
+        if (null_device::is_active())
+            return build_null(fragment, nfrag, vertex, nvert);
+
         // Fragment shader
         uint32_t shader_fragment = GL_CALL(glCreateShader(GL_FRAGMENT_SHADER));
         GL_CALL(glShaderSource(shader_fragment, nfrag, fragment, nullptr));
@@ -91,6 +217,11 @@ namespace gr
         GL_CALL(glDeleteShader(shader_fragment));
         GL_CALL(glDeleteShader(shader_vertex));
 
+        reflect();
+
+        if (trace_recorder::is_recording())
+            trace_recorder::record(trace_op::shader_build, trace_recorder::key(this), join_sources(fragment, nfrag).c_str(), join_sources(vertex, nvert).c_str());
+
         return 1;
     }
 
@@ -99,55 +230,19 @@ namespace gr
         UniformID id = findUniform(name);
         if (id != GR_INVALID_ID)
             return id;
-     
-        if (m_count >= m_capacity)
-            reallocate();
 
-        int location = glGetUniformLocation(shaderID, name);
-        if (location == -1)
+        // o programa refletido ja tem todos os uniforms ativos
+        if (m_reflected)
             return GR_INVALID_ID;
 
-        size_t stride = 0;
-        switch (type)
-        {
-            case UniformType::SAMPLERCUBE:
-            case UniformType::SAMPLER2D:
-            case UniformType::BOOL:
-            case UniformType::INT:
-                stride = count * sizeof(GLint);
-                break;
-            case UniformType::FLOAT:
-                stride = count * sizeof(GLfloat);
-                break;
-            case UniformType::VEC2:
-                stride = count * sizeof(Vector2);
-                break;
-            case UniformType::VEC3:
-                stride = count * sizeof(Vector3);
-                break;
-            case UniformType::VEC4:
-                stride = count * sizeof(Vector4);
-                break;
-            case UniformType::MAT3:
-                stride = count * sizeof(Matrix3x3);
-                break;
-            case UniformType::MAT4:
-                stride = count * sizeof(Matrix4x4);
-                break;
-            default:
-                break;
-        }
-
-        UniformID uniformID = m_count++;
+        // no backend nulo todo nome existe
+        int location = null_device::is_active() ? static_cast<int>(m_count) : glGetUniformLocation(shaderID, name);
+        if (location == -1)
+            return GR_INVALID_ID;
 
-        auto &uniform = m_uniforms[uniformID];
-        uniform.name = strdup(name);
-        uniform.id = location;
-        uniform.type = type;
-        uniform.stride = stride;
-        uniform.offset = m_buffer_size;
+        UniformID uniformID = add_uniform(name, location, count, type);
 
-        m_buffer_size += stride;
+        trace_recorder::record(trace_op::shader_uniform, trace_recorder::key(this), count, static_cast<uint32_t>(type), name);
 
         return uniformID;
     }
@@ -163,47 +258,79 @@ namespace gr
 
     void Shader::SetUniform(UniformID id, const void *data)
     {
+        if (null_device::is_active() && !null_device::check("Shader::SetUniform", id < m_count && data != nullptr))
+            return;
+
         auto &uniform = m_uniforms[id];
 
-        switch (uniform.type)
+        if (!null_device::is_active())
         {
-            case UniformType::SAMPLERCUBE:
-            case UniformType::SAMPLER2D:
-            case UniformType::BOOL:
-            case UniformType::INT:
-                GL_CALL(glUniform1iv(uniform.id, (uniform.stride / sizeof(GLint)), (const GLint *)data));
-                break;
-            case UniformType::FLOAT:
-                GL_CALL(glUniform1fv(uniform.id, (uniform.stride / sizeof(GLfloat)), (const GLfloat *)data));
-                break;
-            case UniformType::VEC2:
-                GL_CALL(glUniform2fv(uniform.id, (uniform.stride / sizeof(Vector2)), (const GLfloat *)data));
-                break;
-            case UniformType::VEC3:
-                GL_CALL(glUniform3fv(uniform.id, (uniform.stride / sizeof(Vector3)), (const GLfloat *)data));
-                break;
-            case UniformType::VEC4:
-                GL_CALL(glUniform4fv(uniform.id, (uniform.stride / sizeof(Vector4)), (const GLfloat *)data));
-                break;
-            case UniformType::MAT3:
-                GL_CALL(glUniformMatrix3fv(uniform.id, (uniform.stride / sizeof(Matrix3x3)), GL_FALSE, (const GLfloat *)data));
-                break;
-            case UniformType::MAT4:
-                GL_CALL(glUniformMatrix4fv(uniform.id, (uniform.stride / sizeof(Matrix4x4)), GL_FALSE, (const GLfloat *)data));
-                break;
-            default:
-                break;
+            switch (uniform.type)
+            {
+                case UniformType::SAMPLERCUBE:
+                case UniformType::SAMPLER2D:
+                case UniformType::BOOL:
+                case UniformType::INT:
+                    GL_CALL(glUniform1iv(uniform.id, (uniform.stride / sizeof(GLint)), (const GLint *)data));
+                    break;
+                case UniformType::FLOAT:
+                    GL_CALL(glUniform1fv(uniform.id, (uniform.stride / sizeof(GLfloat)), (const GLfloat *)data));
+                    break;
+                case UniformType::VEC2:
+                    GL_CALL(glUniform2fv(uniform.id, (uniform.stride / sizeof(Vector2)), (const GLfloat *)data));
+                    break;
+                case UniformType::VEC3:
+                    GL_CALL(glUniform3fv(uniform.id, (uniform.stride / sizeof(Vector3)), (const GLfloat *)data));
+                    break;
+                case UniformType::VEC4:
+                    GL_CALL(glUniform4fv(uniform.id, (uniform.stride / sizeof(Vector4)), (const GLfloat *)data));
+                    break;
+                case UniformType::MAT3:
+                    GL_CALL(glUniformMatrix3fv(uniform.id, (uniform.stride / sizeof(Matrix3x3)), GL_FALSE, (const GLfloat *)data));
+                    break;
+                case UniformType::MAT4:
+                    GL_CALL(glUniformMatrix4fv(uniform.id, (uniform.stride / sizeof(Matrix4x4)), GL_FALSE, (const GLfloat *)data));
+                    break;
+                default:
+                    break;
+            }
         }
+
+        render_stats::count_uniform_upload();
+
+        trace_recorder::record(trace_op::shader_set_uniform, trace_recorder::key(this), uniform.name, trace_blob{data, static_cast<uint32_t>(uniform.stride)});
     }
 
     void Shader::bind()
     {
-        GL_CALL(glUseProgram(shaderID));
+        if (null_device::is_active())
+        {
+            null_device::check("Shader::bind", shaderID != GR_INVALID_ID);
+            null_device::bind_program(shaderID != GR_INVALID_ID ? shaderID : 0);
+        }
+        else
+        {
+            GL_CALL(glUseProgram(shaderID));
+        }
+
+        render_stats::count_program_bind();
+
+        trace_recorder::record(trace_op::shader_bind, trace_recorder::key(this));
     }
 
     void Shader::unbind()
     {
-        glUseProgram(0);
+        if (null_device::is_active())
+        {
+            null_device::check("Shader::unbind");
+            null_device::bind_program(0);
+        }
+        else
+        {
+            glUseProgram(0);
+        }
+
+        trace_recorder::record(trace_op::shader_bind, static_cast<uint64_t>(0));
     }
 
     UniformID Shader::findUniform(const char *name)
@@ -216,6 +343,272 @@ namespace gr
         return GR_INVALID_ID;
     }
 
+    uint32_t Shader::find_block(const char *name) const
+    {
+        for (size_t i = 0; i < m_blocks.size(); i++)
+        {
+            if (m_blocks[i].name == name)
+                return static_cast<uint32_t>(i);
+        }
+        return GR_INVALID_ID;
+    }
+
+    int32_t Shader::find_attribute(const char *name) const
+    {
+        for (const auto &attribute : m_attributes)
+        {
+            if (attribute.name == name)
+                return attribute.location;
+        }
+        return -1;
+    }
+
+    // ********** private ********** //
+    int Shader::build_null(const char **fragment, int nfrag, const char **vertex, int nvert)
+    {
+        bool valid = fragment != nullptr && nfrag > 0 && vertex != nullptr && nvert > 0;
+        for (int i = 0; valid && i < nfrag; i++)
+            valid = fragment[i] != nullptr;
+        for (int i = 0; valid && i < nvert; i++)
+            valid = vertex[i] != nullptr;
+
+        if (!null_device::check("Shader::build", valid))
+            return -1;
+
+        if (shaderID != GR_INVALID_ID)
+            null_device::destroy_object(null_object::program, shaderID, "Shader::build");
+
+        shaderID = null_device::create_object(null_object::program);
+
+        if (trace_recorder::is_recording())
+            trace_recorder::record(trace_op::shader_build, trace_recorder::key(this), join_sources(fragment, nfrag).c_str(), join_sources(vertex, nvert).c_str());
+
+        return 1;
+    }
+
+    void Shader::clear_uniforms()
+    {
+        for (size_t i = 0; i < m_count; i++)
+        {
+            if (m_uniforms[i].name != NULL)
+                free(m_uniforms[i].name);
+        }
+
+        m_count = 0;
+        m_buffer_size = 0;
+        m_sampler_units = 0;
+        m_reflected = false;
+
+        m_blocks.clear();
+        m_block_members.clear();
+        m_attributes.clear();
+    }
+
+    UniformID Shader::add_uniform(const char *name, int location, uint32_t count, UniformType type)
+    {
+        if (m_count >= m_capacity)
+            reallocate();
+
+        uint32_t stride = count * get_uniform_type_size(type);
+
+        UniformID uniformID = m_count++;
+
+        auto &uniform = m_uniforms[uniformID];
+        uniform.name = strdup(name);
+        uniform.id = location;
+        uniform.type = type;
+        uniform.stride = stride;
+        uniform.offset = m_buffer_size;
+        uniform.count = count;
+        uniform.unit = GR_INVALID_ID;
+
+        m_buffer_size += stride;
+
+        return uniformID;
+    }
+
+    void Shader::reflect()
+    {
+        clear_uniforms();
+        m_reflected = true;
+
+        // uniforms: as propriedades de todos vem em uma chamada por propriedade
+        GLint count = 0, max_length = 0;
+        GL_CALL(glGetProgramiv(shaderID, GL_ACTIVE_UNIFORMS, &count));
+        GL_CALL(glGetProgramiv(shaderID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length));
+
+        std::vector<GLuint> indices(count);
+        std::vector<GLint> blocks(count), offsets(count), array_strides(count), matrix_strides(count);
+        for (GLint i = 0; i < count; i++)
+            indices[i] = static_cast<GLuint>(i);
+
+        if (count > 0)
+        {
+            GL_CALL(glGetActiveUniformsiv(shaderID, count, indices.data(), GL_UNIFORM_BLOCK_INDEX, blocks.data()));
+            GL_CALL(glGetActiveUniformsiv(shaderID, count, indices.data(), GL_UNIFORM_OFFSET, offsets.data()));
+            GL_CALL(glGetActiveUniformsiv(shaderID, count, indices.data(), GL_UNIFORM_ARRAY_STRIDE, array_strides.data()));
+            GL_CALL(glGetActiveUniformsiv(shaderID, count, indices.data(), GL_UNIFORM_MATRIX_STRIDE, matrix_strides.data()));
+        }
+
+        struct active_uniform
+        {
+            std::string name;
+
+            int location;
+
+            uint32_t count;
+
+            UniformType type;
+        };
+
+        std::vector<char> name(max_length > 0 ? max_length : 1);
+        std::vector<active_uniform> actives;
+
+        for (GLint i = 0; i < count; i++)
+        {
+            GLint size = 0;
+            GLenum gl_type = 0;
+            GL_CALL(glGetActiveUniform(shaderID, i, static_cast<GLsizei>(name.size()), nullptr, &size, &gl_type, name.data()));
+            strip_array_suffix(name.data());
+
+            UniformType type;
+            if (!from_gl_type(gl_type, type))
+                continue;
+
+            if (blocks[i] >= 0)
+            {
+                shader_block_member member;
+                member.name = name.data();
+                member.block = static_cast<uint32_t>(blocks[i]);
+                member.type = type;
+                member.count = static_cast<uint32_t>(size);
+                member.offset = static_cast<uint32_t>(offsets[i]);
+                member.array_stride = static_cast<uint32_t>(array_strides[i]);
+                member.matrix_stride = static_cast<uint32_t>(matrix_strides[i]);
+                m_block_members.push_back(std::move(member));
+                continue;
+            }
+
+            // gl_* embutidos nao tem location
+            int location = GL_CALL(glGetUniformLocation(shaderID, name.data()));
+            if (location == -1)
+                continue;
+
+            actives.push_back({name.data(), location, static_cast<uint32_t>(size), type});
+        }
+
+        // a ordem do glGetActiveUniform muda entre drivers; por nome os UniformIDs sao estaveis
+        std::sort(actives.begin(), actives.end(), [](const active_uniform &a, const active_uniform &b) {
+            return a.name < b.name;
+        });
+
+        for (const auto &active : actives)
+            add_uniform(active.name.c_str(), active.location, active.count, active.type);
+
+        // samplers: layout(binding = N) != 0 fica; os que estao em 0 recebem unidades livres
+        std::vector<bool> used_units;
+        std::vector<UniformID> automatic;
+        for (size_t i = 0; i < m_count; i++)
+        {
+            ShaderUniform &uniform = m_uniforms[i];
+            if (uniform.type != UniformType::SAMPLER2D && uniform.type != UniformType::SAMPLERCUBE)
+                continue;
+
+            GLint unit = 0;
+            GL_CALL(glGetUniformiv(shaderID, uniform.id, &unit));
+            if (unit <= 0)
+            {
+                automatic.push_back(static_cast<UniformID>(i));
+                continue;
+            }
+
+            uniform.unit = static_cast<uint32_t>(unit);
+            take_units(used_units, uniform.unit, uniform.count);
+        }
+
+        if (!automatic.empty())
+        {
+            GL_CALL(glUseProgram(shaderID));
+            for (UniformID id : automatic)
+            {
+                ShaderUniform &uniform = m_uniforms[id];
+                uniform.unit = find_free_units(used_units, uniform.count);
+                take_units(used_units, uniform.unit, uniform.count);
+
+                std::vector<GLint> units(uniform.count);
+                for (uint32_t e = 0; e < uniform.count; e++)
+                    units[e] = static_cast<GLint>(uniform.unit + e);
+
+                GL_CALL(glUniform1iv(uniform.id, uniform.count, units.data()));
+            }
+            GL_CALL(glUseProgram(0));
+        }
+
+        m_sampler_units = static_cast<uint32_t>(used_units.size());
+
+        // blocks: binding != 0 fica, os demais recebem pontos livres
+        GLint block_count = 0, block_length = 0;
+        GL_CALL(glGetProgramiv(shaderID, GL_ACTIVE_UNIFORM_BLOCKS, &block_count));
+        GL_CALL(glGetProgramiv(shaderID, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &block_length));
+
+        std::vector<bool> used_bindings;
+        name.resize(block_length > 0 ? block_length : 1);
+        for (GLint i = 0; i < block_count; i++)
+        {
+            GLint size = 0, binding = 0;
+            GL_CALL(glGetActiveUniformBlockName(shaderID, i, static_cast<GLsizei>(name.size()), nullptr, name.data()));
+            GL_CALL(glGetActiveUniformBlockiv(shaderID, i, GL_UNIFORM_BLOCK_DATA_SIZE, &size));
+            GL_CALL(glGetActiveUniformBlockiv(shaderID, i, GL_UNIFORM_BLOCK_BINDING, &binding));
+
+            shader_block block;
+            block.name = name.data();
+            block.index = static_cast<uint32_t>(i);
+            block.binding = binding > 0 ? static_cast<uint32_t>(binding) : GR_INVALID_ID;
+            block.size = static_cast<uint32_t>(size);
+
+            if (block.binding != GR_INVALID_ID)
+                take_units(used_bindings, block.binding, 1);
+
+            m_blocks.push_back(std::move(block));
+        }
+
+        for (auto &block : m_blocks)
+        {
+            if (block.binding != GR_INVALID_ID)
+                continue;
+
+            block.binding = find_free_units(used_bindings, 1);
+            take_units(used_bindings, block.binding, 1);
+
+            GL_CALL(glUniformBlockBinding(shaderID, block.index, block.binding));
+        }
+
+        // attributes
+        GLint attribute_count = 0, attribute_length = 0;
+        GL_CALL(glGetProgramiv(shaderID, GL_ACTIVE_ATTRIBUTES, &attribute_count));
+        GL_CALL(glGetProgramiv(shaderID, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &attribute_length));
+
+        name.resize(attribute_length > 0 ? attribute_length : 1);
+        for (GLint i = 0; i < attribute_count; i++)
+        {
+            GLint size = 0;
+            GLenum gl_type = 0;
+            GL_CALL(glGetActiveAttrib(shaderID, i, static_cast<GLsizei>(name.size()), nullptr, &size, &gl_type, name.data()));
+            strip_array_suffix(name.data());
+
+            int location = GL_CALL(glGetAttribLocation(shaderID, name.data()));
+            if (location == -1)
+                continue;
+
+            shader_attribute attribute;
+            attribute.name = name.data();
+            attribute.location = location;
+            attribute.type = gl_type;
+            attribute.count = static_cast<uint32_t>(size);
+            m_attributes.push_back(std::move(attribute));
+        }
+    }
+
     void Shader::reallocate()
     {
         if (m_capacity)
@@ -0,0 +1,379 @@
+#include "shader_library.hpp"
+
+#include "shader.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace gr
+{
+    namespace
+    {
+        // FNV-1a
+        uint64_t hash_text(uint64_t hash, const std::string& text)
+        {
+            for (unsigned char c : text)
+            {
+                hash ^= c;
+                hash *= 1099511628211ull;
+            }
+            return hash;
+        }
+
+        bool is_identifier(char c)
+        {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+        }
+
+        // keyword as a whole identifier, so USE_FOG does not match USE_FOG_EXP
+        bool mentions(const std::string& source, const std::string& keyword)
+        {
+            size_t pos = 0;
+            while ((pos = source.find(keyword, pos)) != std::string::npos)
+            {
+                size_t end = pos + keyword.size();
+                bool starts = pos == 0 || !is_identifier(source[pos - 1]);
+                bool ends = end >= source.size() || !is_identifier(source[end]);
+                if (starts && ends)
+                    return true;
+
+                pos = end;
+            }
+            return false;
+        }
+
+        size_t skip_spaces(const std::string& text, size_t pos, size_t end)
+        {
+            while (pos < end && (text[pos] == ' ' || text[pos] == '\t'))
+                pos++;
+            return pos;
+        }
+
+        // first character of [pos, end) that is not space or comment; a /* */
+        // still open at `end` sets in_comment for the next line
+        size_t skip_comments(const std::string& text, size_t pos, size_t end, bool& in_comment)
+        {
+            while (pos < end)
+            {
+                if (in_comment)
+                {
+                    size_t close = text.find("*/", pos);
+                    if (close == std::string::npos || close + 2 > end)
+                        return end;
+
+                    in_comment = false;
+                    pos = close + 2;
+                    continue;
+                }
+
+                pos = skip_spaces(text, pos, end);
+                if (pos + 1 >= end || text[pos] != '/')
+                    break;
+
+                if (text[pos + 1] == '/')
+                    return end;
+
+                if (text[pos + 1] != '*')
+                    break;
+
+                in_comment = true;
+                pos += 2;
+            }
+            return pos;
+        }
+
+        // '#' directive at the start of [begin, end), or false
+        bool is_directive(const std::string& text, size_t begin, size_t end, const char* name, size_t& after)
+        {
+            size_t pos = skip_spaces(text, begin, end);
+            if (pos >= end || text[pos] != '#')
+                return false;
+
+            pos = skip_spaces(text, pos + 1, end);
+
+            size_t length = strlen(name);
+            if (text.compare(pos, length, name) != 0 || (pos + length < end && is_identifier(text[pos + length])))
+                return false;
+
+            after = pos + length;
+            return true;
+        }
+    }
+
+    shader_library::~shader_library()
+    {
+        clear_variants();
+    }
+
+    void shader_library::set_include_loader(shader_include_loader loader)
+    {
+        m_loader = std::move(loader);
+    }
+
+    void shader_library::add_include(const std::string& path, std::string source)
+    {
+        m_includes[path] = std::move(source);
+    }
+
+    uint32_t shader_library::add_program(const std::string& name, std::string vertex, std::string fragment, const std::vector<std::string>& keywords)
+    {
+        if (keywords.size() > k_max_keywords || find_program(name) != GR_INVALID_ID)
+            return GR_INVALID_ID;
+
+        program entry;
+        entry.name = name;
+        entry.vertex = std::move(vertex);
+        entry.fragment = std::move(fragment);
+        entry.keywords = keywords;
+        entry.valid_mask = keywords.size() == k_max_keywords ? ~0ull : (1ull << keywords.size()) - 1;
+
+        m_programs.push_back(std::move(entry));
+        return static_cast<uint32_t>(m_programs.size() - 1);
+    }
+
+    uint32_t shader_library::find_program(const std::string& name) const
+    {
+        for (size_t i = 0; i < m_programs.size(); i++)
+        {
+            if (m_programs[i].name == name)
+                return static_cast<uint32_t>(i);
+        }
+        return GR_INVALID_ID;
+    }
+
+    uint64_t shader_library::get_keyword_mask(uint32_t program, const char* keyword) const
+    {
+        if (program >= m_programs.size() || keyword == nullptr)
+            return 0;
+
+        const auto& keywords = m_programs[program].keywords;
+        for (size_t i = 0; i < keywords.size(); i++)
+        {
+            if (keywords[i] == keyword)
+                return 1ull << i;
+        }
+        return 0;
+    }
+
+    Shader* shader_library::get_variant(uint32_t program, uint64_t mask)
+    {
+        if (program >= m_programs.size())
+            return nullptr;
+
+        auto& entry = m_programs[program];
+        mask &= entry.valid_mask;
+
+        auto it = entry.variants.find(mask);
+        if (it != entry.variants.end())
+            return it->second;
+
+        Shader* shader = build_variant(entry, mask);
+        entry.variants.emplace(mask, shader);
+
+        m_statistics.variants++;
+        return shader;
+    }
+
+    uint32_t shader_library::precompile(const std::vector<std::pair<uint32_t, uint64_t>>& variants)
+    {
+        uint32_t count = 0;
+        for (const auto& variant : variants)
+        {
+            if (get_variant(variant.first, variant.second) != nullptr)
+                count++;
+        }
+        return count;
+    }
+
+    void shader_library::clear_variants()
+    {
+        for (auto& entry : m_programs)
+            entry.variants.clear();
+
+        m_shaders.clear();
+    }
+
+    // ********** private ********** //
+    Shader* shader_library::build_variant(const program& entry, uint64_t mask)
+    {
+        std::string vertex, fragment;
+        if (!preprocess(entry, entry.vertex, "vert", mask, vertex) || !preprocess(entry, entry.fragment, "frag", mask, fragment))
+        {
+            m_statistics.failures++;
+            return nullptr;
+        }
+
+        // o separador evita que "ab" + "c" e "a" + "bc" colidam
+        uint64_t hash = hash_text(14695981039346656037ull, vertex);
+        hash = hash_text(hash ^ 0xff, fragment);
+
+        auto range = m_shaders.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (it->second.vertex != vertex || it->second.fragment != fragment)
+                continue;
+
+            if (it->second.shader == nullptr)
+            {
+                m_statistics.failures++;
+                return nullptr;
+            }
+
+            m_statistics.shared++;
+            return it->second.shader.get();
+        }
+
+        std::unique_ptr<Shader> shader(new Shader());
+
+        const char* fragment_source = fragment.c_str();
+        const char* vertex_source = vertex.c_str();
+        if (shader->build(&fragment_source, 1, &vertex_source, 1) < 0)
+        {
+            char mask_text[32];
+            snprintf(mask_text, sizeof(mask_text), "%016llx", static_cast<unsigned long long>(mask));
+            m_last_error = entry.name + " variant " + mask_text + ": build failed";
+
+            m_statistics.failures++;
+            m_shaders.emplace(hash, compiled{std::move(vertex), std::move(fragment), nullptr});
+            return nullptr;
+        }
+
+        m_statistics.compiled++;
+
+        Shader* result = shader.get();
+        m_shaders.emplace(hash, compiled{std::move(vertex), std::move(fragment), std::move(shader)});
+        return result;
+    }
+
+    bool shader_library::preprocess(const program& entry, const std::string& source, const char* stage, uint64_t mask, std::string& output)
+    {
+        std::vector<std::string> files = {entry.name + "." + stage};
+
+        std::string expanded;
+        if (!expand_includes(source, 0, 0, files, expanded))
+        {
+            m_last_error = entry.name + " (" + stage + "): " + m_last_error;
+            return false;
+        }
+
+        // #version tem que ser a primeira diretiva (so comentarios antes); os defines vao logo depois
+        size_t header = 0;
+        uint32_t line = 1;
+        bool in_comment = false;
+        for (size_t begin = 0; begin < expanded.size();)
+        {
+            size_t end = expanded.find('\n', begin);
+            end = end == std::string::npos ? expanded.size() : end;
+
+            size_t first = skip_comments(expanded, begin, end, in_comment);
+            if (first < end)
+            {
+                size_t after;
+                if (is_directive(expanded, first, end, "version", after))
+                {
+                    header = std::min(end + 1, expanded.size());
+                    line++;
+                }
+                break;
+            }
+
+            begin = end + 1;
+            line++;
+        }
+        if (header == 0)
+            line = 1;
+
+        output.clear();
+        output.reserve(expanded.size() + 256);
+        output.append(expanded, 0, header);
+        if (header > 0 && output.back() != '\n')
+            output += '\n';
+
+        for (size_t i = 0; i < entry.keywords.size(); i++)
+        {
+            if ((mask & (1ull << i)) && mentions(expanded, entry.keywords[i]))
+                output += "#define " + entry.keywords[i] + " 1\n";
+        }
+
+        output += "#line " + std::to_string(line) + " 0\n";
+        output.append(expanded, header, std::string::npos);
+        return true;
+    }
+
+    bool shader_library::expand_includes(const std::string& source, uint32_t file, uint32_t depth, std::vector<std::string>& files, std::string& output)
+    {
+        if (depth > k_max_include_depth)
+        {
+            m_last_error = "includes nested deeper than " + std::to_string(k_max_include_depth) + " in " + files[file];
+            return false;
+        }
+
+        uint32_t line = 1;
+        for (size_t begin = 0; begin < source.size(); line++)
+        {
+            size_t end = source.find('\n', begin);
+            bool last = end == std::string::npos;
+            end = last ? source.size() : end;
+
+            size_t after;
+            if (!is_directive(source, begin, end, "include", after))
+            {
+                output.append(source, begin, end - begin);
+                output += '\n';
+                begin = end + 1;
+                continue;
+            }
+
+            size_t open = skip_spaces(source, after, end);
+            char close = open < end && source[open] == '<' ? '>' : '"';
+            size_t finish = open < end ? source.find(close, open + 1) : std::string::npos;
+            if (open >= end || (source[open] != '"' && source[open] != '<') || finish == std::string::npos || finish > end)
+            {
+                m_last_error = "malformed #include at " + files[file] + ":" + std::to_string(line);
+                return false;
+            }
+
+            std::string path = source.substr(open + 1, finish - open - 1);
+
+            // cada arquivo entra uma vez por estagio, o que tambem corta ciclos
+            if (std::find(files.begin(), files.end(), path) != files.end())
+            {
+                output += '\n';
+                begin = end + 1;
+                continue;
+            }
+
+            std::string text;
+            if (!load_include(path, text))
+            {
+                m_last_error = "cannot include \"" + path + "\" at " + files[file] + ":" + std::to_string(line);
+                return false;
+            }
+
+            uint32_t index = static_cast<uint32_t>(files.size());
+            files.push_back(path);
+
+            output += "#line 1 " + std::to_string(index) + "\n";
+            if (!expand_includes(text, index, depth + 1, files, output))
+                return false;
+            output += "#line " + std::to_string(line + 1) + " " + std::to_string(file) + "\n";
+
+            begin = end + 1;
+        }
+
+        return true;
+    }
+
+    bool shader_library::load_include(const std::string& path, std::string& source)
+    {
+        auto it = m_includes.find(path);
+        if (it != m_includes.end())
+        {
+            source = it->second;
+            return true;
+        }
+
+        return m_loader && m_loader(path, source);
+    }
+}
@@ -0,0 +1,422 @@
+#include "sprite_batch.hpp"
+
+#include "frame_allocator.hpp"
+#include "gRender.h"
+#include "gTexture.h"
+#include "gVertexArray.h"
+#include "gl.h"
+#include "platform/null/null_device.hpp"
+#include "shader.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+
+namespace gr
+{
+    namespace
+    {
+#if GR_OPENGLES3
+        const char* k_sprite_version = "#version 300 es\nprecision mediump float;\n";
+#else
+        const char* k_sprite_version = "#version 330 core\n";
+#endif
+
+        const char* k_sprite_vertex =
+            "layout(location = 0) in vec2 a_position;\n"
+            "layout(location = 1) in vec2 a_uv;\n"
+            "layout(location = 2) in vec4 a_color;\n"
+            "layout(location = 3) in float a_texture;\n"
+            "uniform mat4 u_projection;\n"
+            "out vec2 v_uv;\n"
+            "out vec4 v_color;\n"
+            "flat out int v_texture;\n"
+            "void main() {\n"
+            "    v_uv = a_uv;\n"
+            "    v_color = a_color;\n"
+            "    v_texture = int(a_texture + 0.5);\n"
+            "    gl_Position = u_projection * vec4(a_position, 0.0, 1.0);\n"
+            "}\n";
+
+        // indexar sampler arrays com valor nao uniforme e' indefinido no GLSL 3.30 / ES 3.0
+        std::string make_sprite_fragment(uint32_t max_textures)
+        {
+            std::string source;
+            source += "in vec2 v_uv;\n";
+            source += "in vec4 v_color;\n";
+            source += "flat in int v_texture;\n";
+            source += "uniform sampler2D u_textures[" + std::to_string(max_textures) + "];\n";
+            source += "out vec4 o_color;\n";
+            source += "void main() {\n";
+            source += "    vec4 texel = vec4(1.0);\n";
+            source += "    switch (v_texture) {\n";
+            for (uint32_t i = 0; i < max_textures; i++)
+            {
+                std::string slot = std::to_string(i);
+                source += "        case " + slot + ": texel = texture(u_textures[" + slot + "], v_uv); break;\n";
+            }
+            source += "    }\n";
+            source += "    o_color = texel * v_color;\n";
+            source += "}\n";
+            return source;
+        }
+
+        inline bool same_rect(const Rect& a, const Rect& b)
+        {
+            return a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h;
+        }
+    }
+
+    sprite_batch::sprite_batch(uint32_t max_quads, uint32_t max_textures)
+        : m_max_quads(max_quads), m_max_textures(max_textures),
+          m_projection_uniform(GR_INVALID_ID), m_textures_uniform(GR_INVALID_ID),
+          m_vertices(nullptr), m_vertex_count(0), m_staging_resets(0),
+          m_clip{0.0f, 0.0f, 0.0f, 0.0f}, m_clip_enabled(false), m_batch_scissor(false)
+    {
+        std::memset(&m_projection, 0, sizeof(m_projection));
+    }
+
+    sprite_batch::~sprite_batch()
+    {
+        release();
+    }
+
+    bool sprite_batch::initialize()
+    {
+        // sem contexto no backend Null: fica com o pedido
+        GLint units = 0;
+        if (!null_device::is_active())
+            GL_CALL(glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &units));
+        if (units > 0)
+            m_max_textures = std::min<uint32_t>(m_max_textures, static_cast<uint32_t>(units));
+        if (m_max_textures == 0)
+            m_max_textures = 1;
+
+        m_shader = std::make_unique<Shader>();
+
+        std::string fragment = make_sprite_fragment(m_max_textures);
+        const char* fragment_sources[] = {k_sprite_version, fragment.c_str()};
+        const char* vertex_sources[] = {k_sprite_version, k_sprite_vertex};
+
+        if (m_shader->build(fragment_sources, 2, vertex_sources, 2) < 0)
+        {
+            m_shader.reset();
+            return false;
+        }
+
+        m_projection_uniform = m_shader->registry("u_projection", 1, UniformType::MAT4);
+        m_textures_uniform = m_shader->registry("u_textures", m_max_textures, UniformType::SAMPLER2D);
+
+        {
+            std::vector<int32_t> slots(m_max_textures);
+            for (uint32_t i = 0; i < m_max_textures; i++)
+                slots[i] = static_cast<int32_t>(i);
+
+            m_shader->bind();
+            if (m_textures_uniform != GR_INVALID_ID)
+                m_shader->SetUniform(m_textures_uniform, slots.data());
+            m_shader->unbind();
+        }
+
+        // padrao de indices compartilhado por todos os quads
+        std::vector<uint32_t> indices(m_max_quads * 6);
+        for (uint32_t q = 0; q < m_max_quads; q++)
+        {
+            uint32_t base = q * 4;
+            uint32_t* out = &indices[q * 6];
+            out[0] = base + 0;
+            out[1] = base + 1;
+            out[2] = base + 2;
+            out[3] = base + 2;
+            out[4] = base + 3;
+            out[5] = base + 0;
+        }
+
+        m_vertex_buffer = vertex_buffer::create(nullptr, m_max_quads * 4 * sizeof(sprite_vertex), buffer_usage::dynamic_draw);
+        m_vertex_buffer->SetLayout({
+            {shader_data_type::Float2, "a_position"},
+            {shader_data_type::Float2, "a_uv"},
+            {shader_data_type::Float4, "a_color"},
+            {shader_data_type::Float, "a_texture"}
+        });
+
+        m_index_buffer = index_buffer::create(indices.data(), static_cast<uint32_t>(indices.size() * sizeof(uint32_t)));
+
+        m_vertex_array = vertex_array::create();
+        m_vertex_array->AddVertexBuffer(m_vertex_buffer);
+        m_vertex_array->SetIndexBuffer(m_index_buffer);
+
+        uint8_t white[4] = {255, 255, 255, 255};
+        m_white = std::make_unique<gTexture>();
+        m_white->set_format(TextureFormat_RGBA8888);
+        m_white->updateBuffer(1, 1, white);
+
+        m_textures.reserve(m_max_textures);
+
+        return true;
+    }
+
+    void sprite_batch::release()
+    {
+        m_vertex_array.reset();
+        m_vertex_buffer.reset();
+        m_index_buffer.reset();
+        m_shader.reset();
+        m_white.reset();
+
+        m_vertices = nullptr;
+        m_vertex_count = 0;
+        m_textures.clear();
+    }
+
+    void sprite_batch::begin(const Matrix4x4& projection)
+    {
+        m_stats = sprite_batch_stats();
+        m_projection = projection;
+
+        acquire_staging();
+        m_vertex_count = 0;
+        m_textures.clear();
+        m_batch_scissor = false;
+    }
+
+    void sprite_batch::end()
+    {
+        flush();
+
+        gRender::SetEnable(GR_SCISSOR_TEST, false);
+    }
+
+    void sprite_batch::flush()
+    {
+        if (m_vertex_count == 0 || !m_shader)
+            return;
+
+        m_vertex_buffer->SetData(m_vertices, m_vertex_count * static_cast<uint32_t>(sizeof(sprite_vertex)));
+
+        m_shader->bind();
+        if (m_projection_uniform != GR_INVALID_ID)
+            m_shader->SetUniform(m_projection_uniform, &m_projection);
+
+        for (uint32_t i = 0; i < m_textures.size(); i++)
+            m_textures[i]->bind(i);
+
+        gRender::SetEnable(GR_SCISSOR_TEST, m_batch_scissor);
+        if (m_batch_scissor)
+            gRender::SetScissor(m_clip);
+
+        m_vertex_array->Bind();
+        gVertexArray::DrawElements(TRIANGLES, static_cast<u32>(m_vertex_count / 4 * 6), nullptr);
+        m_vertex_array->Unbind();
+
+        m_stats.draw_calls++;
+
+        m_vertex_count = 0;
+        m_textures.clear();
+        m_batch_scissor = false;
+    }
+
+    void sprite_batch::set_projection(const Matrix4x4& projection)
+    {
+        if (std::memcmp(&projection, &m_projection, sizeof(Matrix4x4)) == 0)
+            return;
+
+        if (m_vertex_count > 0)
+        {
+            flush();
+            m_stats.state_flushes++;
+        }
+
+        m_projection = projection;
+    }
+
+    void sprite_batch::set_clip_rect(const Rect& rect)
+    {
+        if (m_clip_enabled && same_rect(rect, m_clip))
+            return;
+
+        // so o lote com scissor depende do retangulo; o resto foi recortado na CPU
+        if (m_batch_scissor)
+        {
+            flush();
+            m_stats.state_flushes++;
+        }
+
+        m_clip = rect;
+        m_clip_enabled = true;
+    }
+
+    void sprite_batch::clear_clip_rect()
+    {
+        if (m_batch_scissor)
+        {
+            flush();
+            m_stats.state_flushes++;
+        }
+
+        m_clip_enabled = false;
+    }
+
+    void sprite_batch::draw_quad(const Rect& rect, const Color& color)
+    {
+        draw_quad(rect, m_white.get(), Rect{0.0f, 0.0f, 1.0f, 1.0f}, color);
+    }
+
+    void sprite_batch::draw_quad(const Rect& rect, gTexture* texture, const Rect& uv, const Color& color)
+    {
+        if (rect.w <= 0.0f || rect.h <= 0.0f)
+            return;
+
+        float x0 = rect.x, x1 = rect.x + rect.w;
+        float y0 = rect.y, y1 = rect.y + rect.h;
+
+        Rect coords = uv;
+
+        if (m_clip_enabled)
+        {
+            float cx0 = std::max(x0, m_clip.x), cx1 = std::min(x1, m_clip.x + m_clip.w);
+            float cy0 = std::max(y0, m_clip.y), cy1 = std::min(y1, m_clip.y + m_clip.h);
+
+            if (cx0 >= cx1 || cy0 >= cy1)
+                return;
+
+            // recorta as coordenadas de textura na mesma proporcao
+            coords.x = uv.x + (cx0 - x0) / rect.w * uv.w;
+            coords.y = uv.y + (cy0 - y0) / rect.h * uv.h;
+            coords.w = (cx1 - cx0) / rect.w * uv.w;
+            coords.h = (cy1 - cy0) / rect.h * uv.h;
+
+            x0 = cx0; x1 = cx1;
+            y0 = cy0; y1 = cy1;
+        }
+
+        float slot = acquire_slot(texture);
+
+        const float xs[4] = {x0, x1, x1, x0};
+        const float ys[4] = {y0, y0, y1, y1};
+        push_quad(xs, ys, coords, color, slot);
+    }
+
+    void sprite_batch::draw_quad(const Rect& rect, float rotation, const Vector2& origin, gTexture* texture, const Rect& uv, const Color& color)
+    {
+        if (rotation == 0.0f)
+            return draw_quad(rect, texture, uv, color);
+
+        if (rect.w <= 0.0f || rect.h <= 0.0f)
+            return;
+
+        if (m_clip_enabled && !m_batch_scissor)
+        {
+            if (m_vertex_count > 0)
+            {
+                flush();
+                m_stats.state_flushes++;
+            }
+            m_batch_scissor = true;
+        }
+
+        float s = std::sin(rotation);
+        float c = std::cos(rotation);
+
+        const float cx[4] = {rect.x, rect.x + rect.w, rect.x + rect.w, rect.x};
+        const float cy[4] = {rect.y, rect.y, rect.y + rect.h, rect.y + rect.h};
+
+        float xs[4], ys[4];
+        for (int i = 0; i < 4; i++)
+        {
+            float dx = cx[i] - origin.x;
+            float dy = cy[i] - origin.y;
+
+            xs[i] = origin.x + dx * c - dy * s;
+            ys[i] = origin.y + dx * s + dy * c;
+        }
+
+        float slot = acquire_slot(texture);
+        push_quad(xs, ys, uv, color, slot);
+    }
+
+    void sprite_batch::draw_nine_slice(const Rect& rect, gTexture* texture, const Rect& uv, const nine_slice& slice, const Color& color)
+    {
+        const float xs[4] = {rect.x, rect.x + slice.left, rect.x + rect.w - slice.right, rect.x + rect.w};
+        const float ys[4] = {rect.y, rect.y + slice.bottom, rect.y + rect.h - slice.top, rect.y + rect.h};
+
+        const float us[4] = {uv.x, uv.x + slice.uv_left, uv.x + uv.w - slice.uv_right, uv.x + uv.w};
+        const float vs[4] = {uv.y, uv.y + slice.uv_bottom, uv.y + uv.h - slice.uv_top, uv.y + uv.h};
+
+        for (int j = 0; j < 3; j++)
+        {
+            for (int i = 0; i < 3; i++)
+            {
+                Rect cell{xs[i], ys[j], xs[i + 1] - xs[i], ys[j + 1] - ys[j]};
+                Rect cell_uv{us[i], vs[j], us[i + 1] - us[i], vs[j + 1] - vs[j]};
+
+                draw_quad(cell, texture, cell_uv, color);
+            }
+        }
+    }
+
+    float sprite_batch::acquire_slot(gTexture* texture)
+    {
+        if (texture == nullptr)
+            texture = m_white.get();
+
+        for (size_t i = 0; i < m_textures.size(); i++)
+        {
+            if (m_textures[i] == texture)
+                return static_cast<float>(i);
+        }
+
+        if (m_textures.size() >= m_max_textures)
+        {
+            bool scissor = m_batch_scissor;
+
+            flush();
+            m_stats.texture_flushes++;
+
+            m_batch_scissor = scissor;
+        }
+
+        m_textures.push_back(texture);
+        return static_cast<float>(m_textures.size() - 1);
+    }
+
+    void sprite_batch::acquire_staging()
+    {
+        // um bloco por frame; depois do BeginFrame o anterior ja foi reaproveitado
+        frame_allocator& allocator = gRender::GetFrameAllocator();
+        if (m_vertices != nullptr && m_staging_resets == allocator.get_resets())
+            return;
+
+        m_vertices = allocator.allocate_array<sprite_vertex>(static_cast<size_t>(m_max_quads) * 4);
+        m_staging_resets = allocator.get_resets();
+        m_vertex_count = 0;
+    }
+
+    void sprite_batch::push_quad(const float* xs, const float* ys, const Rect& uv, const Color& color, float slot)
+    {
+        if (m_vertices == nullptr)
+            acquire_staging();
+
+        if (m_vertex_count + 4 > m_max_quads * 4)
+        {
+            gTexture* texture = m_textures[static_cast<size_t>(slot)];
+            bool scissor = m_batch_scissor;
+
+            flush();
+            m_stats.state_flushes++;
+
+            m_batch_scissor = scissor;
+            m_textures.push_back(texture);
+            slot = 0.0f;
+        }
+
+        const float us[4] = {uv.x, uv.x + uv.w, uv.x + uv.w, uv.x};
+        const float vs[4] = {uv.y, uv.y, uv.y + uv.h, uv.y + uv.h};
+
+        for (int i = 0; i < 4; i++)
+            m_vertices[m_vertex_count++] = {xs[i], ys[i], us[i], vs[i], color.r, color.g, color.b, color.a, slot};
+
+        m_stats.quads++;
+    }
+}
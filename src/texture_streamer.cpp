@@ -0,0 +1,390 @@
+#include "texture_streamer.hpp"
+
+#include "memory_tracker.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace gr
+{
+    texture_streamer::texture_streamer(uint64_t budget, thread_pool* pool)
+        :
+            m_pool(pool != nullptr ? pool : &thread_pool::get_default()),
+            m_completed(std::make_shared<completion_queue>()),
+            m_budget(budget),
+            m_frame(0),
+            m_release_epoch(1),
+            m_max_in_flight(8)
+    {
+        m_stats.budget = budget;
+    }
+
+    texture_streamer::~texture_streamer()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_completed->mutex);
+            m_completed->closed = true;
+            m_completed->levels.clear();
+        }
+
+        for (uint32_t i = 0; i < m_entries.size(); i++)
+        {
+            if (m_entries[i].alive)
+                destroy(i);
+        }
+    }
+
+    uint32_t texture_streamer::create(const streaming_texture_desc& desc, texture_level_loader loader)
+    {
+        if (!desc.width || !desc.height || !loader)
+            return GR_INVALID_ID;
+
+        uint32_t handle;
+        if (!m_free.empty())
+        {
+            handle = m_free.back();
+            m_free.pop_back();
+        } else
+        {
+            handle = static_cast<uint32_t>(m_entries.size());
+            m_entries.emplace_back();
+            m_entries.back().generation = 0;
+        }
+
+        entry& e = m_entries[handle];
+        e.texture = std::make_unique<gTexture>();
+        e.texture->set_format(desc.format);
+        e.texture->set_clamping(desc.clamping);
+        e.texture->set_filtering(gTextureFlags_Filter_Trilinear);
+        e.texture->allocate_levels(desc.width, desc.height, desc.levels);
+        e.texture->set_debug_name(desc.name);
+
+        e.loader = std::make_shared<texture_level_loader>(std::move(loader));
+        e.width = desc.width;
+        e.height = desc.height;
+        e.levels = e.texture->get_level_count();
+        e.pixel_size = e.texture->get_pixel_size();
+        e.tail = e.levels - 1;
+        while (e.tail > 0 && std::max(desc.width >> (e.tail - 1), desc.height >> (e.tail - 1)) <= k_tail_size)
+            e.tail--;
+        e.resident = e.levels;
+        e.wanted = e.tail;
+        e.priority = 0.0f;
+        e.last_used = m_frame;
+        e.rejected_epoch = 0;
+        e.failures = 0;
+        e.failed_level = GR_INVALID_ID;
+        e.loading = false;
+        e.alive = true;
+
+        // cauda carregada na hora, do menor para o maior
+        std::vector<uint8_t> pixels;
+        for (uint32_t level = e.levels; level-- > e.tail;)
+        {
+            uint32_t width = std::max(e.width >> level, 1u);
+            uint32_t height = std::max(e.height >> level, 1u);
+
+            pixels.clear();
+            if (!(*e.loader)(level, width, height, pixels) || pixels.size() < static_cast<size_t>(width) * height * e.pixel_size)
+            {
+                e.texture.reset();
+                e.loader.reset();
+                e.alive = false;
+                e.generation++;
+                m_free.push_back(handle);
+                return GR_INVALID_ID;
+            }
+
+            e.texture->update_level(level, pixels.data());
+            e.resident = level;
+        }
+
+        e.texture->set_level_range(e.resident, e.levels - 1);
+
+        uint64_t bytes = resident_size(e);
+        m_stats.resident_bytes += bytes;
+        m_stats.textures++;
+
+        memory_tracker::track(memory_category::texture, e.texture->getTextureID(), bytes, desc.name);
+
+        return handle;
+    }
+
+    void texture_streamer::destroy(uint32_t handle)
+    {
+        if (handle >= m_entries.size() || !m_entries[handle].alive)
+            return;
+
+        entry& e = m_entries[handle];
+
+        m_stats.resident_bytes -= resident_size(e);
+        m_stats.textures--;
+        m_release_epoch++;
+
+        if (e.loading)
+            m_stats.loads_in_flight--;
+
+        // o destrutor do gTexture desfaz o registro no memory_tracker
+        e.texture.reset();
+        e.loader.reset();
+        e.alive = false;
+        e.loading = false;
+        e.generation++;
+
+        m_free.push_back(handle);
+    }
+
+    gTexture* texture_streamer::get_texture(uint32_t handle)
+    {
+        if (handle >= m_entries.size() || !m_entries[handle].alive)
+            return nullptr;
+
+        return m_entries[handle].texture.get();
+    }
+
+    void texture_streamer::request(uint32_t handle, uint32_t level, float priority)
+    {
+        if (handle >= m_entries.size() || !m_entries[handle].alive)
+            return;
+
+        entry& e = m_entries[handle];
+        level = std::min(level, e.tail);
+
+        if (e.last_used != m_frame)
+        {
+            e.wanted = level;
+            e.priority = priority;
+            e.last_used = m_frame;
+        } else
+        {
+            e.wanted = std::min(e.wanted, level);
+            e.priority = std::max(e.priority, priority);
+        }
+    }
+
+    void texture_streamer::update(uint32_t max_uploads)
+    {
+        m_stats.uploads = 0;
+        m_stats.evictions = 0;
+        m_stats.rejected = 0;
+        m_stats.failed = 0;
+
+        std::vector<loaded_level> finished;
+        {
+            std::lock_guard<std::mutex> lock(m_completed->mutex);
+            finished.swap(m_completed->levels);
+        }
+
+        for (size_t i = 0; i < finished.size(); i++)
+        {
+            loaded_level& level = finished[i];
+
+            entry* e = level.handle < m_entries.size() ? &m_entries[level.handle] : nullptr;
+            if (e == nullptr || !e->alive || e->generation != level.generation)
+                continue;
+
+            if (m_stats.uploads >= max_uploads)
+            {
+                // fica para o proximo update
+                std::lock_guard<std::mutex> lock(m_completed->mutex);
+                m_completed->levels.push_back(std::move(level));
+                continue;
+            }
+
+            upload(level.handle, level);
+        }
+
+        schedule();
+
+        m_frame++;
+    }
+
+    void texture_streamer::set_budget(uint64_t budget)
+    {
+        m_budget = budget;
+        m_stats.budget = budget;
+        m_release_epoch++;
+
+        while (m_stats.resident_bytes > m_budget && evict_one(GR_INVALID_ID))
+            ;
+    }
+
+    void texture_streamer::set_max_in_flight(uint32_t loads)
+    {
+        m_max_in_flight = std::max(loads, 1u);
+    }
+
+    uint32_t texture_streamer::get_resident_level(uint32_t handle) const
+    {
+        if (handle >= m_entries.size() || !m_entries[handle].alive)
+            return GR_INVALID_ID;
+
+        return m_entries[handle].resident;
+    }
+
+    uint32_t texture_streamer::required_level(uint32_t width, uint32_t height, float screen_width, float screen_height)
+    {
+        if (screen_width <= 0.0f || screen_height <= 0.0f)
+            return GR_INVALID_ID;
+
+        float ratio = std::max(width / screen_width, height / screen_height);
+        if (ratio <= 1.0f)
+            return 0;
+
+        return static_cast<uint32_t>(std::floor(std::log2(ratio)));
+    }
+
+    // ********** private ********** //
+    uint64_t texture_streamer::level_size(const entry& e, uint32_t level) const
+    {
+        return memory_tracker::texture_size(std::max(e.width >> level, 1u), std::max(e.height >> level, 1u), e.pixel_size);
+    }
+
+    uint64_t texture_streamer::resident_size(const entry& e) const
+    {
+        uint64_t bytes = 0;
+        for (uint32_t level = e.resident; level < e.levels; level++)
+            bytes += level_size(e, level);
+        return bytes;
+    }
+
+    bool texture_streamer::evict_one(uint32_t exclude)
+    {
+        uint32_t victim = GR_INVALID_ID;
+
+        for (uint32_t i = 0; i < m_entries.size(); i++)
+        {
+            const entry& e = m_entries[i];
+            if (!e.alive || i == exclude || e.resident >= e.tail)
+                continue;
+
+            // o que foi pedido neste frame so sai se tiver mips alem do necessario
+            if (e.last_used == m_frame && e.wanted <= e.resident)
+                continue;
+
+            if (victim == GR_INVALID_ID || e.last_used < m_entries[victim].last_used)
+                victim = i;
+        }
+
+        if (victim == GR_INVALID_ID)
+            return false;
+
+        entry& e = m_entries[victim];
+        uint32_t level = e.resident++;
+
+        // o proximo mip a carregar mudou
+        e.failures = 0;
+
+        e.texture->set_level_range(e.resident, e.levels - 1);
+        e.texture->release_level(level);
+
+        m_stats.resident_bytes -= level_size(e, level);
+        m_stats.evictions++;
+        m_release_epoch++;
+
+        memory_tracker::track(memory_category::texture, e.texture->getTextureID(), resident_size(e));
+
+        return true;
+    }
+
+    void texture_streamer::upload(uint32_t handle, loaded_level& level)
+    {
+        entry& e = m_entries[handle];
+        e.loading = false;
+        m_stats.loads_in_flight--;
+
+        // uma eviccao pode ter subido o mip residente enquanto o nivel carregava
+        if (level.level + 1 != e.resident)
+            return;
+
+        if (!level.ok)
+        {
+            m_stats.failed++;
+
+            // desiste do mip em vez de pedir de novo a cada frame
+            if (++e.failures >= k_max_load_attempts)
+                e.failed_level = level.level;
+            return;
+        }
+
+        uint64_t bytes = level_size(e, level.level);
+        while (m_stats.resident_bytes + bytes > m_budget)
+        {
+            if (!evict_one(handle))
+            {
+                // so tenta de novo quando alguma memoria for liberada
+                e.rejected_epoch = m_release_epoch;
+                m_stats.rejected++;
+                return;
+            }
+        }
+
+        e.texture->update_level(level.level, level.pixels.data());
+        e.resident = level.level;
+        e.failures = 0;
+        e.texture->set_level_range(e.resident, e.levels - 1);
+
+        m_stats.resident_bytes += bytes;
+        m_stats.uploads++;
+
+        memory_tracker::track(memory_category::texture, e.texture->getTextureID(), resident_size(e));
+    }
+
+    void texture_streamer::schedule()
+    {
+        if (m_stats.loads_in_flight >= m_max_in_flight)
+            return;
+
+        std::vector<uint32_t> candidates;
+        for (uint32_t i = 0; i < m_entries.size(); i++)
+        {
+            const entry& e = m_entries[i];
+            if (e.alive && !e.loading && e.last_used == m_frame && e.wanted < e.resident && e.rejected_epoch != m_release_epoch &&
+                e.resident - 1 != e.failed_level)
+                candidates.push_back(i);
+        }
+
+        // prioridade do chamador pesada pela distancia ate o mip pedido
+        auto urgency = [this](uint32_t index) {
+            const entry& e = m_entries[index];
+            return e.priority * static_cast<float>(e.resident - e.wanted);
+        };
+
+        std::sort(candidates.begin(), candidates.end(), [&](uint32_t a, uint32_t b) {
+            float ua = urgency(a), ub = urgency(b);
+            return ua != ub ? ua > ub : a < b;
+        });
+
+        for (uint32_t handle : candidates)
+        {
+            if (m_stats.loads_in_flight >= m_max_in_flight)
+                break;
+
+            entry& e = m_entries[handle];
+            e.loading = true;
+            m_stats.loads_in_flight++;
+
+            uint32_t level = e.resident - 1;
+            uint32_t width = std::max(e.width >> level, 1u);
+            uint32_t height = std::max(e.height >> level, 1u);
+            size_t expected = static_cast<size_t>(width) * height * e.pixel_size;
+
+            std::shared_ptr<completion_queue> queue = m_completed;
+            std::shared_ptr<texture_level_loader> loader = e.loader;
+            uint32_t generation = e.generation;
+
+            m_pool->submit([queue, loader, handle, generation, level, width, height, expected]() {
+                loaded_level result;
+                result.handle = handle;
+                result.generation = generation;
+                result.level = level;
+                result.ok = (*loader)(level, width, height, result.pixels) && result.pixels.size() >= expected;
+
+                std::lock_guard<std::mutex> lock(queue->mutex);
+                if (!queue->closed)
+                    queue->levels.push_back(std::move(result));
+            });
+        }
+    }
+}
@@ -0,0 +1,151 @@
+#include "thread_pool.hpp"
+
+#include <memory>
+
+namespace gr
+{
+    namespace
+    {
+        struct parallel_job
+        {
+            std::function<void(uint32_t, uint32_t)> func;
+            std::atomic<uint32_t> next{0};
+            std::atomic<uint32_t> done{0};
+            uint32_t count = 0;
+            uint32_t grain = 1;
+            uint32_t chunks = 0;
+
+            std::mutex mutex;
+            std::condition_variable cv;
+
+            void run()
+            {
+                uint32_t chunk;
+                while ((chunk = next.fetch_add(1, std::memory_order_relaxed)) < chunks)
+                {
+                    uint32_t begin = chunk * grain;
+                    uint32_t end = begin + grain < count ? begin + grain : count;
+
+                    func(begin, end);
+
+                    if (done.fetch_add(1, std::memory_order_acq_rel) + 1 == chunks)
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        cv.notify_all();
+                    }
+                }
+            }
+        };
+    }
+
+    thread_pool::thread_pool(uint32_t threads) : m_active(0), m_stop(false)
+    {
+        if (threads == 0)
+            threads = std::thread::hardware_concurrency();
+
+        if (threads == 0)
+            threads = 1;
+
+        // a thread que chama parallel_for tambem trabalha
+        for (uint32_t i = 1; i < threads; i++)
+            m_workers.emplace_back(&thread_pool::worker_loop, this);
+    }
+
+    thread_pool::~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_task_cv.notify_all();
+
+        for (auto& worker : m_workers)
+            worker.join();
+    }
+
+    thread_pool& thread_pool::get_default()
+    {
+        static thread_pool instance;
+        return instance;
+    }
+
+    void thread_pool::submit(std::function<void()> task)
+    {
+        if (m_workers.empty())
+        {
+            task();
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.push_back(std::move(task));
+        }
+        m_task_cv.notify_one();
+    }
+
+    void thread_pool::wait()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idle_cv.wait(lock, [this] { return m_tasks.empty() && m_active == 0; });
+    }
+
+    void thread_pool::parallel_for(uint32_t count, uint32_t grain, const std::function<void(uint32_t begin, uint32_t end)>& func)
+    {
+        if (count == 0)
+            return;
+
+        if (grain == 0)
+            grain = 1;
+
+        uint32_t chunks = (count + grain - 1) / grain;
+        if (chunks == 1 || m_workers.empty())
+        {
+            func(0, count);
+            return;
+        }
+
+        auto job = std::make_shared<parallel_job>();
+        job->func = func;
+        job->count = count;
+        job->grain = grain;
+        job->chunks = chunks;
+
+        uint32_t helpers = chunks - 1 < m_workers.size() ? chunks - 1 : static_cast<uint32_t>(m_workers.size());
+        for (uint32_t i = 0; i < helpers; i++)
+            submit([job] { job->run(); });
+
+        job->run();
+
+        std::unique_lock<std::mutex> lock(job->mutex);
+        job->cv.wait(lock, [&] { return job->done.load(std::memory_order_acquire) == chunks; });
+    }
+
+    void thread_pool::worker_loop()
+    {
+        for (;;)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_task_cv.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+
+                if (m_stop && m_tasks.empty())
+                    return;
+
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+                m_active++;
+            }
+
+            task();
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_active--;
+                if (m_tasks.empty() && m_active == 0)
+                    m_idle_cv.notify_all();
+            }
+        }
+    }
+}
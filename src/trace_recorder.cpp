@@ -0,0 +1,137 @@
+#include "trace_recorder.hpp"
+
+namespace gr
+{
+    thread_local bool trace_recorder::s_recording = false;
+
+    thread_local std::vector<uint8_t> trace_recorder::s_buffer;
+
+    thread_local std::ofstream trace_recorder::s_file;
+
+    thread_local uint32_t trace_recorder::s_frames_left = 0;
+
+    bool trace_recorder::start(const char* path, uint32_t frames)
+    {
+        stop();
+
+        s_file.open(path, std::ios::binary | std::ios::trunc);
+        if (!s_file)
+            return false;
+
+        s_buffer.clear();
+        s_buffer.reserve(1 << 20);
+
+        uint32_t header[2] = {k_magic, k_version};
+        s_file.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+        s_frames_left = frames;
+        s_recording = true;
+        return true;
+    }
+
+    void trace_recorder::stop()
+    {
+        if (!s_recording)
+            return;
+
+        flush();
+        s_file.close();
+
+        s_recording = false;
+        s_buffer = std::vector<uint8_t>();
+    }
+
+    void trace_recorder::end_frame()
+    {
+        if (!s_recording)
+            return;
+
+        flush();
+
+        if (s_frames_left > 0 && --s_frames_left == 0)
+            stop();
+    }
+
+    // ********** private ********** //
+    void trace_recorder::flush()
+    {
+        if (!s_buffer.empty())
+            s_file.write(reinterpret_cast<const char*>(s_buffer.data()), static_cast<std::streamsize>(s_buffer.size()));
+
+        s_buffer.clear();
+    }
+
+    bool trace_reader::open(const char* path)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file)
+            return false;
+
+        std::streamsize size = file.tellg();
+        if (size < static_cast<std::streamsize>(sizeof(uint32_t) * 2))
+            return false;
+
+        m_data.resize(static_cast<size_t>(size));
+        file.seekg(0);
+        if (!file.read(reinterpret_cast<char*>(m_data.data()), size))
+            return false;
+
+        uint32_t header[2];
+        std::memcpy(header, m_data.data(), sizeof(header));
+        if (header[0] != trace_recorder::k_magic || header[1] != trace_recorder::k_version)
+            return false;
+
+        m_next = sizeof(header);
+        m_cursor = m_end = m_next;
+        return true;
+    }
+
+    bool trace_reader::next()
+    {
+        if (m_next + 8 > m_data.size())
+            return false;
+
+        uint16_t op;
+        uint32_t size;
+        std::memcpy(&op, m_data.data() + m_next, sizeof(op));
+        std::memcpy(&size, m_data.data() + m_next + 4, sizeof(size));
+
+        if (m_next + 8 + size > m_data.size())
+            return false;
+
+        m_op = static_cast<trace_op>(op);
+        m_cursor = m_next + 8;
+        m_end = m_cursor + size;
+        m_next = m_end;
+        m_overrun = false;
+        return true;
+    }
+
+    trace_blob trace_reader::read_blob()
+    {
+        uint32_t size = read<uint32_t>();
+        if (m_overrun || m_cursor + size > m_end)
+        {
+            m_overrun = true;
+            return {nullptr, 0};
+        }
+
+        trace_blob blob = {size > 0 ? m_data.data() + m_cursor : nullptr, size};
+        m_cursor += size;
+        return blob;
+    }
+
+    const char* trace_reader::read_string()
+    {
+        uint32_t size = read<uint32_t>();
+        if (m_overrun || m_cursor + size + 1 > m_end)
+        {
+            m_overrun = true;
+            return "";
+        }
+
+        const char* text = reinterpret_cast<const char*>(m_data.data() + m_cursor);
+        m_cursor += size + 1;
+        return text;
+    }
+}
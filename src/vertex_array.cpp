@@ -1,11 +1,68 @@
 #include "vertex_array.hpp"
 
+#include "platform/null/null_vertex_array.hpp"
+#include "platform/opengl/opengl_dsa_vertex_array.hpp"
 #include "platform/opengl/opengl_vertex_array.hpp"
+#include "platform/software/software_vertex_array.hpp"
+
+#include "gRender.h"
+#include "gl.h"
+#include "trace_recorder.hpp"
 
 namespace gr
 {
+    namespace
+    {
+        std::shared_ptr<vertex_array> create_backend()
+        {
+            RenderBackend backend = gRender::GetBackend();
+            if (backend == RenderBackend::Software)
+                return std::make_shared<software_vertex_array>();
+
+            if (backend == RenderBackend::Null)
+                return std::make_shared<null_vertex_array>();
+
+#if !GR_OPENGLES3
+            if (grr::use_direct_state_access())
+                return std::make_shared<opengl_dsa_vertex_array>();
+#endif
+            return std::make_shared<opengl_vertex_array>();
+        }
+    }
+
     std::shared_ptr<vertex_array> vertex_array::create()
     {
-        return std::make_shared<opengl_vertex_array>();
+        std::shared_ptr<vertex_array> vao = create_backend();
+
+        trace_recorder::record(trace_op::vertex_array_create, trace_recorder::key(vao.get()));
+
+        return vao;
+    }
+
+    vertex_array::~vertex_array()
+    {
+        trace_recorder::record(trace_op::vertex_array_destroy, trace_recorder::key(this));
+    }
+
+    void vertex_array::trace_add_vertex_buffer(const vertex_buffer& vbo) const
+    {
+        if (!trace_recorder::is_recording())
+            return;
+
+        // tipo e flags de cada elemento; nomes nao importam para o replay
+        struct element
+        {
+            uint32_t type;
+            uint8_t normalized;
+            uint8_t instanced;
+            uint16_t reserved;
+        };
+
+        std::vector<element> elements;
+        for (const auto& it : vbo.GetLayout())
+            elements.push_back({static_cast<uint32_t>(it.type), static_cast<uint8_t>(it.normalized), static_cast<uint8_t>(it.instanced), 0});
+
+        trace_recorder::record(trace_op::vertex_array_add_buffer, trace_recorder::key(this), trace_recorder::key(&vbo),
+            trace_blob{elements.data(), static_cast<uint32_t>(elements.size() * sizeof(element))});
     }
 }
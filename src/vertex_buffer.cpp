@@ -1,11 +1,46 @@
 #include "vertex_buffer.hpp"
 
+#include "platform/null/null_vertex_buffer.hpp"
+#include "platform/opengl/opengl_dsa_vertex_buffer.hpp"
 #include "platform/opengl/opengl_vertex_buffer.hpp"
+#include "platform/software/software_vertex_buffer.hpp"
+
+#include "gRender.h"
+#include "gl.h"
+#include "trace_recorder.hpp"
 
 namespace gr
 {
+    namespace
+    {
+        std::shared_ptr<vertex_buffer> create_backend(const void* data, uint32_t size, buffer_usage usage)
+        {
+            RenderBackend backend = gRender::GetBackend();
+            if (backend == RenderBackend::Software)
+                return std::make_shared<software_vertex_buffer>(data, size, usage);
+
+            if (backend == RenderBackend::Null)
+                return std::make_shared<null_vertex_buffer>(data, size, usage);
+
+#if !GR_OPENGLES3
+            if (grr::use_direct_state_access())
+                return std::make_shared<opengl_dsa_vertex_buffer>(data, size, usage);
+#endif
+            return std::make_shared<opengl_vertex_buffer>(data, size, usage);
+        }
+    }
+
     std::shared_ptr<vertex_buffer> vertex_buffer::create(const void *data, uint32_t size, buffer_usage usage)
     {
-        return std::make_shared<opengl_vertex_buffer>(data, size, usage);
+        std::shared_ptr<vertex_buffer> vbo = create_backend(data, size, usage);
+
+        trace_recorder::record(trace_op::vertex_buffer_create, trace_recorder::key(vbo.get()), static_cast<uint32_t>(usage), trace_blob{data, size});
+
+        return vbo;
+    }
+
+    vertex_buffer::~vertex_buffer()
+    {
+        trace_recorder::record(trace_op::vertex_buffer_destroy, trace_recorder::key(this));
     }
 }
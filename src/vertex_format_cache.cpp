@@ -0,0 +1,285 @@
+#include "vertex_format_cache.hpp"
+
+#if !GR_OPENGLES3
+
+#include "gl.h"
+#include "index_buffer.hpp"
+#include "platform/null/null_device.hpp"
+#include "render_stats.hpp"
+#include "trace_recorder.hpp"
+#include "vertex_buffer.hpp"
+
+namespace gr
+{
+    namespace
+    {
+        inline uint64_t stream_hash(const vertex_stream* streams, uint32_t count)
+        {
+            uint64_t hash = count;
+            for (uint32_t i = 0; i < count; i++)
+                hash = (hash ^ streams[i].layout->get_hash()) * 1099511628211ull;
+            return hash;
+        }
+    }
+
+    vertex_format_cache::~vertex_format_cache()
+    {
+        release();
+    }
+
+    uint32_t vertex_format_cache::get_vertex_array(const vertex_stream* streams, uint32_t count)
+    {
+        if (count == 0 || count > k_max_streams)
+            return 0;
+
+        trace_recorder::record(trace_op::unsupported, "vertex_format_cache::get_vertex_array");
+
+        uint64_t hash = stream_hash(streams, count);
+
+        format* entry = find(hash, streams, count);
+        if (entry == nullptr)
+            entry = create(hash, streams, count);
+
+        return entry != nullptr ? entry->id : 0;
+    }
+
+    bool vertex_format_cache::bind(const vertex_stream* streams, uint32_t count, uint32_t index_buffer)
+    {
+        if (count == 0 || count > k_max_streams)
+            return false;
+
+        trace_recorder::record(trace_op::unsupported, "vertex_format_cache::bind");
+
+        uint64_t hash = stream_hash(streams, count);
+
+        // mesma malha ou mesmo formato da anterior: nem consulta o mapa
+        format* entry = m_current;
+        if (entry == nullptr || entry->hash != hash || !matches(*entry, streams, count))
+        {
+            entry = find(hash, streams, count);
+            if (entry == nullptr)
+                entry = create(hash, streams, count);
+            if (entry == nullptr)
+                return false;
+        }
+
+        // nomes apagados voltam em glGenBuffers: o que o VAO guarda pode ser outro buffer
+        uint32_t deletions = grr::get_buffer_deletions();
+        if (deletions != m_buffer_deletions)
+        {
+            forget_buffers();
+            m_buffer_deletions = deletions;
+        }
+
+        const bool null_backend = null_device::is_active();
+
+        if (entry != m_current)
+        {
+            if (null_backend)
+            {
+                null_device::check("vertex_format_cache::bind");
+                null_device::bind_vertex_array(entry->id);
+            } else
+            {
+                GL_CALL(glBindVertexArray(entry->id));
+            }
+            m_current = entry;
+
+            render_stats::count_vertex_array_bind();
+        }
+
+        // o VAO guarda os buffers; so troca o que mudou
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (entry->buffers[i] == streams[i].buffer && entry->offsets[i] == streams[i].offset)
+                continue;
+
+            if (null_backend)
+            {
+                if (!null_device::check("vertex_format_cache::bind", null_device::is_object(null_object::buffer, streams[i].buffer)))
+                    return false;
+            } else
+            {
+                GL_CALL(glBindVertexBuffer(i, streams[i].buffer, streams[i].offset, streams[i].layout->get_stride()));
+            }
+            entry->buffers[i] = streams[i].buffer;
+            entry->offsets[i] = streams[i].offset;
+
+            render_stats::count_buffer_bind();
+        }
+
+        if (entry->index_buffer != index_buffer)
+        {
+            if (null_backend)
+            {
+                if (!null_device::check("vertex_format_cache::bind", index_buffer == 0 || null_device::is_object(null_object::buffer, index_buffer)))
+                    return false;
+            } else
+            {
+                GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer));
+            }
+            entry->index_buffer = index_buffer;
+
+            render_stats::count_buffer_bind();
+        }
+
+        return true;
+    }
+
+    bool vertex_format_cache::bind(const vertex_buffer& vbo, const index_buffer* ibo)
+    {
+        vertex_stream stream;
+        stream.layout = &vbo.GetLayout();
+        stream.buffer = vbo.GetID();
+
+        return bind(&stream, 1, ibo != nullptr ? ibo->GetID() : 0);
+    }
+
+    void vertex_format_cache::reset_bindings()
+    {
+        m_current = nullptr;
+    }
+
+    void vertex_format_cache::forget_buffers()
+    {
+        for (auto& it : m_formats)
+        {
+            format& entry = it.second;
+            for (uint32_t i = 0; i < entry.count; i++)
+                entry.buffers[i] = GR_INVALID_ID;
+
+            entry.index_buffer = GR_INVALID_ID;
+        }
+    }
+
+    void vertex_format_cache::release()
+    {
+        for (auto& it : m_formats)
+        {
+            if (null_device::is_active())
+                null_device::destroy_object(null_object::vertex_array, it.second.id, "vertex_format_cache::release");
+            else
+                glDeleteVertexArrays(1, &it.second.id);
+        }
+
+        m_formats.clear();
+        m_current = nullptr;
+    }
+
+    // ********** private ********** //
+    vertex_format_cache::format* vertex_format_cache::find(uint64_t hash, const vertex_stream* streams, uint32_t count)
+    {
+        auto range = m_formats.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (matches(it->second, streams, count))
+                return &it->second;
+        }
+        return nullptr;
+    }
+
+    bool vertex_format_cache::matches(const format& entry, const vertex_stream* streams, uint32_t count)
+    {
+        if (entry.count != count)
+            return false;
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (!entry.layouts[i].is_compatible(*streams[i].layout))
+                return false;
+        }
+        return true;
+    }
+
+    vertex_format_cache::format* vertex_format_cache::create(uint64_t hash, const vertex_stream* streams, uint32_t count)
+    {
+        // RenderBackend::Null: so o nome e os layouts, nada de formato para gravar
+        if (null_device::is_active())
+        {
+            format entry = {};
+            entry.hash = hash;
+            entry.count = count;
+            entry.id = null_device::create_object(null_object::vertex_array);
+
+            for (uint32_t binding = 0; binding < count; binding++)
+                entry.layouts[binding] = *streams[binding].layout;
+
+            return &m_formats.emplace(hash, std::move(entry))->second;
+        }
+
+        bool dsa = grr::use_direct_state_access();
+
+        // DSA ja exige 4.5; o caminho classico precisa de 4.3 ou da extensao
+        if (!dsa)
+        {
+            if (m_supported < 0)
+                m_supported = grr::supports_vertex_attrib_binding() ? 1 : 0;
+
+            if (m_supported == 0)
+                return nullptr;
+        }
+
+        format entry = {};
+        entry.hash = hash;
+        entry.count = count;
+
+        if (dsa)
+        {
+            GL_CALL(glCreateVertexArrays(1, &entry.id));
+        } else
+        {
+            GL_CALL(glGenVertexArrays(1, &entry.id));
+            GL_CALL(glBindVertexArray(entry.id));
+
+            // o VAO ligado mudou
+            m_current = nullptr;
+        }
+
+        GLuint attribute = 0;
+        for (uint32_t binding = 0; binding < count; binding++)
+        {
+            const buffer_layout& layout = *streams[binding].layout;
+            bool instanced = false;
+
+            for (const auto& element : layout)
+            {
+                GLint components = static_cast<GLint>(element.get_component_count());
+                GLenum type = grr::get_base_type(element.type);
+                GLboolean normalized = element.normalized ? GL_TRUE : GL_FALSE;
+                GLuint offset = static_cast<GLuint>(element.offset);
+
+                if (dsa)
+                {
+                    GL_CALL(glEnableVertexArrayAttrib(entry.id, attribute));
+                    GL_CALL(glVertexArrayAttribFormat(entry.id, attribute, components, type, normalized, offset));
+                    GL_CALL(glVertexArrayAttribBinding(entry.id, attribute, binding));
+                } else
+                {
+                    GL_CALL(glEnableVertexAttribArray(attribute));
+                    GL_CALL(glVertexAttribFormat(attribute, components, type, normalized, offset));
+                    GL_CALL(glVertexAttribBinding(attribute, binding));
+                }
+
+                instanced |= element.instanced;
+                attribute++;
+            }
+
+            if (dsa)
+            {
+                GL_CALL(glVertexArrayBindingDivisor(entry.id, binding, instanced ? 1 : 0));
+            } else
+            {
+                GL_CALL(glVertexBindingDivisor(binding, instanced ? 1 : 0));
+            }
+
+            entry.layouts[binding] = layout;
+        }
+
+        if (!dsa)
+            GL_CALL(glBindVertexArray(0));
+
+        return &m_formats.emplace(hash, std::move(entry))->second;
+    }
+}
+
+#endif // !GR_OPENGLES3
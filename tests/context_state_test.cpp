@@ -0,0 +1,103 @@
+// Null backend: two contexts driven from one thread must not see each other's
+// buffer names. The states are installed by hand so it runs without EGL; with
+// GR_USE_EGL the same checks also go through gr::context::make_current.
+
+#include "context_state.hpp"
+#include "gRender.h"
+#include "gVertexArray.h"
+#include "platform/null/null_device.hpp"
+
+#ifdef GR_USE_EGL
+#include "context.hpp"
+#endif
+
+#include <cstdio>
+#include <functional>
+
+using namespace gr;
+
+namespace
+{
+    int s_failures = 0;
+
+    void expect(bool condition, const char* what)
+    {
+        if (condition)
+            return;
+
+        std::printf("FAIL: %s\n", what);
+        s_failures++;
+    }
+
+    // switch_to(0) and switch_to(1) make one of the two contexts current
+    void run_switch(const std::function<void(int)>& switch_to, const char* what)
+    {
+        null_device::reset_statistics();
+
+        switch_to(0);
+        BufferID vertices = gVertexArray::CreateBuffer(VBO);
+
+        switch_to(1);
+        BufferID indices = gVertexArray::CreateBuffer(EBO);
+
+        // os nomes sao por contexto: o segundo contexto reusa o mesmo nome
+        expect(vertices != GR_INVALID_ID && vertices == indices, what);
+
+        expect(null_device::is_object(null_object::buffer, indices), what);
+        gVertexArray::Bind(indices);
+        gVertexArray::DeleteBuffer(indices);
+        expect(!null_device::is_object(null_object::buffer, indices), what);
+
+        // apagar no segundo contexto nao mexe no buffer do primeiro
+        switch_to(0);
+        expect(null_device::is_object(null_object::buffer, vertices), what);
+        gVertexArray::Bind(vertices);
+        gVertexArray::DeleteBuffer(vertices);
+
+        expect(null_device::get_statistics().validation_errors == 0, what);
+        expect(null_device::get_statistics().objects_destroyed == 2, what);
+    }
+
+    void test_states()
+    {
+        context_state states[2];
+
+        run_switch([&states](int index) { context_state::set_current(&states[index]); }, "states: names stay per context");
+
+        context_state::set_current(nullptr);
+        expect(&context_state::current() != &states[0] && &context_state::current() != &states[1], "states: nullptr goes back to the thread");
+    }
+
+    #ifdef GR_USE_EGL
+    void test_contexts()
+    {
+        std::unique_ptr<context> contexts[2] = {context::create_headless(), context::create_headless()};
+        if (contexts[0] == nullptr || contexts[1] == nullptr)
+        {
+            std::printf("context_state_test: no EGL display, skipping gr::context\n");
+            return;
+        }
+
+        run_switch([&contexts](int index) { contexts[index]->make_current(); }, "contexts: names stay per context");
+
+        contexts[0]->done_current();
+    }
+    #endif
+}
+
+int main()
+{
+    gRender::SetBackend(RenderBackend::Null);
+
+    test_states();
+
+    #ifdef GR_USE_EGL
+    test_contexts();
+    #endif
+
+    if (s_failures != 0)
+        return 1;
+
+    std::printf("context_state_test: ok\n");
+    return 0;
+}
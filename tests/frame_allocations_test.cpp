@@ -0,0 +1,152 @@
+// Null backend: runs the per-frame paths (command arena, sprite batch, render
+// stats) under allocation_hooks and fails when a frame after the warm up
+// allocates. No GL context needed.
+
+// conta os new/delete do processo; so este TU define os hooks
+#define GR_DEFINE_ALLOCATION_HOOKS
+#include "allocation_hooks.hpp"
+
+#include "command_arena.hpp"
+#include "frame_allocator.hpp"
+#include "gRender.h"
+#include "platform/null/null_device.hpp"
+#include "render_stats.hpp"
+#include "shader.hpp"
+#include "sprite_batch.hpp"
+#include "vertex_array.hpp"
+#include "vertex_buffer.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+using namespace gr;
+
+namespace
+{
+    int s_failures = 0;
+
+    void expect(bool condition, const char* what)
+    {
+        if (condition)
+            return;
+
+        std::printf("FAIL: %s\n", what);
+        s_failures++;
+    }
+
+    const char* k_vertex_source =
+        "#version 330 core\n"
+        "layout(location = 0) in vec3 a_position;\n"
+        "layout(location = 1) in vec2 a_uv;\n"
+        "uniform vec4 u_offset;\n"
+        "out vec2 v_uv;\n"
+        "void main() { gl_Position = vec4(a_position * 0.01, 1.0) + u_offset; v_uv = a_uv; }\n";
+
+    const char* k_fragment_source =
+        "#version 330 core\n"
+        "in vec2 v_uv;\n"
+        "out vec4 o_color;\n"
+        "void main() { o_color = vec4(v_uv, 0.0, 1.0); }\n";
+
+    constexpr uint32_t k_draws = 100;
+
+    constexpr uint32_t k_warm_up_frames = 3;
+
+    constexpr uint32_t k_frames = 50;
+
+    // sem os hooks no binario tudo daria 0 e o teste passaria sem medir nada
+    void test_hooks()
+    {
+        allocation_scope scope;
+        std::unique_ptr<int> probe(new int(1));
+
+        expect(scope.get_allocations() == 1, "hooks: operator new is counted");
+    }
+
+    void test_steady_state()
+    {
+        Shader shader;
+        expect(shader.build(&k_fragment_source, 1, &k_vertex_source, 1) >= 0, "frames: shader build");
+
+        UniformID offset = shader.registry("u_offset", 1, UniformType::VEC4);
+
+        const float vertices[] = {-1, -1, 0, 0, 0, 1, -1, 0, 1, 0, 1, 1, 0, 1, 1};
+        auto vbo = vertex_buffer::create(vertices, sizeof(vertices), buffer_usage::static_draw);
+        vbo->SetLayout({{shader_data_type::Float3, "a_position"}, {shader_data_type::Float2, "a_uv"}});
+        auto vao = vertex_array::create();
+        vao->AddVertexBuffer(vbo);
+
+        sprite_batch batch(1024, 4);
+        expect(batch.initialize(), "frames: sprite_batch initialize");
+
+        Matrix4x4 projection;
+        std::memset(&projection, 0, sizeof(projection));
+
+        Color white;
+        white.r = white.g = white.b = white.a = 1.0f;
+
+        command_arena arena(1024, 4096);
+        command_arena* arenas[] = {&arena};
+        command_replayer replayer;
+
+        float value[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+        auto frame = [&](uint32_t index) {
+            gRender::BeginFrame();
+
+            arena.reset();
+            for (uint32_t i = 0; i < k_draws; i++)
+            {
+                value[0] = static_cast<float>(i);
+
+                arena.set_key(i);
+                arena.bind_shader(&shader);
+                arena.set_uniform(&shader, offset, value);
+                arena.bind_vertex_array(vao.get());
+                arena.draw_arrays(TRIANGLES, 3);
+            }
+            replayer.submit(arenas, 1);
+
+            // o numero de quads muda de frame para frame
+            batch.begin(projection);
+            for (uint32_t i = 0; i < 200 + index % 3 * 100; i++)
+                batch.draw_quad(Rect{static_cast<float>(i % 32), static_cast<float>(i / 32), 4.0f, 4.0f}, white);
+            batch.end();
+
+            uint32_t count = 0;
+            render_stats::get_history(gRender::GetFrameAllocator(), count);
+
+            gRender::EndFrame();
+        };
+
+        for (uint32_t i = 0; i < k_warm_up_frames; i++)
+            frame(i);
+
+        allocation_scope scope;
+        for (uint32_t i = 0; i < k_frames; i++)
+            frame(i);
+
+        uint64_t allocations = scope.get_allocations();
+        if (allocations != 0)
+            std::printf("%llu allocations in %u frames\n", static_cast<unsigned long long>(allocations), k_frames);
+
+        expect(allocations == 0, "frames: steady state frames do not allocate");
+        expect(null_device::get_statistics().validation_errors == 0, "frames: no validation errors");
+    }
+}
+
+int main()
+{
+    gRender::SetBackend(RenderBackend::Null);
+    gRender::Initialize();
+
+    test_hooks();
+    test_steady_state();
+
+    if (s_failures != 0)
+        return 1;
+
+    std::printf("frame_allocations_test: ok\n");
+    return 0;
+}
@@ -0,0 +1,65 @@
+// CPU only: gl_debug::report deduplicates by call site, and by text when the
+// message has no call site (asynchronous callback, check_erros_opengl).
+
+#include "gl.h"
+#include "gl_debug.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+using namespace gr;
+
+namespace
+{
+    int s_failures = 0;
+
+    void expect(bool condition, const char* what)
+    {
+        if (condition)
+            return;
+
+        std::printf("FAIL: %s\n", what);
+        s_failures++;
+    }
+
+    void report(const char* text, const grr::call_site& site)
+    {
+        gl_debug::report(1, 2, 3, gl_debug_severity::high, text, std::strlen(text), site);
+    }
+
+    uint32_t s_flushed = 0;
+
+    void test_deduplicate()
+    {
+        gl_debug::reset();
+        gl_debug::set_sink([](const gl_debug_message&) { s_flushed++; });
+
+        const grr::call_site first = {"glDrawArrays", "a.cpp", 10};
+        const grr::call_site second = {"glDrawArrays", "a.cpp", 20};
+        const grr::call_site unknown = {nullptr, nullptr, 0};
+
+        report("draw", first);
+        report("draw", first);
+        report("draw", second);
+        expect(gl_debug::flush() == 2, "call site: one message per site");
+
+        report("texture 4 is incomplete", unknown);
+        report("texture 5 is incomplete", unknown);
+        report("texture 5 is incomplete", unknown);
+        expect(gl_debug::flush() == 2, "no call site: one message per text");
+
+        expect(gl_debug::get_statistics().duplicates == 2, "two duplicates counted");
+        expect(s_flushed == 4, "sink sees every queued message");
+    }
+}
+
+int main()
+{
+    test_deduplicate();
+
+    if (s_failures != 0)
+        return 1;
+
+    std::printf("gl_debug_test: ok\n");
+    return 0;
+}
@@ -0,0 +1,162 @@
+// CPU only: simplifies grids with a UV seam and unwelded (flat shaded)
+// vertices and checks they reduce without mixing the two sides of the seam.
+
+#include "mesh_simplifier.hpp"
+
+#include <cstdio>
+#include <vector>
+
+using namespace gr;
+
+namespace
+{
+    int s_failures = 0;
+
+    void expect(bool condition, const char* what)
+    {
+        if (condition)
+            return;
+
+        std::printf("FAIL: %s\n", what);
+        s_failures++;
+    }
+
+    constexpr uint32_t k_size = 16;
+
+    struct vertex
+    {
+        float position[3];
+
+        float uv[2];
+    };
+
+    const buffer_layout k_layout = {
+        {shader_data_type::Float3, "position"},
+        {shader_data_type::Float2, "uv"},
+    };
+
+    // Flat k_size x k_size grid; the right half has its own vertices on the
+    // middle column with u shifted by 10, like a texture seam.
+    void make_seam_grid(std::vector<vertex>& vertices, std::vector<uint32_t>& indices)
+    {
+        auto add = [&vertices](uint32_t x, uint32_t y, float shift) {
+            vertices.push_back({{static_cast<float>(x), static_cast<float>(y), 0.0f}, {static_cast<float>(x) + shift, static_cast<float>(y)}});
+            return static_cast<uint32_t>(vertices.size() - 1);
+        };
+
+        std::vector<uint32_t> left((k_size + 1) * (k_size + 1));
+        std::vector<uint32_t> right((k_size + 1) * (k_size + 1));
+        for (uint32_t y = 0; y <= k_size; y++)
+        {
+            for (uint32_t x = 0; x <= k_size; x++)
+            {
+                uint32_t i = y * (k_size + 1) + x;
+                left[i] = x <= k_size / 2 ? add(x, y, 0.0f) : 0;
+                right[i] = x >= k_size / 2 ? add(x, y, 10.0f) : 0;
+            }
+        }
+
+        for (uint32_t y = 0; y < k_size; y++)
+        {
+            for (uint32_t x = 0; x < k_size; x++)
+            {
+                const std::vector<uint32_t>& side = x < k_size / 2 ? left : right;
+
+                uint32_t a = side[y * (k_size + 1) + x];
+                uint32_t b = side[y * (k_size + 1) + x + 1];
+                uint32_t c = side[(y + 1) * (k_size + 1) + x];
+                uint32_t d = side[(y + 1) * (k_size + 1) + x + 1];
+                indices.insert(indices.end(), {a, b, c, b, d, c});
+            }
+        }
+    }
+
+    void test_seam()
+    {
+        std::vector<vertex> vertices;
+        std::vector<uint32_t> indices;
+        make_seam_grid(vertices, indices);
+
+        std::vector<uint32_t> result(indices.size());
+        size_t count = mesh_simplifier::simplify(result.data(), indices.data(), indices.size(), vertices.data(), vertices.size(),
+            k_layout, indices.size() / 4, 0.0f);
+
+        expect(count > 0 && count <= indices.size() / 2, "seam: the grid reduces across the seam column");
+
+        bool sides = true;
+        for (size_t t = 0; t + 2 < count; t += 3)
+        {
+            bool shifted = vertices[result[t]].uv[0] >= 10.0f;
+            for (size_t k = 1; k < 3; k++)
+                sides &= (vertices[result[t + k]].uv[0] >= 10.0f) == shifted;
+        }
+        expect(sides, "seam: no triangle mixes the two sides");
+
+        // as duas copias da coluna do meio tinham 2 * (k_size + 1) vertices
+        std::vector<uint8_t> used(vertices.size(), 0);
+        for (size_t i = 0; i < count; i++)
+            used[result[i]] = 1;
+
+        uint32_t seam_vertices = 0;
+        for (size_t v = 0; v < vertices.size(); v++)
+            seam_vertices += used[v] && vertices[v].position[0] == static_cast<float>(k_size / 2);
+        expect(seam_vertices < 2 * (k_size + 1), "seam: vertices on the seam collapse too");
+    }
+
+    // every triangle with its own vertices, as a flat shaded export would write them
+    void test_unwelded()
+    {
+        std::vector<vertex> welded;
+        std::vector<uint32_t> welded_indices;
+        make_seam_grid(welded, welded_indices);
+
+        std::vector<vertex> vertices;
+        std::vector<uint32_t> indices;
+        for (uint32_t index : welded_indices)
+        {
+            vertices.push_back(welded[index]);
+            indices.push_back(static_cast<uint32_t>(vertices.size() - 1));
+        }
+
+        std::vector<uint32_t> result(indices.size());
+        size_t count = mesh_simplifier::simplify(result.data(), indices.data(), indices.size(), vertices.data(), vertices.size(),
+            k_layout, indices.size() / 4, 0.0f);
+
+        expect(count > 0 && count <= indices.size() / 2, "unwelded: identical vertices collapse as one");
+    }
+
+    void test_index_range()
+    {
+        std::vector<vertex> vertices;
+        std::vector<uint32_t> indices;
+        make_seam_grid(vertices, indices);
+        indices[7] = static_cast<uint32_t>(vertices.size());
+
+        std::vector<uint32_t> result(indices.size());
+        size_t count = mesh_simplifier::simplify(result.data(), indices.data(), indices.size(), vertices.data(), vertices.size(),
+            k_layout, indices.size() / 4, 0.0f);
+        expect(count == 0, "range: simplify rejects an out of range index");
+
+        mesh_data mesh;
+        mesh.layout = k_layout;
+        mesh.vertices.assign(reinterpret_cast<const uint8_t*>(vertices.data()), reinterpret_cast<const uint8_t*>(vertices.data() + vertices.size()));
+        mesh.indices = indices;
+
+        const mesh_lod_level levels[] = {{0.5f, 0.0f}};
+        std::vector<mesh_lod> lods = mesh_simplifier::generate_lods(mesh, levels, 1);
+        expect(lods.size() == 1 && mesh.indices.size() == indices.size(), "range: generate_lods keeps only the base mesh");
+    }
+}
+
+int main()
+{
+    test_seam();
+    test_unwelded();
+    test_index_range();
+
+    if (s_failures != 0)
+        return 1;
+
+    std::printf("mesh_simplifier_test: ok\n");
+    return 0;
+}
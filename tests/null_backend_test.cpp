@@ -0,0 +1,162 @@
+// RenderBackend::Null: the pools, the vertex format cache and the static
+// texture unbind must go through null_device instead of calling GL, so this
+// runs (and would crash otherwise) without a context. Also checks that
+// framebuffer attachments are tracked as render targets.
+
+#include "gFramebuffer.h"
+#include "gRender.h"
+#include "gTexture.h"
+#include "memory_tracker.hpp"
+#include "platform/null/null_device.hpp"
+#include "resource_pool.hpp"
+#include "vertex_format_cache.hpp"
+
+#include <cstdio>
+
+using namespace gr;
+
+namespace
+{
+    int s_failures = 0;
+
+    void expect(bool condition, const char* what)
+    {
+        if (condition)
+            return;
+
+        std::printf("FAIL: %s\n", what);
+        s_failures++;
+    }
+
+    const float k_vertices[] = {
+        0.0f, 0.0f, 0.0f,
+        1.0f, 0.0f, 0.0f,
+        0.0f, 1.0f, 0.0f,
+    };
+
+    const uint32_t k_indices[] = {0, 1, 2};
+
+    void test_pools()
+    {
+        null_device::reset_statistics();
+
+        {
+            buffer_pool buffers;
+            vertex_array_pool arrays(buffers);
+
+            buffer_handle vertices = buffers.create(buffer_target::vertex, k_vertices, sizeof(k_vertices));
+            buffer_handle indices = buffers.create(buffer_target::index, k_indices, sizeof(k_indices));
+            buffers.set_layout(vertices, buffer_layout({{shader_data_type::Float3, "position"}}));
+
+            expect(null_device::is_object(null_object::buffer, buffers.get_id(vertices)), "pools: buffer names come from null_device");
+
+            buffers.set_data(vertices, k_vertices, sizeof(k_vertices) * 2);
+            expect(buffers.get_size(vertices) == sizeof(k_vertices) * 2, "pools: set_data grows the buffer");
+            buffers.bind(indices);
+
+            vertex_array_handle array = arrays.create();
+            expect(arrays.add_vertex_buffer(array, vertices), "pools: add_vertex_buffer");
+            arrays.set_index_buffer(array, indices);
+            arrays.bind(array);
+
+            arrays.destroy(array);
+            buffers.destroy(vertices);
+        }
+
+        // o destrutor apaga o buffer de indices que sobrou
+        expect(null_device::get_statistics().objects_created == null_device::get_statistics().objects_destroyed, "pools: every name is released");
+        expect(null_device::get_statistics().validation_errors == 0, "pools: no validation errors");
+    }
+
+    void test_vertex_format_cache()
+    {
+        null_device::reset_statistics();
+
+        buffer_pool buffers;
+        buffer_handle first = buffers.create(buffer_target::vertex, k_vertices, sizeof(k_vertices));
+        buffer_handle second = buffers.create(buffer_target::vertex, k_vertices, sizeof(k_vertices));
+
+        buffer_layout layout({{shader_data_type::Float3, "position"}});
+
+        vertex_stream stream;
+        stream.layout = &layout;
+        stream.buffer = buffers.get_id(first);
+
+        vertex_format_cache cache;
+        uint32_t id = cache.get_vertex_array(&stream, 1);
+        expect(null_device::is_object(null_object::vertex_array, id), "format cache: vertex array name");
+        expect(cache.bind(&stream, 1), "format cache: bind");
+
+        stream.buffer = buffers.get_id(second);
+        expect(cache.bind(&stream, 1), "format cache: same format, other buffer");
+        expect(cache.get_vertex_array(&stream, 1) == id, "format cache: one vertex array per format");
+
+        // nome que nao existe: erro de validacao, sem GL
+        stream.buffer = 12345;
+        expect(!cache.bind(&stream, 1), "format cache: unknown buffer fails");
+        expect(null_device::get_statistics().validation_errors == 1, "format cache: one validation error");
+
+        cache.release();
+        expect(!null_device::is_object(null_object::vertex_array, id), "format cache: release frees the name");
+    }
+
+    void test_texture_unbind()
+    {
+        null_device::reset_statistics();
+
+        gTexture::Unbind(0);
+
+        expect(null_device::get_statistics().calls == 1, "texture: Unbind counted");
+        expect(null_device::get_statistics().validation_errors == 0, "texture: Unbind is valid");
+    }
+
+    void test_render_target_memory()
+    {
+        null_device::reset_statistics();
+        memory_tracker::reset();
+
+        {
+            gTexture texture;
+            texture.set_format(TextureFormat_RGBA8888);
+            texture.updateBuffer(64, 64, nullptr);
+
+            uint64_t bytes = texture.get_memory_size();
+            expect(memory_tracker::get_stats(memory_category::texture).bytes == bytes, "render target: counted as texture before attaching");
+
+            u32 framebuffer = gFramebuffer::Create();
+            gFramebuffer::Bind(framebuffer);
+            gFramebuffer::SetTexture(&texture, gFramebufferFlags_Color_Attachiment0);
+
+            expect(texture.is_render_target(), "render target: attached texture");
+            expect(memory_tracker::get_stats(memory_category::texture).bytes == 0, "render target: moved out of texture");
+            expect(memory_tracker::get_stats(memory_category::render_target).bytes == bytes, "render target: counted as render_target");
+
+            // mudar o tamanho continua na mesma categoria
+            texture.updateBuffer(128, 128, nullptr);
+            expect(memory_tracker::get_stats(memory_category::render_target).bytes == texture.get_memory_size(), "render target: resize stays in render_target");
+
+            gFramebuffer::Unbind();
+            gFramebuffer::Destroy(framebuffer);
+        }
+
+        expect(memory_tracker::get_stats(memory_category::render_target).bytes == 0, "render target: destroy untracks");
+        expect(null_device::get_statistics().validation_errors == 0, "render target: no validation errors");
+    }
+}
+
+int main()
+{
+    gRender::SetBackend(RenderBackend::Null);
+    gRender::Initialize();
+
+    test_pools();
+    test_vertex_format_cache();
+    test_texture_unbind();
+    test_render_target_memory();
+
+    if (s_failures != 0)
+        return 1;
+
+    std::printf("null_backend_test: ok\n");
+    return 0;
+}
@@ -0,0 +1,172 @@
+// CPU only: rasterises occluders into the occlusion_culler depth buffer and
+// checks the box queries, no GL context needed.
+
+#include "frustum_culler.hpp"
+#include "occlusion_culler.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace gr;
+
+namespace
+{
+    int s_failures = 0;
+
+    void expect(bool condition, const char* what)
+    {
+        if (condition)
+            return;
+
+        std::printf("FAIL: %s\n", what);
+        s_failures++;
+    }
+
+    Matrix4x4 identity()
+    {
+        static const float k_identity[16] = {
+            1.0f, 0.0f, 0.0f, 0.0f,
+            0.0f, 1.0f, 0.0f, 0.0f,
+            0.0f, 0.0f, 1.0f, 0.0f,
+            0.0f, 0.0f, 0.0f, 1.0f,
+        };
+
+        Matrix4x4 matrix;
+        std::memcpy(&matrix, k_identity, sizeof(matrix));
+        return matrix;
+    }
+
+    // quad over x, y in [-0.5, 0.5] at z = 0 (depth 0.5), counter clockwise
+    const float k_quad_positions[] = {
+        -0.5f, -0.5f, 0.0f,
+         0.5f, -0.5f, 0.0f,
+         0.5f,  0.5f, 0.0f,
+        -0.5f,  0.5f, 0.0f,
+    };
+
+    const uint32_t k_quad_indices[] = {0, 1, 2, 0, 2, 3};
+
+    // same quad wound clockwise
+    const uint32_t k_back_indices[] = {0, 2, 1, 0, 3, 2};
+
+    // z ranges in NDC
+    const Vector3 k_hidden_min{-0.3f, -0.3f, 0.2f};
+    const Vector3 k_hidden_max{0.3f, 0.3f, 0.4f};
+
+    const Vector3 k_front_min{-0.3f, -0.3f, -0.4f};
+    const Vector3 k_front_max{0.3f, 0.3f, -0.2f};
+
+    // behind the quad but sticking out on the right
+    const Vector3 k_partial_min{0.2f, -0.3f, 0.2f};
+    const Vector3 k_partial_max{0.8f, 0.3f, 0.4f};
+
+    void test_depth_buffer(occlusion_culler& culler)
+    {
+        culler.begin_frame(identity());
+        culler.add_occluder(k_quad_positions, 3 * sizeof(float), 4, k_quad_indices, 6, identity());
+        culler.rasterize();
+
+        expect(culler.get_statistics().occluder_triangles == 2, "depth: occluder triangles");
+        expect(culler.get_statistics().rasterized_triangles == 2, "depth: rasterized triangles");
+
+        // 256 x 128: o quad cobre [64, 192] x [32, 96]
+        const float* depth = culler.get_depth();
+        uint32_t pitch = (culler.get_width() + occlusion_culler::k_tile_size - 1) / occlusion_culler::k_tile_size * occlusion_culler::k_tile_size;
+
+        bool inside = true;
+        bool outside = true;
+        for (uint32_t y = 0; y < culler.get_height(); y++)
+        {
+            for (uint32_t x = 0; x < culler.get_width(); x++)
+            {
+                float z = depth[y * pitch + x];
+                if (x >= 65 && x <= 190 && y >= 33 && y <= 94)
+                    inside &= std::fabs(z - 0.5f) < 1e-4f;
+                else if (x < 63 || x > 192 || y < 31 || y > 96)
+                    outside &= z == 1.0f;
+            }
+        }
+        expect(inside, "depth: covered pixels hold the quad depth");
+        expect(outside, "depth: uncovered pixels stay at the far plane");
+    }
+
+    void test_queries(occlusion_culler& culler)
+    {
+        culler.begin_frame(identity());
+        culler.add_occluder(k_quad_positions, 3 * sizeof(float), 4, k_quad_indices, 6, identity());
+        culler.rasterize();
+
+        expect(!culler.is_visible(k_hidden_min, k_hidden_max), "query: box behind the quad is hidden");
+        expect(culler.is_visible(k_front_min, k_front_max), "query: box in front of the quad is visible");
+        expect(culler.is_visible(k_partial_min, k_partial_max), "query: box sticking out is visible");
+
+        // atravessa o near plane: sempre visivel
+        expect(culler.is_visible(Vector3{-0.1f, -0.1f, -2.0f}, Vector3{0.1f, 0.1f, 0.4f}), "query: box crossing the near plane is visible");
+    }
+
+    void test_back_faces(occlusion_culler& culler)
+    {
+        culler.begin_frame(identity());
+        culler.add_occluder(k_quad_positions, 3 * sizeof(float), 4, k_back_indices, 6, identity());
+        culler.rasterize();
+
+        expect(culler.get_statistics().rasterized_triangles == 0, "back faces: not rasterized");
+        expect(culler.is_visible(k_hidden_min, k_hidden_max), "back faces: nothing is hidden");
+    }
+
+    // more boxes than one test chunk, so the compaction across chunks runs too
+    void test_batch(occlusion_culler& culler)
+    {
+        culler.begin_frame(identity());
+        culler.add_occluder(k_quad_positions, 3 * sizeof(float), 4, k_quad_indices, 6, identity());
+        culler.rasterize();
+
+        const uint32_t count = 3000;
+
+        bounds_set bounds;
+        std::vector<uint32_t> candidates(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const Vector3& min = (i % 3 == 0) ? k_hidden_min : (i % 3 == 1) ? k_front_min : k_partial_min;
+            const Vector3& max = (i % 3 == 0) ? k_hidden_max : (i % 3 == 1) ? k_front_max : k_partial_max;
+
+            Vector3 center{(min.x + max.x) * 0.5f, (min.y + max.y) * 0.5f, (min.z + max.z) * 0.5f};
+            bounds.add(center, 1.0f, min, max);
+            candidates[i] = i;
+        }
+
+        std::vector<uint32_t> visible(count);
+        uint32_t visible_count = culler.test(bounds, candidates.data(), count, visible.data());
+
+        expect(visible_count == count - count / 3, "batch: visible count");
+
+        bool order = true;
+        for (uint32_t i = 0; i < visible_count && i < count; i++)
+        {
+            // os ocultos sao os multiplos de 3; o resto sai na ordem
+            uint32_t expected = i / 2 * 3 + 1 + i % 2;
+            order &= visible[i] == expected;
+        }
+        expect(order, "batch: visible boxes keep their order");
+        expect(culler.get_statistics().tested == count, "batch: tested");
+        expect(culler.get_statistics().culled == count / 3, "batch: culled");
+    }
+}
+
+int main()
+{
+    occlusion_culler culler(256, 128);
+
+    test_depth_buffer(culler);
+    test_queries(culler);
+    test_back_faces(culler);
+    test_batch(culler);
+
+    if (s_failures != 0)
+        return 1;
+
+    std::printf("occlusion_culler_test: ok\n");
+    return 0;
+}
@@ -0,0 +1,218 @@
+// CPU only: draws with RenderBackend::Software and checks the pixels, no GL
+// context needed.
+
+#include "gRender.h"
+#include "platform/software/software_rasterizer.hpp"
+#include "vertex_array.hpp"
+
+#include <cstdio>
+
+using namespace gr;
+
+namespace
+{
+    int s_failures = 0;
+
+    void expect(bool condition, const char* what)
+    {
+        if (condition)
+            return;
+
+        std::printf("FAIL: %s\n", what);
+        s_failures++;
+    }
+
+    // x, y, z in clip space (w = 1) and a grey level
+    std::shared_ptr<vertex_array> make_mesh(const float* vertices, uint32_t vertex_count, const uint32_t* indices, uint32_t index_count)
+    {
+        std::shared_ptr<vertex_buffer> vbo = vertex_buffer::create(vertices, static_cast<uint32_t>(vertex_count * 4 * sizeof(float)), buffer_usage::static_draw);
+        vbo->SetLayout({
+            {shader_data_type::Float3, "position"},
+            {shader_data_type::Float, "value"},
+        });
+
+        std::shared_ptr<vertex_array> vao = vertex_array::create();
+        vao->AddVertexBuffer(vbo);
+
+        if (indices != nullptr)
+        {
+            std::shared_ptr<index_buffer> ibo = index_buffer::create(indices, static_cast<uint32_t>(index_count * sizeof(uint32_t)));
+            vao->SetIndexBuffer(ibo);
+        }
+        return vao;
+    }
+
+    software_pipeline make_pipeline()
+    {
+        software_pipeline pipeline;
+        pipeline.varying_count = 1;
+        pipeline.vertex = [](const float* const* attributes, float* position, float* varyings) {
+            position[0] = attributes[0][0];
+            position[1] = attributes[0][1];
+            position[2] = attributes[0][2];
+            position[3] = 1.0f;
+            varyings[0] = attributes[1][0];
+        };
+        pipeline.fragment = [](const float* varyings, float* color) {
+            color[0] = color[1] = color[2] = varyings[0];
+            color[3] = 0.5f;
+            return true;
+        };
+        return pipeline;
+    }
+
+    inline const uint8_t* pixel(const software_target& target, uint32_t x, uint32_t y)
+    {
+        return target.get_color() + (static_cast<size_t>(y) * target.get_width() + x) * 4;
+    }
+
+    // pixel centers strictly inside the lower left half are covered, strictly
+    // outside are not; the diagonal goes to the top-left rule
+    void test_coverage(software_rasterizer& rasterizer)
+    {
+        const float vertices[] = {
+            -1.0f, -1.0f, 0.0f, 1.0f,
+             1.0f, -1.0f, 0.0f, 1.0f,
+            -1.0f,  1.0f, 0.0f, 1.0f,
+        };
+        std::shared_ptr<vertex_array> vao = make_mesh(vertices, 3, nullptr, 0);
+
+        software_target target(64, 64);
+        target.clear(Color::black);
+
+        software_pipeline pipeline = make_pipeline();
+        pipeline.depth_test = false;
+        expect(rasterizer.draw(pipeline, *vao, TRIANGLES, 3, target), "coverage: draw");
+
+        bool inside = true;
+        bool outside = true;
+        for (uint32_t y = 0; y < 64; y++)
+        {
+            for (uint32_t x = 0; x < 64; x++)
+            {
+                uint8_t value = pixel(target, x, y)[0];
+                if (x + y < 63)
+                    inside &= value == 255;
+                else if (x + y > 63)
+                    outside &= value == 0;
+            }
+        }
+        expect(inside, "coverage: pixels inside the triangle are written");
+        expect(outside, "coverage: pixels outside the triangle are untouched");
+    }
+
+    // two triangles over the whole target with blending: a pixel on the
+    // shared edge drawn twice would come out brighter
+    void test_shared_edge(software_rasterizer& rasterizer)
+    {
+        const float vertices[] = {
+            -1.0f, -1.0f, 0.0f, 1.0f,
+             1.0f, -1.0f, 0.0f, 1.0f,
+             1.0f,  1.0f, 0.0f, 1.0f,
+            -1.0f,  1.0f, 0.0f, 1.0f,
+        };
+        const uint32_t indices[] = {0, 1, 2, 0, 2, 3};
+        std::shared_ptr<vertex_array> vao = make_mesh(vertices, 4, indices, 6);
+
+        software_target target(67, 45);
+        target.clear(Color::black);
+
+        software_pipeline pipeline = make_pipeline();
+        pipeline.depth_test = false;
+        pipeline.blend = true;
+
+        rasterizer.reset_statistics();
+        expect(rasterizer.draw(pipeline, *vao, TRIANGLES, 6, target), "shared edge: draw");
+
+        bool once = true;
+        for (uint32_t y = 0; y < target.get_height(); y++)
+        {
+            for (uint32_t x = 0; x < target.get_width(); x++)
+                once &= pixel(target, x, y)[0] == 128;
+        }
+        expect(once, "shared edge: every pixel is written exactly once");
+        expect(rasterizer.get_statistics().fragments == 67u * 45u, "shared edge: fragment count");
+    }
+
+    // the nearer quad wins whatever the draw order
+    void test_depth(software_rasterizer& rasterizer)
+    {
+        const float near_vertices[] = {
+            -1.0f, -1.0f, -0.5f, 1.0f,
+             1.0f, -1.0f, -0.5f, 1.0f,
+             1.0f,  1.0f, -0.5f, 1.0f,
+            -1.0f,  1.0f, -0.5f, 1.0f,
+        };
+        const float far_vertices[] = {
+            -1.0f, -1.0f, 0.5f, 0.0f,
+             1.0f, -1.0f, 0.5f, 0.0f,
+             1.0f,  1.0f, 0.5f, 0.0f,
+            -1.0f,  1.0f, 0.5f, 0.0f,
+        };
+        const uint32_t indices[] = {0, 1, 2, 0, 2, 3};
+        std::shared_ptr<vertex_array> near_quad = make_mesh(near_vertices, 4, indices, 6);
+        std::shared_ptr<vertex_array> far_quad = make_mesh(far_vertices, 4, indices, 6);
+
+        software_target target(40, 40);
+        target.clear(Color::black);
+
+        software_pipeline pipeline = make_pipeline();
+
+        rasterizer.draw(pipeline, *far_quad, TRIANGLES, 6, target);
+        rasterizer.draw(pipeline, *near_quad, TRIANGLES, 6, target);
+        rasterizer.draw(pipeline, *far_quad, TRIANGLES, 6, target);
+
+        bool near_wins = true;
+        for (uint32_t y = 0; y < 40; y++)
+        {
+            for (uint32_t x = 0; x < 40; x++)
+                near_wins &= pixel(target, x, y)[0] == 255;
+        }
+        expect(near_wins, "depth: the near quad is kept");
+
+        // z = -0.5 em NDC vira 0.25 no depth buffer
+        float depth = target.get_depth()[20 * 40 + 20];
+        expect(depth > 0.249f && depth < 0.251f, "depth: written depth");
+    }
+
+    // back faces (clockwise) are dropped
+    void test_cull(software_rasterizer& rasterizer)
+    {
+        const float vertices[] = {
+            -1.0f, -1.0f, 0.0f, 1.0f,
+            -1.0f,  1.0f, 0.0f, 1.0f,
+             1.0f, -1.0f, 0.0f, 1.0f,
+        };
+        std::shared_ptr<vertex_array> vao = make_mesh(vertices, 3, nullptr, 0);
+
+        software_target target(16, 16);
+        target.clear(Color::black);
+
+        software_pipeline pipeline = make_pipeline();
+        pipeline.cull = software_cull::back;
+
+        rasterizer.reset_statistics();
+        rasterizer.draw(pipeline, *vao, TRIANGLES, 3, target);
+
+        expect(rasterizer.get_statistics().culled == 1, "cull: clockwise triangle culled");
+        expect(pixel(target, 2, 2)[0] == 0, "cull: nothing written");
+    }
+}
+
+int main()
+{
+    gRender::SetBackend(RenderBackend::Software);
+
+    software_rasterizer rasterizer;
+
+    test_coverage(rasterizer);
+    test_shared_edge(rasterizer);
+    test_depth(rasterizer);
+    test_cull(rasterizer);
+
+    if (s_failures != 0)
+        return 1;
+
+    std::printf("software_rasterizer_test: ok\n");
+    return 0;
+}
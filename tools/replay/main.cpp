@@ -0,0 +1,570 @@
+// gr-replay: re-executes a trace_recorder capture on a headless context and
+// reports the CPU submission time and GPU time of every frame.
+//
+//   gr-replay <trace> [--classic | --dsa] [--gles]
+
+#include "context.hpp"
+#include "gFramebuffer.h"
+#include "gRender.h"
+#include "gTexture.h"
+#include "gVertexArray.h"
+#include "gl.h"
+#include "index_buffer.hpp"
+#include "sampler_cache.hpp"
+#include "shader.hpp"
+#include "trace_recorder.hpp"
+#include "vertex_array.hpp"
+#include "vertex_buffer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+using namespace gr;
+
+namespace
+{
+    struct frame_result
+    {
+        double cpu_ms;
+
+        // timestamps at the start and end of the frame, like the profiler
+        uint32_t queries[2];
+
+        uint32_t draw_calls;
+    };
+
+    // objetos do trace (chave da captura) -> objetos desta execucao
+    struct replay_state
+    {
+        std::unordered_map<uint64_t, std::shared_ptr<vertex_buffer>> vertex_buffers;
+
+        std::unordered_map<uint64_t, std::shared_ptr<index_buffer>> index_buffers;
+
+        std::unordered_map<uint64_t, std::shared_ptr<vertex_array>> vertex_arrays;
+
+        std::unordered_map<uint64_t, std::unique_ptr<gVertexArray>> legacy_arrays;
+
+        std::unordered_map<uint32_t, BufferID> buffers;
+
+        std::unordered_map<uint64_t, std::unique_ptr<Shader>> shaders;
+
+        std::unordered_map<uint64_t, std::unique_ptr<gTexture>> textures;
+
+        std::unordered_map<uint32_t, u32> framebuffers;
+
+        sampler_cache samplers;
+
+        std::unordered_map<uint32_t, uint32_t> sampler_names;
+    };
+
+    template <typename T>
+    T* find(std::unordered_map<uint64_t, T>& map, uint64_t key)
+    {
+        auto it = map.find(key);
+        return it != map.end() ? &it->second : nullptr;
+    }
+
+    gTexture& get_texture(replay_state& state, uint64_t key)
+    {
+        auto& texture = state.textures[key];
+        if (texture == nullptr)
+            texture.reset(new gTexture());
+        return *texture;
+    }
+
+    void apply_texture_flags(gTexture& texture, uint16_t format, uint32_t flags)
+    {
+        texture.set_format(static_cast<TextureFormat>(format));
+        texture.set_texture(flags & (gTextureFlags_Texture | gTextureFlags_Cubemap));
+        texture.set_filtering(flags & (gTextureFlags_Filter_Linear | gTextureFlags_Filter_Nearest | gTextureFlags_Filter_Trilinear | gTextureFlags_Filter_Bilinear));
+        texture.set_clamping(flags & (gTextureFlags_Clamp_Repeat | gTextureFlags_Clamp_Border | gTextureFlags_Clamp_Edge));
+        texture.set_face(flags & gTextureCubemapFace_All);
+
+        if (flags & gTextureFlags_MipMaps)
+            texture.generate_mipmaps();
+    }
+
+    uint32_t map_sampler(const replay_state& state, uint32_t id)
+    {
+        // 0 sao os parametros da propria textura
+        auto it = state.sampler_names.find(id);
+        return it != state.sampler_names.end() ? it->second : 0;
+    }
+
+    uint32_t map_buffer(const replay_state& state, uint32_t id)
+    {
+        auto it = state.buffers.find(id);
+        return it != state.buffers.end() ? it->second : 0;
+    }
+
+    // false for an unknown or malformed packet
+    bool execute(trace_reader& reader, replay_state& state)
+    {
+        switch (reader.get_op())
+        {
+            case trace_op::frame_begin:
+            case trace_op::frame_end:
+                break;
+
+            case trace_op::background_color: {
+                Color color;
+                color.r = reader.read<float>();
+                color.g = reader.read<float>();
+                color.b = reader.read<float>();
+                color.a = reader.read<float>();
+                gRender::SetBackgroundColor(color);
+                break;
+            }
+            case trace_op::viewport:
+            case trace_op::scissor: {
+                Rect bounds;
+                bounds.x = reader.read<float>();
+                bounds.y = reader.read<float>();
+                bounds.w = reader.read<float>();
+                bounds.h = reader.read<float>();
+                if (reader.get_op() == trace_op::viewport)
+                    gRender::SetViewport(bounds);
+                else
+                    gRender::SetScissor(bounds);
+                break;
+            }
+            case trace_op::enable: {
+                uint32_t state_id = reader.read<uint32_t>();
+                gRender::SetEnable(state_id, reader.read<uint8_t>() != 0);
+                break;
+            }
+            case trace_op::render_state: {
+                uint64_t render_state = reader.read<uint64_t>();
+                gRender::SetRenderState(static_cast<RenderState>(render_state), reader.read<uint32_t>());
+                break;
+            }
+
+            case trace_op::vertex_buffer_create: {
+                uint64_t key = reader.read<uint64_t>();
+                buffer_usage usage = static_cast<buffer_usage>(reader.read<uint32_t>());
+                trace_blob data = reader.read_blob();
+                state.vertex_buffers[key] = vertex_buffer::create(data.data, data.size, usage);
+                break;
+            }
+            case trace_op::vertex_buffer_data: {
+                auto* vbo = find(state.vertex_buffers, reader.read<uint64_t>());
+                trace_blob data = reader.read_blob();
+                if (vbo != nullptr)
+                    (*vbo)->SetData(data.data, data.size);
+                break;
+            }
+            case trace_op::vertex_buffer_destroy:
+                state.vertex_buffers.erase(reader.read<uint64_t>());
+                break;
+            case trace_op::index_buffer_create: {
+                uint64_t key = reader.read<uint64_t>();
+                trace_blob data = reader.read_blob();
+                state.index_buffers[key] = index_buffer::create(data.data, data.size);
+                break;
+            }
+            case trace_op::index_buffer_destroy:
+                state.index_buffers.erase(reader.read<uint64_t>());
+                break;
+            case trace_op::vertex_array_create:
+                state.vertex_arrays[reader.read<uint64_t>()] = vertex_array::create();
+                break;
+            case trace_op::vertex_array_add_buffer: {
+                auto* vao = find(state.vertex_arrays, reader.read<uint64_t>());
+                auto* vbo = find(state.vertex_buffers, reader.read<uint64_t>());
+                trace_blob elements = reader.read_blob();
+                if (vao == nullptr || vbo == nullptr)
+                    break;
+
+                struct element
+                {
+                    uint32_t type;
+                    uint8_t normalized;
+                    uint8_t instanced;
+                    uint16_t reserved;
+                };
+
+                std::vector<buffer_element> layout;
+                for (uint32_t i = 0; i < elements.size / sizeof(element); i++)
+                {
+                    element e;
+                    std::memcpy(&e, static_cast<const uint8_t*>(elements.data) + i * sizeof(element), sizeof(element));
+                    layout.emplace_back(static_cast<shader_data_type>(e.type), "a" + std::to_string(i), e.instanced != 0, e.normalized != 0);
+                }
+
+                (*vbo)->SetLayout(buffer_layout(std::move(layout)));
+                (*vao)->AddVertexBuffer(*vbo);
+                break;
+            }
+            case trace_op::vertex_array_index_buffer: {
+                auto* vao = find(state.vertex_arrays, reader.read<uint64_t>());
+                auto* ibo = find(state.index_buffers, reader.read<uint64_t>());
+                if (vao != nullptr && ibo != nullptr)
+                    (*vao)->SetIndexBuffer(*ibo);
+                break;
+            }
+            case trace_op::vertex_array_bind: {
+                auto* vao = find(state.vertex_arrays, reader.read<uint64_t>());
+                if (vao != nullptr)
+                    (*vao)->Bind();
+                break;
+            }
+            case trace_op::vertex_array_destroy:
+                state.vertex_arrays.erase(reader.read<uint64_t>());
+                break;
+
+            case trace_op::legacy_array_create:
+                state.legacy_arrays[reader.read<uint64_t>()].reset(new gVertexArray());
+                break;
+            case trace_op::legacy_array_bind: {
+                uint64_t key = reader.read<uint64_t>();
+                auto* vao = find(state.legacy_arrays, key);
+                if (vao != nullptr)
+                    (*vao)->bind();
+                else if (key == 0)
+                    glBindVertexArray(0);
+                break;
+            }
+            case trace_op::legacy_array_destroy:
+                state.legacy_arrays.erase(reader.read<uint64_t>());
+                break;
+            case trace_op::buffer_create: {
+                uint32_t id = reader.read<uint32_t>();
+                uint32_t type = reader.read<uint32_t>();
+                trace_blob data = reader.read_blob();
+                state.buffers[id] = gVertexArray::CreateBuffer(type, data.data, data.size);
+                break;
+            }
+            case trace_op::buffer_destroy: {
+                uint32_t id = reader.read<uint32_t>();
+                gVertexArray::DeleteBuffer(map_buffer(state, id));
+                state.buffers.erase(id);
+                break;
+            }
+            case trace_op::buffer_bind:
+                gVertexArray::Bind(map_buffer(state, reader.read<uint32_t>()));
+                break;
+            case trace_op::buffer_resize: {
+                uint32_t size = reader.read<uint32_t>();
+                gVertexArray::UpdateResizeBuffer(size, static_cast<BufferUsage>(reader.read<uint32_t>()));
+                break;
+            }
+            case trace_op::buffer_update: {
+                uint32_t offset = reader.read<uint32_t>();
+                trace_blob data = reader.read_blob();
+                gVertexArray::SetBufferUpdate(offset, data.size, data.data);
+                break;
+            }
+            case trace_op::attrib: {
+                uint8_t index = reader.read<uint8_t>();
+                uint16_t size = reader.read<uint16_t>();
+                uint16_t stride = reader.read<uint16_t>();
+                const void* offset = reinterpret_cast<const void*>(static_cast<uintptr_t>(reader.read<uint64_t>()));
+                if (reader.read<uint8_t>() != 0)
+                    gVertexArray::SetAttribI(index, size, stride, offset);
+                else
+                    gVertexArray::SetAttrib(index, size, stride, offset);
+                break;
+            }
+            case trace_op::attrib_divisor: {
+                uint8_t index = reader.read<uint8_t>();
+                gVertexArray::SetAttribDivisor(index, reader.read<uint8_t>());
+                break;
+            }
+            case trace_op::draw_elements: {
+                PrimitiveType primitive = static_cast<PrimitiveType>(reader.read<uint32_t>());
+                uint32_t count = reader.read<uint32_t>();
+                const void* offset = reinterpret_cast<const void*>(static_cast<uintptr_t>(reader.read<uint64_t>()));
+                uint32_t instances = reader.read<uint32_t>();
+                if (reader.read<uint8_t>() != 0)
+                    gVertexArray::DrawElementsInstanced(primitive, count, offset, instances);
+                else
+                    gVertexArray::DrawElements(primitive, count, offset);
+                break;
+            }
+            case trace_op::draw_arrays: {
+                PrimitiveType primitive = static_cast<PrimitiveType>(reader.read<uint32_t>());
+                uint32_t count = reader.read<uint32_t>();
+                uint32_t instances = reader.read<uint32_t>();
+                if (reader.read<uint8_t>() != 0)
+                    gVertexArray::DrawArraysInstanced(primitive, count, instances);
+                else
+                    gVertexArray::DrawArrays(primitive, count);
+                break;
+            }
+
+            case trace_op::shader_build: {
+                auto& shader = state.shaders[reader.read<uint64_t>()];
+                if (shader == nullptr)
+                    shader.reset(new Shader());
+
+                const char* fragment = reader.read_string();
+                const char* vertex = reader.read_string();
+                if (shader->build(&fragment, 1, &vertex, 1) < 0)
+                    fprintf(stderr, "gr-replay: shader build failed\n");
+                break;
+            }
+            case trace_op::shader_uniform: {
+                auto* shader = find(state.shaders, reader.read<uint64_t>());
+                uint32_t count = reader.read<uint32_t>();
+                UniformType type = static_cast<UniformType>(reader.read<uint32_t>());
+                const char* name = reader.read_string();
+                if (shader != nullptr)
+                    (*shader)->registry(name, count, type);
+                break;
+            }
+            case trace_op::shader_set_uniform: {
+                auto* shader = find(state.shaders, reader.read<uint64_t>());
+                const char* name = reader.read_string();
+                trace_blob data = reader.read_blob();
+                if (shader == nullptr)
+                    break;
+
+                // pelo nome: os UniformIDs dependem de quais uniforms o driver manteve ativos
+                UniformID id = (*shader)->findUniform(name);
+                if (id == GR_INVALID_ID || data.size != (*shader)->GetUniforms()[id].stride)
+                {
+                    fprintf(stderr, "gr-replay: uniform \"%s\" missing or of another size\n", name);
+                    break;
+                }
+                (*shader)->SetUniform(id, data.data);
+                break;
+            }
+            case trace_op::shader_bind: {
+                uint64_t key = reader.read<uint64_t>();
+                auto* shader = find(state.shaders, key);
+                if (shader != nullptr)
+                    (*shader)->bind();
+                else if (key == 0)
+                    glUseProgram(0);
+                break;
+            }
+            case trace_op::shader_destroy:
+                state.shaders.erase(reader.read<uint64_t>());
+                break;
+
+            case trace_op::texture_update: {
+                gTexture& texture = get_texture(state, reader.read<uint64_t>());
+                uint32_t width = reader.read<uint32_t>();
+                uint32_t height = reader.read<uint32_t>();
+                uint16_t format = reader.read<uint16_t>();
+                uint32_t flags = reader.read<uint32_t>();
+                trace_blob pixels = reader.read_blob();
+
+                apply_texture_flags(texture, format, flags);
+                texture.updateBuffer(width, height, const_cast<void*>(pixels.data));
+                break;
+            }
+            case trace_op::texture_allocate: {
+                gTexture& texture = get_texture(state, reader.read<uint64_t>());
+                uint32_t width = reader.read<uint32_t>();
+                uint32_t height = reader.read<uint32_t>();
+                uint32_t levels = reader.read<uint32_t>();
+                uint16_t format = reader.read<uint16_t>();
+                uint32_t flags = reader.read<uint32_t>();
+
+                apply_texture_flags(texture, format, flags);
+                texture.allocate_levels(width, height, levels);
+                break;
+            }
+            case trace_op::texture_level: {
+                gTexture& texture = get_texture(state, reader.read<uint64_t>());
+                uint32_t level = reader.read<uint32_t>();
+                texture.update_level(level, reader.read_blob().data);
+                break;
+            }
+            case trace_op::texture_bind: {
+                gTexture& texture = get_texture(state, reader.read<uint64_t>());
+                uint32_t unit = reader.read<uint32_t>();
+                texture.bind(unit, map_sampler(state, reader.read<uint32_t>()));
+                break;
+            }
+            case trace_op::texture_destroy:
+                state.textures.erase(reader.read<uint64_t>());
+                break;
+
+            case trace_op::framebuffer_create:
+                state.framebuffers[reader.read<uint32_t>()] = gFramebuffer::Create();
+                break;
+            case trace_op::framebuffer_bind: {
+                uint32_t id = reader.read<uint32_t>();
+                auto it = state.framebuffers.find(id);
+                if (it != state.framebuffers.end())
+                    gFramebuffer::Bind(it->second);
+                else
+                    gFramebuffer::Unbind();
+                break;
+            }
+            case trace_op::framebuffer_texture: {
+                gTexture& texture = get_texture(state, reader.read<uint64_t>());
+                gFramebufferFlags attachment = static_cast<gFramebufferFlags>(reader.read<uint32_t>());
+                gFramebuffer::SetTexture(&texture, attachment, static_cast<gFramebufferFlags>(reader.read<uint32_t>()));
+                break;
+            }
+            case trace_op::framebuffer_destroy: {
+                uint32_t id = reader.read<uint32_t>();
+                auto it = state.framebuffers.find(id);
+                if (it != state.framebuffers.end())
+                {
+                    gFramebuffer::Destroy(it->second);
+                    state.framebuffers.erase(it);
+                }
+                break;
+            }
+
+            case trace_op::sampler_create: {
+                uint32_t id = reader.read<uint32_t>();
+                state.sampler_names[id] = state.samplers.get(reader.read<sampler_state>());
+                break;
+            }
+            case trace_op::sampler_bind: {
+                uint32_t unit = reader.read<uint32_t>();
+                sampler_cache::bind(unit, map_sampler(state, reader.read<uint32_t>()));
+                break;
+            }
+            case trace_op::unsupported:
+                fprintf(stderr, "gr-replay: the trace calls %s, which is not captured\n", reader.read_string());
+                return false;
+
+            default:
+                return false;
+        }
+
+        return !reader.has_overrun();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const char* path = nullptr;
+    context_config config;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--classic") == 0)
+            config.path = RenderPath::Classic;
+        else if (strcmp(argv[i], "--dsa") == 0)
+            config.path = RenderPath::DirectStateAccess;
+        else if (strcmp(argv[i], "--gles") == 0)
+            config.gles = true;
+        else
+            path = argv[i];
+    }
+
+    if (path == nullptr)
+    {
+        fprintf(stderr, "usage: gr-replay <trace> [--classic | --dsa] [--gles]\n");
+        return 1;
+    }
+
+    trace_reader reader;
+    if (!reader.open(path))
+    {
+        fprintf(stderr, "gr-replay: cannot read %s\n", path);
+        return 1;
+    }
+
+    std::unique_ptr<context> ctx = context::create_headless(config);
+    if (ctx == nullptr || !ctx->make_current())
+    {
+        fprintf(stderr, "gr-replay: no headless context\n");
+        return 1;
+    }
+
+#if !GR_OPENGLES3
+    const bool gpu_timing = !config.gles;
+#else
+    const bool gpu_timing = false;
+#endif
+
+    std::vector<frame_result> frames;
+    std::chrono::steady_clock::time_point frame_start;
+    bool in_frame = false;
+
+    {
+        replay_state state;
+
+        while (reader.next())
+        {
+            trace_op op = reader.get_op();
+
+            if (op == trace_op::frame_begin)
+            {
+                frame_result frame = {};
+#if !GR_OPENGLES3
+                if (gpu_timing)
+                {
+                    glGenQueries(2, frame.queries);
+                    glQueryCounter(frame.queries[0], GL_TIMESTAMP);
+                }
+#endif
+                frames.push_back(frame);
+
+                gRender::BeginFrame();
+                frame_start = std::chrono::steady_clock::now();
+                in_frame = true;
+            }
+
+            if (!execute(reader, state))
+            {
+                if (op != trace_op::unsupported)
+                    fprintf(stderr, "gr-replay: bad packet %u\n", static_cast<uint32_t>(op));
+                return 1;
+            }
+
+            if (op == trace_op::frame_end && in_frame)
+            {
+                frame_result& frame = frames.back();
+                frame.cpu_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frame_start).count();
+                frame.draw_calls = gRender::GetFrameStats().draw_calls;
+
+#if !GR_OPENGLES3
+                if (gpu_timing)
+                    glQueryCounter(frame.queries[1], GL_TIMESTAMP);
+#endif
+                gRender::EndFrame();
+                in_frame = false;
+            }
+        }
+
+        glFinish();
+
+        // os objetos do trace sao liberados aqui, com o contexto ainda ativo
+    }
+
+    double cpu_total = 0.0, gpu_total = 0.0;
+    double cpu_max = 0.0, gpu_max = 0.0;
+
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        double gpu_ms = 0.0;
+#if !GR_OPENGLES3
+        if (gpu_timing)
+        {
+            GLuint64 begin = 0, end = 0;
+            glGetQueryObjectui64v(frames[i].queries[0], GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(frames[i].queries[1], GL_QUERY_RESULT, &end);
+            glDeleteQueries(2, frames[i].queries);
+            gpu_ms = end > begin ? (end - begin) / 1e6 : 0.0;
+        }
+#endif
+        printf("frame %zu cpu_ms %.3f gpu_ms %.3f draws %u\n", i, frames[i].cpu_ms, gpu_ms, frames[i].draw_calls);
+
+        cpu_total += frames[i].cpu_ms;
+        gpu_total += gpu_ms;
+        cpu_max = std::max(cpu_max, frames[i].cpu_ms);
+        gpu_max = std::max(gpu_max, gpu_ms);
+    }
+
+    if (!frames.empty())
+    {
+        double n = static_cast<double>(frames.size());
+        printf("frames %zu cpu_ms avg %.3f max %.3f gpu_ms avg %.3f max %.3f\n", frames.size(), cpu_total / n, cpu_max, gpu_total / n, gpu_max);
+    }
+
+    return 0;
+}